@@ -0,0 +1,244 @@
+#! /usr/bin/env python3 #
+# -*- coding: utf-8 -*- #
+
+
+## Required Modules - - - - - - - - - - - - - - - - - - - - - - - - - -#
+## python built-in modules
+import sys
+import argparse
+from os       import EX_OK
+from os       import EX_DATAERR
+
+## third party modules
+import numpy as np
+
+
+## Formato - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -#
+## cabeçalho dos arquivos CSR gravados por --export-csr (csr_graph.h);
+## todos os números são little-endian
+CSR_MAGIC = b"HKCSR"
+CSR_VERSION = 1
+CSR_BYTE_ORDER = 0x01020304
+CSR_PAGE_SIZE = 4096
+CSR_ARC_IDS = 1
+
+CSR_HEADER = np.dtype([
+    ("magic",           "S8"),
+    ("version",         "<u4"),
+    ("byte_order",      "<u4"),
+    ("num_lines",       "<i4"),
+    ("width",           "<i4"),
+    ("overlap",         "<i4"),
+    ("flags",           "<u4"),
+    ("type",            "S16"),
+    ("nodes",           "<i8"),
+    ("arcs",            "<i8"),
+    ("weight_offset",   "<u8"),
+    ("bar_offset",      "<u8"),
+    ("offsets_offset",  "<u8"),
+    ("targets_offset",  "<u8"),
+    ("file_size",       "<u8"),
+    ("checksum",        "<u8"),
+    ("header_checksum", "<u8"),
+])
+
+FNV_OFFSET = 14695981039346656037
+FNV_PRIME = 1099511628211
+MASK_64 = (1 << 64) - 1
+
+
+## Implementações de Funções - - - - - - - - - - - - - - - - - - - - - -#
+def checksum(data: bytes) -> int:
+    """
+Calcula o checksum usado nos arquivos CSR e de cache (FNV-1a sobre
+palavras de 8 bytes, a última completada com zeros).
+
+Parâmetros
+----------
+data: bytes
+   Os bytes.
+
+Retorno
+-------
+int
+O checksum dos bytes.
+    """
+
+    resto = len(data) % 8
+    if resto != 0:
+        data = bytes(data) + bytes(8 - resto)
+
+    h = FNV_OFFSET
+    for palavra in np.frombuffer(data, dtype="<u8").tolist():
+        h = ((h ^ palavra) * FNV_PRIME) & MASK_64
+
+    return h
+
+
+def read_config_graph(path: str, verify: bool = False) -> dict:
+    """
+Abre um grafo de configuração gravado por --export-csr, sem copiar as
+seções do arquivo (cada uma é um np.memmap).
+
+Parâmetros
+----------
+path: str
+   O nome do arquivo CSR.
+
+verify: bool
+   Se o checksum das seções também deve ser conferido (percorre o
+   arquivo inteiro).
+
+Retorno
+-------
+dict
+O cabeçalho ("header") e as seções "node_weight", "bar", "offsets" e
+"targets": os arcos do vértice u vão para
+targets[offsets[u]:offsets[u +1]], e o peso de um arco é node_weight
+do seu destino.
+    """
+
+    header = np.fromfile(path, dtype=CSR_HEADER, count=1)
+    if len(header) != 1:
+        raise ValueError(f"{path} não é um arquivo CSR")
+    header = header[0]
+
+    if header["magic"] != CSR_MAGIC or header["version"] != CSR_VERSION \
+       or header["byte_order"] != CSR_BYTE_ORDER:
+        raise ValueError(f"{path} não é um arquivo CSR")
+
+    ## o checksum do cabeçalho cobre todos os campos antes dele
+    tamanho = CSR_HEADER.fields["header_checksum"][1]
+    if checksum(header.tobytes()[:tamanho]) != int(header["header_checksum"]):
+        raise ValueError(f"o cabeçalho de {path} está corrompido")
+
+    nodes = int(header["nodes"])
+    arcs = int(header["arcs"])
+
+    grafo = {
+        "header": header,
+        "node_weight": np.memmap(path, dtype="<i4", mode="r",
+                                 offset=int(header["weight_offset"]),
+                                 shape=(nodes,)),
+        "bar": np.memmap(path, dtype="<u8", mode="r",
+                         offset=int(header["bar_offset"]),
+                         shape=(nodes,)),
+        "offsets": np.memmap(path, dtype="<i8", mode="r",
+                             offset=int(header["offsets_offset"]),
+                             shape=(nodes +1,)),
+        "targets": np.memmap(path, dtype="<i4", mode="r",
+                             offset=int(header["targets_offset"]),
+                             shape=(arcs,)),
+    }
+
+    if verify:
+        dados = np.memmap(path, dtype=np.uint8, mode="r",
+                          offset=CSR_PAGE_SIZE)
+        if checksum(dados.tobytes()) != int(header["checksum"]):
+            raise ValueError(f"{path} está corrompido")
+
+    return grafo
+
+
+def bar_code(grafo: dict, u: int) -> list:
+    """
+Obtém os vértices do código em uma barra.
+
+Parâmetros
+----------
+grafo: dict
+   Um grafo de configuração lido por read_config_graph.
+
+u: int
+   O id de um vértice do grafo de configuração.
+
+Retorno
+-------
+list
+Os vértices do código na barra de u, como pares (coluna, linha), com
+as linhas numeradas a partir de 1 (como nos arquivos de Codes).
+    """
+
+    largura = int(grafo["header"]["width"])
+    linhas = int(grafo["header"]["num_lines"])
+    barra = int(grafo["bar"][u])
+
+    return [(c, r +1) for r in range(linhas) for c in range(largura)
+            if barra >> (r * largura + c) & 1]
+
+
+def to_networkx(grafo: dict):
+    """
+Constrói um networkx.DiGraph com os arcos do grafo de configuração,
+cada um com o seu peso no atributo "weight" (networkx só é importado
+aqui).
+
+Parâmetros
+----------
+grafo: dict
+   Um grafo de configuração lido por read_config_graph.
+
+Retorno
+-------
+networkx.DiGraph
+O grafo de configuração.
+    """
+
+    import networkx as nx
+
+    offsets = np.asarray(grafo["offsets"])
+    targets = np.asarray(grafo["targets"])
+    origens = np.repeat(np.arange(len(offsets) -1), np.diff(offsets))
+    pesos = np.asarray(grafo["node_weight"])[targets]
+
+    D = nx.DiGraph()
+    D.add_nodes_from(range(len(offsets) -1))
+    D.add_weighted_edges_from(zip(origens.tolist(), targets.tolist(),
+                                  pesos.tolist()))
+
+    return D
+
+
+## Script - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -#
+if __name__ == "__main__":
+    ## configuração dos argumentos do script
+    arg_parser = argparse.ArgumentParser(
+        prog="ConfigGraphCSR",
+        description="Reads a configuration graph saved by --export-csr"
+    )
+
+    arg_parser.add_argument(
+        "path",
+        help="CSR file of the configuration graph"
+    )
+
+    arg_parser.add_argument(
+        "--verify",
+        action="store_true",
+        help="also checks the checksum of the sections of the file"
+    )
+
+    script_args = arg_parser.parse_args()
+
+    try:
+        grafo = read_config_graph(script_args.path, script_args.verify)
+    except ValueError as e:
+        print(e)
+        sys.exit(EX_DATAERR)
+
+    header = grafo["header"]
+    graus = np.diff(grafo["offsets"])
+
+    print(f"H{header['num_lines']}: bars with {header['width']} columns "
+          f"({header['overlap']} overlapping), code "
+          f"{header['type'].decode()}")
+    print(f"Number of vertices: {header['nodes']}\t"
+          f"Number of edges: {header['arcs']}")
+    if header["nodes"] > 0:
+        print(f"Out degree: min {graus.min()}, max {graus.max()}")
+        print(f"Weights: min {grafo['node_weight'].min()}, "
+              f"max {grafo['node_weight'].max()}")
+    print("Arc ids of the programs: "
+          f"{'yes' if header['flags'] & CSR_ARC_IDS else 'no'}")
+
+    sys.exit(EX_OK)
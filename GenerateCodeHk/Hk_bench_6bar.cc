@@ -0,0 +1,343 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Benchmarks of the kernels of Hk_lemon_eng_6bar.cc (bars with 4
+   columns, overlapping 2), for each k given in the command line:
+
+       barcodes/generic      generate_all_barcodes over the hexagonal grid
+       barcodes/specialized  generate_all_barcodes with the checkers
+                             specialized for k
+       pairs/generic         check_unon_bars on a fixed set of pairs
+       pairs/specialized     seam_valid of the specialized checkers on the
+                             same pairs
+       mmc/<engine>          the MMC algorithm on the saved configuration
+                             graph of k
+
+   The program is linked with libhkcode, which has the kernels
+   (hkcode_6bar.h), as Hk_lemon_eng_6bar.cc (see benchmark.h for the
+   options).
+*/
+
+
+/* Bibliotecas - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include "hkcode_6bar.h"
+#include "benchmark.h"
+
+
+/* Namespaces - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+using namespace std;
+using namespace lemon;
+using namespace std::chrono;
+using namespace hk6;
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// name of the program in the results
+#define BENCH_PROGRAM "Hk_bench_6bar"
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: barcode_input
+ * ---------------------
+ * The input of the benchmarks of the bar codes
+ *
+ *       k: the number of lines of the hexagonal grid
+ * checker: the checkers specialized for k (NULL: over the hexagonal grid)
+ */
+struct barcode_input
+{
+  int               k;
+  const hk_checker *checker;
+};
+
+typedef struct barcode_input barcode_input;
+
+/*
+ * Struct: pair_input
+ * ------------------
+ * The input of the benchmarks of the unions of two bar codes
+ *
+ *         k: the number of lines of the hexagonal grid
+ *      size: the number of vertices of a bar code
+ *       bar: the bar codes
+ *     lines: the bar codes, one byte per line
+ *      pair: the pairs tested (indexes of bar)
+ * bar_union: the bar used by check_unon_bars to store a union
+ *   checker: the checkers specialized for k
+ */
+struct pair_input
+{
+  int               k;
+  int               size;
+  vector<vertex *>  bar;
+  vector<uint8_t>   lines;
+  vector<int>       pair;
+  vertex            bar_union;
+  const hk_checker *checker;
+};
+
+typedef struct pair_input pair_input;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: barcode_kernel
+ * ------------------------
+ * Generates all the bar codes
+ *
+ * returns: the number of bar codes
+ */
+long long barcode_kernel(void *input)
+{
+  barcode_input *barcodes;
+  linked_list l;
+  long long amt;
+
+  barcodes = (barcode_input *) input;
+
+  init_list(&l, barcodes->k, AMT_COLUMNS);
+  generate_all_barcodes(&l, barcodes->k, AMT_COLUMNS, barcodes->checker,
+			NULL, NULL);
+  amt = l.size;
+  deallocate_list(&l);
+
+  return amt;
+}
+
+/*
+ * Function: pair_generic_kernel
+ * -----------------------------
+ * Tests the pairs with check_unon_bars
+ *
+ * returns: the number of pairs whose union is a bar code
+ */
+long long pair_generic_kernel(void *input)
+{
+  pair_input *pairs;
+  long long valid;
+  size_t i;
+
+  pairs = (pair_input *) input;
+  valid = 0;
+
+  for (i = 0; i < pairs->pair.size(); i += 2)
+    valid += check_unon_bars(pairs->bar[pairs->pair[i]],
+			     pairs->bar[pairs->pair[i +1]],
+			     &pairs->bar_union, pairs->size, pairs->k);
+
+  return valid;
+}
+
+/*
+ * Function: pair_specialized_kernel
+ * ---------------------------------
+ * Tests the pairs with the specialized checkers
+ *
+ * returns: the number of pairs whose union is a bar code
+ */
+long long pair_specialized_kernel(void *input)
+{
+  pair_input *pairs;
+  long long valid;
+  size_t i;
+
+  pairs = (pair_input *) input;
+  valid = 0;
+
+  for (i = 0; i < pairs->pair.size(); i += 2)
+    valid += pairs->checker->seam_valid
+      (&pairs->lines[(size_t) pairs->pair[i] * pairs->k],
+       &pairs->lines[(size_t) pairs->pair[i +1] * pairs->k]);
+
+  return valid;
+}
+
+/*
+ * Function: save_bench_graph
+ * --------------------------
+ * Builds the configuration graph of k and saves it in a CSR file
+ *
+ *    path: the file
+ *       k: the number of lines of the hexagonal grid
+ * checker: the checkers specialized for k (NULL: over the hexagonal grid)
+ *
+ * returns: 1 if the graph was saved, otherwise, 0
+ */
+int save_bench_graph(const string &path, int k, const hk_checker *checker)
+{
+  linked_list l;
+  SmartDigraph G;
+  node **map;
+  vector<uint64_t> bar;
+  vector<int32_t> node_weight;
+  int saved;
+
+  init_list(&l, k, AMT_COLUMNS);
+  if (generate_all_barcodes(&l, k, AMT_COLUMNS, checker, NULL, NULL) == 0)
+    {
+      deallocate_list(&l);
+      return 0;
+    }
+
+  map = new (nothrow) node*[l.size];
+  if (map == NULL)
+    {
+      deallocate_list(&l);
+      return 0;
+    }
+
+  allocate_vertex_config_graph(&G, &l, map);
+  SmartDigraph::ArcMap<int> weight(G);
+
+  saved = 0;
+  if (allocate_edge_config_graph(&G, &l, map, k, &weight, -1, checker, NULL,
+				 NULL, NULL) == 1)
+    {
+      config_graph_arrays(G, map, k, &bar, &node_weight);
+      saved = save_csr_graph(path, k, AMT_COLUMNS, AMT_OVERLAP,
+			     CACHE_TYPE_IDCODE, bar, node_weight, G);
+    }
+
+  delete[] map;
+  deallocate_list(&l);
+  return saved;
+}
+
+/*
+ * Function: bench_lines
+ * ---------------------
+ * Runs the benchmarks of a value of k
+ *
+ *       k: the number of lines of the hexagonal grid
+ * options: the options of the benchmarks
+ *
+ * returns: 1 if all the benchmarks ran, otherwise, 0
+ */
+int bench_lines(int k, const bench_options &options)
+{
+  hk_checker specialized;
+  const hk_checker *checker; // NULL if there is no checker for k
+  barcode_input barcodes;
+  pair_input pairs;
+  bench_result result;
+  linked_list l;
+  node *nodeAux;
+  string path;
+  string mmc_name;           // the name of the benchmark of the MMC
+  int i;
+
+  checker = NULL;
+  if (select_checker<AMT_COLUMNS, AMT_OVERLAP>(k, &specialized) == 1)
+    checker = &specialized;
+
+  // the bar codes
+  barcodes.k = k;
+  barcodes.checker = NULL;
+  if (bench_selected(options, "barcodes/generic") == 1)
+    {
+      run_benchmark("barcodes/generic", k, 1LL << (k * AMT_COLUMNS),
+		    barcode_kernel, &barcodes, options, &result);
+      report_benchmark(BENCH_PROGRAM, options, result);
+    }
+
+  barcodes.checker = checker;
+  if (checker != NULL && bench_selected(options, "barcodes/specialized") == 1)
+    {
+      run_benchmark("barcodes/specialized", k, 1LL << (k * AMT_COLUMNS),
+		    barcode_kernel, &barcodes, options, &result);
+      report_benchmark(BENCH_PROGRAM, options, result);
+    }
+
+  // the unions of the same pairs of bar codes, drawn with a fixed seed
+  if (bench_selected(options, "pairs/generic") == 1 ||
+      (checker != NULL && bench_selected(options, "pairs/specialized") == 1))
+    {
+      init_list(&l, k, AMT_COLUMNS);
+      if (generate_all_barcodes(&l, k, AMT_COLUMNS, checker, NULL,
+				NULL) == 0 ||
+	  create_bar(&pairs.bar_union,
+		     k * (2 * AMT_COLUMNS - AMT_OVERLAP)) == 0)
+	{
+	  cerr << "It was not possible to generate the bar codes!\n";
+	  deallocate_list(&l);
+	  return 0;
+	}
+
+      pairs.k = k;
+      pairs.size = l.vertex_size;
+      pairs.checker = checker;
+      pairs.lines.resize((size_t) l.size * k);
+      for (nodeAux = l.first, i = 0; nodeAux != NULL;
+	   nodeAux = nodeAux->next, i++)
+	{
+	  pairs.bar.push_back(nodeAux->v);
+	  checker_lines(nodeAux->v->bar, k, AMT_COLUMNS,
+			&pairs.lines[(size_t) i * k]);
+	}
+      bench_pairs(l.size, options.pairs, &pairs.pair);
+
+      if (bench_selected(options, "pairs/generic") == 1)
+	{
+	  run_benchmark("pairs/generic", k, options.pairs,
+			pair_generic_kernel, &pairs, options, &result);
+	  report_benchmark(BENCH_PROGRAM, options, result);
+	}
+
+      if (checker != NULL && bench_selected(options, "pairs/specialized") == 1)
+	{
+	  run_benchmark("pairs/specialized", k, options.pairs,
+			pair_specialized_kernel, &pairs, options, &result);
+	  report_benchmark(BENCH_PROGRAM, options, result);
+	}
+
+      deallocate_bar(&pairs.bar_union);
+      deallocate_list(&l);
+    }
+
+  // the MMC algorithm on the saved graph, which is built the first time
+  mmc_name = string("mmc/") + options.engine_name;
+  if (bench_selected(options, mmc_name.c_str()) == 1)
+    {
+      path = bench_graph_file(options.graph_dir, k, AMT_COLUMNS,
+			      AMT_OVERLAP);
+
+      if (access(path.c_str(), F_OK) != 0)
+	{
+	  cout << "Saving the configuration graph in " << path << "\n";
+	  if (save_bench_graph(path, k, checker) == 0)
+	    {
+	      cerr << "It was not possible to save the configuration graph in "
+		   << path << "!\n";
+	      return 0;
+	    }
+	}
+
+      if (bench_mmc(BENCH_PROGRAM, path, k, AMT_COLUMNS, AMT_OVERLAP,
+		    options) == 0)
+	return 0;
+    }
+
+  return 1;
+}
+
+
+/* Main Program - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+int main(int argc, char **argv)
+{
+  bench_options options;
+  size_t i;
+
+  if (parse_bench_options(argc, argv, &options) == 0)
+    return EXIT_FAILURE;
+
+  print_bench_header(cout);
+  for (i = 0; i < options.lines.size(); i++)
+    if (bench_lines(options.lines[i], options) == 0)
+      return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -7,7 +7,11 @@
    Implementation of a program that builds a configuration graph, find a
    minimum mean cycle, on this graph, and use it as a pattern of code,
    with mininum density, for the hexagonal grid with k rows, denoted by
-   H_k
+   H_k. The kernels are in libhkcode (hkcode_6bar.h); this file reads
+   the options, plans the memory of the run and prints the code found.
+   It is built with
+
+       g++ -O2 -fopenmp Hk_lemon_eng_6bar.cc -L. -lhkcode -lemon -fopenmp
 */
 
 
@@ -17,1131 +21,641 @@
 #include <cstdlib>
 #include <new>
 #include <lemon/list_graph.h>
-#include <lemon/hartmann_orlin_mmc.h>
 #include <lemon/path.h>
 #include <lemon/smart_graph.h>
 #include <lemon/full_graph.h>
 #include <chrono>
 #include <string>
+#include <vector>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include "mmc_engine.h"
+#include "options.h"
+#include "arc_pruning.h"
+#include "bounded_period.h"
+#include "certificate.h"
+#include "barcode_extension.h"
+#include "transfer_count.h"
+#include "specialized_checker.h"
+#include "csr_graph.h"
+#include "hkcode.h"
+#include "hkcode_6bar.h"
 
 
 /* Namespaces - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 using namespace std;
 using namespace lemon;
 using namespace std::chrono;
-
-
-/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-// defines the maximum number of vertices in the closed neighborhood of a
-// vertex in hexagonal grid with finite number of rows
-#define NEIGHBOORHOD_SIZE 4
-
-// define the amount of columns in a 4-bar
-#define AMT_COLUMNS 4
-
-// define the amount of columns that two 4-bars overlap
-#define AMT_OVERLAP 2
-
-
-/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
-/*
- * Struct: vertex
- * --------------
- * Represents a vertex in configuration graph
- *
- *    bar: bit array that indicantes which vertex, from the
- *         hexagonal grid H_k, belongs to the code; which are represented
- *         in the following way (for a 4-bar)
- *         ...
- *         line 3: 12-13-14-15
- *                 |      |
- *         line 2: 8--9--10-11
- *                    |     |
- *         line 1: 4--5--6--7
- *                 |     |
- *         line 0: 0--1--2--3
- *
- * weight: the number of vertices that belongs to the code
- */
-struct vertex
-{
-  int    *bar;
-  double weight;
-};
-
-typedef struct vertex vertex;
-
-
-/*
- * Struct: node
- * ------------
- * Represents a node of a linked list
- *
- *   next: points to the next node of the list
- *
- * vertex: points to a vertex in configuration graph (struct vertex)
- */
-struct node
-{
-  struct node *next;
-  vertex      *v;
-};
-
-typedef struct node node;
-
-
-/*
- * Struct: linked_list
- * -------------------
- * Represents a linked list, where each node points to a vertex in
- * configuration graph
- *
- *        size: the number of nodes in the list
- *
- * vertex_size: the number of vertices that a vertex, in configuration
- *              graph, contains (number of columns = size of l-bar x
- *                               number of lines)
- *
- *       first: points to the first node of the list
- *
- *        last: points to the last element of the list
- */
-struct linked_list
-{
-  int size;
-  int vertex_size;
-  node  *first;
-  node  *last;
-};
-
-typedef struct linked_list linked_list;
-
-
-/*
- * Struct: config_vertex
- * ---------------------
- * Represents the line, column and identifier of a vertex in the
- * hexagonal grid. This struct is used to map the vertices from the bar
- * to the struct of the hexagonal grid and check if a set of vertices
- * is an identifying code; restricted to the vertices of the bar
- * (discarting the firts and last columns)
- *
- *       line: the line of the vertex in hexagonal grid
- *
- *     column: the column of th vertex in hexagonal grid
- *
- * identifier: the identifier of a vertex, such that:
- *             identifier[] = -1 -> there is no vertex
- *             identifier[] =  i -> id of the vertex that belongs
- *                                  to the code
- */
-struct config_vertex
-{
-  int line;
-  int column;
-  int identifier[NEIGHBOORHOD_SIZE] = {-1, -1, -1, -1};
-                        // o identifier tem 4 posições pois estamos
-                        // trabalhando com o conceito de 1-código de
-                        // identificação
-};
-
-typedef struct config_vertex config_vertex;
+using namespace hk6;
 
 
 /* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
 /*
- * Function: init_bar
- * ------------------
- * Initialize a bar
- *
- * v: points to a vertex in configuration graph (struct vertex)
- */
-void init_bar(vertex *v)
-{
-  v->bar = nullptr;
-  v->weight = 0;
-}
-
-/*
- * Function: create_bar
+ * Function: plan_lines
  * --------------------
- * Allocates a bar of given size
+ * Estimates the memory of the run (memory_plan.h) before anything is
+ * allocated, and changes the options to follow the plan: the engine of
+ * --mmc=auto, or the out-of-core mode when the graph does not fit in
+ * memory, and the number of OpenMP threads
  *
- *       v: points a vertex, which represents a bar
+ * num_lines: the number of lines of the hexagonal grid
+ *   options: the options of the run, changed by the plan
  *
- *    size: the amount of vertices, of the hexgonal grid, represented in
- *          the bar
- *
- * returns: 1, if the bar was allocated, otherwise, 0
+ * returns: 1 if the run fits in the limit, otherwise, 0
  */
-int create_bar(vertex *v, int size)
+int plan_lines(int num_lines, hk_options *options)
 {
-  int i;
-
-  try
-    {
-      v->bar = new int[size];
-    }
-  catch (bad_alloc& e)
+  memory_plan plan;
+  long long bar_bytes;        // memory of a bar code in the list
+  int allow_external;         // 1 if the options allow --external
+
+  bar_bytes = sizeof(node) + sizeof(vertex) +
+    num_lines * AMT_COLUMNS * sizeof(int) + 3 * PLAN_MALLOC_OVERHEAD;
+  allow_external = (external_allowed(options) == 1 &&
+		    options->checkpoint_dir == NULL) ? 1 : 0;
+
+  make_memory_plan(AMT_COLUMNS, 2 * AMT_COLUMNS - AMT_OVERLAP, num_lines,
+		   bar_bytes, options->mem_limit_mb, options->engine,
+		   allow_external, (options->external_dir != NULL) ? 1 : 0,
+		   options->ram_mb, &plan);
+  print_memory_plan(cout, plan);
+
+  if (plan.mode == PLAN_NONE)
     {
-      cerr << "bad_alloc: " << e.what() << "\n";
-      v->bar = nullptr;
-      v->weight = 0;
+      cerr << "The run for " << num_lines << " lines does not fit in "
+	   << plan.limit / (1024 * 1024) << " MB";
+      if (allow_external == 0 && options->external_dir == NULL)
+	cerr << " (and the options do not allow --external)";
+      cerr << "!\n";
       return 0;
     }
 
-  // initialize the array with zeros
-  // 0 means that a vertex (from the hexagonal grid) does not belongs
-  // to the code
-  for (i = 0; i < size; i++)
-    v->bar[i] = 0;
+  if (plan.mode == PLAN_EXTERNAL && options->external_dir == NULL)
+    options->external_dir = EXTERNAL_DEFAULT_DIR;
+  options->ram_mb = plan.ram_mb;
+  options->engine = plan.engine;
+#ifdef _OPENMP
+  omp_set_num_threads(plan.threads);
+#endif
 
   return 1;
 }
 
-/*
- * Function: deallocate_bar
- * ------------------------
- * Deallocates a bar
- *
- * v: points a vertex, which represents a bar
- */
-void deallocate_bar(vertex *v)
-{
-  if (v->bar != nullptr)
-    {
-      delete[] v->bar;
-      v->bar = nullptr;
-    }
-
-  v->weight = 0;
-}
 
+/* Main Program - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 /*
- * Function: print_bar
+ * Function: run_lines
  * -------------------
- * Prints the data of a vertex associate to a bar
+ * Finds the code of the hexagonal grid with the given number of lines (or
+ * only checks the fast kernels, with --differential)
  *
- *       v: points a vertex, which represents a bar
+ * num_lines: the number of lines of the hexagonal grid
+ *   options: the options given in the command line
+ * open_bars: the open bars extended by --row-extension, kept between the
+ *            values of k of a sweep
+ *   metrics: the metrics of the run, already initialized
  *
- *    size: the amount of vertices, of the hexgonal grid, represented in
- *          the bar
+ * returns: 1 if the code was found (or the checks passed), otherwise, 0
  */
-void print_bar(vertex *v, int size)
+int run_lines(int num_lines, const hk_options &options,
+	      barcode_table *open_bars, run_metrics *metrics)
 {
-  int i;
-
-  cout << "weight: " << v->weight << "  [";
-
-  for (i = 0; i < size -1; i++)
-    cout << v->bar[i] << ", ";
-
-  if (size != 0)
-    cout << v->bar[size -1];
-
-  cout << "]\n";
-}
-
-
-/*
- * Function: generate_all_bars
- * ---------------------------
- * Generate all the permutations of the vertices (hexagonal grid) of a bar
- * in the code of a given size
- *
- *       v: points a vertex, which represents a bar
- *
- *    size: the amount of vertices, of the hexgonal grid, represented in
- *          the bar
- *
- * returns: of the permutations
- */
-int generate_all_bars(vertex* v, int size) {
-  int k;
-
-  k = size -1;
-
-  while (k >= 0)
+  linked_list bar_codes;      // list of bar codes
+  SmartDigraph G;             // digraph which represents the configuration graph
+  node **map_vertex_grap_cfg; // array which makes the mapping from a vertex, in
+                              // configuration graph, to a bar code
+  ofstream code_file;         // file where the code will be outputed
+  mmc_engine engine;          // algorithm used to find the minimum mean cycle
+  pruning_stats pruning;      // arcs eliminated before the MMC
+  mmc_result mmc;             // the minimum mean cycle found
+  int config_graph_columns;   // number of columns represented in
+                              // configuration graph
+  vector<uint64_t> cycle_bars; // the bar codes of the cycle, as masks
+  hk_pattern pattern;         // the pattern of the code found
+  int max_length;             // number of arcs of the longest closed walk
+			      // with at most --max-period columns
+  vector<long long> period_cost; // minimum weight of a closed walk with
+			      // each number of arcs
+  string certificate_path;    // file with the certificate of optimality
+  hk_checker specialized;     // checkers specialized for the number of
+			      // lines
+  const hk_checker *checker;  // the checkers used (NULL: over LEMON graphs)
+  string cache_path;          // file with the cached configuration graph
+  graph_cache cache;          // the cache file, mapped in memory
+  int cached;                 // 1 if the graph is loaded from the cache
+  csr_graph csr;              // the CSR file given by --import-csr
+  vector<uint64_t> bar_masks; // the bar codes, by id, as masks
+  vector<int32_t> node_weight; // the weights of the arcs entering each
+			      // vertex, by id
+  string external_path;       // CSR file with the arcs, in the
+			      // out-of-core mode
+  external_graph external;    // the arcs being written to disk
+  checkpoint run_checkpoint;  // the checkpoints of the construction of
+			      // the graph
+  checkpoint *ckpt;           // &run_checkpoint, or NULL (no checkpoints)
+  long long tested;            // the bars tested before the extension
+  int l;
+
+  // the checkers specialized at compile time, when k is in their range
+  checker = NULL;
+  if (options.generic == 0 &&
+      select_checker<AMT_COLUMNS, AMT_OVERLAP>(num_lines, &specialized) == 1)
+    checker = &specialized;
+
+  // only checks the fast kernels against the reference ones
+  if (options.differential == 1)
+    return run_differential(num_lines, checker, options.differential_seed);
+
+  certificate_path = "../Codes/CodigoH" + to_string(num_lines) +
+    "GrafoConfig.cert";
+
+  // a closed walk with l arcs represents AMT_COLUMNS + AMT_OVERLAP (l -2)
+  // columns
+  max_length = (options.max_period - AMT_COLUMNS + 2 * AMT_OVERLAP) /
+    AMT_OVERLAP;
+
+  if (options.max_period > 0 && max_length < 1)
     {
-      if (v->bar[k] == 1)
-	v->bar[k--] = 0;
-
-      else
-	{
-	  v->bar[k] = 1;
-	  break;
-	}
+      cerr << "The period must have at least " << AMT_COLUMNS - AMT_OVERLAP
+	   << " columns!\n";
+      return 0;
     }
 
-  return k;
-}
-
-/*
- * Function: compute_bar_weight
- * ----------------------------
- * Computes the weight of a vertex which represents a bar
- *
- *       v: points a vertex, which represents a bar
- *
- *    size: the amount of vertices, of the hexgonal grid, represented in
- *          the bar
- *
- * returns: the weight (numeber of vertices in the code) of v
- */
-int compute_bar_weight(vertex *v, int size)
-{
-  int i, weight;
-
-  weight = 0;
+  // the bar codes are generated, or loaded with the graph
+  metrics_begin(metrics, METRICS_BARCODES);
 
-  for (i = 0; i < size; i++)
+  // the bar codes and the edges exported by a previous run, or saved in
+  // the cache
+  cached = 0;
+  csr.data = NULL;
+  cache.data = NULL;
+  if (options.import_csr != NULL)
     {
-      if (v->bar[i] == 1)
-	weight++;
+      if (open_csr_graph(options.import_csr, num_lines, AMT_COLUMNS,
+			 AMT_OVERLAP, CACHE_TYPE_IDCODE, &csr) == 0)
+	return 0;
     }
-
-  return weight;
-}
-
-/*
- * Function: copy_bar
- * ------------------
- * Copies the data from v2 (source) to v1 (target), of same size
- *
- * v1: points a veterx which represents a bar
- *
- * v2: points a veterx which represents a bar
- *
- * size: the number of vertices contained in the bar
- *
- */
-void copy_bar(vertex *v1, vertex *v2, int size)
-{
-  int i;
-
-  v1->weight = v2->weight;
-
-  for (i = 0; i < size; i++)
-    v1->bar[i] = v2->bar[i];
-}
-
-
-/*
- * Function: init_list
- * -------------------
- * Initializes a linked list l
- *
- * l: points to a linked list
- * k: number of lines of the hexagonal grid
- * z: number of columns of the hexagonal grid
- */
-void init_list(linked_list *l, int k, int z)
-{
-  l->size = 0;
-  l->vertex_size = z * k;
-  l->first = NULL;
-  l->last = NULL;
-}
-
-/*
- * Function: deallocate_list
- * -------------------------
- * Deallocate a linked list
- *
- * l: points to a linked list
- */
-void deallocate_list(linked_list *l)
-{
-  node *elemento;
-  node *aux;
-
-  if (l->size != 0)
+  else if (options.cache_dir != NULL)
     {
-      elemento = l->first;
+      cache_path = cache_file_name(options.cache_dir, num_lines, AMT_COLUMNS,
+				   AMT_OVERLAP, CACHE_TYPE_IDCODE);
+      cached = open_graph_cache(cache_path, num_lines, AMT_COLUMNS,
+				AMT_OVERLAP, CACHE_TYPE_IDCODE, &cache);
+    }
 
-      while (elemento != NULL)
+  // the checkpoints of the construction of the graph, and the last one
+  // when the run is resumed
+  ckpt = NULL;
+  if (options.checkpoint_dir != NULL && cached == 0)
+    {
+      checkpoint_init(&run_checkpoint,
+		      checkpoint_file_name(options.checkpoint_dir, num_lines,
+					   AMT_COLUMNS, AMT_OVERLAP,
+					   CACHE_TYPE_IDCODE),
+		      options.checkpoint_every, num_lines, AMT_COLUMNS,
+		      AMT_OVERLAP, CACHE_TYPE_IDCODE);
+      ckpt = &run_checkpoint;
+
+      if (options.resume == 1 && load_checkpoint(ckpt) == 0)
 	{
-	  deallocate_bar(elemento->v);
-	  delete elemento->v;
-	  elemento->v = nullptr;
-	  aux = elemento;
-	  elemento = elemento->next;
-	  delete aux;
+	  cerr << "The checkpoint " << ckpt->path << " is not valid!\n";
+	  return 0;
 	}
 
-      l->first = nullptr;
-      l->last = nullptr;
-      l->size = 0;
+      if (ckpt->phase != CHECKPOINT_NONE)
+	cout << "Resuming from " << ckpt->path << "\n";
     }
-}
 
-/*
- * Function: append_list
- * ---------------------
- * Appends an element to a linked list
- *
- * l: points to a linked list
- * v: an array which represents a bar code
- *
- * returns: 1 if the element was successfully appended, otherwise, 0
- */
-int append_list(linked_list *l, vertex *v)
-{
-  node *node_list;
+  // builds all the bar codes
+  init_list(&bar_codes, num_lines, AMT_COLUMNS);
 
-  try
+  if (csr.data != NULL || cached == 1)
     {
-      node_list = new node;
+      if ((csr.data != NULL &&
+	   append_barcodes(&bar_codes, csr.bar, csr.header->nodes) == 0) ||
+	  (cached == 1 &&
+	   append_barcodes(&bar_codes, cache.bar, cache.header->nodes) == 0))
+	{
+	  cerr << "It was not possible to load the bar codes!\n";
+	  close_csr_graph(&csr);
+	  close_graph_cache(&cache);
+	  deallocate_list(&bar_codes);
+	  return 0;
+	}
     }
-  catch (bad_alloc& e)
+  else if (ckpt != NULL && ckpt->phase != CHECKPOINT_NONE)
     {
-      cerr << "A node could not be allocated!\n" << e.what() << "\n";
-      return 0;
-    }
+      // the bar codes of the checkpoint, and the bars after its cursor
+      if (append_barcodes(&bar_codes, ckpt->bar.data(),
+			  ckpt->bar.size()) == 0)
+	{
+	  cerr << "It was not possible to load the bar codes!\n";
+	  deallocate_list(&bar_codes);
+	  return 0;
+	}
 
-  try
-    {
-      node_list->v = new vertex;
+      if (ckpt->phase == CHECKPOINT_BARS)
+	generate_all_barcodes(&bar_codes, num_lines, AMT_COLUMNS, checker,
+			      ckpt, metrics);
     }
-  catch (bad_alloc& e)
+  else if (options.row_extension == 1)
     {
-      cerr << "It was not possible to allocate a bar!\n" << e.what()
-	   << "\n";
-      delete node_list;
-      node_list = nullptr;
-      return 0;
-    }
+      // in a sweep, the open bars of the previous k gain a line
+      tested = open_bars->tested;
 
-  node_list->next = nullptr;
+      if (extend_all_barcodes(&bar_codes, num_lines, open_bars) == 0)
+	{
+	  cerr << "It was not possible to extend the bar codes!\n";
+	  deallocate_list(&bar_codes);
+	  return 0;
+	}
 
-  if (create_bar(node_list->v, l->vertex_size) == 0)
-    {
-      delete node_list;
-      node_list = nullptr;
-      return 0;
+      metrics->candidates_tested += open_bars->tested - tested;
     }
-
-  copy_bar(node_list->v, v, l->vertex_size);
-
-  if (l->size == 0)
-    l->first = node_list;
   else
-    l->last->next = node_list;
-
-  l->last = node_list;
-  l->size++;
-  return 1;
-}
+    generate_all_barcodes(&bar_codes, num_lines, AMT_COLUMNS, checker, ckpt,
+			  metrics);
 
-/*
- * Function: print_list
- * --------------------
- * Ouputs to stdout the data of a linked list l
- *
- * l: points to a linked list
- */
-void print_list(linked_list *l)
-{
-  node *element;
-
-  printf("Size: %d\t Size of a vertex (configuration graph): %d\n",
-	 l->size, l->vertex_size);
-  element = l->first;
+  metrics->valid_barcodes = bar_codes.size;
+  metrics_begin(metrics, METRICS_VERTICES);
 
-  while (element != NULL)
+  // creates the vertex which is used to make a maping from a bar code
+  // to a node list the list of bar codes
+  try
     {
-      print_bar(element->v, l->vertex_size);
-      element = element->next;
+      map_vertex_grap_cfg = new node*[bar_codes.size];
     }
-}
-
-
-/*
- * Function: allocate_hexagonal_grid
- * ---------------------------------
- * Allocates the hexgonal grid with k lines and z columns
- *
- * k: the number of lines of the hexagonal grid
- * z: the number of columns of the hexagonal grid
- * H: points to the graph which will represent the hexagonal grid
- */
-void allocate_hexagonal_grid(int k, int z, SmartGraph *H)
-{
-  int size;
-  int parity;
-  int i, j;
-
-  // number of vertices
-  size = k * z;
-
-  // creates the vertices
-  for (i = 0; i < size; i++)
-    H->addNode();
-
-  // add edges which represents the lines of the hexagonal grid
-  for(i = 0; i < size; i = i +z)
-    for(j = 0; j < z -1; j++)
-      H->addEdge(H->nodeFromId(i +j), H->nodeFromId(i +j +1));
-
-  // add the edges that represents the columns of the hexagonal grid
-  // we assume that we start at line 0, and also, even lines has
-  // parity -1
-  parity = -1;
-
-  // loop condition is i < size -z because, at each step we advance z
-  // vertices (number of vertices in a column)
-  // when z = 4 we got the following structure
-  for (i = 0; i < size -z; i = i +z)
+  catch (bad_alloc& e)
     {
-      if (parity == -1)
-	j = 0;
-      else
-	j = 1;
-
-      while (j < z)
-	{
-	  H->addEdge(H->nodeFromId(i +j), H->nodeFromId(i +z +j));
-	  j = j +2;
-	}
-
-      parity = parity * (-1);
+      cerr << "It was not possible to allotace the array to map vertices!\n"
+	   << e.what() << "\n";
+      deallocate_list(&bar_codes);
+      return 0;
     }
-}
-
-
-/*
- * Function: identifier_size
- * -------------------------
- * Computes the number of vertices in an identifier
- *
- *      id: an array of integers that represents an identifier
- *
- *    size: the number of vertices in the array id
- *
- * returns: the number of vertices in the array id which are in the
- *          code
- */
-int identifier_size(int *id, int size)
-{
-  int i;
-  int size_id;
-
-  size_id = 0;
-
-  for (i = 0; i < size; i++)
-    if (id[i] != -1)
-      size_id++;
-
-  return size_id;
-}
-
 
-/*
- * Function: equal_identifier
- * --------------------------
- * Check if two identifiers have the same vertices, that is, if they are
- * equal
- *
- *  id1: array of integers that represents the vertices of an identifier
- *
- *  id2: array of integers that represents the vertices of an identifier
- *
- * size: the number of vertices in a identifier (it applies to id1 and id2)
- *
- * returns: true if id1 == id2, otherwise, false
- */
-bool equal_identifier(int *id1, int *id2, int size)
-{
-  int amt_equal;
-  int size_id1, size_id2;
-  int i, j;
-
-  amt_equal = 0;
-  i = 0;
+  // creates the vertices and the edges of the configuration graph, with
+  // their weights; the weights are small integers, so the MMC runs with
+  // 64-bit integer accumulators and compares cycle means as fractions,
+  // instead of using floating point. In the anytime mode the edges are
+  // only created by run_anytime_mmc, in increasing order of weight
+  allocate_vertex_config_graph(&G, &bar_codes, map_vertex_grap_cfg);
+  SmartDigraph::ArcMap<int> MapPeso(G);
 
-  // computes the actual size of the identifiers id1 and id2
-  // this is done because an identifier has a fixed size of size
-  // and when it is created, the identifier is initialized with -1
-  // meaning that no vertex was assigned to the identifier
-  size_id1 = 0;
-  size_id2 = 0;
+  metrics_begin(metrics, METRICS_EDGES);
 
-  for (i = 0; i < size; i++)
+  if (csr.data != NULL)
     {
-      if (id1[i] != -1)
-	size_id1++;
+      if (options.target_den == 0)
+	csr_add_arcs(csr, &G, &MapPeso);
 
-      if (id2[i] != -1)
-	size_id2++;
+      close_csr_graph(&csr);
+      cout << "Configuration graph loaded from " << options.import_csr
+	   << "\n";
     }
-
-  // if size_d1 != size_id2, as id1 and id2 are not empty, then there is an
-  // element from id1 which does not belogs to id2, or vice-versa; then
-  // id1 and id2 are distinct
-  if (size_id1 != size_id2)
-    return false;
-
-  // note that, from this part, size_id1 = size_id2
-  i = 0;
-  while (i < size_id1)
+  else if (cached == 1)
     {
-      j = 0;
+      if (options.target_den == 0)
+	cache_add_arcs(cache, &G, &MapPeso);
 
-      while (j < size_id2)
+      close_graph_cache(&cache);
+      cout << "Configuration graph loaded from " << cache_path << "\n";
+    }
+  else if (options.external_dir != NULL)
+    {
+      // the arcs go to sorted runs on disk, merged into a CSR file
+      external_path = external_file_name(options.external_dir, num_lines,
+					 AMT_COLUMNS, AMT_OVERLAP,
+					 CACHE_TYPE_IDCODE);
+      config_graph_arrays(G, map_vertex_grap_cfg, num_lines, &bar_masks,
+			  &node_weight);
+      external_init(&external, external_path, options.ram_mb, num_lines,
+		    AMT_COLUMNS, AMT_OVERLAP, bar_masks, node_weight);
+
+      if (allocate_edge_config_graph(&G, &bar_codes, map_vertex_grap_cfg,
+				     num_lines, &MapPeso, -1, checker,
+				     &external, NULL, metrics) == 0 ||
+	  external_finish(&external) == 0)
 	{
-	  if (id1[i] == id2[j])
-	    {
-	      amt_equal++;
-	    }
-
-	  j++;
+	  cerr << "It was not possible to write the edges of the"
+	       << " configuration graph in " << external_path << "!\n";
+	  deallocate_list(&bar_codes);
+	  delete[] map_vertex_grap_cfg;
+	  return 0;
 	}
 
-      i++;
+      cout << "Configuration graph written to " << external_path << "\n";
     }
-
-  if (amt_equal == size_id1)
-    return true;
-
-  return false;
-}
-
-
-/*
- * Function: generate_all_barcodes
- * -------------------------------
- * Generates a list wit all bar codes
- *
- * linked_list: the list which has all the bar codes
- *
- *           k: number of lines of the hexagonal grid
- *
- *           z: number of columns of the hexagonal grid
- *
- *     returns: 1 if the list was created, otherwise, 0
- */
-int generate_all_barcodes(linked_list *l, int k, int z)
-{
-  vertex v;       // vertex which represents a bar
-  SmartGraph H;   // graph used to check if a bar is a bar code (valid)
-  bool valid_bar; // true if the bar, associated to v, is a bar code,
-                  // otherwise, false
-  int i, j;
-
-
-  // initialize the vertex which will be used to generate all the
-  // possible bars
-  init_bar(&v);
-
-  if (create_bar(&v, l->vertex_size) == 0)
-    return 0;
-
-  // creates the hexagonal grid which will be used to check if a bar
-  // is a bar code
-  SmartGraph::NodeMap<config_vertex> map_vertex_id(H);
-  allocate_hexagonal_grid(k, z, &H);
-
-  // do the maping from a vertex from H to a vertex in the hexagonal grid
-  // (z, k) (a vertex from the hexagonal grid)
-  for(i = 0; i < l->vertex_size; i = i +z)
-    for(j = 0; j < z; j++)
-      {
-        map_vertex_id[H.nodeFromId(i +j)].column = j;
-        map_vertex_id[H.nodeFromId(i +j)].line = i/z;
-      }
-
-  // loop that generates all the bar code
-  while (generate_all_bars(&v, l->vertex_size) >= 0)
+  else if (options.target_den == 0)
     {
-      v.weight = compute_bar_weight(&v, l->vertex_size);
-	  // build the identifiers for all vertices
-	  for (SmartGraph::NodeIt vertice(H); vertice != INVALID;
-	       ++vertice)
-	    {
-	      if (map_vertex_id[vertice].column != 0 &&
-		  map_vertex_id[vertice].column != z -1)
-		{
-		  i = 0;
-
-		  if (v.bar[H.id(vertice)] == 1)
-		    {
-		      map_vertex_id[vertice].identifier[i] =
-			H.id(vertice);
-		      i++;
-		    }
-
-		  for (SmartGraph::IncEdgeIt aresta(H, vertice);
-		       aresta != INVALID; ++aresta)
-		    {
-		      if (H.id(H.u(aresta)) != H.id(vertice) &&
-			  v.bar[H.id(H.u(aresta))] == 1)
-			{
-			  map_vertex_id[vertice].identifier[i] =
-			    H.id(H.u(aresta));
-			  i++;
-			}
-
-		      else if (H.id(H.v(aresta)) != H.id(vertice) &&
-			       v.bar[H.id(H.v(aresta))] == 1)
-			{
-			  map_vertex_id[vertice].identifier[i] =
-			    H.id(H.v(aresta));
-			  i++;
-			}
-		    }
-		}
-	    }
-
-	  valid_bar = true;
-
-	  // check if there is an empty identifier
-	  for (SmartGraph::NodeIt vertice(H); vertice != INVALID;
-	       ++vertice)
-	    {
-	      if (map_vertex_id[vertice].column != 0 &&
-		  map_vertex_id[vertice].column != z -1)
-		if (identifier_size(map_vertex_id[vertice].identifier, NEIGHBOORHOD_SIZE) == 0)
-		  valid_bar = false;
-	    }
-
-	  // check if there is two distinct vertices with the same identifier
-          if (valid_bar == true)
-	    {
-	      for (SmartGraph::NodeIt v1(H); v1 != INVALID; ++v1)
-		{
-		  if (map_vertex_id[v1].column != 0 &&
-		      map_vertex_id[v1].column != z -1)
-		    for (SmartGraph::NodeIt v2(H); v2 != INVALID; ++v2)
-		      {
-			if (H.id(v1) != H.id(v2) &&
-			    map_vertex_id[v2].column != 0 &&
-			    map_vertex_id[v2].column != z -1)
-			  if (equal_identifier(map_vertex_id[v1].identifier, map_vertex_id[v2].identifier, NEIGHBOORHOD_SIZE) == true)
-			    valid_bar = false;
-		      }
-		}
-	    }
-
-	  if (valid_bar == true)
-	    append_list(l, &v);
-
-	  // reinitialize the identifier for the next iteration
-          for (SmartGraph::NodeIt w(H); w != INVALID; ++w)
-	    {
-	      map_vertex_id[w].identifier[0] = -1;
-	      map_vertex_id[w].identifier[1] = -1;
-	      map_vertex_id[w].identifier[2] = -1;
-	      map_vertex_id[w].identifier[3] = -1;
-	    }
-    }
-
-  deallocate_bar(&v);
-  return 1;
-}
-
+      // the checkpoints of the edges have the bar codes by id, and the
+      // first one is saved as soon as all the bar codes are known
+      if (ckpt != NULL)
+	{
+	  config_graph_arrays(G, map_vertex_grap_cfg, num_lines, &ckpt->bar,
+			      &node_weight);
+
+	  if (ckpt->phase != CHECKPOINT_EDGES &&
+	      save_checkpoint(ckpt, CHECKPOINT_EDGES, 0, countNodes(G) -1,
+			      &G) == 0)
+	    cerr << "It was not possible to save the checkpoint "
+		 << ckpt->path << "!\n";
+	}
 
-/*
- * Function: check_unon_bars
- * -------------------------
- * Check if the union of two bars, by overlaping two columns,
- * forms a bar code.
- *
- *   v1: points to a vertex which represents a bar code
- *   v2: points to a vertex which represents a bar code
- * size: the number of vertices in v1 (or v2)
- *    k: number of lines of the hexagonal grids
- *
- * return: 1 if bar codes v1 and v2 froms a bar code, otherwise, 0
- *
- *  representation of how the union of v1 and v2 are made
- *                columns that overlap (must have the same pattern)
- *                ____________
- *                |           |
- * line 3: 12-13-14-15 == 12-13-14-15
- *         |      |       |      |
- * line 2: 8--9--10-11 == 8--9--10-11
- *            |     |        |     |
- * line 1: 4--5--6--7  == 4--5--6--7
- *         |     |        |     |
- * line 0: 0--1--2--3  == 0--1--2--3
- *               |           |
- *               -------------
- *         v1             v2
- */
-int check_unon_bars(vertex *v1, vertex *v2,
-	       vertex *new_vertex, int size, int k)
-{
-  SmartGraph H;          // graph used to check if the union of v1 and v2,
-                         // overlaping two columns, forms a bar code
-  int amt_columns_new_v; // number of vertices in H
-  int i, j;
+      if (allocate_edge_config_graph(&G, &bar_codes, map_vertex_grap_cfg,
+				     num_lines, &MapPeso, -1, checker,
+				     NULL, ckpt, metrics) == 0)
+	{
+	  cerr << "It was not possible to create the edges of the"
+	       << " configuration graph!\n";
+	  deallocate_list(&bar_codes);
+	  delete[] map_vertex_grap_cfg;
+	  return 0;
+	}
 
-  // check if v1 and v2 overlaps
-  for (i = 0; i < size; i = i + AMT_COLUMNS)
-    {
-      if (v1->bar[i+2] != v2->bar[i])
-	return 0;
+      // the graph is complete
+      if (ckpt != NULL)
+	remove_checkpoint(ckpt);
 
-      if (v1->bar[i+3] != v2->bar[i+1])
-	return 0;
+      if (options.cache_dir != NULL)
+	{
+	  config_graph_arrays(G, map_vertex_grap_cfg, num_lines, &bar_masks,
+			      &node_weight);
+
+	  if (save_graph_cache(cache_path, num_lines, AMT_COLUMNS,
+			       AMT_OVERLAP, CACHE_TYPE_IDCODE, bar_masks,
+			       node_weight, G) == 1)
+	    cout << "Configuration graph saved in " << cache_path << "\n";
+	  else
+	    cerr << "It was not possible to save the cache " << cache_path
+		 << "!\n";
+	}
     }
 
-  // creates a bar by the union of v1 and v2,
-  // overlaping two columns
-  amt_columns_new_v = AMT_COLUMNS + (AMT_COLUMNS - AMT_OVERLAP);
-  j = 0;
-  for (i = 0; i < size; i = i +AMT_COLUMNS)
+  // the configuration graph in CSR form, for other tools
+  if (options.export_csr != NULL && options.target_den == 0)
     {
-      new_vertex->bar[j] = v1->bar[i];
-      new_vertex->bar[j +1] = v1->bar[i +1];
-      new_vertex->bar[j +2] = v1->bar[i +2];
-      new_vertex->bar[j +3] = v1->bar[i +3];
-
-      new_vertex->bar[j +4] = v2->bar[i +2];
-      new_vertex->bar[j +5] = v2->bar[i +3];
-
-      j = j + amt_columns_new_v;
+      config_graph_arrays(G, map_vertex_grap_cfg, num_lines, &bar_masks,
+			  &node_weight);
+
+      if (save_csr_graph(options.export_csr, num_lines, AMT_COLUMNS,
+			 AMT_OVERLAP, CACHE_TYPE_IDCODE, bar_masks,
+			 node_weight, G) == 1)
+	cout << "Configuration graph exported to " << options.export_csr
+	     << "\n";
+      else
+	cerr << "It was not possible to export the configuration graph to "
+	     << options.export_csr << "!\n";
     }
 
-  new_vertex->weight = compute_bar_weight(new_vertex, amt_columns_new_v * k);
+  metrics_end(metrics);
+  metrics->arcs_accepted = (options.external_dir != NULL) ? external.arcs :
+    countArcs(G);
 
-  // create the graph to check the union of v1 and v2 is a bar code
-  SmartGraph::NodeMap<config_vertex> map_vertice_id(H);
-  allocate_hexagonal_grid(k, amt_columns_new_v, &H);
-
-  // set the column and line for the vertices of H, maping the vertices
-  // of H into the struct of the hexagonal grid
-  for(i = 0; i < amt_columns_new_v * k; i = i + amt_columns_new_v)
-    for(j = 0; j < amt_columns_new_v; j++)
-      {
-        map_vertice_id[H.nodeFromId(i +j)].column = j;
-        map_vertice_id[H.nodeFromId(i +j)].line = i/amt_columns_new_v;
-      }
+  cout << "Configuration Graph information\n";
+  cout << "Number of vertices: " << countNodes(G);
+  // the anytime search creates the edges, they are counted after it
+  if (options.target_den > 0)
+    cout << "\n\n";
+  else
+    cout << "\tNumber of edges: " << metrics->arcs_accepted << "\n\n";
+  cout << "Time to build the bar codes:\n";
+  print_elapsed(cout, metrics->phase_ns[METRICS_BARCODES]);
+  cout << "\n";
+  print_phase_perf(cout, *metrics, METRICS_BARCODES);
+  cout << "Time to build the vertices:\n";
+  print_elapsed(cout, metrics->phase_ns[METRICS_VERTICES]);
+  cout << "\n";
+  print_phase_perf(cout, *metrics, METRICS_VERTICES);
+  cout << "Time to build the edges:\n";
+  print_elapsed(cout, metrics->phase_ns[METRICS_EDGES]);
+  cout << "\n";
+  print_phase_perf(cout, *metrics, METRICS_EDGES);
 
-  // create the identifiers
-  for (SmartGraph::NodeIt vertice(H); vertice != INVALID;
-       ++vertice)
+  // compute the time to run a MMC algorithm
+  metrics_begin(metrics, METRICS_MMC);
+
+  // execute an algorithm to find a minimum mean cycle (or the closed
+  // walk with the smallest mean among the walks with bounded length)
+  if (run_mmc_step(&G, &bar_codes, map_vertex_grap_cfg, num_lines, &MapPeso,
+		   &options, checker, certificate_path, max_length,
+		   (options.external_dir != NULL) ? &external : NULL,
+		   &period_cost, &pruning, &engine, &mmc, metrics) == 0)
     {
-      if (map_vertice_id[vertice].column != 0 &&
-	  map_vertice_id[vertice].column != amt_columns_new_v -1)
-	{
-	  i = 0;
-
-	  if (new_vertex->bar[H.id(vertice)] == 1)
-	    {
-	      map_vertice_id[vertice].identifier[i] =
-		H.id(vertice);
-	      i++;
-	    }
-
-	  for (SmartGraph::IncEdgeIt aresta(H, vertice);
-	       aresta != INVALID; ++aresta)
-	    {
-	      if (H.id(H.u(aresta)) != H.id(vertice) &&
-		  new_vertex->bar[H.id(H.u(aresta))] == 1)
-		{
-		  map_vertice_id[vertice].identifier[i] =
-		    H.id(H.u(aresta));
-		  i++;
-		}
-
-	      else if (H.id(H.v(aresta)) != H.id(vertice) &&
-		      new_vertex->bar[H.id(H.v(aresta))] == 1)
-		{
-		  map_vertice_id[vertice].identifier[i] =
-		    H.id(H.v(aresta));
-		  i++;
-		}
-	    }
-	}
+      deallocate_list(&bar_codes);
+      delete[] map_vertex_grap_cfg;
+      return 0;
     }
 
-  // check if there is an empty identifier
-  for (SmartGraph::NodeIt vertice(H); vertice != INVALID;
-       ++vertice)
+  metrics_end(metrics);
+  metrics->mmc_iterations = mmc.iterations;
+  if (options.target_den > 0)
+    metrics->arcs_accepted = countArcs(G);
+  if (options.check == 1)
+    metrics->mmc_engine = "certificate";
+  else if (options.max_period > 0)
+    metrics->mmc_engine = "bounded period";
+  else
+    metrics->mmc_engine = mmc_engine_name(engine);
+
+  if (options.check == 1)
+    cout << "Time to check the certificate:\n";
+  else if (options.max_period > 0)
+    cout << "Time to run the bounded period dynamic program:\n";
+  else if (options.target_den > 0)
+    cout << "Time to create the edges and run the anytime search:\n";
+  else if (options.external_dir != NULL)
+    cout << "Time to run the out-of-core " << mmc_engine_name(engine)
+	 << " MMC algorithm (" << mmc.iterations << " probes):\n";
+  else
+    cout << "Time to run " << mmc_engine_name(engine) << " MMC algorithm:\n";
+  print_elapsed(cout, metrics->phase_ns[METRICS_MMC]);
+  cout << "\n";
+  print_phase_perf(cout, *metrics, METRICS_MMC);
+  if (options.target_den > 0)
+    cout << "Number of edges: " << metrics->arcs_accepted << "\n";
+  cout << "\n";
+
+  if (mmc.found == 0)
     {
-      if (map_vertice_id[vertice].column != 0 &&
-	  map_vertice_id[vertice].column != amt_columns_new_v -1)
-	if (identifier_size(map_vertice_id[vertice].identifier, NEIGHBOORHOD_SIZE) == 0)
-	  return 0;
+      if (options.check == 1)
+	cerr << "The certificate " << certificate_path
+	     << " is not valid!\n";
+      else if (options.max_period > 0)
+	cerr << "There is no code with period of at most "
+	     << options.max_period << " columns!\n";
+      else
+	cerr << "The configuration graph has no cycle!\n";
+      deallocate_list(&bar_codes);
+      delete[] map_vertex_grap_cfg;
+      return 0;
     }
 
-  // check if the identifiers are pairwise distinct
-  for (SmartGraph::NodeIt v1(H); v1 != INVALID; ++v1)
+  if (options.prune == 1 && options.check == 0 && options.max_period == 0 &&
+      options.target_den == 0)
+    cout << "Arc elimination (upper bound " << pruning.bound_cost << "/"
+	 << pruning.bound_size << ", " << pruning.rounds << " rounds): "
+	 << pruning.arcs_removed << " of " << countArcs(G) << " arcs and "
+	 << pruning.nodes_removed << " of " << countNodes(G)
+	 << " vertices removed\n\n";
+
+  // saves the certificate that the cycle is a minimum mean cycle
+  if (options.certificate == 1 && options.check == 0 &&
+      options.max_period == 0 && options.target_den == 0)
     {
-      if (map_vertice_id[v1].column != 0 &&
-	  map_vertice_id[v1].column != amt_columns_new_v -1)
-	for (SmartGraph::NodeIt v2(H); v2 != INVALID; ++v2)
-	  {
-	    if (H.id(v1) != H.id(v2) &&
-		map_vertice_id[v2].column != 0 &&
-		map_vertice_id[v2].column != amt_columns_new_v -1)
-	      if (equal_identifier(map_vertice_id[v1].identifier,
-				   map_vertice_id[v2].identifier,
-				   NEIGHBOORHOD_SIZE) == true)
-		return 0;
-	  }
+      if (write_certificate(certificate_path.c_str(), G, MapPeso, num_lines, AMT_COLUMNS,
+			    AMT_OVERLAP, &mmc) == 1)
+	cout << "Certificate saved in " << certificate_path << "\n\n";
+      else
+	cerr << "It was not possible to save the certificate!\n";
     }
 
-  return 1;
-}
-
-
-/*
- * Function: allocate_vertex_config_graph
- * --------------------------------------
- * Given a list with bar codes, creates the vertices of the configuration
- * graph
- *
- *   G: points to a digraph, which represents the configuration graph
- *
- *   l: linke list with bar codes
- *
- * map: a mapping from a vertex (configuration graph) to a bar code
- *      in the list l
- */
-void allocate_vertex_config_graph(SmartDigraph *G, linked_list *l, node **map)
-{
-  SmartDigraph::Node v;
-  node *No;
-  int i;
-
-  No = l->first;
-
-  for (i = 0; i < l->size; i++)
+  // shows the best density of the codes with each period
+  if (options.max_period > 0 && options.check == 0)
     {
-      v = G->addNode();
-      map[i] = No;
-      No = No->next;
+      cout << "Best density for each period:\n";
+      for (l = 1; l <= max_length; l++)
+	{
+	  config_graph_columns = AMT_COLUMNS + AMT_OVERLAP * (l -2);
+	  cout << "columns: " << config_graph_columns << "\t";
+
+	  if (period_cost[l] == PERIOD_INF)
+	    cout << "no code\n";
+	  else
+	    cout << "density: " << (double) period_cost[l] /
+	      (config_graph_columns * num_lines) << "\n";
+	}
+      cout << "\n";
     }
-}
-
-
-/*
- * Function: allocate_edge_config_graph
- * ------------------------------------
- * Given a list with bar codes, creates the edges of the configuration
- * graph
- *
- *   G: points to a digraph, which represents the configuration graph
- *
- *   l: linke list with bar codes
- *
- * map: a mapping from a vertex (configuration graph) to a bar code
- *      in the list l
- *
- *   k: the number of lines of the hexagonal grid
- */
-int allocate_edge_config_graph(SmartDigraph *G, linked_list *l, node **map, int k)
-{
-  node *nodeU;
-  node *nodeV;
-  vertex NovaCfg;
-
-  // creates a bar
-  if (create_bar(&NovaCfg, k * (2 * AMT_COLUMNS -2)) == 0)
-    return 0;
 
-  // add the edges
-  for (SmartDigraph::NodeIt u(*G); u != INVALID; ++u)
+  // checks the cycle mean with an engine independent from LEMON (the
+  // bounded period code is not always a minimum mean cycle)
+  if (options.cross_check == 1 && options.max_period == 0)
     {
-      for (SmartDigraph::NodeIt v(*G); v != INVALID; ++v)
+      switch (cross_check_mmc(G, MapPeso, &mmc))
 	{
-	  nodeU = map[G->id(u)];
-	  nodeV = map[G->id(v)];
-
-          if (check_unon_bars(nodeU->v, nodeV->v, &NovaCfg,
-			 l->vertex_size, k) == 1)
-	    G->addArc(u, v);
+	case 1:
+	  cout << "Cross-check (tropical engine): ok\n\n";
+	  break;
+	case 0:
+	  cout << "Cross-check (tropical engine): MISMATCH\n\n";
+	  break;
+	default:
+	  cout << "Cross-check (tropical engine): graph too large\n\n";
+	  break;
 	}
     }
 
-  return 1;
-}
+  // shows the information about the patter of the code, decoded from the
+  // bar codes of the cycle as in libhkcode
+  cycle_barcodes(G, mmc.cycle, map_vertex_grap_cfg, num_lines, &cycle_bars);
+  decode_pattern(num_lines, cycle_bars, &pattern);
 
+  cout << "Data about the code found:\n";
+  cout << "lines: "   << num_lines     << "\t";
+  cout << "columns: " << pattern.columns   << "\t";
+  cout << "density: " << (double) pattern.density_num / pattern.density_den
+       << " (" << pattern.density_num << "/" << pattern.density_den << ")"
+       << endl;
+
+  metrics->columns = pattern.columns;
+  metrics->density_num = pattern.density_num;
+  metrics->density_den = pattern.density_den;
+
+  // the code with bounded period does not replace the optimal code
+  if (options.max_period > 0)
+    code_file.open("../Codes/CodigoH" + to_string(num_lines) + "P" +
+		   to_string(options.max_period) + "GrafoConfig.txt");
+  else
+    code_file.open("../Codes/CodigoH" + to_string(num_lines) +
+		   "GrafoConfig.txt");
+  code_file << num_lines << " " << pattern.columns << " "
+	    << (double) pattern.density_num / pattern.density_den << "\n";
 
-/*
- * Function: compute_weigth_barcode
- * --------------------------------
- */
-double compute_weigth_barcode(int *bar, int k, int z)
-{
-  int i, j;
-  double weigth;
+  // prints the identifying code
+  print_pattern(cout, pattern);
+  print_pattern(code_file, pattern);
 
-  weigth = 0;
+  cout << "\n";
+  code_file << "\n";
+  code_file.close();
 
-  for (i = 0; i < k * z; i = i +z)
-      for (j = 2; j < z; j++)
-	weigth = weigth + (double) bar[i +j];
+  // the record of the run, with its peak memory
+  if (options.metrics_path != NULL &&
+      save_metrics(options.metrics_path, metrics) == 0)
+    cerr << "It was not possible to save the metrics in "
+	 << options.metrics_path << "!\n";
 
-  return weigth;
+  deallocate_list(&bar_codes);
+  delete[] map_vertex_grap_cfg;
+  return 1;
 }
 
-
-/* Main Program - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 int main(int argc, char **argv)
 {
+  hk_options options;         // options given in the command line
+  hk_options run_options;     // the options of a k, after its memory plan
+  barcode_table open_bars;    // open bars, extended by --row-extension
+  run_metrics process;        // the hardware counters of the process
+  vector<run_metrics> runs;   // the metrics of each k of the sweep
   int num_lines;              // number of lines of the hexagonal grid
-  linked_list bar_codes;      // list of bar codes
-  SmartDigraph G;             // digraph which represents the configuration graph
-  node **map_vertex_grap_cfg; // array which makes the mapping from a vertex, in
-                              // configuration graph, to a bar code
-  ofstream code_file;         // file where the code will be outputed
-  int config_graph_size;      // size of the configuration graph
-  int config_graph_columns;   // number of columns represented in
-                              // configuration graph
-  int i, j, h;
 
   // check if the all the arguments were properly passed
-  if (argc != 2)
-    {
-      cerr << "Invalid number of arguments!\n";
-      cerr << "Usage: " << argv[0] << " <number of lines>\n";
-      return EXIT_FAILURE;
-    }
-  else
-    num_lines = atoi(argv[1]);
-
-  // computes the time to create the graph
-  auto start = std::chrono::high_resolution_clock::now();
-
-  // builds all the bar codes
-  init_list(&bar_codes, num_lines, AMT_COLUMNS);
-  generate_all_barcodes(&bar_codes, num_lines, AMT_COLUMNS);
+  if (parse_options(argc, argv, &options) == 0)
+    return EXIT_FAILURE;
 
-  // creates the vertex which is used to make a maping from a bar code
-  // to a node list the list of bar codes
-  try
-    {
-      map_vertex_grap_cfg = new node*[bar_codes.size];
-    }
-  catch (bad_alloc& e)
+  // counts the bar codes and the arcs, without building them
+  if (options.count == 1)
     {
-      cerr << "It was not possible to allotace the array to map vertices!\n"
-	   << e.what() << "\n";
-      deallocate_list(&bar_codes);
-      return EXIT_FAILURE;
-    }
-
-  // creates the vertices and the edges of the configuration graph
-  allocate_vertex_config_graph(&G, &bar_codes, map_vertex_grap_cfg);
+      if (print_counts(options.num_lines, AMT_COLUMNS,
+		       2 * AMT_COLUMNS - AMT_OVERLAP) == 0)
+	return EXIT_FAILURE;
 
-  if (allocate_edge_config_graph(&G, &bar_codes, map_vertex_grap_cfg, num_lines) == 0)
-    {
-      cerr << "It was not possible to create the edges of the"
-	   << " configuration graph!\n";
-      deallocate_list(&bar_codes);
-      return EXIT_FAILURE;
+      return EXIT_SUCCESS;
     }
 
-  // add the weights to the edges
-  SmartDigraph::ArcMap<double> MapPeso(G);
-  SmartDigraph::Node u;
-  SmartDigraph::Node v;
-
-  for (SmartDigraph::ArcIt arco(G); arco != INVALID; ++arco)
+  // the hardware counters are opened before the worker threads exist, so
+  // the threads are counted too; without them only the times are measured
+  metrics_init(&process, "Hk_lemon_eng_6bar", options.k_first, AMT_COLUMNS,
+	       AMT_OVERLAP);
+  if (options.perf == 1 && metrics_enable_perf(&process) < PERF_EVENTS)
+    cerr << "Some hardware counters are not available ("
+	 << strerror(process.counters.error) << ")!\n";
+
+  open_bars.lines = 0;
+  open_bars.tested = 0;
+
+  // the values of k of a sweep run one after the other, each one with all
+  // the threads; the open bars, the counters and the threads of OpenMP
+  // are kept between them
+  for (num_lines = options.k_first; num_lines <= options.k_last; num_lines++)
     {
-      u = G.source(arco);
-      v = G.target(arco);
-      MapPeso[arco] = compute_weigth_barcode(map_vertex_grap_cfg[G.id(v)]->v->bar,
-					     num_lines,
-					     NEIGHBOORHOD_SIZE);
-    }
-
-  auto end = std::chrono::high_resolution_clock::now();
+      run_metrics metrics;    // the times and counters of this k
 
-  cout << "Configuration Graph information\n";
-  cout << "Number of vertices: " << countNodes(G) << "\t";
-  cout << "Number of edges: " << countArcs(G) << "\n\n";
-  cout << "Time to create the graph:\n"
-       << chrono::duration_cast<chrono::hours>(end - start).count()
-       << "h "
-       << chrono::duration_cast<chrono::minutes>(end - start).count() % 60
-       << "m "
-       << chrono::duration_cast<chrono::seconds>(end - start).count() % 60
-       << "s "
-       << chrono::duration_cast<chrono::milliseconds>(end - start).count() % 1000
-       << "ms "
-       << chrono::duration_cast<chrono::nanoseconds>(end - start).count() % 1000000
-       << "ns\n";
+      if (options.k_first < options.k_last)
+	cout << "Hexagonal grid with " << num_lines << " lines\n\n";
 
-  // compute the time to run a MMC algorithm
-  start = std::chrono::high_resolution_clock::now();
-
-  // execute an algorithm to find a minimum mean cycle
-  HartmannOrlinMmc<SmartDigraph, SmartDigraph::ArcMap<double>>
-    MMC(G, MapPeso);
-  Path<SmartDigraph> direct_path;
-  MMC.cycle(direct_path);
-  MMC.run();
-
-  end = std::chrono::high_resolution_clock::now();
-  cout << "Time to run Hartmann and Orlin's MMC algorithm:\n"
-       << chrono::duration_cast<chrono::hours>(end - start).count()
-       << "h "
-       << chrono::duration_cast<chrono::minutes>(end - start).count() % 60
-       << "m "
-       << chrono::duration_cast<chrono::seconds>(end - start).count() % 60
-       << "s "
-       << chrono::duration_cast<chrono::milliseconds>(end - start).count() % 1000
-       << "ms "
-       << chrono::duration_cast<chrono::nanoseconds>(end - start).count() % 1000000
-       << "ns\n\n";
-
-  // shows the information about the patter of the code
-  config_graph_columns = AMT_COLUMNS + AMT_OVERLAP * (MMC.cycleSize() -2);
-  config_graph_size = config_graph_columns * num_lines;
+      metrics_init(&metrics, "Hk_lemon_eng_6bar", num_lines, AMT_COLUMNS,
+		   AMT_OVERLAP);
+      if (process.perf == 1)
+	metrics_use_perf(&metrics, process.counters);
 
-  cout << "Data about the code found:\n";
-  cout << "lines: "   << num_lines     << "\t";
-  cout << "columns: " << config_graph_columns   << "\t";
-  cout << "density: " << (MMC.cycleMean() * MMC.cycleSize())/ (num_lines * config_graph_columns) << endl;
+      // the memory is planned before anything of this k is allocated
+      run_options = options;
+      if (options.mem_limit_mb != 0 && options.differential == 0 &&
+	  plan_lines(num_lines, &run_options) == 0)
+	return EXIT_FAILURE;
 
-  code_file.open("../Codes/CodigoH" + to_string(num_lines) + "GrafoConfig.txt");
-  code_file << num_lines << " " << config_graph_columns
-	    << " " << MMC.cycleMean() << "\n";
+      if (run_lines(num_lines, run_options, &open_bars, &metrics) == 0)
+	return EXIT_FAILURE;
 
-  // prints the identifying code
-  h = 0;
-  for (Path<SmartDigraph>::ArcIt arco(direct_path); arco != INVALID; ++arco)
-    {
-      u = G.source(arco);
-      if (h == 0)
-	{
-	  for (i = 0; i < bar_codes.vertex_size; i = i +AMT_COLUMNS)
-	    for (j = AMT_OVERLAP; j < AMT_COLUMNS; j++)
-	      if (map_vertex_grap_cfg[G.id(u)]->v->bar[i +j] == 1)
-		{
-		  cout << "(" << j - AMT_OVERLAP << ","
-		       << i/AMT_COLUMNS +1 << ") ";
-		  code_file << "(" << j - AMT_OVERLAP
-			    << "," << i/AMT_COLUMNS +1 << ") ";
-		}
-	}
-      else
-	{
-	  for (i = 0; i < bar_codes.vertex_size; i = i +AMT_COLUMNS)
-	    for (j = AMT_OVERLAP; j < AMT_COLUMNS; j++)
-	      if (map_vertex_grap_cfg[G.id(u)]->v->bar[i +j] == 1)
-		{
-		  cout << "(" << j + AMT_COLUMNS -2 +
-		    (h -1) * AMT_OVERLAP - AMT_OVERLAP
-		       << "," << i/AMT_COLUMNS +1 << ") ";
-		  code_file << "(" << j + AMT_COLUMNS -2 +
-		    (h -1) * AMT_OVERLAP - AMT_OVERLAP
-			    << "," << i/AMT_COLUMNS +1 << ") ";
-		}
-	}
-
-      h++;
+      runs.push_back(metrics);
+      if (options.k_first < options.k_last)
+	cout << "\n";
     }
 
-  cout << "\n";
-  code_file << "\n";
-  code_file.close();
+  if (options.k_first < options.k_last && options.differential == 0)
+    print_sweep_summary(cout, runs);
 
-  deallocate_list(&bar_codes);
-  delete[] map_vertex_grap_cfg;
   return EXIT_SUCCESS;
 }
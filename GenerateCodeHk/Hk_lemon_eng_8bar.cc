@@ -7,7 +7,11 @@
    Implementation of a program that builds a configuration graph, find a
    minimum mean cycle, on this graph, and use it as a pattern of code,
    with mininum density, for the hexagonal grid with k rows, denoted by
-   H_k
+   H_k. The kernels are in libhkcode (hkcode_8bar.h); this file reads
+   the options, plans the memory of the run and prints the code found.
+   It is built with
+
+       g++ -O2 -fopenmp Hk_lemon_eng_8bar.cc -L. -lhkcode -lemon -fopenmp
 */
 
 
@@ -17,999 +21,619 @@
 #include <cstdlib>
 #include <new>
 #include <lemon/list_graph.h>
-#include <lemon/hartmann_orlin_mmc.h>
 #include <lemon/path.h>
 #include <lemon/smart_graph.h>
 #include <lemon/full_graph.h>
 #include <chrono>
 #include <string>
+#include <vector>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include "mmc_engine.h"
+#include "options.h"
+#include "arc_pruning.h"
+#include "bounded_period.h"
+#include "certificate.h"
+#include "barcode_extension.h"
+#include "transfer_count.h"
+#include "specialized_checker.h"
+#include "csr_graph.h"
+#include "hkcode.h"
+#include "hkcode_8bar.h"
 
 
 /* Namespaces - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 using namespace std;
 using namespace lemon;
 using namespace std::chrono;
-
-
-/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-// defines the maximum number of vertices in the closed neighborhood of a
-// vertex in hexagonal grid with finite number of rows
-#define NEIGHBOORHOD_SIZE 4
-
-
-/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
-/*
- * Struct: vertex
- * --------------
- * Represents a vertex in configuration graph
- *
- *    bar: bit array that indicantes which vertex, from the
- *         hexagonal grid H_k, belongs to the code; which are represented
- *         in the following way (for a 4-bar)
- *         ...
- *         line 3: 12-13-14-15
- *                 |      |
- *         line 2: 8--9--10-11
- *                    |     |
- *         line 1: 4--5--6--7
- *                 |     |
- *         line 0: 0--1--2--3
- *
- * weight: the number of vertices that belongs to the code
- */
-struct vertex
-{
-  int    *bar;
-  double weight;
-};
-
-typedef struct vertex vertex;
-
-
-/*
- * Struct: node
- * ------------
- * Represents a node of a linked list
- *
- *   next: points to the next node of the list
- *
- * vertex: points to a vertex in configuration graph (struct vertex)
- */
-struct node
-{
-  struct node *next;
-  vertex      *v;
-};
-
-typedef struct node node;
-
-
-/*
- * Struct: linked_list
- * -------------------
- * Represents a linked list, where each node points to a vertex in
- * configuration graph
- *
- *        size: the number of nodes in the list
- *
- * vertex_size: the number of vertices that a vertex, in configuration
- *              graph, contains (number of columns = size of l-bar x
- *                               number of lines)
- *
- *       first: points to the first node of the list
- *
- *        last: points to the last element of the list
- */
-struct linked_list
-{
-  int  size;
-  int  vertex_size;
-  node *first;
-  node *last;
-};
-
-typedef struct linked_list linked_list;
-
-
-/*
- * Struct: config_vertex
- * ---------------------
- * Represents the line, column and identifier of a vertex in the
- * hexagonal grid. This struct is used to map the vertices from the bar
- * to the struct of the hexagonal grid and check if a set of vertices
- * is an identifying code; restricted to the vertices of the bar
- * (discarting the firts and last columns)
- *
- *    line: the line of the vertex in hexagonal grid
- *
- *   column: the column of th vertex in hexagonal grid
- *
- * pertence: indicates if a vertex belongs to the code
- *
- * identificador: the identifier of a vertex, such that:
- *                identificador[] = -1 -> there is no vertex
- *                identificador[] =  i -> id of the vertex that belongs
- *                                        to the code
- */
-struct config_vertex
-{
-  int line;
-  int column;
-  int pertence;
-  int identificador[NEIGHBOORHOD_SIZE] = {-1, -1, -1, -1};
-                        // the identifier has 4 positions since we are
-                        // working with 1-identifying code
-};
-
-typedef struct config_vertex config_vertex;
+using namespace hk8;
 
 
 /* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
 /*
- * Function: allocate_vertex
- * -------------------------
- * Allocates a vertex (struct vertex) of configuration graph
- *
- * vertex: a vertex in configuration graph
- *
- *   size: the number of vertices, from the hexagonal grid, in a
- *         vertex of the configuration graph
+ * Function: plan_lines
+ * --------------------
+ * Estimates the memory of the run (memory_plan.h) before anything is
+ * allocated, and changes the options to follow the plan: the engine of
+ * --mmc=auto, or the out-of-core mode when the graph does not fit in
+ * memory, and the number of OpenMP threads
  *
- *  return: 1 when the vertex was allocated, otherwise, 0
- */
-int allocate_vertex(vertex *v, int size)
-{
-  v->weight = 0;
-  v->bar = NULL;
-  v->bar = new (nothrow) int[size];
-
-  if (v->bar == NULL)
-      return 0;
-
-  return 1;
-}
-
-/*
- * Function: deallocate_vertex
- * ---------------------------
- * Deallocate a vertex (configuration graph)
+ *       k: the number of lines of the hexagonal grid
+ * options: the options of the run, changed by the plan
  *
- * vertex: a vertex of the configuration graph
+ * returns: 1 if the run fits in the limit, otherwise, 0
  */
-void deallocate_vertex(vertex *v)
+int plan_lines(int k, hk_options *options)
 {
-  v->weight = 0;
-
-  if (v->bar != NULL)
-    delete[] v->bar;
-
-  v->bar = NULL;
-}
-
-/*
- * Function: copy_vertex
- * ---------------------
- * Copies a bar code, of size tam, to a vertex of the configuration graph
- *
- *    v: points to a vertex (configuration graph)
- * size: the number of vertices in v
- *    u: array of integer, of the same size of v, which represents a bar
- *       code
- */
-void copy_vertex(vertex *v, int size, int *u)
-{
-  int i;
-
-  if (v->bar != NULL)
+  memory_plan plan;
+  long long bar_bytes;        // memory of a bar code in the list
+  int allow_external;         // 1 if the options allow --external
+
+  bar_bytes = sizeof(node) + sizeof(vertex) +
+    k * NEIGHBOORHOD_SIZE * sizeof(int) + 3 * PLAN_MALLOC_OVERHEAD;
+  allow_external = (external_allowed(options) == 1 &&
+		    options->checkpoint_dir == NULL) ? 1 : 0;
+
+  make_memory_plan(NEIGHBOORHOD_SIZE, 2 * NEIGHBOORHOD_SIZE, k,
+		   bar_bytes, options->mem_limit_mb, options->engine,
+		   allow_external, (options->external_dir != NULL) ? 1 : 0,
+		   options->ram_mb, &plan);
+  print_memory_plan(cout, plan);
+
+  if (plan.mode == PLAN_NONE)
     {
-      for (i = 0; i < size; i++)
-	{
-	  v->bar[i] = u[i];
-
-	  // if the vertex u[i] belongs to the code, then v-> weight is
-	  // incremented in one unit
-	  if (u[i] == 1)
-	    v->weight++;
-	}
-
-      v->weight = v->weight;
+      cerr << "ERRO: The run for " << k << " lines does not fit in "
+	   << plan.limit / (1024 * 1024) << " MB";
+      if (allow_external == 0 && options->external_dir == NULL)
+	cerr << " (and the options do not allow --external)";
+      cerr << "!\n";
+      return 0;
     }
-}
 
-/*
- * Function: print_vertex
- * ----------------------
- * Output to stdout the data of a vertex (configuration graph)
- *
- *    v: points to a vertex (configuration graph)
- * size: the number of vertex in v
- */
-void print_vertex(vertex *v, int size)
-{
-  int i;
-
-  printf("\nDensity: %f\n", v->weight);
-  printf("[");
+  if (plan.mode == PLAN_EXTERNAL && options->external_dir == NULL)
+    options->external_dir = EXTERNAL_DEFAULT_DIR;
+  options->ram_mb = plan.ram_mb;
+  options->engine = plan.engine;
+#ifdef _OPENMP
+  omp_set_num_threads(plan.threads);
+#endif
 
-  for (i = 0; i < size -1; i ++)
-    printf("%d, ", v->bar[i]);
-
-  if (size == 0)
-    printf("]");
-
-  else
-    printf("%d]\n", v->bar[size -1]);
+  return 1;
 }
 
 
+/* Main Program - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 /*
- * Function: init_list
+ * Function: run_lines
  * -------------------
- * Initializes a linked list l
- *
- * l: points to a linked list
- * k: number of lines of the hexagonal grid
- * z: number of columns of the hexagonal grid
- */
-void init_list(linked_list *l, int k, int z)
-{
-  l->size = 0;
-  l->vertex_size = z * k;
-  l->first = NULL;
-  l->last = NULL;
-}
-
-/*
- * Function: append_list
- * ---------------------
- * Appends an element to a linked list
+ * Finds the code of the hexagonal grid with k lines (or only checks the
+ * fast kernels, with --differential)
  *
- * l: points to a linked list
- * c: an array which represents a bar code
+ *         k: the number of lines of the hexagonal grid
+ *   options: the options given in the command line
+ * open_bars: the open bars extended by --row-extension, kept between the
+ *            values of k of a sweep
+ *   metrics: the metrics of the run, already initialized
  *
- * returns: 1 if the element was successfully appended, otherwise, 0
+ * returns: 1 if the code was found (or the checks passed), otherwise, 0
  */
-int append_list(linked_list *l, int *c)
+int run_lines(int k, const hk_options &options, barcode_table *open_bars,
+	      run_metrics *metrics)
 {
-  node *element;
-
-  element = NULL;
-  element = new (nothrow) node;
-
-  if (element == NULL)
-    return 0;
-
-  element->v = NULL;
-  element->v = new (nothrow) vertex;
-
-  if (element->v == NULL)
-    {
-      delete element;
-      element = NULL;
-      return 0;
-    }
-
-  if (allocate_vertex(element->v, l->vertex_size) == 0)
+  SmartDigraph G;            // digraph which represents a
+                             // configuration graph
+  SmartGraph H;              // graph used to check if a set of
+                             // vertices is a bar code
+  linked_list bar_code_list; // list with all bar codes
+  int i;
+  node *nodeAux;
+  ofstream code_file;
+  mmc_engine engine;         // algorithm used to find the minimum mean
+                             // cycle
+  pruning_stats pruning;     // arcs eliminated before the MMC
+  mmc_result mmc;            // the minimum mean cycle found
+  vector<uint64_t> cycle_bars; // the bar codes of the cycle, as masks
+  hk_pattern pattern;        // the pattern of the code found
+  int max_length;            // number of arcs of the longest closed
+			     // walk with at most --max-period columns
+  vector<long long> period_cost; // minimum weight of a closed walk
+			     // with each number of arcs
+  string certificate_path;   // file with the certificate of optimality
+  hk_checker specialized;    // checkers specialized for the number of
+			     // lines
+  const hk_checker *checker; // the checkers used (NULL: over LEMON graphs)
+  string cache_path;         // file with the cached configuration graph
+  graph_cache cache;         // the cache file, mapped in memory
+  int cached;                // 1 if the graph is loaded from the cache
+  csr_graph csr;             // the CSR file given by --import-csr
+  vector<uint64_t> bar_masks; // the bar codes, by id, as masks
+  vector<int32_t> node_weight; // the weights of the arcs entering each
+			     // vertex, by id
+  string external_path;      // CSR file with the arcs, in the out-of-core
+			     // mode
+  external_graph external;   // the arcs being written to disk
+  checkpoint run_checkpoint; // the checkpoints of the construction of
+			     // the graph
+  checkpoint *ckpt;          // &run_checkpoint, or NULL (no checkpoints)
+  long long tested;          // the bars tested before the extension
+  int l;
+
+  // the checkers specialized at compile time, when k is in their range
+  checker = NULL;
+  if (options.generic == 0 &&
+      select_checker<NEIGHBOORHOD_SIZE, 0>(k, &specialized) == 1)
+    checker = &specialized;
+
+  // only checks the fast kernels against the reference ones
+  if (options.differential == 1)
+    return run_differential(k, checker, options.differential_seed);
+
+  certificate_path = "../Codes/CodigoH" + to_string(k) + "GrafoConfig.cert";
+
+  // a closed walk with l arcs represents l * NEIGHBOORHOD_SIZE columns
+  max_length = options.max_period / NEIGHBOORHOD_SIZE;
+
+  if (options.max_period > 0 && max_length < 1)
     {
-      delete element;
-      element = NULL;
+      cerr << "ERRO: The period must have at least " << NEIGHBOORHOD_SIZE
+	   << " columns!\n";
       return 0;
     }
 
-  copy_vertex(element->v, l->vertex_size, c);
-  element->next = NULL;
-
-  if (l->size == 0)
-    l->first = element;
-
-  else
-    l->last->next = element;
-
-  l->last = element;
-  l->size++;
-  return 1;
-}
-
-/*
- * Function: deallocate_list
- * -------------------------
- * Deallocate a linked list l
- *
- * l: points to a linked lists
- */
-void deallocate_list(linked_list *l)
-{
-  node *element;
-  node *aux;
+  // builds all the bar codes
+  metrics_begin(metrics, METRICS_BARCODES);
+  init_list(&bar_code_list, k, NEIGHBOORHOD_SIZE);
 
-  if (l->size != 0)
+  // the bar codes and the edges exported by a previous run, or saved in
+  // the cache
+  cached = 0;
+  csr.data = NULL;
+  cache.data = NULL;
+  if (options.import_csr != NULL)
     {
-      element = l->first;
-
-      while (element != NULL)
+      if (open_csr_graph(options.import_csr, k, NEIGHBOORHOD_SIZE, 0,
+			 CACHE_TYPE_IDCODE, &csr) == 0)
 	{
-	  deallocate_vertex(element->v);
-	  delete element->v;
-	  element->v = NULL;
-	  aux = element;
-	  element = element->next;
-	  delete aux;
+	  deallocate_list(&bar_code_list);
+	  return 0;
 	}
-
-      l->first = NULL;
-      l->last = NULL;
-      l->size = 0;
     }
-}
-
-/*
- * Function: print_list
- * --------------------
- * Ouputs to stdout the data of a linked list l
- *
- * l: points to a linked list
- */
-void print_list(linked_list *l)
-{
-  node *element;
-
-  printf("Size: %d\t Size of a vertex (configuration graph): %d\n",
-	 l->size, l->vertex_size);
-  element = l->first;
-
-  while (element != NULL)
+  else if (options.cache_dir != NULL)
     {
-      print_vertex(element->v, l->vertex_size);
-      element = element->next;
+      cache_path = cache_file_name(options.cache_dir, k, NEIGHBOORHOD_SIZE, 0,
+				   CACHE_TYPE_IDCODE);
+      cached = open_graph_cache(cache_path, k, NEIGHBOORHOD_SIZE, 0,
+				CACHE_TYPE_IDCODE, &cache);
     }
-}
-
 
-/*
- * Function: next_config
- * ---------------------
- * Generates all permutations of the vertices, in the bar, in the code
- *
- * c: an array, of integers, which represents the vertices in a bar
- *
- * retuns: one of the possibile permutation of the vertices in the code
- */
-int next_config(int* c, int size) {
-  int k;
-
-  k = size -1;
-
-  while (k >= 0)
+  // the checkpoints of the construction of the graph, and the last one
+  // when the run is resumed
+  ckpt = NULL;
+  if (options.checkpoint_dir != NULL && cached == 0)
     {
-      if (c[k] == 1)
-	c[k--] = 0;
-
-      else
+      checkpoint_init(&run_checkpoint,
+		      checkpoint_file_name(options.checkpoint_dir, k,
+					   NEIGHBOORHOD_SIZE, 0,
+					   CACHE_TYPE_IDCODE),
+		      options.checkpoint_every, k, NEIGHBOORHOD_SIZE, 0,
+		      CACHE_TYPE_IDCODE);
+      ckpt = &run_checkpoint;
+
+      if (options.resume == 1 && load_checkpoint(ckpt) == 0)
 	{
-	  c[k] = 1;
-	  break;
+	  cerr << "ERRO: The checkpoint " << ckpt->path
+	       << " is not valid!\n";
+	  deallocate_list(&bar_code_list);
+	  return 0;
 	}
-    }
 
-  return k;
-}
-
-
-/*
- * Function: identifier_size
- * -------------------------
- * Computes the number of vertices in an identifier
- *
- *   id: an array of integers that represents an identifier
- * size: the number of vertices in the array id
- *
- * returns: the number of vertices in the array id which are in the
- *          code
- */
-int identifier_size(int *id, int size)
-{
-  int i;
-  int size_id;
-
-  size_id = 0;
-
-  for (i = 0; i < size; i++)
-    if (id[i] != -1) // -1 means that there is no vertex
-      size_id++;
-
-  return size_id;
-}
-
-
-/*
- * Function: equal_identifier
- * --------------------------
- * Check if two identifiers have the same vertices, that is, if they are
- * equal
- *
- *  id1: array of integers that represents the vertices of an identifier
- *
- *  id2: array of integers that represents the vertices of an identifier
- *
- * size: the number of vertices in a identifier (it applies to id1 and id2)
- *
- * returns: true if id1 == id2, otherwise, false
- */
-bool equal_identifier(int *id1, int *id2, int size)
-{
-  int qtde_elementos_iguais;
-  int size_id1, size_id2;
-  int i, j;
-
-  qtde_elementos_iguais = 0;
-  i = 0;
-
-  // computes the actual size of the identifiers id1 and id2
-  // this is done because an identifier has a fixed size of size
-  // and when it is created, the identifier is initialized with -1
-  // meaning that no vertex was assigned to the identifier
-  size_id1 = 0;
-  size_id2 = 0;
+      if (ckpt->phase != CHECKPOINT_NONE)
+	cout << "Resuming from " << ckpt->path << "\n";
+    }
 
-  for (i = 0; i < size; i++)
+  // in a sweep, the open bars of the previous k gain a line
+  tested = open_bars->tested;
+
+  // the bar codes of a checkpoint of the edges are by id, and the ones of
+  // a checkpoint of the bars are followed by the bars after its cursor
+  if ((csr.data != NULL &&
+       load_graph_cfg(&bar_code_list, csr.bar, csr.header->nodes) == 0) ||
+      (cached == 1 &&
+       load_graph_cfg(&bar_code_list, cache.bar, cache.header->nodes) == 0) ||
+      (ckpt != NULL && ckpt->phase == CHECKPOINT_EDGES &&
+       load_graph_cfg(&bar_code_list, ckpt->bar.data(),
+		      ckpt->bar.size()) == 0) ||
+      (ckpt != NULL && ckpt->phase == CHECKPOINT_BARS &&
+       (append_barcodes(&bar_code_list, ckpt->bar.data(),
+			ckpt->bar.size()) == 0 ||
+	create_graph_cfg(&bar_code_list, k, NEIGHBOORHOD_SIZE, checker,
+			 ckpt, metrics) == 0)) ||
+      (csr.data == NULL && cached == 0 &&
+       (ckpt == NULL || ckpt->phase == CHECKPOINT_NONE) &&
+       options.row_extension == 1 &&
+       extend_graph_cfg(&bar_code_list, k, open_bars) == 0) ||
+      (csr.data == NULL && cached == 0 &&
+       (ckpt == NULL || ckpt->phase == CHECKPOINT_NONE) &&
+       options.row_extension == 0 &&
+       create_graph_cfg(&bar_code_list, k, NEIGHBOORHOD_SIZE, checker,
+			ckpt, metrics) == 0))
     {
-      if (id1[i] != -1)
-	size_id1++;
-
-      if (id2[i] != -1)
-	size_id2++;
+      cerr << "ERRO: It was not possible to generate the bar codes!\n";
+      close_csr_graph(&csr);
+      close_graph_cache(&cache);
+      deallocate_list(&bar_code_list);
+      return 0;
     }
 
-  // if size_d1 != size_id2, as id1 and id2 are not empty, then there is an
-  // element from id1 which does not belogs to id2, or vice-versa; then
-  // id1 and id2 are distinct
-  if (size_id1 != size_id2)
-    return false;
-
-  // note that, from this part, size_id1 = size_id2
-  i = 0;
-  while (i < size_id1)
-    {
-      j = 0;
+  metrics_end(metrics);
+  metrics->candidates_tested += open_bars->tested - tested;
+  metrics->valid_barcodes = bar_code_list.size;
+  cout << "Time to build all bar codes: ";
+  print_elapsed(cout, metrics->phase_ns[METRICS_BARCODES]);
+  cout << "\n";
+  print_phase_perf(cout, *metrics, METRICS_BARCODES);
 
-      while (j < size_id2)
-	{
-	  if (id1[i] == id2[j])
-	    {
-	      qtde_elementos_iguais++;
-	    }
+  // builds the configuration graph
+  metrics_begin(metrics, METRICS_VERTICES);
+  for (i = 0; i < bar_code_list.size; i++)
+    G.addNode();
 
-	  j++;
-	}
+  // assign a bar code for each vertex of the configuration graph
+  SmartDigraph::NodeMap<node *> map_vertices(G);
+  nodeAux = bar_code_list.first;
 
-      i++;
+  for (SmartDigraph::NodeIt v(G); v != INVALID; ++v)
+    {
+      map_vertices[v] = nodeAux;
+      nodeAux = nodeAux->next;
     }
 
-  if (qtde_elementos_iguais == size_id1)
-    return true;
+  metrics_end(metrics);
+  cout << "Time to build all the vertices: ";
+  print_elapsed(cout, metrics->phase_ns[METRICS_VERTICES]);
+  cout << "\n";
+  print_phase_perf(cout, *metrics, METRICS_VERTICES);
 
-  return false;
-}
+  // build all the edges of the configuration graph
+  metrics_begin(metrics, METRICS_EDGES);
+  create_vertex_graph_cfg(k, 2 * NEIGHBOORHOD_SIZE, &H);
 
+  // creates a map to add a weight to the edges; the weights are small
+  // integers, so the MMC runs with 64-bit integer accumulators and
+  // compares cycle means as fractions, instead of using floating point.
+  // In the anytime mode the edges are only created by run_anytime_mmc,
+  // in increasing order of weight
+  SmartDigraph::ArcMap<int> map_weight(G);
 
-/*
- * Function: obtain_weigth
- * -----------------------
- * Computes the number of vertices, in bar of size tam, belongs to the
- * code
- *
- *   c: an array which represents a bar o length tam
- * tam: the number of vertices in the array c
- *
- * returns: the number of elements in c which belongs to the code
- */
-int obtain_weigth(int *c, int size)
-{
-  int i;
-  int weight = 0;
-
-  for (i = 0; i < size; i++)
+  if (csr.data != NULL)
     {
-      if (c[i] == 1)
-	weight++;
-    }
-
-  return weight;
-}
+      if (options.target_den == 0)
+	csr_add_arcs(csr, &G, &map_weight);
 
-
-/*
- * Function: create_vertex_graph_cfg
- * ---------------------------------
- * Creates a vertex of configuration graph
- *
- * k: number of lines of the hexagonal grid
- * z: number of columns of the hexagonal grid
- * H: points to a SmathGraph
- */
-void create_vertex_graph_cfg(int k, int z, SmartGraph *H)
-{
-  int size;
-  int parity;
-  int i, j;
-
-  // number of vertices, from the hexagonal grid, that a vertex from
-  // configuration graph has
-  size = k * z;
-
-  // creates the vertices
-  for (i = 0; i < size; i++)
-    H->addNode();
-
-  // add edges between vertices in the same line
-  for(i = 0; i < size; i = i +z)
-    for(j = 0; j < z -1; j++)
-      H->addEdge(H->nodeFromId(i +j), H->nodeFromId(i +j +1));
-
-  // add the edges that represents the columns of the hexagonal grid
-  // we assume that we start at line 0, and also, even lines has
-  // parity -1
-  parity = -1;
-
-  // loop condition is i < size -z because, at each step we advance z
-  // vertices (number of vertices in a column)
-  // when z = 4 we got the following structure
-  for (i = 0; i < size -z; i = i +z)
+      close_csr_graph(&csr);
+      cout << "Configuration graph loaded from " << options.import_csr
+	   << "\n";
+    }
+  else if (cached == 1)
     {
-      if (parity == -1)
-	j = 0;
-      else
-	j = 1;
+      if (options.target_den == 0)
+	cache_add_arcs(cache, &G, &map_weight);
 
-      while (j < z)
+      close_graph_cache(&cache);
+      cout << "Configuration graph loaded from " << cache_path << "\n";
+    }
+  else if (options.external_dir != NULL)
+    {
+      // the arcs go to sorted runs on disk, merged into a CSR file
+      external_path = external_file_name(options.external_dir, k,
+					 NEIGHBOORHOD_SIZE, 0,
+					 CACHE_TYPE_IDCODE);
+      config_graph_arrays(G, map_vertices, bar_code_list.vertex_size,
+			  &bar_masks, &node_weight);
+      external_init(&external, external_path, options.ram_mb, k,
+		    NEIGHBOORHOD_SIZE, 0, bar_masks, node_weight);
+
+      if (allocate_edge_config_graph(&G, map_vertices,
+				     bar_code_list.vertex_size, k,
+				     &map_weight, -1, checker,
+				     &external, NULL, metrics) == 0 ||
+	  external_finish(&external) == 0)
 	{
-	  H->addEdge(H->nodeFromId(i +j), H->nodeFromId(i +z +j));
-	  j = j +2;
+	  cerr << "ERRO: It was not possible to write the edges of the"
+	       << " configuration graph in " << external_path << "!\n";
+	  deallocate_list(&bar_code_list);
+	  return 0;
 	}
 
-      parity = parity * (-1);
+      cout << "Configuration graph written to " << external_path << "\n";
     }
-}
-
-
-/*
- * Function: create_graph_cfg
- * --------------------------
- * Creates all the vertices of a configuration graph
- *
- * linked_list: list which contains all barcodes
- *
- *           k: number of lines of the hexagonal grid
- *
- *           z: number of columns of the hexagonal grid
- *
- * returns: the amount of vertices created
- */
-int create_graph_cfg(linked_list *l, int k, int z)
-{
-  int size;       // the size of the array which represents a bar
-  int *c;         // the array used to represent a bar
-  SmartGraph H;   // graph used to check if a set of vertices is a bar
-                  // code
-  bool valid_bar; // true if a set of vertices is a bar code, otherwise
-                  // is false
-  int i, j;
-
-  // allocates the array all the possible barcode of a bar
-  c = nullptr;
-  size = k * z;
-  c = new (nothrow) int[size];
-
-  if (c == nullptr)
-    return 0;
-
-  // initialize the array c with zeros, because 0 means a
-  // vertex, in the bar, boes not belongs to code
-  for (i = 0; i < size; i++)
-    c[i] = 0;
-
-  // generates the graph used to check if a set of vertices is a bar code
-  SmartGraph::NodeMap<config_vertex> map_vertice_id(H);
-  create_vertex_graph_cfg(k, z, &H);
-
-  // does a mapping of a vertex, from the bar, to an order pair
-  // (z, k) (column, line) which representes a vertex in hexagonal grid
-  for(i = 0; i < size; i = i +z)
-    for(j = 0; j < z; j++)
-      {
-        map_vertice_id[H.nodeFromId(i +j)].column = j;
-        map_vertice_id[H.nodeFromId(i +j)].line = i/z;
-      }
-
-  // check if a set of vertices is a bar code
-  while (next_config(c, size) >= 0)
+  else if (options.target_den == 0)
     {
-      valid_bar = true;
-
-      if (valid_bar == true)
+      // the checkpoints of the edges have the bar codes by id, and the
+      // first one is saved as soon as all the bar codes are known
+      if (ckpt != NULL)
 	{
-	  // builds the identifier for the vertices (discarting the
-	  // first and last columns) in the bar
-	  for (SmartGraph::NodeIt vertex(H); vertex != INVALID;
-	       ++vertex)
-	    {
-	      if (map_vertice_id[vertex].column != 0 &&
-		  map_vertice_id[vertex].column != z -1)
-		{
-		  i = 0;
-
-		  if (c[H.id(vertex)] == 1)
-		    {
-		      map_vertice_id[vertex].identificador[i] =
-			H.id(vertex);
-		      i++;
-		    }
-
-		  for (SmartGraph::IncEdgeIt aresta(H, vertex);
-		       aresta != INVALID; ++aresta)
-		    {
-		      if (H.id(H.u(aresta)) != H.id(vertex) &&
-			  c[H.id(H.u(aresta))] == 1)
-			{
-			  map_vertice_id[vertex].identificador[i] =
-			    H.id(H.u(aresta));
-			  i++;
-			}
-
-		      else if (H.id(H.v(aresta)) != H.id(vertex) &&
-			       c[H.id(H.v(aresta))] == 1)
-			{
-			  map_vertice_id[vertex].identificador[i] =
-			    H.id(H.v(aresta));
-			  i++;
-			}
-		    }
-		}
-	    }
-
-	  // check if the identifiers (dispate the first and last column)
-	  // are not empty
-	  for (SmartGraph::NodeIt vertex(H); vertex != INVALID;
-	       ++vertex)
-	    {
-	      if (map_vertice_id[vertex].column != 0 &&
-		  map_vertice_id[vertex].column != z -1)
-		if (identifier_size(map_vertice_id[vertex].identificador, NEIGHBOORHOD_SIZE) == 0)
-		  valid_bar = false;
-	    }
+	  config_graph_arrays(G, map_vertices, bar_code_list.vertex_size,
+			      &ckpt->bar, &node_weight);
+
+	  if (ckpt->phase != CHECKPOINT_EDGES &&
+	      save_checkpoint(ckpt, CHECKPOINT_EDGES, 0, countNodes(G) -1,
+			      &G) == 0)
+	    cerr << "ERRO: It was not possible to save the checkpoint "
+		 << ckpt->path << "!\n";
 	}
 
-      // check if the identifiers are pairwise distinct
-      if (valid_bar == true)
+      if (allocate_edge_config_graph(&G, map_vertices,
+				     bar_code_list.vertex_size, k,
+				     &map_weight, -1, checker, NULL,
+				     ckpt, metrics) == 0)
 	{
-	  for (SmartGraph::NodeIt v1(H); v1 != INVALID; ++v1)
-	    {
-	      if (map_vertice_id[v1].column != 0 &&
-		  map_vertice_id[v1].column != z -1)
-		for (SmartGraph::NodeIt v2(H); v2 != INVALID; ++v2)
-		  {
-		    if (H.id(v1) != H.id(v2) &&
-			map_vertice_id[v2].column != 0 &&
-			map_vertice_id[v2].column != z -1)
-		      if (equal_identifier(
-				  map_vertice_id[v1].identificador,
-				  map_vertice_id[v2].identificador,
-				  NEIGHBOORHOD_SIZE) == true)
-			valid_bar = false;
-		  }
-	    }
+	  cerr << "ERRO: It was not possible to create the edges of the"
+	       << " configuration graph!\n";
+	  deallocate_list(&bar_code_list);
+	  return 0;
 	}
 
-      if (valid_bar == true)
-	append_list(l, c);
+      // the graph is complete
+      if (ckpt != NULL)
+	remove_checkpoint(ckpt);
 
-      // re-initialize the identifiers for the next iteration
-      for (SmartGraph::NodeIt w(H); w != INVALID; ++w)
+      if (options.cache_dir != NULL)
 	{
-	  map_vertice_id[w].identificador[0] = -1;
-	  map_vertice_id[w].identificador[1] = -1;
-	  map_vertice_id[w].identificador[2] = -1;
-	  map_vertice_id[w].identificador[3] = -1;
+	  config_graph_arrays(G, map_vertices, bar_code_list.vertex_size,
+			      &bar_masks, &node_weight);
+
+	  if (save_graph_cache(cache_path, k, NEIGHBOORHOD_SIZE, 0,
+			       CACHE_TYPE_IDCODE, bar_masks, node_weight,
+			       G) == 1)
+	    cout << "Configuration graph saved in " << cache_path << "\n";
+	  else
+	    cerr << "ERRO: It was not possible to save the cache "
+		 << cache_path << "!\n";
 	}
     }
 
-  delete[] c;
-  c = nullptr;
-  return 1;
-}
+  // the configuration graph in CSR form, for other tools
+  if (options.export_csr != NULL && options.target_den == 0)
+    {
+      config_graph_arrays(G, map_vertices, bar_code_list.vertex_size,
+			  &bar_masks, &node_weight);
 
+      if (save_csr_graph(options.export_csr, k, NEIGHBOORHOD_SIZE, 0,
+			 CACHE_TYPE_IDCODE, bar_masks, node_weight, G) == 1)
+	cout << "Configuration graph exported to " << options.export_csr
+	     << "\n";
+      else
+	cerr << "ERRO: It was not possible to export the configuration graph"
+	     << " to " << options.export_csr << "!\n";
+    }
+  metrics_end(metrics);
+  metrics->arcs_accepted = (options.external_dir != NULL) ? external.arcs :
+    countArcs(G);
+  cout << "Time to build all the edges: ";
+  print_elapsed(cout, metrics->phase_ns[METRICS_EDGES]);
+  cout << "\n";
+  print_phase_perf(cout, *metrics, METRICS_EDGES);
 
-/*
- * Function: check_bar_code
- * ------------------------
- * Check if a set of vertices induces a bar code
- *
- * bar1: represents a set of vertices in a bar
- * bar2: represents a set of vertices in a bar
- * size: the size of the bars 1 and 2
- *    k: the number of lines in hexagonal grid
- *
- * returns: 1 if the union of bars 1 and 2 induces a bar code,
- *          otherwise, returns 0
- *
- * how the vertices of the bars 1 and 2 are represented
- * ...
- * line 3: 12-13-14-15 == 12-13-14-15
- *         |      |       |      |
- * line 2: 8--9--10-11 == 8--9--10-11
- *            |     |        |     |
- * line 1: 4--5--6--7  == 4--5--6--7
- *         |     |        |     |
- * line 0: 0--1--2--3  == 0--1--2--3
- *         bar1           bar2
- */
-int check_bar_code(int *bar1, int *bar2, int z, int k)
-{
-  SmartGraph H;     // graph that represents that union of the bars 1 and 2
-  int num_vertices; // the number of vertices in H
-  int i, j;
-
-  // creates the graphi which represents the union of bar 1 and bar 2
-  num_vertices = 2 * z *k;
-
-  SmartGraph::NodeMap<config_vertex> map_vertice_id(H);
-  create_vertex_graph_cfg(k, 2 * z, &H);
-
-  // set the column and line for the vertices of H, maping the vertices
-  // of H into the struct of the hexagonal grid
-  for(i = 0; i < num_vertices; i = i +(2 * z))
-    for(j = 0; j < 2 * z; j++)
-      {
-        map_vertice_id[H.nodeFromId(i +j)].column = j;
-        map_vertice_id[H.nodeFromId(i +j)].line = i/(2* z);
-      }
-
-  // set which vertices belongs to the code according to the information
-  // in bar code 1 and 2
-  for (i = 0; i < num_vertices; i = i + (2 * z))
-    for (j = 0; j < z; j++)
-      {
-	map_vertice_id[H.nodeFromId(i +j)].pertence = bar1[i/2 +j];
-	map_vertice_id[H.nodeFromId(i +j +z)].pertence = bar2[i/2 +j];
-      }
-
-  // create the identifiers
-  for (SmartGraph::NodeIt v(H); v != INVALID; ++v)
+  cout << "Number of vertices: " << countNodes(G);
+  // the anytime search creates the edges, they are counted after it
+  if (options.target_den > 0)
+    cout << endl;
+  else
+    cout << "\tNumber of edges : " << metrics->arcs_accepted << endl;
+
+  // execute an algorithm to find a minimum mean cycle (or the closed
+  // walk with the smallest mean among the walks with bounded length)
+  metrics_begin(metrics, METRICS_MMC);
+  if (run_mmc_step(&G, map_vertices, bar_code_list.vertex_size, k,
+		   &map_weight, &options, checker, certificate_path, max_length,
+		   (options.external_dir != NULL) ? &external : NULL,
+		   &period_cost, &pruning, &engine, &mmc, metrics) == 0)
     {
-      i = 0;
+      deallocate_list(&bar_code_list);
+      return 0;
+    }
+  metrics_end(metrics);
+  metrics->mmc_iterations = mmc.iterations;
+  if (options.target_den > 0)
+    metrics->arcs_accepted = countArcs(G);
+  if (options.check == 1)
+    metrics->mmc_engine = "certificate";
+  else if (options.max_period > 0)
+    metrics->mmc_engine = "bounded period";
+  else
+    metrics->mmc_engine = mmc_engine_name(engine);
+
+  if (options.check == 1)
+    cout << "Time to check the certificate: ";
+  else if (options.max_period > 0)
+    cout << "Time to run the bounded period dynamic program: ";
+  else if (options.target_den > 0)
+    cout << "Time to create the edges and run the anytime search: ";
+  else if (options.external_dir != NULL)
+    cout << "Time to run the out-of-core " << mmc_engine_name(engine)
+	 << " algorithm (" << mmc.iterations << " probes): ";
+  else
+    cout << "Time to run " << mmc_engine_name(engine) << " algorithm: ";
+  print_elapsed(cout, metrics->phase_ns[METRICS_MMC]);
+  cout << "\n";
+  print_phase_perf(cout, *metrics, METRICS_MMC);
+  if (options.target_den > 0)
+    cout << "Number of edges : " << metrics->arcs_accepted << endl;
 
-      if (map_vertice_id[v].pertence == 1)
-	{
-	  map_vertice_id[v].identificador[0] = H.id(v);
-	  i++;
-	}
+  if (mmc.found == 0)
+    {
+      if (options.check == 1)
+	cerr << "ERRO: The certificate " << certificate_path
+	     << " is not valid!\n";
+      else if (options.max_period > 0)
+	cerr << "ERRO: There is no code with period of at most "
+	     << options.max_period << " columns!\n";
+      else
+	cerr << "ERRO: The configuration graph has no cycle!\n";
+      deallocate_list(&bar_code_list);
+      return 0;
+    }
 
-      for (SmartGraph::IncEdgeIt e(H, v); e != INVALID; ++e)
-	{
-	  if (H.id(H.u(e)) != H.id(v) &&
-	      map_vertice_id[H.u(e)].pertence == 1)
-	    {
-	      map_vertice_id[v].identificador[i] = H.id(H.u(e));
-	      i++;
-	    }
-	  else if (H.id(H.v(e)) != H.id(v) &&
-		   map_vertice_id[H.v(e)].pertence == 1)
-	    {
-	      map_vertice_id[v].identificador[i] = H.id(H.v(e));
-	      i++;
-	    }
-	}
+  if (options.prune == 1 && options.check == 0 && options.max_period == 0 &&
+      options.target_den == 0)
+    cout << "Arc elimination (upper bound " << pruning.bound_cost << "/"
+	 << pruning.bound_size << ", " << pruning.rounds << " rounds): "
+	 << pruning.arcs_removed << " of " << countArcs(G) << " arcs and "
+	 << pruning.nodes_removed << " of " << countNodes(G)
+	 << " vertices removed\n";
+
+  // saves the certificate that the cycle is a minimum mean cycle
+  if (options.certificate == 1 && options.check == 0 &&
+      options.max_period == 0 && options.target_den == 0)
+    {
+      if (write_certificate(certificate_path.c_str(), G, map_weight, k, NEIGHBOORHOD_SIZE,
+			    0, &mmc) == 1)
+	cout << "Certificate saved in " << certificate_path << "\n";
+      else
+	cerr << "ERRO: It was not possible to save the certificate!\n";
     }
 
-  // check if there is an empty identifier
-  for (SmartGraph::NodeIt v(H); v != INVALID; ++v)
+  // shows the best density of the codes with each period
+  if (options.max_period > 0 && options.check == 0)
     {
-      if (map_vertice_id[v].column > 0 &&
-	  map_vertice_id[v].column < 2 * z -1)
-	if (identifier_size(map_vertice_id[v].identificador,
-			     NEIGHBOORHOD_SIZE) == 0)
-	    return 0;
+      cout << "Best density for each period:\n";
+      for (l = 1; l <= max_length; l++)
+	{
+	  cout << "columns: " << l * NEIGHBOORHOD_SIZE << "\t";
+
+	  if (period_cost[l] == PERIOD_INF)
+	    cout << "no code\n";
+	  else
+	    cout << "density: " << (double) period_cost[l] /
+	      ((long long) k * l * NEIGHBOORHOD_SIZE) << "\n";
+	}
     }
 
-  // check if the identifiers are pairwise distinct
-  for(SmartGraph::NodeIt v(H); v != INVALID; ++v)
+  // checks the cycle mean with an engine independent from LEMON (the
+  // bounded period code is not always a minimum mean cycle)
+  if (options.cross_check == 1 && options.max_period == 0)
     {
-      if (map_vertice_id[v].column > 0 &&
-	  map_vertice_id[v].column < 2 * z -1)
+      switch (cross_check_mmc(G, map_weight, &mmc))
 	{
-	for (SmartGraph::NodeIt u(H); u != INVALID; ++u)
-	  if (map_vertice_id[u].column > 0 &&
-	      map_vertice_id[u].column < 2 * z -1 &&
-	      H.id(u) != H.id(v))
-	    {
-	      if (equal_identifier(map_vertice_id[v].identificador,
-				   map_vertice_id[u].identificador,
-				   NEIGHBOORHOD_SIZE) == true)
-		return 0;
-	    }
+	case 1:
+	  cout << "Cross-check (tropical engine): ok\n";
+	  break;
+	case 0:
+	  cout << "Cross-check (tropical engine): MISMATCH\n";
+	  break;
+	default:
+	  cout << "Cross-check (tropical engine): graph too large\n";
+	  break;
 	}
     }
 
+  // the pattern of the code, decoded from the bar codes of the cycle as
+  // in libhkcode
+  cycle_barcodes(G, mmc.cycle, map_vertices, k, &cycle_bars);
+  decode_pattern(k, cycle_bars, &pattern);
+
+  // the code with bounded period does not replace the optimal code
+  if (options.max_period > 0)
+    code_file.open("../Codes/CodigoH" + to_string(k) + "P" +
+		   to_string(options.max_period) + "GrafoConfig.txt");
+  else
+    code_file.open("../Codes/CodigoH" + to_string(k) + "GrafoConfig.txt");
+  cout << "columns: " << pattern.columns << endl;
+  cout << "density: " << (double) pattern.density_num / pattern.density_den
+       << " (" << pattern.density_num << "/" << pattern.density_den
+       << ")\n";
+
+  metrics->columns = pattern.columns;
+  metrics->density_num = pattern.density_num;
+  metrics->density_den = pattern.density_den;
+
+  code_file << k << " " << pattern.columns << " "
+	    << (double) pattern.density_num / pattern.density_den << "\n";
+
+  // output the pattern of the code found (minimum mean cycle)
+  print_pattern(cout, pattern);
+  print_pattern(code_file, pattern);
+  cout << "\n";
+  code_file << "\n";
+  code_file.close();
+
+  // the record of the run, with its peak memory
+  if (options.metrics_path != NULL &&
+      save_metrics(options.metrics_path, metrics) == 0)
+    cerr << "ERRO: It was not possible to save the metrics in "
+	 << options.metrics_path << "!\n";
+
+  deallocate_list(&bar_code_list);
   return 1;
 }
 
-
-/* Main Program - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 int main(int argc, char **argv)
 {
+  hk_options options;        // options given in the command line
+  hk_options run_options;    // the options of a k, after its memory plan
+  barcode_table open_bars;   // open bars, extended by --row-extension
+  run_metrics process;       // the hardware counters of the process
+  vector<run_metrics> runs;  // the metrics of each k of the sweep
   int k;                     // number of lines of the hexagonal
                              // grids
-  SmartDigraph G;            // digraph which represents a
-                             // configuration graph
-  SmartGraph H;              // graph used to check if a set of
-                             // vertices is a bar code
-  linked_list bar_code_list; // list with all bar codes
-  int i, j, h;
-  node *nodeAux;
-  node *nodeV, *nodeU;
-  ofstream code_file;
 
   // check if the all the arguments were properly passed
-  if (argc != 2)
-    {
-      cerr << "Invalid number of arguments!\n";
-      cerr << "Usage: " << argv[0] << " <number of lines>\n";
-      return EXIT_FAILURE;
-    }
-  else
-    k = atoi(argv[1]);
-
-  // builds all the bar codes
-  auto start = std::chrono::high_resolution_clock::now();
-  init_list(&bar_code_list, k, NEIGHBOORHOD_SIZE);
+  if (parse_options(argc, argv, &options) == 0)
+    return EXIT_FAILURE;
 
-  if (create_graph_cfg(&bar_code_list, k, NEIGHBOORHOD_SIZE) == 0)
+  // counts the bar codes and the arcs, without building them
+  if (options.count == 1)
     {
-      cerr << "ERRO: It was not possible to generate the bar codes!\n";
-      deallocate_list(&bar_code_list);
-      return EXIT_FAILURE;
-    }
+      if (print_counts(options.num_lines, NEIGHBOORHOD_SIZE,
+		       2 * NEIGHBOORHOD_SIZE) == 0)
+	return EXIT_FAILURE;
 
-  auto end = std::chrono::high_resolution_clock::now();
-  cout << "Time to build all bar codes: "
-       << chrono::duration_cast<chrono::hours>(end - start).count()
-       << "h "
-       << chrono::duration_cast<chrono::minutes>(end - start).count() % 60
-       << "m "
-       << chrono::duration_cast<chrono::seconds>(end - start).count() % 60
-       << "s "
-       << chrono::duration_cast<chrono::milliseconds>(end - start).count() % 1000
-       << "ms "
-       << chrono::duration_cast<chrono::nanoseconds>(end - start).count() % 1000000
-       << "ns\n";
-
-  // builds the configuration graph
-  start = std::chrono::high_resolution_clock::now();
-  for (i = 0; i < bar_code_list.size; i++)
-    G.addNode();
-
-  // assign a bar code for each vertex of the configuration graph
-  SmartDigraph::NodeMap<node *> map_vertices(G);
-  nodeAux = bar_code_list.first;
+      return EXIT_SUCCESS;
+    }
 
-  for (SmartDigraph::NodeIt v(G); v != INVALID; ++v)
+  // the hardware counters are opened before the worker threads exist, so
+  // the threads are counted too; without them only the times are measured
+  metrics_init(&process, "Hk_lemon_eng_8bar", options.k_first,
+	       NEIGHBOORHOD_SIZE, 0);
+  if (options.perf == 1 && metrics_enable_perf(&process) < PERF_EVENTS)
+    cerr << "Some hardware counters are not available ("
+	 << strerror(process.counters.error) << ")!\n";
+
+  open_bars.lines = 0;
+  open_bars.tested = 0;
+
+  // the values of k of a sweep run one after the other, each one with all
+  // the threads; the open bars, the counters and the threads of OpenMP
+  // are kept between them
+  for (k = options.k_first; k <= options.k_last; k++)
     {
-      map_vertices[v] = nodeAux;
-      nodeAux = nodeAux->next;
-    }
+      run_metrics metrics;   // the times and counters of this k
 
-  end = std::chrono::high_resolution_clock::now();
-  cout << "Time to build all the vertices: "
-       << chrono::duration_cast<chrono::hours>(end - start).count()
-       << "h "
-       << chrono::duration_cast<chrono::minutes>(end - start).count() % 60
-       << "m "
-       << chrono::duration_cast<chrono::seconds>(end - start).count() % 60
-       << "s "
-       << chrono::duration_cast<chrono::milliseconds>(end - start).count() % 1000
-       << "ms "
-       << chrono::duration_cast<chrono::nanoseconds>(end - start).count() % 1000000
-       << "ns\n";
+      if (options.k_first < options.k_last)
+	cout << "Hexagonal grid with " << k << " lines\n\n";
 
-  // build all the edges of the configuration graph
-  start = std::chrono::high_resolution_clock::now();
-  create_vertex_graph_cfg(k, 2 * NEIGHBOORHOD_SIZE, &H);
+      metrics_init(&metrics, "Hk_lemon_eng_8bar", k, NEIGHBOORHOD_SIZE, 0);
+      if (process.perf == 1)
+	metrics_use_perf(&metrics, process.counters);
 
-  # pragma omp parallel for
-  for (SmartDigraph::NodeIt u(G); u != INVALID; ++u)
-    {
-      for (SmartDigraph::NodeIt v(G); v != INVALID; ++v)
-	{
-	  nodeU = map_vertices[u];
-	  nodeV = map_vertices[v];
-
-          if (check_bar_code(nodeU->v->bar, nodeV->v->bar,
-			 NEIGHBOORHOD_SIZE, k) == 1)
-	    {
-	    G.addArc(u, v);
-	    }
-	}
-    }
+      // the memory is planned before anything of this k is allocated
+      run_options = options;
+      if (options.mem_limit_mb != 0 && options.differential == 0 &&
+	  plan_lines(k, &run_options) == 0)
+	return EXIT_FAILURE;
 
-  // creates a map to add a weight to the edges
-  SmartDigraph::ArcMap<double> map_weight(G);
-  SmartDigraph::Node u;
+      if (run_lines(k, run_options, &open_bars, &metrics) == 0)
+	return EXIT_FAILURE;
 
-  for (SmartDigraph::ArcIt arco(G); arco != INVALID; ++arco)
-    {
-      u = G.target(arco);
-      nodeAux = map_vertices[u];
-      map_weight[arco] = nodeAux->v->weight;
+      runs.push_back(metrics);
+      if (options.k_first < options.k_last)
+	cout << "\n";
     }
-  end = std::chrono::high_resolution_clock::now();
-  cout << "Time to build all the edges: "
-       << chrono::duration_cast<chrono::hours>(end - start).count()
-       << "h "
-       << chrono::duration_cast<chrono::minutes>(end - start).count() % 60
-       << "m "
-       << chrono::duration_cast<chrono::seconds>(end - start).count() % 60
-       << "s "
-       << chrono::duration_cast<chrono::milliseconds>(end - start).count() % 1000
-       << "ms "
-       << chrono::duration_cast<chrono::nanoseconds>(end - start).count() % 1000000
-       << "ns\n";
-
-  cout << "Number of vertices: " << countNodes(G) << "\t";
-  cout << "Number of edges : " << countArcs(G) << endl;
-
-  // execute an algorithm to find a minimum mean cycle
-  start = std::chrono::high_resolution_clock::now();
-  HartmannOrlinMmc<SmartDigraph, SmartDigraph::ArcMap<double>>
-    MMC(G, map_weight);
-  Path<SmartDigraph> mmc_path;
-  MMC.cycle(mmc_path);
-  MMC.run();
-  end = std::chrono::high_resolution_clock::now();
-  cout << "Time to run Hartmann and Orlin algorithm: "
-       << chrono::duration_cast<chrono::hours>(end - start).count()
-       << "h "
-       << chrono::duration_cast<chrono::minutes>(end - start).count() % 60
-       << "m "
-       << chrono::duration_cast<chrono::seconds>(end - start).count() % 60
-       << "s "
-       << chrono::duration_cast<chrono::milliseconds>(end - start).count() % 1000
-       << "ms "
-       << chrono::duration_cast<chrono::nanoseconds>(end - start).count() % 1000000
-       << "ns\n";
-
-  code_file.open("../Codes/CodigoH" + to_string(num_lines) + "GrafoConfig.txt");
-  cout << "columns: " << MMC.cycleSize() * NEIGHBOORHOD_SIZE << endl;
-  cout << "density: " << (MMC.cycleMean() * MMC.cycleSize())/ (k * MMC.cycleSize() * NEIGHBOORHOD_SIZE)
-       << "\n";
-  code_file << k << " " << MMC.cycleSize() * NEIGHBOORHOD_SIZE << " "
-	    << MMC.cycleMean() << "\n";
 
-  // output the pattern of the code found (minimum mean cycle)
-  SmartDigraph::Node v;
-  h = 0;
+  if (options.k_first < options.k_last && options.differential == 0)
+    print_sweep_summary(cout, runs);
 
-  for (Path<SmartDigraph>::ArcIt arco(mmc_path); arco != INVALID; ++arco)
-    {
-      u = G.source(arco);
-      for (j = 0; j < NEIGHBOORHOD_SIZE * k; j = j +NEIGHBOORHOD_SIZE)
-	{
-	  for (i = 0; i < NEIGHBOORHOD_SIZE; i++)
-	    {
-	      if (map_vertices[u]->v->bar[i+j] == 1)
-		{
-		  cout << "(" << i + NEIGHBOORHOD_SIZE * h <<
-		    "," << (j/4) +1 << ") ";
-		  code_file << "(" << i + NEIGHBOORHOD_SIZE * h <<
-		    "," << (j/4) +1 << ") ";
-		}
-	    }
-	}
-      h++;
-    }
-  cout << "\n";
-  code_file << "\n";
-  code_file.close();
-
-  deallocate_list(&bar_code_list);
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,157 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Checks that the patterns saved in ../Codes (or in the files and
+   directories given in the command line) are periodic identifying codes
+   of the hexagonal grid, independently of the programs which found them
+   (see idcode_check.h), and outputs the exact density of each one:
+
+       Hk_verify_code [--quiet] [FILE | DIRECTORY] ...
+
+   All the files of a directory whose names end with .txt are checked.
+   With --quiet only the codes which fail and the summary are written.
+   The program returns EXIT_FAILURE when some code fails. It does not
+   need LEMON:
+
+       g++ -O2 Hk_verify_code.cc -o Hk_verify_code
+*/
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "idcode_check.h"
+
+
+/* Namespaces - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+using namespace std;
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// directory checked when no file is given
+#define VERIFY_DEFAULT_DIR "../Codes"
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: collect_files
+ * -----------------------
+ * Adds a file, or the files of a directory whose names end with .txt (in
+ * alphabetical order), to the list of files to check
+ *
+ *  path: the file or the directory
+ * files: the list of files
+ *
+ * returns: 1 if path exists, otherwise, 0
+ */
+int collect_files(const string &path, vector<string> *files)
+{
+  struct stat info;
+  DIR *dir;
+  struct dirent *entry;
+  vector<string> names;
+  string name;
+  size_t i;
+
+  if (stat(path.c_str(), &info) != 0)
+    return 0;
+
+  if (!S_ISDIR(info.st_mode))
+    {
+      files->push_back(path);
+      return 1;
+    }
+
+  dir = opendir(path.c_str());
+  if (dir == NULL)
+    return 0;
+
+  while ((entry = readdir(dir)) != NULL)
+    {
+      name = entry->d_name;
+      if (name.size() > 4 && name.compare(name.size() -4, 4, ".txt") == 0)
+	names.push_back(name);
+    }
+  closedir(dir);
+
+  sort(names.begin(), names.end());
+  for (i = 0; i < names.size(); i++)
+    files->push_back(path + "/" + names[i]);
+
+  return 1;
+}
+
+
+/* Main Program - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+int main(int argc, char **argv)
+{
+  vector<string> files;      // the files to check
+  periodic_code code;        // the code of a file
+  code_report report;        // the result of its check
+  string error;
+  int quiet;                 // 1 if only the failures are written
+  long long failures;
+  size_t i;
+
+  quiet = 0;
+  for (i = 1; i < (size_t) argc; i++)
+    {
+      if (strcmp(argv[i], "--quiet") == 0)
+	quiet = 1;
+      else if (argv[i][0] == '-' || collect_files(argv[i], &files) == 0)
+	{
+	  cerr << "Invalid argument: " << argv[i] << "\n";
+	  cerr << "Usage: " << argv[0]
+	       << " [--quiet] [FILE | DIRECTORY] ...\n";
+	  return EXIT_FAILURE;
+	}
+    }
+
+  if (files.empty() && collect_files(VERIFY_DEFAULT_DIR, &files) == 0)
+    {
+      cerr << "There is no directory " << VERIFY_DEFAULT_DIR << "!\n";
+      return EXIT_FAILURE;
+    }
+
+  failures = 0;
+  for (i = 0; i < files.size(); i++)
+    {
+      if (read_periodic_code(files[i], &code, &error) == 0)
+	{
+	  failures++;
+	  cout << files[i] << ": INVALID FILE (" << error << ")\n";
+	  continue;
+	}
+
+      if (check_periodic_code(code, &report) == 0)
+	{
+	  failures++;
+	  cout << files[i] << ": FAILED (" << report.error << ")\n";
+	  continue;
+	}
+
+      if (quiet == 0)
+	{
+	  cout << files[i] << ": ok, H_" << code.lines << ", "
+	       << code.columns << " columns, " << report.vertices
+	       << " vertices, density " << report.density_num << "/"
+	       << report.density_den;
+	  if (report.parity == IDCODE_PARITY_LP)
+	    cout << " (vertical edges in the columns c + r even)";
+	  cout << "\n";
+	}
+    }
+
+  cout << files.size() << " codes checked, " << failures << " failed\n";
+
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,321 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Elimination of arcs of the configuration graph which cannot belong to
+   a minimum mean cycle, done between the construction of the arcs and
+   the MMC algorithm.
+
+   A few iterations of Howard's algorithm (a partial run of the parallel
+   Howard engine) give a cycle with mean U = c/d, an upper bound for the
+   minimum mean. Then some rounds of Bellman-Ford with the weights w - U
+   give potentials pi, and the reduced cost of an arc e = (u, v) is r(e) = w(e) + pi(u) - pi(v).
+   For any potentials, L = min r(e) is a lower bound for the minimum
+   mean and every cycle C through e has mean at least
+   L + (r(e) - L) / |C|. Hence, if r(e) - L > n (U - L), the arc e is
+   not in any cycle with mean at most U; in particular, it is not in
+   any minimum mean cycle, so removing it keeps the optimal density.
+   When the partial run already found an optimal cycle the Bellman-Ford
+   rounds converge, L = U, and only the arcs with r(e) = U are kept.
+*/
+
+#ifndef ARC_PRUNING_H
+#define ARC_PRUNING_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <vector>
+#include <lemon/smart_graph.h>
+#include <lemon/path.h>
+#include "mmc_engine.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// number of policies of Howard's algorithm evaluated to find the upper
+// bound
+#define PRUNING_HOWARD_ITERATIONS 8
+
+// maximum number of rounds of Bellman-Ford to compute the potentials
+#define PRUNING_MAX_ROUNDS 64
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: pruning_stats
+ * ---------------------
+ * Information about the elimination of arcs
+ *
+ *     bound_cost: total weight of the cycle which gives the upper bound
+ *     bound_size: number of arcs of that cycle (U = cost / size)
+ *   arcs_removed: number of arcs eliminated
+ *  nodes_removed: number of vertices eliminated (no arcs left in or out)
+ *         rounds: number of rounds of Bellman-Ford performed
+ */
+struct pruning_stats
+{
+  long long bound_cost;
+  int       bound_size;
+  long long arcs_removed;
+  long long nodes_removed;
+  int       rounds;
+};
+
+typedef struct pruning_stats pruning_stats;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: pruning_upper_bound
+ * -----------------------------
+ * Runs a few iterations of Howard's policy iteration; the mean of the
+ * best cycle of the last policy is an upper bound for the minimum mean
+ * (and it is usually already the minimum mean)
+ *
+ *      G: the configuration graph
+ * weight: the weights of the arcs of G
+ *  stats: where the cost and size of the cycle are stored
+ *
+ * returns: 1 if a cycle was found, otherwise, 0
+ */
+inline int pruning_upper_bound(const lemon::SmartDigraph &G,
+			       const lemon::SmartDigraph::ArcMap<int> &weight,
+			       pruning_stats *stats)
+{
+  lemon::Path<lemon::SmartDigraph> cycle;
+  long long cost;
+  int size;
+
+  if (howard_policy_iteration(G, weight, PRUNING_HOWARD_ITERATIONS, &cycle,
+			      &cost, &size, NULL) == 0)
+    return 0;
+
+  stats->bound_cost = cost;
+  stats->bound_size = size;
+  return 1;
+}
+
+/*
+ * Function: prune_config_graph
+ * ----------------------------
+ * Builds P, the configuration graph without the arcs which cannot be in
+ * a minimum mean cycle (and without the vertices left with no arc
+ * entering or leaving them)
+ *
+ *        G: the configuration graph
+ *   weight: the weights of the arcs of G
+ *        P: an empty digraph, where the pruned graph is built
+ * p_weight: a map of P, where the weights of the arcs of P are stored
+ *   origin: origin[id of an arc of P] = id of the same arc in G
+ *    stats: information about the elimination
+ *
+ * returns: 1 if the arcs were eliminated, 0 if G has no cycle
+ */
+inline int prune_config_graph(const lemon::SmartDigraph &G,
+			      const lemon::SmartDigraph::ArcMap<int> &weight,
+			      lemon::SmartDigraph *P,
+			      lemon::SmartDigraph::ArcMap<int> *p_weight,
+			      std::vector<int> *origin, pruning_stats *stats)
+{
+  std::vector<long long> dist, next;
+  std::vector<char> keep;
+  std::vector<int> in_degree, out_degree, queue, node_of;
+  lemon::SmartDigraph::Arc arc;
+  long long c, d, lower, reduced;
+  int n, m, u, v, h, round, changed;
+
+  stats->arcs_removed = 0;
+  stats->nodes_removed = 0;
+  stats->rounds = 0;
+
+  if (pruning_upper_bound(G, weight, stats) == 0)
+    return 0;
+
+  n = lemon::countNodes(G);
+  m = lemon::countArcs(G);
+  c = stats->bound_cost;
+  d = stats->bound_size;
+
+  // potentials: distances with the weights d * w - c (that is, w - U
+  // scaled by d), from a virtual source linked to every vertex
+  dist.assign(n, 0);
+  next.assign(n, 0);
+
+  for (round = 0; round < PRUNING_MAX_ROUNDS; round++)
+    {
+      changed = 0;
+
+      # pragma omp parallel for schedule(dynamic, 256) reduction(+:changed)
+      for (v = 0; v < n; v++)
+	{
+	  long long x;
+
+	  next[v] = dist[v];
+	  for (lemon::SmartDigraph::InArcIt a(G, G.nodeFromId(v));
+	       a != lemon::INVALID; ++a)
+	    {
+	      x = dist[G.id(G.source(a))] + d * weight[a] - c;
+	      if (x < next[v])
+		next[v] = x;
+	    }
+
+	  if (next[v] < dist[v])
+	    changed++;
+	}
+
+      dist.swap(next);
+      stats->rounds++;
+
+      if (changed == 0)
+	break;
+    }
+
+  // lower bound (scaled by d): the smallest reduced cost, which is at
+  // most c, the mean of the cycle of the upper bound
+  lower = c;
+  for (lemon::SmartDigraph::ArcIt a(G); a != lemon::INVALID; ++a)
+    {
+      reduced = d * weight[a] + dist[G.id(G.source(a))] -
+	dist[G.id(G.target(a))];
+
+      if (reduced < lower)
+	lower = reduced;
+    }
+
+  // an arc is kept when r(e) - L <= n (U - L), all scaled by d
+  keep.assign(m, 0);
+  in_degree.assign(n, 0);
+  out_degree.assign(n, 0);
+
+  for (lemon::SmartDigraph::ArcIt a(G); a != lemon::INVALID; ++a)
+    {
+      reduced = d * weight[a] + dist[G.id(G.source(a))] -
+	dist[G.id(G.target(a))];
+
+      if ((__int128) (reduced - lower) <= (__int128) n * (c - lower))
+	{
+	  keep[G.id(a)] = 1;
+	  out_degree[G.id(G.source(a))]++;
+	  in_degree[G.id(G.target(a))]++;
+	}
+    }
+
+  // removes the vertices with no arc entering or leaving them, and
+  // their arcs, until no such vertex is left
+  for (u = 0; u < n; u++)
+    if (in_degree[u] == 0 || out_degree[u] == 0)
+      queue.push_back(u);
+
+  node_of.assign(n, 0);
+  for (h = 0; h < (int) queue.size(); h++)
+    {
+      u = queue[h];
+      if (node_of[u] == -1)
+	continue;
+
+      node_of[u] = -1;
+
+      for (lemon::SmartDigraph::OutArcIt a(G, G.nodeFromId(u));
+	   a != lemon::INVALID; ++a)
+	if (keep[G.id(a)])
+	  {
+	    keep[G.id(a)] = 0;
+	    v = G.id(G.target(a));
+	    if (--in_degree[v] == 0)
+	      queue.push_back(v);
+	  }
+
+      for (lemon::SmartDigraph::InArcIt a(G, G.nodeFromId(u));
+	   a != lemon::INVALID; ++a)
+	if (keep[G.id(a)])
+	  {
+	    keep[G.id(a)] = 0;
+	    v = G.id(G.source(a));
+	    if (--out_degree[v] == 0)
+	      queue.push_back(v);
+	  }
+    }
+
+  // builds the pruned graph, keeping the order of the vertices and arcs
+  for (u = 0; u < n; u++)
+    {
+      if (node_of[u] == -1)
+	{
+	  stats->nodes_removed++;
+	  continue;
+	}
+
+      node_of[u] = P->id(P->addNode());
+    }
+
+  origin->clear();
+  for (h = 0; h < m; h++)
+    {
+      if (!keep[h])
+	{
+	  stats->arcs_removed++;
+	  continue;
+	}
+
+      arc = G.arcFromId(h);
+      origin->push_back(h);
+      (*p_weight)[P->addArc(P->nodeFromId(node_of[G.id(G.source(arc))]),
+			    P->nodeFromId(node_of[G.id(G.target(arc))]))] =
+	weight[arc];
+    }
+
+  return 1;
+}
+
+/*
+ * Function: run_mmc_pruned
+ * ------------------------
+ * Eliminates the arcs which cannot be in a minimum mean cycle and runs
+ * an MMC engine on the remaining graph; the cycle found is given with
+ * the arcs of G
+ *
+ *      G: the configuration graph
+ * weight: the weights of the arcs of G
+ * engine: the algorithm to use
+ * result: where the cycle is stored
+ *  stats: information about the elimination
+ *
+ * returns: the engine that was actually run
+ */
+inline mmc_engine run_mmc_pruned(const lemon::SmartDigraph &G,
+				 const lemon::SmartDigraph::ArcMap<int> &weight,
+				 mmc_engine engine, mmc_result *result,
+				 pruning_stats *stats)
+{
+  lemon::SmartDigraph P;
+  lemon::SmartDigraph::ArcMap<int> p_weight(P);
+  std::vector<int> origin;
+  lemon::Path<lemon::SmartDigraph> cycle;
+
+  if (prune_config_graph(G, weight, &P, &p_weight, &origin, stats) == 0)
+    {
+      result->found = 0;
+      result->cost = 0;
+      result->size = 0;
+      result->iterations = 0;
+      result->cycle.clear();
+      return (engine == MMC_AUTO) ? MMC_HOWARD : engine;
+    }
+
+  engine = run_mmc(P, p_weight, engine, result);
+
+  // translates the arcs of the cycle to the arcs of G
+  for (lemon::Path<lemon::SmartDigraph>::ArcIt a(result->cycle);
+       a != lemon::INVALID; ++a)
+    cycle.addBack(G.arcFromId(origin[P.id(a)]));
+
+  result->cycle.clear();
+  for (lemon::Path<lemon::SmartDigraph>::ArcIt a(cycle);
+       a != lemon::INVALID; ++a)
+    result->cycle.addBack(a);
+
+  return engine;
+}
+
+#endif
@@ -0,0 +1,260 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Generation of the bar codes of H_k row by row, instead of enumerating
+   the 2^(4k) bars. A bar is stored as a bit mask (bit 4 r + c is the
+   vertex of line r and column c), so k is limited to 16 lines.
+
+   The identifier of a vertex of line r only depends on the lines r -1,
+   r and r +1. Hence, once the line r +1 of a bar is chosen, the
+   identifiers of the line r are final, and they can already be checked
+   (not empty, and distinct from the identifiers of the lines r -2, r -1
+   and r; two vertices farther apart have no common neighbor). The table
+   of a bar with m lines keeps the "open" bars: the ones whose lines
+   0..m-2 passed the checks. Extending the table by one line only tries
+   the 16 possible new lines on each open bar, and the bar codes of H_m
+   are the open bars whose last line also passes, as the top line of the
+   grid. The open table of H_k is cached, so a sweep over k only extends
+   it by one line at a time.
+*/
+
+#ifndef BARCODE_EXTENSION_H
+#define BARCODE_EXTENSION_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// number of columns of a bar
+#define BARCODE_COLUMNS 4
+
+// the largest number of lines of a bar stored in 64 bits
+#define BARCODE_MAX_LINES 16
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: barcode_table
+ * ---------------------
+ * The open bars with a given number of lines
+ *
+ *  lines: the number of lines of the bars (0 if the table is empty)
+ *   open: the bars whose lines 0..lines-2 have valid identifiers
+ * tested: the number of bars checked by barcode_extend and
+ *         barcode_table_for (kept between calls, like the table)
+ */
+struct barcode_table
+{
+  int                   lines;
+  std::vector<uint64_t> open;
+  long long             tested;
+};
+
+typedef struct barcode_table barcode_table;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: barcode_neighborhood
+ * ------------------------------
+ * returns: the closed neighborhood of the vertex (r, c), as a mask, in a
+ *          hexagonal grid with the given number of lines; the vertical
+ *          edges leave the columns 0 and 2 in even lines and the columns
+ *          1 and 3 in odd lines, as in allocate_hexagonal_grid
+ */
+inline uint64_t barcode_neighborhood(int r, int c, int lines)
+{
+  uint64_t mask;
+
+  mask = 1ULL << (BARCODE_COLUMNS * r + c);
+
+  if (c > 0)
+    mask |= 1ULL << (BARCODE_COLUMNS * r + c -1);
+  if (c < BARCODE_COLUMNS -1)
+    mask |= 1ULL << (BARCODE_COLUMNS * r + c +1);
+
+  // edge to the line above: column parity equals line parity
+  if (r +1 < lines && c % 2 == r % 2)
+    mask |= 1ULL << (BARCODE_COLUMNS * (r +1) + c);
+
+  // edge to the line below: the line below has the other parity
+  if (r > 0 && c % 2 == (r -1) % 2)
+    mask |= 1ULL << (BARCODE_COLUMNS * (r -1) + c);
+
+  return mask;
+}
+
+/*
+ * Function: barcode_line_valid
+ * ----------------------------
+ * Checks the identifiers of the vertices of the line r which are not in
+ * the first or last column: they must be not empty and distinct from
+ * the identifiers of the same columns in the lines r -2, r -1 and r
+ *
+ *   bar: the bar, as a mask
+ *     r: the line checked
+ * lines: the number of lines of the grid (the identifiers of the lines
+ *        up to r must be final)
+ *
+ * returns: 1 if the line is valid, otherwise, 0
+ */
+inline int barcode_line_valid(uint64_t bar, int r, int lines)
+{
+  uint64_t id, other;
+  int c, s, d;
+
+  for (c = 1; c < BARCODE_COLUMNS -1; c++)
+    {
+      id = bar & barcode_neighborhood(r, c, lines);
+      if (id == 0)
+	return 0;
+
+      for (s = (r >= 2) ? r -2 : 0; s <= r; s++)
+	for (d = 1; d < BARCODE_COLUMNS -1; d++)
+	  {
+	    if (s == r && d >= c)
+	      break;
+
+	    other = bar & barcode_neighborhood(s, d, lines);
+	    if (other == id)
+	      return 0;
+	  }
+    }
+
+  return 1;
+}
+
+/*
+ * Function: barcode_extend
+ * ------------------------
+ * Extends the open bars of the table by one line (the bars of an empty
+ * table are extended to one line, with all the 16 possible lines)
+ *
+ * table: the table, extended in place
+ */
+inline void barcode_extend(barcode_table *table)
+{
+  std::vector<uint64_t> next;
+  std::vector<unsigned int> valid;
+  int m, i, j, amt_bars;
+
+  m = table->lines;
+
+  if (m == 0)
+    {
+      table->open.clear();
+      for (i = 0; i < (1 << BARCODE_COLUMNS); i++)
+	table->open.push_back((uint64_t) i);
+      table->lines = 1;
+      return;
+    }
+
+  amt_bars = (int) table->open.size();
+  valid.assign(amt_bars, 0);
+  table->tested += (long long) amt_bars << BARCODE_COLUMNS;
+
+  // valid[j] has the bit row set if the bar j extended with the line row
+  // is open; with the new line, the identifiers of the line m -1 are final
+  # pragma omp parallel for schedule(static)
+  for (j = 0; j < amt_bars; j++)
+    {
+      uint64_t bar;
+      int row;
+
+      for (row = 0; row < (1 << BARCODE_COLUMNS); row++)
+	{
+	  bar = table->open[j] | ((uint64_t) row << (BARCODE_COLUMNS * m));
+	  if (barcode_line_valid(bar, m -1, m +1) == 1)
+	    valid[j] |= 1u << row;
+	}
+    }
+
+  for (j = 0; j < amt_bars; j++)
+    for (i = 0; i < (1 << BARCODE_COLUMNS); i++)
+      if (valid[j] & (1u << i))
+	next.push_back(table->open[j] | ((uint64_t) i << (BARCODE_COLUMNS * m)));
+
+  table->open.swap(next);
+  table->lines = m +1;
+}
+
+/*
+ * Function: barcode_enumeration_key
+ * ---------------------------------
+ * returns: the number whose binary digits are the vertices of the bar,
+ *          the vertex 0 being the most significant one; sorting the bars
+ *          by this key gives the order of the enumeration of all bars
+ */
+inline uint64_t barcode_enumeration_key(uint64_t bar, int lines)
+{
+  uint64_t key;
+  int i, size;
+
+  size = BARCODE_COLUMNS * lines;
+  key = 0;
+  for (i = 0; i < size; i++)
+    if (bar & (1ULL << i))
+      key |= 1ULL << (size -1 - i);
+
+  return key;
+}
+
+/*
+ * Function: barcode_table_for
+ * ---------------------------
+ * Extends the cached table of open bars up to the given number of lines
+ * (starting again from an empty table when the cache has more lines)
+ * and selects the bar codes of H_k
+ *
+ *     lines: the number of lines of the hexagonal grid (k)
+ *     cache: the table of open bars, kept between calls
+ *  barcodes: where the bar codes are stored, in the order of the
+ *            enumeration of all bars
+ *
+ * returns: 1 if the bar codes were generated, otherwise, 0 (k out of
+ *          the range 1..BARCODE_MAX_LINES)
+ */
+inline int barcode_table_for(int lines, barcode_table *cache,
+			     std::vector<uint64_t> *barcodes)
+{
+  std::vector<std::pair<uint64_t, uint64_t> > sorted;
+  size_t j;
+
+  if (lines < 1 || lines > BARCODE_MAX_LINES)
+    return 0;
+
+  if (cache->lines > lines)
+    {
+      cache->lines = 0;
+      cache->open.clear();
+    }
+
+  while (cache->lines < lines)
+    barcode_extend(cache);
+
+  // the last line of a bar of H_k is the top line of the grid
+  cache->tested += (long long) cache->open.size();
+  for (j = 0; j < cache->open.size(); j++)
+    if (barcode_line_valid(cache->open[j], lines -1, lines) == 1)
+      sorted.push_back(std::make_pair(barcode_enumeration_key(cache->open[j],
+							       lines),
+				      cache->open[j]));
+
+  std::sort(sorted.begin(), sorted.end());
+
+  barcodes->clear();
+  for (j = 0; j < sorted.size(); j++)
+    barcodes->push_back(sorted[j].second);
+
+  return 1;
+}
+
+#endif
@@ -0,0 +1,588 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   A small benchmark harness for the kernels of the programs which build
+   a configuration graph, used by Hk_bench_6bar.cc and Hk_bench_8bar.cc:
+   the generation of the bar codes, the test of a union of two bar codes
+   (on a fixed set of pairs) and the minimum mean cycle of a saved
+   configuration graph, each one for the values of k given in the command
+   line.
+
+   As in Google Benchmark, a kernel is first run once to find how many
+   iterations fill --min-time seconds, and then the iterations are timed
+   --repetitions times; the median, the minimum and the deviation of the
+   time of an iteration are reported, together with the time of each
+   item (a bar tested, a pair tested). A kernel returns a count (of the
+   bar codes, of the valid pairs, the cost of the cycle), which is
+   reported too, so the compiler cannot discard its work and a change in
+   a kernel which changes its result is noticed.
+
+   The inputs are reproducible: the bar codes only depend on k, the pairs
+   are drawn from them by a generator with a fixed seed, and the graph
+   of each k is saved in --graph-dir (in the CSR format of csr_graph.h)
+   the first time it is needed and read back in the next runs. With
+   --json=FILE the results are appended to FILE, one JSON object per
+   line, so runs of different versions can be compared.
+*/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <sys/stat.h>
+#include <lemon/smart_graph.h>
+#include "mmc_engine.h"
+#include "csr_graph.h"
+#include "graph_cache.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// seed of the generator which draws the pairs of bar codes
+#define BENCHMARK_SEED 0x48b7c0de5eedULL
+
+// directory of the saved configuration graphs
+#define BENCHMARK_DEFAULT_DIR "../Benchmarks"
+
+// timed repetitions of each benchmark
+#define BENCHMARK_DEFAULT_REPETITIONS 5
+
+// minimum time of a repetition, in seconds
+#define BENCHMARK_DEFAULT_MIN_TIME 0.5
+
+// number of pairs of bar codes tested by an iteration
+#define BENCHMARK_DEFAULT_PAIRS 100000
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Type: bench_kernel
+ * ------------------
+ * A kernel: runs once over its input and returns a count of what it
+ * found
+ */
+typedef long long (*bench_kernel)(void *input);
+
+/*
+ * Struct: bench_options
+ * ---------------------
+ * The options of a benchmark program
+ *
+ *       lines: the values of k
+ * repetitions: the number of timed repetitions of each benchmark
+ *    min_time: the minimum time of a repetition, in seconds
+ *       pairs: the number of pairs of bar codes tested by an iteration
+ *      filter: only the benchmarks whose name has this text are run (NULL
+ *              to run all of them)
+ *   graph_dir: the directory of the saved configuration graphs
+ *      engine: the MMC algorithm measured
+ * engine_name: its name in the command line
+ *   json_path: the file where the results are appended (NULL: none)
+ */
+struct bench_options
+{
+  std::vector<int> lines;
+  int         repetitions;
+  double      min_time;
+  long long   pairs;
+  const char *filter;
+  const char *graph_dir;
+  mmc_engine  engine;
+  const char *engine_name;
+  const char *json_path;
+};
+
+typedef struct bench_options bench_options;
+
+/*
+ * Struct: bench_result
+ * --------------------
+ * The result of a benchmark
+ *
+ *       name: the name of the benchmark
+ *  num_lines: the number of lines of the hexagonal grid (k)
+ *      items: the number of items handled by an iteration
+ * iterations: the number of iterations of a repetition
+ *         ns: the nanoseconds of an iteration, in each repetition
+ *      count: what the kernel returned
+ */
+struct bench_result
+{
+  std::string         name;
+  int                 num_lines;
+  long long           items;
+  long long           iterations;
+  std::vector<double> ns;
+  long long           count;
+};
+
+typedef struct bench_result bench_result;
+
+/*
+ * Struct: bench_mmc_input
+ * -----------------------
+ * The input of the MMC kernel
+ *
+ *      G: the configuration graph
+ * weight: the weights of its arcs
+ * engine: the MMC algorithm
+ */
+struct bench_mmc_input
+{
+  const lemon::SmartDigraph              *G;
+  const lemon::SmartDigraph::ArcMap<int> *weight;
+  mmc_engine                              engine;
+};
+
+typedef struct bench_mmc_input bench_mmc_input;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: bench_random
+ * ----------------------
+ * The next number of a generator (splitmix64), the same in every machine
+ *
+ * state: the state of the generator, started with BENCHMARK_SEED
+ */
+inline uint64_t bench_random(uint64_t *state)
+{
+  uint64_t z;
+
+  *state += 0x9e3779b97f4a7c15ULL;
+  z = *state;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+  return z ^ (z >> 31);
+}
+
+/*
+ * Function: bench_pairs
+ * ---------------------
+ * Draws the pairs of bar codes tested by the benchmarks of the unions,
+ * uniformly among all the pairs (as the construction of the edges tests
+ * them)
+ *
+ *    n: the number of bar codes
+ *  amt: the number of pairs
+ * pair: where the pairs are stored (pair[2 i] and pair[2 i +1])
+ */
+inline void bench_pairs(int n, long long amt, std::vector<int> *pair)
+{
+  uint64_t state;
+  long long i;
+
+  state = BENCHMARK_SEED;
+  pair->resize(2 * amt);
+
+  for (i = 0; i < 2 * amt; i++)
+    (*pair)[i] = (int) (bench_random(&state) % (uint64_t) n);
+}
+
+/*
+ * Function: print_bench_usage
+ * ---------------------------
+ * Outputs the options of a benchmark program
+ */
+inline void print_bench_usage(const char *program)
+{
+  std::cerr << "Usage: " << program << " <number of lines> ... [options]\n"
+	    << "  --repetitions=N  timed repetitions of each benchmark ("
+	    << BENCHMARK_DEFAULT_REPETITIONS << " by default)\n"
+	    << "  --min-time=S     minimum seconds of a repetition ("
+	    << BENCHMARK_DEFAULT_MIN_TIME << " by default)\n"
+	    << "  --pairs=N        pairs of bar codes tested by an iteration ("
+	    << BENCHMARK_DEFAULT_PAIRS << " by default)\n"
+	    << "  --filter=TEXT    only runs the benchmarks whose name has"
+	    << " TEXT\n"
+	    << "  --graph-dir=DIR  directory of the saved configuration graphs"
+	    << " (" << BENCHMARK_DEFAULT_DIR << " by default)\n"
+	    << "  --mmc=ENGINE     MMC algorithm measured (hartmann-orlin by"
+	    << " default)\n"
+	    << "  --json=FILE      appends the results to FILE, one JSON"
+	    << " object per line\n";
+}
+
+/*
+ * Function: parse_bench_options
+ * -----------------------------
+ * Reads the options of a benchmark program
+ *
+ *    argc: the number of arguments
+ *    argv: the arguments
+ * options: where the options are stored
+ *
+ * returns: 1 if the arguments are valid, otherwise, 0 (after printing the
+ *          usage)
+ */
+inline int parse_bench_options(int argc, char **argv, bench_options *options)
+{
+  int i;
+
+  options->lines.clear();
+  options->repetitions = BENCHMARK_DEFAULT_REPETITIONS;
+  options->min_time = BENCHMARK_DEFAULT_MIN_TIME;
+  options->pairs = BENCHMARK_DEFAULT_PAIRS;
+  options->filter = NULL;
+  options->graph_dir = BENCHMARK_DEFAULT_DIR;
+  options->engine = MMC_HARTMANN_ORLIN;
+  options->engine_name = "hartmann-orlin";
+  options->json_path = NULL;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (argv[i][0] >= '0' && argv[i][0] <= '9' && atoi(argv[i]) >= 2)
+	options->lines.push_back(atoi(argv[i]));
+      else if (strncmp(argv[i], "--repetitions=", 14) == 0 &&
+	       atoi(argv[i] +14) >= 1)
+	options->repetitions = atoi(argv[i] +14);
+      else if (strncmp(argv[i], "--min-time=", 11) == 0 &&
+	       atof(argv[i] +11) > 0)
+	options->min_time = atof(argv[i] +11);
+      else if (strncmp(argv[i], "--pairs=", 8) == 0 &&
+	       atoll(argv[i] +8) >= 1)
+	options->pairs = atoll(argv[i] +8);
+      else if (strncmp(argv[i], "--filter=", 9) == 0)
+	options->filter = argv[i] +9;
+      else if (strncmp(argv[i], "--graph-dir=", 12) == 0 &&
+	       argv[i][12] != '\0')
+	options->graph_dir = argv[i] +12;
+      else if (strncmp(argv[i], "--mmc=", 6) == 0 &&
+	       parse_mmc_engine(argv[i] +6, &options->engine) == 1)
+	options->engine_name = argv[i] +6;
+      else if (strncmp(argv[i], "--json=", 7) == 0 && argv[i][7] != '\0')
+	options->json_path = argv[i] +7;
+      else
+	{
+	  std::cerr << "Invalid argument: " << argv[i] << "\n";
+	  print_bench_usage(argv[0]);
+	  return 0;
+	}
+    }
+
+  if (options->lines.empty())
+    {
+      print_bench_usage(argv[0]);
+      return 0;
+    }
+
+  return 1;
+}
+
+/*
+ * Function: bench_selected
+ * ------------------------
+ * returns: 1 if the benchmark passes the filter, otherwise, 0
+ */
+inline int bench_selected(const bench_options &options, const char *name)
+{
+  if (options.filter == NULL || strstr(name, options.filter) != NULL)
+    return 1;
+
+  return 0;
+}
+
+/*
+ * Function: bench_graph_file
+ * --------------------------
+ * Creates, if needed, the directory of the saved configuration graphs
+ *
+ *       dir: the directory
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *
+ * returns: the name of the CSR file of the configuration graph
+ */
+inline std::string bench_graph_file(const char *dir, int num_lines,
+				    int width, int overlap)
+{
+  // the directory may already exist
+  mkdir(dir, 0755);
+
+  return graph_file_name(dir, num_lines, width, overlap, CACHE_TYPE_IDCODE,
+			 ".csr");
+}
+
+/*
+ * Function: bench_time
+ * --------------------
+ * Runs a kernel a number of times
+ *
+ *     kernel: the kernel
+ *      input: its input
+ * iterations: the number of runs
+ *      count: where the result of the last run is stored
+ *
+ * returns: the nanoseconds of all the runs
+ */
+inline double bench_time(bench_kernel kernel, void *input,
+			 long long iterations, long long *count)
+{
+  std::chrono::steady_clock::time_point start;
+  long long i;
+
+  start = std::chrono::steady_clock::now();
+  for (i = 0; i < iterations; i++)
+    *count = kernel(input);
+
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Function: run_benchmark
+ * -----------------------
+ * Measures a kernel: a run to warm the caches and find the number of
+ * iterations of a repetition, and then the timed repetitions
+ *
+ *      name: the name of the benchmark
+ * num_lines: the number of lines of the hexagonal grid
+ *     items: the number of items handled by a run of the kernel
+ *    kernel: the kernel
+ *     input: its input
+ *   options: the options of the benchmarks
+ *    result: where the result is stored
+ */
+inline void run_benchmark(const char *name, int num_lines, long long items,
+			  bench_kernel kernel, void *input,
+			  const bench_options &options, bench_result *result)
+{
+  double elapsed;
+  int r;
+
+  result->name = name;
+  result->num_lines = num_lines;
+  result->items = items;
+  result->ns.clear();
+
+  // the iterations which fill the minimum time, from the first run
+  elapsed = bench_time(kernel, input, 1, &result->count);
+  result->iterations = (long long) (options.min_time * 1e9 /
+				    std::max(elapsed, 1.0));
+  result->iterations = std::max(1LL, std::min(result->iterations,
+					      1000000000LL));
+
+  for (r = 0; r < options.repetitions; r++)
+    result->ns.push_back(bench_time(kernel, input, result->iterations,
+				    &result->count) / result->iterations);
+}
+
+/*
+ * Function: bench_median
+ * ----------------------
+ * returns: the median of the times of an iteration
+ */
+inline double bench_median(const bench_result &result)
+{
+  std::vector<double> ns;
+  size_t n;
+
+  ns = result.ns;
+  std::sort(ns.begin(), ns.end());
+  n = ns.size();
+
+  return (n % 2 == 1) ? ns[n / 2] : (ns[n / 2 -1] + ns[n / 2]) / 2;
+}
+
+/*
+ * Function: bench_deviation
+ * -------------------------
+ * returns: the standard deviation of the times of an iteration, as a
+ *          fraction of their mean
+ */
+inline double bench_deviation(const bench_result &result)
+{
+  double mean, variance;
+  size_t i;
+
+  mean = 0;
+  for (i = 0; i < result.ns.size(); i++)
+    mean += result.ns[i];
+  mean /= result.ns.size();
+
+  variance = 0;
+  for (i = 0; i < result.ns.size(); i++)
+    variance += (result.ns[i] - mean) * (result.ns[i] - mean);
+  variance /= result.ns.size();
+
+  return (mean > 0) ? std::sqrt(variance) / mean : 0;
+}
+
+/*
+ * Function: print_bench_header
+ * ----------------------------
+ * Outputs the header of the table of results
+ */
+inline void print_bench_header(std::ostream &out)
+{
+  out << std::left << std::setw(28) << "benchmark" << std::right
+      << std::setw(4) << "k" << std::setw(12) << "iterations"
+      << std::setw(16) << "median (ns)" << std::setw(16) << "min (ns)"
+      << std::setw(9) << "dev" << std::setw(14) << "ns/item"
+      << std::setw(12) << "count" << "\n";
+}
+
+/*
+ * Function: print_bench_result
+ * ----------------------------
+ * Outputs a result as a line of the table
+ */
+inline void print_bench_result(std::ostream &out, const bench_result &result)
+{
+  double median;
+
+  median = bench_median(result);
+
+  out << std::left << std::setw(28) << result.name << std::right
+      << std::setw(4) << result.num_lines
+      << std::setw(12) << result.iterations
+      << std::fixed << std::setprecision(0)
+      << std::setw(16) << median
+      << std::setw(16) << *std::min_element(result.ns.begin(),
+					    result.ns.end())
+      << std::setprecision(1) << std::setw(8)
+      << 100 * bench_deviation(result) << "%"
+      << std::setprecision(2) << std::setw(14) << median / result.items
+      << std::setw(12) << result.count << "\n";
+  out.unsetf(std::ios::fixed);
+  out << std::setprecision(6);
+}
+
+/*
+ * Function: save_bench_result
+ * ---------------------------
+ * Appends a result to a file, as a JSON object in a single line
+ *
+ *    path: the file
+ * program: the name of the benchmark program
+ *  result: the result
+ *
+ * returns: 1 if the result was written, otherwise, 0
+ */
+inline int save_bench_result(const char *path, const char *program,
+			     const bench_result &result)
+{
+  std::ofstream file;
+  size_t i;
+
+  file.open(path, std::ios::app);
+  if (!file.is_open())
+    return 0;
+
+  file << std::fixed << std::setprecision(0)
+       << "{\"program\":\"" << program << "\",\"benchmark\":\""
+       << result.name << "\",\"lines\":" << result.num_lines
+       << ",\"timestamp\":" << (long long) time(NULL)
+       << ",\"items\":" << result.items
+       << ",\"iterations\":" << result.iterations
+       << ",\"median_ns\":" << bench_median(result)
+       << ",\"ns\":[";
+  for (i = 0; i < result.ns.size(); i++)
+    file << ((i > 0) ? "," : "") << result.ns[i];
+  file << "],\"count\":" << result.count << "}\n";
+  file.close();
+
+  return file.good() ? 1 : 0;
+}
+
+/*
+ * Function: report_benchmark
+ * --------------------------
+ * Outputs a result, and appends it to the file of --json
+ */
+inline void report_benchmark(const char *program, const bench_options &options,
+			     const bench_result &result)
+{
+  print_bench_result(std::cout, result);
+
+  if (options.json_path != NULL &&
+      save_bench_result(options.json_path, program, result) == 0)
+    std::cerr << "It was not possible to save the results in "
+	      << options.json_path << "!\n";
+}
+
+/*
+ * Function: bench_mmc_kernel
+ * --------------------------
+ * The MMC kernel: finds a minimum mean cycle of the graph
+ *
+ * returns: the cost of the cycle
+ */
+inline long long bench_mmc_kernel(void *input)
+{
+  bench_mmc_input *mmc_input;
+  mmc_result mmc;
+
+  mmc_input = (bench_mmc_input *) input;
+  run_mmc(*mmc_input->G, *mmc_input->weight, mmc_input->engine, &mmc);
+
+  return mmc.cost;
+}
+
+/*
+ * Function: bench_mmc
+ * -------------------
+ * Measures the MMC algorithm of the options on a saved configuration
+ * graph
+ *
+ *   program: the name of the benchmark program
+ *      path: the CSR file of the graph
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *   options: the options of the benchmarks
+ *
+ * returns: 1 if the graph was read, otherwise, 0
+ */
+inline int bench_mmc(const char *program, const std::string &path,
+		     int num_lines, int width, int overlap,
+		     const bench_options &options)
+{
+  lemon::SmartDigraph G;
+  csr_graph csr;
+  bench_mmc_input input;
+  bench_result result;
+  std::string name;          // mmc/ followed by the engine of --mmc
+  int64_t u;
+
+  if (open_csr_graph(path.c_str(), num_lines, width, overlap,
+		     CACHE_TYPE_IDCODE, &csr) == 0)
+    return 0;
+
+  lemon::SmartDigraph::ArcMap<int> weight(G);
+  G.reserveNode((int) csr.header->nodes);
+  for (u = 0; u < csr.header->nodes; u++)
+    G.addNode();
+  csr_add_arcs(csr, &G, &weight);
+  close_csr_graph(&csr);
+
+  input.G = &G;
+  input.weight = &weight;
+  input.engine = options.engine;
+
+  name = std::string("mmc/") + options.engine_name;
+  run_benchmark(name.c_str(), num_lines, lemon::countArcs(G),
+		bench_mmc_kernel, &input, options, &result);
+  report_benchmark(program, options, result);
+
+  return 1;
+}
+
+#endif
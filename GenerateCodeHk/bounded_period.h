@@ -0,0 +1,186 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Search for the code with the smallest density among the codes whose
+   period is bounded (--max-period). Instead of a minimum mean cycle,
+   a dynamic program over the length of the walks finds, for every
+   length l up to a limit, the closed walk with l arcs of minimum
+   weight in the configuration graph.
+
+   Every closed walk is counted from its vertex with the smallest id, s,
+   and only passes through vertices with id at least s, so the sources
+   are independent and the dynamic programs run in parallel (OpenMP),
+   each one with (l + 1) n entries.
+*/
+
+#ifndef BOUNDED_PERIOD_H
+#define BOUNDED_PERIOD_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <vector>
+#include <climits>
+#include <lemon/smart_graph.h>
+#include <lemon/path.h>
+#include "mmc_engine.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// weight of a walk which does not exist
+#define PERIOD_INF (LLONG_MAX / 4)
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: period_walks_from
+ * ---------------------------
+ * Computes D[l * n + v], the minimum weight of a walk with l arcs from
+ * s to v which only passes through vertices with id at least s
+ *
+ *          G: the configuration graph
+ *     weight: the weights of the arcs of G
+ *          s: the first vertex of the walks
+ * max_length: the largest number of arcs of a walk
+ *          D: where the weights are stored
+ *     parent: where the last arc of each walk is stored (may be NULL)
+ */
+inline void period_walks_from(const lemon::SmartDigraph &G,
+			      const lemon::SmartDigraph::ArcMap<int> &weight,
+			      int s, int max_length, std::vector<long long> &D,
+			      std::vector<int> *parent)
+{
+  long long x;
+  int n, l, u, v;
+
+  n = lemon::countNodes(G);
+  D.assign((size_t) (max_length +1) * n, PERIOD_INF);
+  if (parent != NULL)
+    parent->assign((size_t) (max_length +1) * n, -1);
+
+  D[s] = 0;
+  for (l = 0; l < max_length; l++)
+    for (u = s; u < n; u++)
+      {
+	if (D[(size_t) l * n + u] == PERIOD_INF)
+	  continue;
+
+	for (lemon::SmartDigraph::OutArcIt a(G, G.nodeFromId(u));
+	     a != lemon::INVALID; ++a)
+	  {
+	    v = G.id(G.target(a));
+	    if (v < s)
+	      continue;
+
+	    x = D[(size_t) l * n + u] + weight[a];
+	    if (x < D[(size_t) (l +1) * n + v])
+	      {
+		D[(size_t) (l +1) * n + v] = x;
+		if (parent != NULL)
+		  (*parent)[(size_t) (l +1) * n + v] = G.id(a);
+	      }
+	  }
+      }
+}
+
+/*
+ * Function: bounded_period_dp
+ * ---------------------------
+ * Finds, for every length l = 1, ..., max_length, the minimum weight of
+ * a closed walk with l arcs, and the closed walk with the smallest mean
+ * among them (the shortest one, in a tie)
+ *
+ *          G: the configuration graph
+ *     weight: the weights of the arcs of G
+ * max_length: the largest number of arcs of a closed walk
+ *       cost: cost[l] = minimum weight of a closed walk with l arcs
+ *             (PERIOD_INF if there is none)
+ *     result: where the best closed walk is stored
+ *
+ * returns: 1 if G has a closed walk with at most max_length arcs,
+ *          otherwise, 0
+ */
+inline int bounded_period_dp(const lemon::SmartDigraph &G,
+			     const lemon::SmartDigraph::ArcMap<int> &weight,
+			     int max_length, std::vector<long long> *cost,
+			     mmc_result *result)
+{
+  std::vector<int> source, parent, walk;
+  std::vector<long long> D;
+  int n, s, l, best_l, u;
+
+  n = lemon::countNodes(G);
+  cost->assign(max_length +1, PERIOD_INF);
+  source.assign(max_length +1, -1);
+
+  result->found = 0;
+  result->cost = 0;
+  result->size = 0;
+  result->iterations = 0;
+  result->cycle.clear();
+
+  # pragma omp parallel
+  {
+    std::vector<long long> local_D;
+    std::vector<long long> local_cost(max_length +1, PERIOD_INF);
+    std::vector<int> local_source(max_length +1, -1);
+    int t, i;
+
+    # pragma omp for schedule(dynamic)
+    for (t = 0; t < n; t++)
+      {
+	period_walks_from(G, weight, t, max_length, local_D, NULL);
+
+	for (i = 1; i <= max_length; i++)
+	  if (local_D[(size_t) i * n + t] < local_cost[i])
+	    {
+	      local_cost[i] = local_D[(size_t) i * n + t];
+	      local_source[i] = t;
+	    }
+      }
+
+    // in a tie, the smallest source is kept, so the walk found does not
+    // depend on the number of threads
+    # pragma omp critical
+    for (i = 1; i <= max_length; i++)
+      if (local_source[i] != -1 &&
+	  (local_cost[i] < (*cost)[i] ||
+	   (local_cost[i] == (*cost)[i] && local_source[i] < source[i])))
+	{
+	  (*cost)[i] = local_cost[i];
+	  source[i] = local_source[i];
+	}
+  }
+
+  best_l = -1;
+  for (l = 1; l <= max_length; l++)
+    if ((*cost)[l] != PERIOD_INF &&
+	(best_l == -1 || (*cost)[l] * best_l < (*cost)[best_l] * l))
+      best_l = l;
+
+  if (best_l == -1)
+    return 0;
+
+  // rebuilds the best closed walk, going backwards from its source
+  s = source[best_l];
+  period_walks_from(G, weight, s, best_l, D, &parent);
+
+  u = s;
+  for (l = best_l; l > 0; l--)
+    {
+      walk.push_back(parent[(size_t) l * n + u]);
+      u = G.id(G.source(G.arcFromId(walk.back())));
+    }
+
+  for (l = best_l -1; l >= 0; l--)
+    result->cycle.addBack(G.arcFromId(walk[l]));
+
+  result->found = 1;
+  result->cost = (*cost)[best_l];
+  result->size = best_l;
+  return 1;
+}
+
+#endif
@@ -0,0 +1,261 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Certificate of optimality of a minimum mean cycle. Besides the cycle,
+   with mean p/q, the certificate has a potential pi(v) for every vertex
+   of the configuration graph such that
+
+       q w(u, v) - p + pi(u) - pi(v) >= 0   for every arc (u, v).
+
+   Summing over the arcs of any cycle C, the potentials cancel out, so
+   q w(C) >= p |C|, that is, no cycle has mean smaller than p/q. Hence the
+   certificate is checked with one pass over the arcs, which is much
+   cheaper than running an MMC algorithm again.
+
+   File format (binary, byte order of the machine which wrote it):
+       certificate_header
+       int32_t cycle[size]       ids of the arcs of the cycle, in order
+       int64_t potential[nodes]  potential of each vertex, by id
+*/
+
+#ifndef CERTIFICATE_H
+#define CERTIFICATE_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <lemon/smart_graph.h>
+#include <lemon/path.h>
+#include "mmc_engine.h"
+#include "lawler_mmc.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// first bytes of a certificate file (the last two are the version)
+#define CERTIFICATE_MAGIC "HKCERT01"
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: certificate_header
+ * --------------------------
+ * The beginning of a certificate file
+ *
+ *     magic: CERTIFICATE_MAGIC
+ * num_lines: the number of lines of the hexagonal grid (k)
+ *     width: the number of columns of a bar of the configuration graph
+ *   overlap: the number of columns shared by two consecutive bars
+ *      size: the number of arcs of the cycle (q)
+ *     nodes: the number of vertices of the configuration graph
+ *      arcs: the number of arcs of the configuration graph
+ *      cost: the total weight of the cycle (p)
+ */
+struct certificate_header
+{
+  char    magic[8];
+  int32_t num_lines;
+  int32_t width;
+  int32_t overlap;
+  int32_t size;
+  int64_t nodes;
+  int64_t arcs;
+  int64_t cost;
+};
+
+typedef struct certificate_header certificate_header;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: write_certificate
+ * ---------------------------
+ * Computes the potentials of the vertices (the distances with the
+ * weights q w - p, from a virtual source linked to every vertex) and
+ * saves the certificate of the minimum mean cycle found
+ *
+ *      path: the name of the certificate file
+ *         G: the configuration graph
+ *    weight: the weights of the arcs of G
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar
+ *   overlap: the number of columns shared by two consecutive bars
+ *    result: the minimum mean cycle found
+ *
+ * returns: 1 if the certificate was saved, otherwise, 0 (the cycle is
+ *          not a minimum mean cycle or the file could not be written)
+ */
+inline int write_certificate(const char *path, const lemon::SmartDigraph &G,
+			     const lemon::SmartDigraph::ArcMap<int> &weight,
+			     int num_lines, int width, int overlap,
+			     const mmc_result *result)
+{
+  certificate_header header;
+  lawler_workspace ws;
+  std::vector<int> cycle;
+  std::vector<int32_t> arcs;
+  std::vector<int64_t> potential;
+  std::ofstream file;
+  int v;
+
+  // with p/q optimal there is no negative cycle, and the distances are
+  // the potentials
+  if (lawler_probe(G, weight, result->size, result->cost, &ws, cycle) == 1)
+    {
+      std::cerr << "The cycle is not a minimum mean cycle!\n";
+      return 0;
+    }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CERTIFICATE_MAGIC, 8);
+  header.num_lines = num_lines;
+  header.width = width;
+  header.overlap = overlap;
+  header.size = result->size;
+  header.nodes = lemon::countNodes(G);
+  header.arcs = lemon::countArcs(G);
+  header.cost = result->cost;
+
+  for (lemon::Path<lemon::SmartDigraph>::ArcIt a(result->cycle);
+       a != lemon::INVALID; ++a)
+    arcs.push_back(G.id(a));
+
+  potential.resize(header.nodes);
+  for (v = 0; v < header.nodes; v++)
+    potential[v] = (int64_t) ws.dist[v];
+
+  file.open(path, std::ios::binary);
+  if (!file.is_open())
+    {
+      std::cerr << "It was not possible to create " << path << "\n";
+      return 0;
+    }
+
+  file.write((const char *) &header, sizeof(header));
+  file.write((const char *) arcs.data(), arcs.size() * sizeof(int32_t));
+  file.write((const char *) potential.data(),
+	     potential.size() * sizeof(int64_t));
+  file.close();
+
+  return file.good() ? 1 : 0;
+}
+
+/*
+ * Function: check_certificate
+ * ---------------------------
+ * Checks a certificate against the configuration graph, with one pass
+ * over the arcs of the cycle and one pass over all the arcs
+ *
+ *      path: the name of the certificate file
+ *         G: the configuration graph (regenerated by the program)
+ *    weight: the weights of the arcs of G
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar
+ *   overlap: the number of columns shared by two consecutive bars
+ *    result: where the certified cycle is stored
+ *
+ * returns: 1 if the certificate is valid, otherwise, 0 (after printing
+ *          what is wrong)
+ */
+inline int check_certificate(const char *path, const lemon::SmartDigraph &G,
+			     const lemon::SmartDigraph::ArcMap<int> &weight,
+			     int num_lines, int width, int overlap,
+			     mmc_result *result)
+{
+  certificate_header header;
+  std::vector<int32_t> arcs;
+  std::vector<int64_t> potential;
+  std::ifstream file;
+  long long cost;
+  int i;
+
+  result->found = 0;
+  result->cycle.clear();
+
+  file.open(path, std::ios::binary);
+  if (!file.is_open())
+    {
+      std::cerr << "It was not possible to open " << path << "\n";
+      return 0;
+    }
+
+  file.read((char *) &header, sizeof(header));
+  if (!file || memcmp(header.magic, CERTIFICATE_MAGIC, 8) != 0)
+    {
+      std::cerr << path << " is not a certificate file!\n";
+      return 0;
+    }
+
+  if (header.num_lines != num_lines || header.width != width ||
+      header.overlap != overlap || header.nodes != lemon::countNodes(G) ||
+      header.arcs != lemon::countArcs(G) || header.size < 1 ||
+      header.size > header.arcs)
+    {
+      std::cerr << "The certificate is not of this configuration graph!\n";
+      return 0;
+    }
+
+  arcs.resize(header.size);
+  potential.resize(header.nodes);
+  file.read((char *) arcs.data(), arcs.size() * sizeof(int32_t));
+  file.read((char *) potential.data(), potential.size() * sizeof(int64_t));
+  if (!file)
+    {
+      std::cerr << "The certificate file is truncated!\n";
+      return 0;
+    }
+
+  // the cycle: consecutive arcs, closed, with the weight of the header
+  for (i = 0; i < header.size; i++)
+    if (arcs[i] < 0 || arcs[i] >= header.arcs)
+      {
+	std::cerr << "The certificate has an invalid arc!\n";
+	return 0;
+      }
+
+  cost = 0;
+  for (i = 0; i < header.size; i++)
+    {
+      if (G.target(G.arcFromId(arcs[i])) !=
+	  G.source(G.arcFromId(arcs[(i +1) % header.size])))
+	{
+	  std::cerr << "The arcs of the certificate do not form a cycle!\n";
+	  return 0;
+	}
+
+      cost += weight[G.arcFromId(arcs[i])];
+    }
+
+  if (cost != header.cost)
+    {
+      std::cerr << "The weight of the cycle is " << cost << ", not "
+		<< header.cost << "!\n";
+      return 0;
+    }
+
+  // the potentials: no arc has negative reduced cost
+  for (lemon::SmartDigraph::ArcIt e(G); e != lemon::INVALID; ++e)
+    if ((__int128) header.size * weight[e] - header.cost +
+	potential[G.id(G.source(e))] - potential[G.id(G.target(e))] < 0)
+      {
+	std::cerr << "The arc " << G.id(e) << " has negative reduced cost!\n";
+	return 0;
+      }
+
+  for (i = 0; i < header.size; i++)
+    result->cycle.addBack(G.arcFromId(arcs[i]));
+
+  result->found = 1;
+  result->cost = header.cost;
+  result->size = header.size;
+  result->iterations = 0;
+  return 1;
+}
+
+#endif
@@ -0,0 +1,439 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Checkpoints of the construction of the configuration graph
+   (--checkpoint and --resume). While the bars are enumerated and while
+   the arcs are created, the state of the run is saved periodically, so
+   a run which is interrupted can continue from the last checkpoint and
+   build the same graph (same ids of the vertices and of the arcs) and
+   find the same code as a run which was not interrupted.
+
+   A checkpoint is saved in <dir>/H<k>_w<width>_o<overlap>_<type>.ckpt
+   with
+
+       checkpoint_header
+       uint64_t bar[bars]     the bar codes found (bit r * width + c is
+                              the vertex (r, c)): in the order of the
+                              list of bar codes while the bars are
+                              enumerated, by id of the vertex while the
+                              arcs are created
+       int32_t  arc[arcs][2]  source and target of each arc, by id
+
+   in the byte order of the machine which wrote it, and the checksums of
+   graph_cache.h. The file is written with another name and renamed, so
+   an interruption while saving leaves the previous checkpoint.
+
+   The bars are enumerated as a binary counter (generate_all_bars and
+   next_config), with the last vertex of the bar as the least
+   significant bit, so the value of the counter is the number of bars
+   already tested. The arcs are created from the source with the largest
+   id to the one with id 0, so the sources already processed are the
+   ones with id greater than next_source.
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <sys/stat.h>
+#include <lemon/smart_graph.h>
+#include "graph_cache.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// first bytes of a checkpoint
+#define CHECKPOINT_MAGIC "HKCKPT"
+
+// version of the format
+#define CHECKPOINT_VERSION 1
+
+// directory used by --checkpoint and --resume without a directory
+#define CHECKPOINT_DEFAULT_DIR "../Checkpoints"
+
+// seconds between two checkpoints, by default
+#define CHECKPOINT_DEFAULT_INTERVAL 600
+
+// number of bars tested between two readings of the clock
+#define CHECKPOINT_BAR_STEP 4096
+
+// number of sources whose arcs are found in parallel between two
+// readings of the clock
+#define CHECKPOINT_SOURCE_BLOCK 256
+
+// phases of the construction of the configuration graph
+#define CHECKPOINT_NONE  0
+#define CHECKPOINT_BARS  1
+#define CHECKPOINT_EDGES 2
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: checkpoint_header
+ * -------------------------
+ * The beginning of a checkpoint
+ *
+ *           magic: CHECKPOINT_MAGIC
+ *         version: CHECKPOINT_VERSION
+ *       num_lines: the number of lines of the hexagonal grid (k)
+ *           width: the number of columns of a bar code
+ *         overlap: the number of columns shared by two consecutive bars
+ *           phase: CHECKPOINT_BARS or CHECKPOINT_EDGES
+ *            type: the type of code, as CACHE_TYPE_IDCODE
+ *          cursor: the number of bars tested (CHECKPOINT_BARS)
+ *     next_source: the id of the next source whose arcs are created
+ *                  (CHECKPOINT_EDGES)
+ *            bars: the number of bar codes
+ *            arcs: the number of arcs
+ *        checksum: checksum of the bytes after the header
+ * header_checksum: checksum of the fields above
+ */
+struct checkpoint_header
+{
+  char     magic[8];
+  int32_t  version;
+  int32_t  num_lines;
+  int32_t  width;
+  int32_t  overlap;
+  int32_t  phase;
+  char     type[16];
+  uint64_t cursor;
+  int64_t  next_source;
+  int64_t  bars;
+  int64_t  arcs;
+  uint64_t checksum;
+  uint64_t header_checksum;
+};
+
+typedef struct checkpoint_header checkpoint_header;
+
+/*
+ * Struct: checkpoint
+ * ------------------
+ * The checkpoints of a run
+ *
+ *        path: the name of the checkpoint
+ *    interval: the seconds between two checkpoints
+ *        last: when the last checkpoint was saved (or the run started)
+ *   num_lines: the number of lines of the hexagonal grid
+ *       width: the number of columns of a bar code
+ *     overlap: the number of columns shared by two consecutive bars
+ *        type: the type of code
+ *       phase: the phase of the checkpoint loaded by --resume
+ *              (CHECKPOINT_NONE if there is none)
+ *      cursor: the number of bars tested
+ * next_source: the id of the next source whose arcs are created
+ *         bar: the bar codes found
+ *         arc: the arcs of the checkpoint loaded, as pairs (source,
+ *              target), by id
+ */
+struct checkpoint
+{
+  std::string path;
+  long long   interval;
+  std::chrono::steady_clock::time_point last;
+  int         num_lines;
+  int         width;
+  int         overlap;
+  const char *type;
+  int         phase;
+  uint64_t    cursor;
+  int64_t     next_source;
+  std::vector<uint64_t> bar;
+  std::vector<int32_t>  arc;
+};
+
+typedef struct checkpoint checkpoint;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: checkpoint_file_name
+ * ------------------------------
+ * Creates, if needed, the directory of the checkpoints
+ *
+ *       dir: the directory of the checkpoints
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *      type: the type of code
+ *
+ * returns: the name of the checkpoint of the configuration graph
+ */
+inline std::string checkpoint_file_name(const char *dir, int num_lines,
+					int width, int overlap,
+					const char *type)
+{
+  // the directory may already exist
+  mkdir(dir, 0755);
+
+  return graph_file_name(dir, num_lines, width, overlap, type, ".ckpt");
+}
+
+/*
+ * Function: checkpoint_init
+ * -------------------------
+ * Starts the checkpoints of a run, with no checkpoint loaded
+ */
+inline void checkpoint_init(checkpoint *ckpt, const std::string &path,
+			    long long interval, int num_lines, int width,
+			    int overlap, const char *type)
+{
+  ckpt->path = path;
+  ckpt->interval = interval;
+  ckpt->last = std::chrono::steady_clock::now();
+  ckpt->num_lines = num_lines;
+  ckpt->width = width;
+  ckpt->overlap = overlap;
+  ckpt->type = type;
+  ckpt->phase = CHECKPOINT_NONE;
+  ckpt->cursor = 0;
+  ckpt->next_source = -1;
+  ckpt->bar.clear();
+  ckpt->arc.clear();
+}
+
+/*
+ * Function: checkpoint_due
+ * ------------------------
+ * returns: 1 if the interval between two checkpoints has passed since
+ *          the last one, otherwise, 0
+ */
+inline int checkpoint_due(const checkpoint *ckpt)
+{
+  return (std::chrono::steady_clock::now() - ckpt->last >=
+	  std::chrono::seconds(ckpt->interval)) ? 1 : 0;
+}
+
+/*
+ * Function: checkpoint_counter
+ * ----------------------------
+ * Sets a bar to the value of the counter of generate_all_bars and
+ * next_config, the last vertex being the least significant bit
+ *
+ *     bar: the bar (0s and 1s)
+ *    size: the number of vertices of the bar
+ * counter: the value of the counter
+ */
+inline void checkpoint_counter(int *bar, int size, uint64_t counter)
+{
+  int i;
+
+  for (i = 0; i < size; i++)
+    bar[i] = (int) ((counter >> (size -1 - i)) & 1);
+}
+
+/*
+ * Function: checkpoint_init_header
+ * --------------------------------
+ * Fills the fields of a header which identify the configuration graph
+ */
+inline void checkpoint_init_header(checkpoint_header *header,
+				   const checkpoint *ckpt)
+{
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+  header->version = CHECKPOINT_VERSION;
+  header->num_lines = ckpt->num_lines;
+  header->width = ckpt->width;
+  header->overlap = ckpt->overlap;
+  strncpy(header->type, ckpt->type, sizeof(header->type) -1);
+}
+
+/*
+ * Function: save_checkpoint
+ * -------------------------
+ * Saves the state of the run, with the bar codes in ckpt->bar, and
+ * restarts the interval until the next checkpoint
+ *
+ *        ckpt: the checkpoints of the run
+ *       phase: CHECKPOINT_BARS or CHECKPOINT_EDGES
+ *      cursor: the number of bars tested
+ * next_source: the id of the next source whose arcs are created
+ *           G: the configuration graph with the arcs created (NULL
+ *              while the bars are enumerated)
+ *
+ * returns: 1 if the checkpoint was saved, otherwise, 0
+ */
+inline int save_checkpoint(checkpoint *ckpt, int phase, uint64_t cursor,
+			   int64_t next_source, const lemon::SmartDigraph *G)
+{
+  checkpoint_header header;
+  cache_hasher h;
+  std::vector<int32_t> arc;
+  std::string temporary;
+  std::ofstream file;
+  int a, m;
+
+  m = (G != NULL) ? lemon::countArcs(*G) : 0;
+  arc.resize((size_t) 2 * m);
+  for (a = 0; a < m; a++)
+    {
+      arc[2 * (size_t) a] = G->id(G->source(G->arcFromId(a)));
+      arc[2 * (size_t) a +1] = G->id(G->target(G->arcFromId(a)));
+    }
+
+  checkpoint_init_header(&header, ckpt);
+  header.phase = phase;
+  header.cursor = cursor;
+  header.next_source = next_source;
+  header.bars = (int64_t) ckpt->bar.size();
+  header.arcs = m;
+
+  cache_hash_init(&h);
+  cache_hash_update(&h, ckpt->bar.data(), ckpt->bar.size() * sizeof(uint64_t));
+  cache_hash_update(&h, arc.data(), arc.size() * sizeof(int32_t));
+
+  header.checksum = cache_hash_final(&h);
+  header.header_checksum = cache_checksum(&header,
+					  offsetof(checkpoint_header,
+						   header_checksum));
+
+  // the next interval starts now, even if this checkpoint fails
+  ckpt->last = std::chrono::steady_clock::now();
+
+  temporary = ckpt->path + ".tmp";
+  file.open(temporary.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return 0;
+
+  file.write((const char *) &header, sizeof(header));
+  file.write((const char *) ckpt->bar.data(),
+	     ckpt->bar.size() * sizeof(uint64_t));
+  file.write((const char *) arc.data(), arc.size() * sizeof(int32_t));
+  file.close();
+
+  if (!file.good() || rename(temporary.c_str(), ckpt->path.c_str()) != 0)
+    {
+      remove(temporary.c_str());
+      return 0;
+    }
+
+  return 1;
+}
+
+/*
+ * Function: load_checkpoint
+ * -------------------------
+ * Loads the last checkpoint of the configuration graph, if there is one
+ *
+ * ckpt: the checkpoints of the run, where the state is stored
+ *
+ * returns: 1 if the checkpoint was loaded or there is no checkpoint
+ *          (ckpt->phase is then CHECKPOINT_NONE), otherwise, 0 (a
+ *          checkpoint which does not match or is corrupted)
+ */
+inline int load_checkpoint(checkpoint *ckpt)
+{
+  checkpoint_header header, expected;
+  cache_hasher h;
+  std::ifstream file;
+
+  ckpt->phase = CHECKPOINT_NONE;
+
+  file.open(ckpt->path.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return 1;
+
+  checkpoint_init_header(&expected, ckpt);
+
+  if (!file.read((char *) &header, sizeof(header)) ||
+      memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+      header.version != expected.version ||
+      header.num_lines != expected.num_lines ||
+      header.width != expected.width || header.overlap != expected.overlap ||
+      memcmp(header.type, expected.type, sizeof(header.type)) != 0 ||
+      header.header_checksum !=
+      cache_checksum(&header, offsetof(checkpoint_header, header_checksum)) ||
+      (header.phase != CHECKPOINT_BARS && header.phase != CHECKPOINT_EDGES) ||
+      header.bars < 0 || header.arcs < 0)
+    return 0;
+
+  ckpt->bar.resize((size_t) header.bars);
+  ckpt->arc.resize((size_t) header.arcs * 2);
+
+  if (!file.read((char *) ckpt->bar.data(),
+		 ckpt->bar.size() * sizeof(uint64_t)) ||
+      !file.read((char *) ckpt->arc.data(),
+		 ckpt->arc.size() * sizeof(int32_t)) ||
+      file.peek() != std::ifstream::traits_type::eof())
+    return 0;
+
+  cache_hash_init(&h);
+  cache_hash_update(&h, ckpt->bar.data(), ckpt->bar.size() * sizeof(uint64_t));
+  cache_hash_update(&h, ckpt->arc.data(), ckpt->arc.size() * sizeof(int32_t));
+  if (cache_hash_final(&h) != header.checksum)
+    return 0;
+
+  ckpt->phase = header.phase;
+  ckpt->cursor = header.cursor;
+  ckpt->next_source = header.next_source;
+  return 1;
+}
+
+/*
+ * Function: checkpoint_add_arcs
+ * -----------------------------
+ * Adds the arcs of the checkpoint loaded to the configuration graph, in
+ * the order of their ids, and releases them
+ *
+ *        ckpt: the checkpoint loaded
+ *           G: the configuration graph, with all its vertices and no arcs
+ *      weight: where the weights of the arcs are stored
+ * node_weight: the weights of the arcs entering each vertex, by id
+ *
+ * returns: 1 if the arcs are arcs of G, otherwise, 0
+ */
+inline int checkpoint_add_arcs(checkpoint *ckpt, lemon::SmartDigraph *G,
+			       lemon::SmartDigraph::ArcMap<int> *weight,
+			       const std::vector<int> &node_weight)
+{
+  lemon::SmartDigraph::Arc arc;
+  size_t a;
+  int n;
+
+  n = lemon::countNodes(*G);
+
+  for (a = 0; a < ckpt->arc.size(); a++)
+    if (ckpt->arc[a] < 0 || ckpt->arc[a] >= n)
+      return 0;
+
+  G->reserveArc((int) (ckpt->arc.size() / 2));
+
+  for (a = 0; a < ckpt->arc.size(); a += 2)
+    {
+      arc = G->addArc(G->nodeFromId(ckpt->arc[a]),
+		      G->nodeFromId(ckpt->arc[a +1]));
+      (*weight)[arc] = node_weight[ckpt->arc[a +1]];
+    }
+
+  std::vector<int32_t>().swap(ckpt->arc);
+  return 1;
+}
+
+/*
+ * Function: remove_checkpoint
+ * ---------------------------
+ * Removes the checkpoint, once the configuration graph is complete
+ */
+inline void remove_checkpoint(checkpoint *ckpt)
+{
+  remove(ckpt->path.c_str());
+  ckpt->phase = CHECKPOINT_NONE;
+  std::vector<uint64_t>().swap(ckpt->bar);
+  std::vector<int32_t>().swap(ckpt->arc);
+}
+
+#endif
@@ -0,0 +1,552 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Configuration graph in compressed sparse row (CSR) form, in a file
+   which other tools can map in memory without rebuilding the graph
+   (--export-csr and --import-csr; ConfigGraphCSR.py reads it with numpy).
+   Unlike the cache files of graph_cache.h, this format is fixed and
+   documented here:
+
+       offset 0           csr_header (the rest of the page is zero)
+       weight_offset      int32_t  node_weight[nodes]
+       bar_offset         uint64_t bar[nodes]
+       offsets_offset     int64_t  offsets[nodes +1]
+       targets_offset     int32_t  targets[arcs]
+
+   Every number is little-endian, and every section starts at a multiple
+   of CSR_PAGE_SIZE (the gaps are filled with zeros), so each one can be
+   mapped as an array of its type. The vertex with id u is the bar code
+   bar[u] (bit r * width + c is the vertex of the line r and column c of
+   the bar), and its arcs go to targets[offsets[u]], ...,
+   targets[offsets[u +1] -1], in the order they were created; the weight
+   of an arc is node_weight of its target.
+
+   When the flag CSR_ARC_IDS is set, the ids of the arcs are the ones
+   obtained by adding the arcs of the vertices n -1, n -2, ..., 0 (the
+   order of the programs), so the LEMON graph is rebuilt exactly, with
+   the same ids of vertices and arcs.
+*/
+
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <lemon/smart_graph.h>
+#include "graph_cache.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// first bytes of a CSR file
+#define CSR_MAGIC "HKCSR"
+
+// version of the format
+#define CSR_VERSION 1
+
+// written as a 32-bit number; read as 0x04030201 on a big-endian machine
+#define CSR_BYTE_ORDER 0x01020304u
+
+// alignment of the sections
+#define CSR_PAGE_SIZE 4096
+
+// the ids of the arcs follow the order of the vertices n -1, ..., 0
+#define CSR_ARC_IDS 1u
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: csr_header
+ * ------------------
+ * The first bytes of a CSR file (all the fields are little-endian)
+ *
+ *           magic: CSR_MAGIC, completed with zeros
+ *         version: CSR_VERSION
+ *      byte_order: CSR_BYTE_ORDER
+ *       num_lines: the number of lines of the hexagonal grid (k)
+ *           width: the number of columns of a bar code
+ *         overlap: the number of columns shared by two consecutive bars
+ *           flags: CSR_ARC_IDS, if the ids of the arcs can be rebuilt
+ *            type: the type of code, as CACHE_TYPE_IDCODE
+ *           nodes: the number of vertices of the configuration graph
+ *            arcs: the number of arcs of the configuration graph
+ *   weight_offset: the position of node_weight in the file
+ *      bar_offset: the position of bar in the file
+ *  offsets_offset: the position of offsets in the file
+ *  targets_offset: the position of targets in the file
+ *       file_size: the size of the file
+ *        checksum: checksum (as in graph_cache.h) of the bytes from
+ *                  CSR_PAGE_SIZE up to the end of the file
+ * header_checksum: checksum of the fields above
+ */
+struct csr_header
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  int32_t  num_lines;
+  int32_t  width;
+  int32_t  overlap;
+  uint32_t flags;
+  char     type[16];
+  int64_t  nodes;
+  int64_t  arcs;
+  uint64_t weight_offset;
+  uint64_t bar_offset;
+  uint64_t offsets_offset;
+  uint64_t targets_offset;
+  uint64_t file_size;
+  uint64_t checksum;
+  uint64_t header_checksum;
+};
+
+typedef struct csr_header csr_header;
+
+/*
+ * Struct: csr_graph
+ * -----------------
+ * A CSR file mapped in memory
+ *
+ *        data: the beginning of the mapping (NULL if there is none)
+ *        size: the size of the mapping
+ *      header: the header of the file
+ * node_weight: the weights of the arcs entering each vertex
+ *         bar: the bar codes of the vertices
+ *     offsets: the first arc of each vertex in targets
+ *     targets: the targets of the arcs
+ */
+struct csr_graph
+{
+  void             *data;
+  size_t            size;
+  const csr_header *header;
+  const int32_t    *node_weight;
+  const uint64_t   *bar;
+  const int64_t    *offsets;
+  const int32_t    *targets;
+};
+
+typedef struct csr_graph csr_graph;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: csr_little_endian
+ * ---------------------------
+ * returns: 1 if the machine is little-endian (the programs only write and
+ *          map CSR files on such machines), otherwise, 0
+ */
+inline int csr_little_endian()
+{
+  uint32_t word = 1;
+  unsigned char first;
+
+  memcpy(&first, &word, 1);
+  return (first == 1) ? 1 : 0;
+}
+
+/*
+ * Function: csr_align
+ * -------------------
+ * returns: the smallest multiple of CSR_PAGE_SIZE not smaller than size
+ */
+inline uint64_t csr_align(uint64_t size)
+{
+  return (size + CSR_PAGE_SIZE -1) / CSR_PAGE_SIZE * CSR_PAGE_SIZE;
+}
+
+/*
+ * Function: csr_write_section
+ * ---------------------------
+ * Writes a section at the position given, after the zeros which fill the
+ * gap from the current position, and adds all of them to the checksum
+ *
+ *     file: the CSR file
+ *        h: the checksum of the bytes after the header
+ * position: the current position in the file, updated
+ *   offset: the position of the section
+ *     data: the section
+ *     size: the size of the section, in bytes
+ */
+inline void csr_write_section(std::ofstream &file, cache_hasher *h,
+			      uint64_t *position, uint64_t offset,
+			      const void *data, uint64_t size)
+{
+  std::vector<char> zeros(offset - *position, 0);
+
+  file.write(zeros.data(), zeros.size());
+  file.write((const char *) data, size);
+
+  if (*position >= CSR_PAGE_SIZE)
+    cache_hash_update(h, zeros.data(), zeros.size());
+  cache_hash_update(h, data, size);
+
+  *position = offset + size;
+}
+
+/*
+ * Function: csr_init_header
+ * -------------------------
+ * Fills the fields of the header of a CSR file, except the flags and the
+ * checksums, with the sections placed one after the other
+ */
+inline void csr_init_header(csr_header *header, int num_lines, int width,
+			    int overlap, const char *type, int64_t nodes,
+			    int64_t arcs)
+{
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, CSR_MAGIC, sizeof(CSR_MAGIC));
+  header->version = CSR_VERSION;
+  header->byte_order = CSR_BYTE_ORDER;
+  header->num_lines = num_lines;
+  header->width = width;
+  header->overlap = overlap;
+  strncpy(header->type, type, sizeof(header->type) -1);
+  header->nodes = nodes;
+  header->arcs = arcs;
+
+  header->weight_offset = CSR_PAGE_SIZE;
+  header->bar_offset = csr_align(header->weight_offset +
+				 nodes * sizeof(int32_t));
+  header->offsets_offset = csr_align(header->bar_offset +
+				     nodes * sizeof(uint64_t));
+  header->targets_offset = csr_align(header->offsets_offset +
+				     (nodes +1) * sizeof(int64_t));
+  header->file_size = header->targets_offset + arcs * sizeof(int32_t);
+}
+
+/*
+ * Function: csr_close_file
+ * ------------------------
+ * Writes the header, with the checksums, at the beginning of a CSR file
+ * whose sections were written, and gives the file its final name
+ *
+ *      file: the CSR file, written with the name temporary
+ *    header: the header, without the checksums
+ *         h: the checksum of the sections
+ * temporary: the name with which the file was written
+ *      path: the name of the CSR file
+ *
+ * returns: 1 if the file was saved, otherwise, 0
+ */
+inline int csr_close_file(std::ofstream &file, csr_header *header,
+			  cache_hasher *h, const std::string &temporary,
+			  const std::string &path)
+{
+  header->checksum = cache_hash_final(h);
+  header->header_checksum = cache_checksum(header,
+					   offsetof(csr_header,
+						    header_checksum));
+
+  file.seekp(0);
+  file.write((const char *) header, sizeof(*header));
+  file.close();
+
+  if (!file.good() || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+      remove(temporary.c_str());
+      return 0;
+    }
+
+  return 1;
+}
+
+/*
+ * Function: csr_arcs
+ * ------------------
+ * Groups the arcs of a configuration graph by source, keeping the order
+ * of their ids
+ *
+ *       G: the configuration graph
+ *       n: the number of vertices
+ * offsets: where the first arc of each vertex is stored
+ * targets: where the targets of the arcs are stored
+ *
+ * returns: CSR_ARC_IDS if the sources never increase along the ids of
+ *          the arcs (so csr_add_arcs rebuilds the ids), otherwise, 0
+ */
+inline uint32_t csr_arcs(const lemon::SmartDigraph &G, int64_t n,
+			 std::vector<int64_t> *offsets,
+			 std::vector<int32_t> *targets)
+{
+  std::vector<int64_t> next;    // where the next target of each vertex goes
+  uint32_t flags;
+  int64_t m, a;
+  int u;
+
+  m = lemon::countArcs(G);
+  flags = CSR_ARC_IDS;
+  offsets->assign(n +1, 0);
+  for (a = 0; a < m; a++)
+    {
+      u = G.id(G.source(G.arcFromId((int) a)));
+      (*offsets)[u +1]++;
+
+      if (a > 0 && u > G.id(G.source(G.arcFromId((int) a -1))))
+	flags = 0;
+    }
+
+  for (u = 0; u < n; u++)
+    (*offsets)[u +1] += (*offsets)[u];
+
+  next.assign(offsets->begin(), offsets->end() -1);
+  targets->resize(m);
+  for (a = 0; a < m; a++)
+    (*targets)[next[G.id(G.source(G.arcFromId((int) a)))]++] =
+      G.id(G.target(G.arcFromId((int) a)));
+
+  return flags;
+}
+
+/*
+ * Function: save_csr_graph
+ * ------------------------
+ * Saves the configuration graph in a CSR file; the file is written with
+ * another name and renamed at the end
+ *
+ *        path: the name of the CSR file
+ *   num_lines: the number of lines of the hexagonal grid
+ *       width: the number of columns of a bar code
+ *     overlap: the number of columns shared by two consecutive bars
+ *        type: the type of code
+ *         bar: the bar codes of the vertices, by id
+ * node_weight: the weights of the arcs entering each vertex, by id
+ *           G: the configuration graph
+ *
+ * returns: 1 if the file was saved, otherwise, 0
+ */
+inline int save_csr_graph(const std::string &path, int num_lines,
+			  int width, int overlap, const char *type,
+			  const std::vector<uint64_t> &bar,
+			  const std::vector<int32_t> &node_weight,
+			  const lemon::SmartDigraph &G)
+{
+  csr_header header;
+  cache_hasher h;
+  std::vector<int64_t> offsets;
+  std::vector<int32_t> targets;
+  std::string temporary;
+  std::ofstream file;
+  uint64_t position;
+  int64_t n, m;
+
+  if (csr_little_endian() == 0)
+    return 0;
+
+  n = (int64_t) bar.size();
+  m = lemon::countArcs(G);
+  csr_init_header(&header, num_lines, width, overlap, type, n, m);
+
+  // the arcs are grouped by source, keeping the order of their ids; the
+  // ids are rebuilt if the sources never increase along the ids
+  header.flags = csr_arcs(G, n, &offsets, &targets);
+
+  temporary = path + ".tmp";
+  file.open(temporary.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return 0;
+
+  // the header is written at the end, with the checksum of the sections
+  position = 0;
+  cache_hash_init(&h);
+  csr_write_section(file, &h, &position, header.weight_offset,
+		    node_weight.data(), n * sizeof(int32_t));
+  csr_write_section(file, &h, &position, header.bar_offset,
+		    bar.data(), n * sizeof(uint64_t));
+  csr_write_section(file, &h, &position, header.offsets_offset,
+		    offsets.data(), (n +1) * sizeof(int64_t));
+  csr_write_section(file, &h, &position, header.targets_offset,
+		    targets.data(), m * sizeof(int32_t));
+
+  return csr_close_file(file, &header, &h, temporary, path);
+}
+
+/*
+ * Function: close_csr_graph
+ * -------------------------
+ * Unmaps a CSR file
+ */
+inline void close_csr_graph(csr_graph *csr)
+{
+  if (csr->data != NULL)
+    munmap(csr->data, csr->size);
+
+  csr->data = NULL;
+  csr->size = 0;
+}
+
+/*
+ * Function: open_csr_graph
+ * ------------------------
+ * Maps a CSR file in memory and checks that it is a configuration graph
+ * of the parameters given and that it is not corrupted
+ *
+ *      path: the name of the CSR file
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *      type: the type of code
+ *       csr: where the mapping is stored
+ *
+ * returns: 1 if the file can be used, otherwise, 0 (after printing what
+ *          is wrong)
+ */
+inline int open_csr_graph(const char *path, int num_lines, int width,
+			  int overlap, const char *type, csr_graph *csr)
+{
+  const csr_header *header;
+  struct stat info;
+  int64_t u;
+  int fd;
+
+  csr->data = NULL;
+  csr->size = 0;
+
+  fd = open(path, O_RDONLY);
+  if (fd == -1)
+    {
+      std::cerr << "It was not possible to open " << path << "\n";
+      return 0;
+    }
+
+  if (fstat(fd, &info) != 0 || (size_t) info.st_size < CSR_PAGE_SIZE ||
+      csr_little_endian() == 0)
+    {
+      std::cerr << path << " is not a CSR file of this machine!\n";
+      close(fd);
+      return 0;
+    }
+
+  csr->size = (size_t) info.st_size;
+  csr->data = mmap(NULL, csr->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (csr->data == MAP_FAILED)
+    {
+      csr->data = NULL;
+      std::cerr << "It was not possible to map " << path << "\n";
+      return 0;
+    }
+
+  header = (const csr_header *) csr->data;
+
+  if (memcmp(header->magic, CSR_MAGIC, sizeof(CSR_MAGIC)) != 0 ||
+      header->version != CSR_VERSION ||
+      header->byte_order != CSR_BYTE_ORDER ||
+      header->header_checksum !=
+      cache_checksum(header, offsetof(csr_header, header_checksum)))
+    {
+      std::cerr << path << " is not a CSR file!\n";
+      close_csr_graph(csr);
+      return 0;
+    }
+
+  if (header->num_lines != num_lines || header->width != width ||
+      header->overlap != overlap ||
+      strncmp(header->type, type, sizeof(header->type)) != 0)
+    {
+      std::cerr << "The CSR file is not of this configuration graph!\n";
+      close_csr_graph(csr);
+      return 0;
+    }
+
+  if (header->nodes < 0 || header->arcs < 0 ||
+      header->file_size != csr->size ||
+      header->weight_offset != CSR_PAGE_SIZE ||
+      header->bar_offset !=
+      csr_align(header->weight_offset + header->nodes * sizeof(int32_t)) ||
+      header->offsets_offset !=
+      csr_align(header->bar_offset + header->nodes * sizeof(uint64_t)) ||
+      header->targets_offset !=
+      csr_align(header->offsets_offset +
+		(header->nodes +1) * sizeof(int64_t)) ||
+      header->file_size !=
+      header->targets_offset + header->arcs * sizeof(int32_t) ||
+      cache_checksum((const char *) csr->data + CSR_PAGE_SIZE,
+		     csr->size - CSR_PAGE_SIZE) != header->checksum)
+    {
+      std::cerr << "The CSR file " << path << " is corrupted!\n";
+      close_csr_graph(csr);
+      return 0;
+    }
+
+  csr->header = header;
+  csr->node_weight = (const int32_t *) ((const char *) csr->data +
+					header->weight_offset);
+  csr->bar = (const uint64_t *) ((const char *) csr->data +
+				 header->bar_offset);
+  csr->offsets = (const int64_t *) ((const char *) csr->data +
+				    header->offsets_offset);
+  csr->targets = (const int32_t *) ((const char *) csr->data +
+				    header->targets_offset);
+
+  // the offsets and the targets must describe a graph
+  if (csr->offsets[0] != 0 || csr->offsets[header->nodes] != header->arcs)
+    {
+      std::cerr << "The CSR file " << path << " is corrupted!\n";
+      close_csr_graph(csr);
+      return 0;
+    }
+
+  for (u = 0; u < header->nodes; u++)
+    if (csr->offsets[u] > csr->offsets[u +1])
+      {
+	std::cerr << "The CSR file " << path << " is corrupted!\n";
+	close_csr_graph(csr);
+	return 0;
+      }
+
+  for (u = 0; u < header->arcs; u++)
+    if (csr->targets[u] < 0 || csr->targets[u] >= header->nodes)
+      {
+	std::cerr << "The CSR file " << path << " is corrupted!\n";
+	close_csr_graph(csr);
+	return 0;
+      }
+
+  return 1;
+}
+
+/*
+ * Function: csr_add_arcs
+ * ----------------------
+ * Adds the arcs of a CSR file to the configuration graph, from the last
+ * vertex to the first one (with the flag CSR_ARC_IDS, the arcs get the
+ * ids of the graph which was saved)
+ *
+ *    csr: the CSR file mapped in memory
+ *      G: the configuration graph, with all its vertices and no arcs
+ * weight: where the weights of the arcs are stored
+ */
+inline void csr_add_arcs(const csr_graph &csr, lemon::SmartDigraph *G,
+			 lemon::SmartDigraph::ArcMap<int> *weight)
+{
+  lemon::SmartDigraph::Arc arc;
+  int64_t u, a;
+
+  G->reserveArc((int) csr.header->arcs);
+
+  for (u = csr.header->nodes -1; u >= 0; u--)
+    for (a = csr.offsets[u]; a < csr.offsets[u +1]; a++)
+      {
+	arc = G->addArc(G->nodeFromId((int) u),
+			G->nodeFromId(csr.targets[a]));
+	(*weight)[arc] = csr.node_weight[csr.targets[a]];
+      }
+}
+
+#endif
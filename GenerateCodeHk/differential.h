@@ -0,0 +1,208 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Differential check (--differential) of the fast kernels of the
+   programs against the reference ones, which check the bars over LEMON
+   graphs of the hexagonal grid (generate_all_barcodes, create_graph_cfg,
+   check_unon_bars and check_bar_code are kept for that):
+
+     - the list of bar codes of the reference enumeration must be the
+       same, in the same order, as the lists of the specialized checkers
+       and of the row extension, and its size must be the one counted by
+       the transfer matrices of transfer_count.h;
+     - the union of random pairs of bar codes (drawn with the seed of
+       --differential=SEED) must be accepted by the specialized checker
+       exactly when it is accepted by the reference one;
+     - the graph built by the fast path must have the number of arcs
+       counted by the transfer matrices, and the arcs of some of its
+       sources (all of them in small graphs) must be the ones found by
+       the reference check;
+     - the density of the minimum mean cycle of that graph must be the
+       density of the code saved in Codes/CodigoH<k>GrafoConfig.txt,
+       when there is one.
+
+   Any optimization of these kernels can be gated by running both
+   programs with --differential for k = 2, ..., 6; the program returns
+   EXIT_FAILURE when a check fails. This file has the parts shared by
+   the programs; the checks themselves are in run_differential of each
+   one.
+*/
+
+#ifndef DIFFERENTIAL_H
+#define DIFFERENTIAL_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "transfer_count.h"
+#include "benchmark.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// seed of the random pairs (drawn by bench_random), when --differential
+// has none
+#define DIFFERENTIAL_DEFAULT_SEED BENCHMARK_SEED
+
+// number of random pairs of bar codes tested
+#define DIFFERENTIAL_PAIRS 100000
+
+// the arcs of every source are checked when the graph has at most this
+// number of pairs of bar codes; otherwise only DIFFERENTIAL_SOURCES
+// random sources are checked
+#define DIFFERENTIAL_FULL_PAIRS (1LL << 22)
+#define DIFFERENTIAL_SOURCES 64
+
+// the graphs with more arcs are not built (nor their density checked)
+#define DIFFERENTIAL_MAX_ARCS (1LL << 25)
+
+// directory of the codes found by the programs
+#define DIFFERENTIAL_CODES_DIR "../Codes"
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: diff_report
+ * -------------------
+ * The result of the checks done so far
+ *
+ *   checks: the number of checks
+ * failures: the number of checks which failed
+ */
+struct diff_report
+{
+  int checks;
+  int failures;
+};
+
+typedef struct diff_report diff_report;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: diff_check
+ * --------------------
+ * Records and outputs the result of a check
+ *
+ * report: the result of the checks
+ *   what: what was checked
+ *     ok: 1 if the check passed, otherwise, 0
+ * detail: what was found (may be empty)
+ */
+inline void diff_check(diff_report *report, const std::string &what, int ok,
+		       const std::string &detail)
+{
+  report->checks++;
+  if (ok == 0)
+    report->failures++;
+
+  std::cout << "  " << what << ": " << ((ok == 1) ? "ok" : "MISMATCH");
+  if (!detail.empty())
+    std::cout << " (" << detail << ")";
+  std::cout << "\n";
+}
+
+/*
+ * Function: diff_barcodes
+ * -----------------------
+ * Checks that two lists of bar codes are equal, in the same order (the
+ * ids of the vertices of the configuration graph follow it)
+ *
+ *    report: the result of the checks
+ *      what: what is checked
+ * reference: the bar codes of the reference enumeration, as masks
+ *      fast: the bar codes of the enumeration checked
+ */
+inline void diff_barcodes(diff_report *report, const std::string &what,
+			  const std::vector<uint64_t> &reference,
+			  const std::vector<uint64_t> &fast)
+{
+  std::ostringstream detail;
+  size_t i;
+
+  for (i = 0; i < reference.size() && i < fast.size(); i++)
+    if (reference[i] != fast[i])
+      break;
+
+  detail << fast.size() << " of " << reference.size() << " bar codes";
+  if (i < reference.size() || i < fast.size())
+    detail << ", the first difference is at position " << i;
+
+  diff_check(report, what, (reference == fast) ? 1 : 0, detail.str());
+}
+
+/*
+ * Function: diff_counts
+ * ---------------------
+ * Counts the bar codes and the arcs of the configuration graph with the
+ * transfer matrices, independently of the enumerations
+ *
+ *       width: the number of columns of a bar code
+ * union_width: the number of columns of the union of the bar codes of
+ *              an arc
+ *   num_lines: the number of lines of the hexagonal grid
+ *        bars: where the number of bar codes is stored
+ *        arcs: where the number of arcs is stored
+ *
+ * returns: 1 if both numbers were counted exactly, otherwise, 0
+ */
+inline int diff_counts(int width, int union_width, int num_lines,
+		       long long *bars, long long *arcs)
+{
+  std::vector<unsigned __int128> total_bars, total_arcs;
+  std::vector<int> exact_bars, exact_arcs;
+
+  if (count_valid_bars(width, num_lines, &total_bars, &exact_bars) == 0 ||
+      count_valid_bars(union_width, num_lines, &total_arcs,
+		       &exact_arcs) == 0 ||
+      exact_bars[num_lines] == 0 || exact_arcs[num_lines] == 0 ||
+      total_arcs[num_lines] > (unsigned __int128) INT64_MAX)
+    return 0;
+
+  *bars = (long long) total_bars[num_lines];
+  *arcs = (long long) total_arcs[num_lines];
+  return 1;
+}
+
+/*
+ * Function: saved_code_density
+ * ----------------------------
+ * Reads the density of a code saved by the programs: the first line has
+ * the number of lines and of columns of the pattern, and the next one
+ * the vertices of the code, as (column, line)
+ *
+ *      path: the file of the code
+ * num_lines: the number of lines of the hexagonal grid
+ *  vertices: where the number of vertices of the code is stored
+ *   columns: where the number of columns of the pattern is stored
+ *
+ * returns: 1 if the file has a code of H_k, otherwise, 0
+ */
+inline int saved_code_density(const std::string &path, int num_lines,
+			      long long *vertices, long long *columns)
+{
+  std::ifstream file;
+  std::string token;
+  int lines;
+
+  file.open(path);
+  if (!file.is_open() || !(file >> lines >> *columns >> token) ||
+      lines != num_lines || *columns <= 0)
+    return 0;
+
+  *vertices = 0;
+  while (file >> token)
+    if (token[0] == '(')
+      (*vertices)++;
+
+  return 1;
+}
+
+#endif
@@ -0,0 +1,829 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Out-of-core configuration graph (--external), for the values of k
+   whose arcs do not fit in memory. Only the arrays with one entry per
+   vertex are kept in memory; the arcs use at most a RAM budget (--ram,
+   in megabytes).
+
+   Edge phase: the arcs created by the programs are kept in a buffer of
+   half the budget; a full buffer is sorted in the order of a CSR file
+   (sources in increasing order, the targets of a source in the order
+   they were created) and written to disk as a run. At the end the runs
+   are merged, sequentially, into a CSR file (csr_graph.h), which can
+   also be loaded with --import-csr or read by ConfigGraphCSR.py.
+
+   MMC step: Lawler's parametric search, as in lawler_mmc.h, in which
+   each round of Bellman-Ford is one sequential pass over the targets of
+   the CSR file, read in windows of half the budget. The distances are
+   updated in place, and the arcs of the vertices whose distance did not
+   change since their last pass are skipped (that part of the file is
+   not read). The weight of an arc is the weight of its target, so the
+   graph of predecessors only keeps the source of each arc.
+*/
+
+#ifndef EXTERNAL_GRAPH_H
+#define EXTERNAL_GRAPH_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <lemon/smart_graph.h>
+#include <lemon/path.h>
+#include "mmc_engine.h"
+#include "lawler_mmc.h"
+#include "csr_graph.h"
+#include "graph_cache.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// directory used by --external without a directory
+#define EXTERNAL_DEFAULT_DIR "../External"
+
+// RAM budget for the arcs, in megabytes, when --ram is not given
+#define EXTERNAL_DEFAULT_RAM_MB 1024
+
+// the smallest budget, in bytes, used by the buffers
+#define EXTERNAL_MIN_BUDGET (1 << 16)
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: external_arc
+ * --------------------
+ * An arc of the configuration graph, in a run
+ *
+ * source: the id of the source
+ * target: the id of the target
+ *  order: the number of arcs created before it
+ */
+struct external_arc
+{
+  int32_t source;
+  int32_t target;
+  int64_t order;
+};
+
+typedef struct external_arc external_arc;
+
+/*
+ * Struct: external_graph
+ * ----------------------
+ * The configuration graph whose arcs are being written to disk
+ *
+ *        path: the name of the CSR file
+ *      budget: the RAM budget for the arcs, in bytes
+ *   num_lines: the number of lines of the hexagonal grid
+ *       width: the number of columns of a bar code
+ *     overlap: the number of columns shared by two consecutive bars
+ *         bar: the bar codes of the vertices, by id
+ * node_weight: the weights of the arcs entering each vertex, by id
+ *      degree: the number of arcs leaving each vertex
+ *      buffer: the arcs not yet written to a run
+ *        runs: the names of the runs written
+ *        arcs: the number of arcs
+ *    in_order: 1 while the sources of the arcs never increase (the ids
+ *              of the arcs can then be rebuilt), otherwise, 0
+ *        last: the source of the last arc
+ */
+struct external_graph
+{
+  std::string               path;
+  size_t                    budget;
+  int                       num_lines;
+  int                       width;
+  int                       overlap;
+  std::vector<uint64_t>     bar;
+  std::vector<int32_t>      node_weight;
+  std::vector<int64_t>      degree;
+  std::vector<external_arc> buffer;
+  std::vector<std::string>  runs;
+  int64_t                   arcs;
+  int                       in_order;
+  int                       last;
+};
+
+typedef struct external_graph external_graph;
+
+/*
+ * Struct: external_csr
+ * --------------------
+ * A CSR file read by the out-of-core MMC: the arrays with one entry per
+ * vertex are in memory, and the targets are read in windows
+ *
+ *          fd: the CSR file
+ *      header: its header
+ * node_weight: the weights of the arcs entering each vertex
+ *     offsets: the first arc of each vertex
+ *      window: the targets read
+ *       first: the index of the first target of the window
+ *    capacity: the largest number of targets read at once
+ */
+struct external_csr
+{
+  int                  fd;
+  csr_header           header;
+  std::vector<int32_t> node_weight;
+  std::vector<int64_t> offsets;
+  std::vector<int32_t> window;
+  int64_t              first;
+  size_t               capacity;
+};
+
+typedef struct external_csr external_csr;
+
+/*
+ * Struct: external_workspace
+ * --------------------------
+ * The arrays (one entry per vertex) used by the probes
+ *
+ *    dist: the distances computed so far
+ *  parent: the source of the arc which gave the current distance (-1 if
+ *          none)
+ * changed: 1 if the distance changed since the last pass over the arcs
+ *          leaving the vertex
+ *   stamp: used to find a cycle in the graph of predecessors
+ */
+struct external_workspace
+{
+  std::vector<lawler_value> dist;
+  std::vector<int>          parent;
+  std::vector<char>         changed;
+  std::vector<int>          stamp;
+};
+
+typedef struct external_workspace external_workspace;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: external_run_order
+ * ----------------------------
+ * returns: true if the arc a comes before the arc b in a run (and in the
+ *          CSR file)
+ */
+inline bool external_run_order(const external_arc &a, const external_arc &b)
+{
+  if (a.source != b.source)
+    return a.source < b.source;
+
+  return a.order < b.order;
+}
+
+/*
+ * Function: external_file_name
+ * ----------------------------
+ * Creates, if needed, the directory of the out-of-core graphs
+ *
+ *      root: the directory
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *      type: the type of code
+ *
+ * returns: the name of the CSR file of the configuration graph
+ */
+inline std::string external_file_name(const char *root, int num_lines,
+				      int width, int overlap,
+				      const char *type)
+{
+  // the directory may already exist
+  mkdir(root, 0755);
+
+  return graph_file_name(root, num_lines, width, overlap, type, ".csr");
+}
+
+/*
+ * Function: external_init
+ * -----------------------
+ * Starts an out-of-core configuration graph, with its vertices
+ *
+ *          eg: the graph
+ *        path: the name of the CSR file
+ *      ram_mb: the RAM budget for the arcs, in megabytes
+ *   num_lines: the number of lines of the hexagonal grid
+ *       width: the number of columns of a bar code
+ *     overlap: the number of columns shared by two consecutive bars
+ *         bar: the bar codes of the vertices, by id
+ * node_weight: the weights of the arcs entering each vertex, by id
+ */
+inline void external_init(external_graph *eg, const std::string &path,
+			  long long ram_mb, int num_lines, int width,
+			  int overlap, const std::vector<uint64_t> &bar,
+			  const std::vector<int32_t> &node_weight)
+{
+  eg->path = path;
+  eg->budget = (size_t) ram_mb << 20;
+  if (eg->budget < EXTERNAL_MIN_BUDGET)
+    eg->budget = EXTERNAL_MIN_BUDGET;
+
+  eg->num_lines = num_lines;
+  eg->width = width;
+  eg->overlap = overlap;
+  eg->bar = bar;
+  eg->node_weight = node_weight;
+  eg->degree.assign(bar.size(), 0);
+  eg->runs.clear();
+
+  // the buffer never grows past half of the budget, so it is allocated
+  // once (growing it by doubling would use the whole budget)
+  std::vector<external_arc>().swap(eg->buffer);
+  eg->buffer.reserve(eg->budget / 2 / sizeof(external_arc) +1);
+  eg->arcs = 0;
+  eg->in_order = 1;
+  eg->last = 0;
+}
+
+/*
+ * Function: external_flush
+ * ------------------------
+ * Sorts the arcs of the buffer and writes them as a new run
+ *
+ * returns: 1 if the run was written, otherwise, 0
+ */
+inline int external_flush(external_graph *eg)
+{
+  std::ofstream file;
+  std::string name;
+
+  if (eg->buffer.empty())
+    return 1;
+
+  std::sort(eg->buffer.begin(), eg->buffer.end(), external_run_order);
+
+  name = eg->path + ".run" + std::to_string(eg->runs.size());
+  file.open(name.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return 0;
+
+  file.write((const char *) eg->buffer.data(),
+	     eg->buffer.size() * sizeof(external_arc));
+  file.close();
+
+  eg->runs.push_back(name);
+  eg->buffer.clear();
+  return file.good() ? 1 : 0;
+}
+
+/*
+ * Function: external_add_arc
+ * --------------------------
+ * Adds an arc to the out-of-core graph (the buffer is written as a run
+ * when it reaches half of the budget)
+ *
+ * returns: 1 if the arc was added, otherwise, 0
+ */
+inline int external_add_arc(external_graph *eg, int source, int target)
+{
+  external_arc a;
+
+  a.source = source;
+  a.target = target;
+  a.order = eg->arcs;
+
+  if (eg->arcs > 0 && source > eg->last)
+    eg->in_order = 0;
+
+  eg->last = source;
+  eg->buffer.push_back(a);
+  eg->degree[source]++;
+  eg->arcs++;
+
+  if (eg->buffer.size() * sizeof(external_arc) >= eg->budget / 2)
+    return external_flush(eg);
+
+  return 1;
+}
+
+/*
+ * Function: external_read_run
+ * ---------------------------
+ * Reads the next arcs of a run
+ *
+ *  input: the run
+ *  chunk: where the arcs are stored (its size is the number of arcs
+ *         read, 0 at the end of the run)
+ *    amt: the largest number of arcs read
+ */
+inline void external_read_run(std::ifstream &input,
+			      std::vector<external_arc> &chunk, size_t amt)
+{
+  chunk.resize(amt);
+  input.read((char *) chunk.data(), amt * sizeof(external_arc));
+  chunk.resize((size_t) input.gcount() / sizeof(external_arc));
+}
+
+/*
+ * Function: external_finish
+ * -------------------------
+ * Merges the runs into the CSR file of the graph and removes them
+ *
+ * returns: 1 if the CSR file was saved, otherwise, 0
+ */
+inline int external_finish(external_graph *eg)
+{
+  typedef std::pair<external_arc, size_t> entry;
+  struct later
+  {
+    bool operator()(const entry &a, const entry &b) const
+    {
+      return external_run_order(b.first, a.first);
+    }
+  };
+  std::vector<std::ifstream> input;
+  std::vector<std::vector<external_arc> > chunk;
+  std::vector<size_t> position;
+  std::priority_queue<entry, std::vector<entry>, later> heap;
+  std::vector<int64_t> offsets;
+  std::vector<int32_t> targets;
+  csr_header header;
+  cache_hasher h;
+  std::ofstream file;
+  std::string temporary;
+  uint64_t file_position;
+  size_t chunk_size, r;
+  int64_t n, u;
+
+  if (csr_little_endian() == 0 || external_flush(eg) == 0)
+    return 0;
+
+  // the buffer is not needed any more, and the budget goes to the merge
+  std::vector<external_arc>().swap(eg->buffer);
+  targets.reserve(eg->budget / 4 / sizeof(int32_t) +1);
+
+  n = (int64_t) eg->bar.size();
+  csr_init_header(&header, eg->num_lines, eg->width, eg->overlap,
+		  CACHE_TYPE_IDCODE, n, eg->arcs);
+  header.flags = (eg->in_order == 1) ? CSR_ARC_IDS : 0;
+
+  offsets.assign(n +1, 0);
+  for (u = 0; u < n; u++)
+    offsets[u +1] = offsets[u] + eg->degree[u];
+
+  temporary = eg->path + ".tmp";
+  file.open(temporary.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return 0;
+
+  file_position = 0;
+  cache_hash_init(&h);
+  csr_write_section(file, &h, &file_position, header.weight_offset,
+		    eg->node_weight.data(), n * sizeof(int32_t));
+  csr_write_section(file, &h, &file_position, header.bar_offset,
+		    eg->bar.data(), n * sizeof(uint64_t));
+  csr_write_section(file, &h, &file_position, header.offsets_offset,
+		    offsets.data(), (n +1) * sizeof(int64_t));
+  csr_write_section(file, &h, &file_position, header.targets_offset,
+		    NULL, 0);
+
+  // half of the budget is shared by the runs, the other half keeps the
+  // targets merged until they are written
+  chunk_size = eg->budget / 4 / sizeof(external_arc) /
+    std::max((size_t) 1, eg->runs.size()) +1;
+
+  input.resize(eg->runs.size());
+  chunk.resize(eg->runs.size());
+  position.assign(eg->runs.size(), 0);
+  for (r = 0; r < eg->runs.size(); r++)
+    {
+      input[r].open(eg->runs[r].c_str(), std::ios::binary);
+      external_read_run(input[r], chunk[r], chunk_size);
+      if (!chunk[r].empty())
+	heap.push(entry(chunk[r][0], r));
+    }
+
+  while (!heap.empty())
+    {
+      entry e = heap.top();
+      heap.pop();
+      r = e.second;
+
+      targets.push_back(e.first.target);
+
+      if (++position[r] == chunk[r].size())
+	{
+	  external_read_run(input[r], chunk[r], chunk_size);
+	  position[r] = 0;
+	}
+
+      if (position[r] < chunk[r].size())
+	heap.push(entry(chunk[r][position[r]], r));
+
+      if (targets.size() * sizeof(int32_t) >= eg->budget / 4 ||
+	  heap.empty())
+	{
+	  csr_write_section(file, &h, &file_position, file_position,
+			    targets.data(), targets.size() * sizeof(int32_t));
+	  targets.clear();
+	}
+    }
+
+  for (r = 0; r < eg->runs.size(); r++)
+    {
+      input[r].close();
+      remove(eg->runs[r].c_str());
+    }
+  eg->runs.clear();
+
+  if (file_position != header.file_size)
+    {
+      file.close();
+      remove(temporary.c_str());
+      return 0;
+    }
+
+  return csr_close_file(file, &header, &h, temporary, eg->path);
+}
+
+/*
+ * Function: external_close
+ * ------------------------
+ * Closes a CSR file read by the out-of-core MMC
+ */
+inline void external_close(external_csr *csr)
+{
+  if (csr->fd != -1)
+    close(csr->fd);
+
+  csr->fd = -1;
+  std::vector<int32_t>().swap(csr->window);
+}
+
+/*
+ * Function: external_open
+ * -----------------------
+ * Opens a CSR file for the out-of-core MMC: checks the header and the
+ * checksum (with one pass over the file) and reads the arrays with one
+ * entry per vertex
+ *
+ *      path: the name of the CSR file
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *    budget: the RAM budget for the arcs, in bytes
+ *       csr: where the file is stored
+ *
+ * returns: 1 if the file can be used, otherwise, 0 (after printing what
+ *          is wrong)
+ */
+inline int external_open(const std::string &path, int num_lines, int width,
+			 int overlap, size_t budget, external_csr *csr)
+{
+  csr_header expected;
+  cache_hasher h;
+  struct stat info;
+  std::vector<char> block;
+  uint64_t done, amt;
+  int ok;
+
+  csr->fd = open(path.c_str(), O_RDONLY);
+  if (csr->fd == -1)
+    {
+      std::cerr << "It was not possible to open " << path << "\n";
+      return 0;
+    }
+
+  ok = (csr_little_endian() == 1 && fstat(csr->fd, &info) == 0 &&
+	pread(csr->fd, &csr->header, sizeof(csr_header), 0) ==
+	(ssize_t) sizeof(csr_header)) ? 1 : 0;
+
+  if (ok == 1)
+    {
+      csr_init_header(&expected, num_lines, width, overlap,
+		      CACHE_TYPE_IDCODE, csr->header.nodes, csr->header.arcs);
+      ok = (memcmp(csr->header.magic, expected.magic, 8) == 0 &&
+	    csr->header.version == expected.version &&
+	    csr->header.byte_order == expected.byte_order &&
+	    csr->header.header_checksum ==
+	    cache_checksum(&csr->header,
+			   offsetof(csr_header, header_checksum)) &&
+	    csr->header.num_lines == num_lines &&
+	    csr->header.width == width && csr->header.overlap == overlap &&
+	    csr->header.nodes >= 0 && csr->header.arcs >= 0 &&
+	    csr->header.targets_offset == expected.targets_offset &&
+	    csr->header.file_size == expected.file_size &&
+	    (uint64_t) info.st_size == expected.file_size) ? 1 : 0;
+    }
+
+  // the checksum of the sections, read in blocks of the budget
+  cache_hash_init(&h);
+  block.resize(std::max(budget / 2, (size_t) CSR_PAGE_SIZE));
+  for (done = CSR_PAGE_SIZE; ok == 1 && done < csr->header.file_size;
+       done += amt)
+    {
+      amt = std::min((uint64_t) block.size(), csr->header.file_size - done);
+      if (pread(csr->fd, block.data(), amt, done) != (ssize_t) amt)
+	ok = 0;
+      else
+	cache_hash_update(&h, block.data(), amt);
+    }
+  std::vector<char>().swap(block);
+
+  if (ok == 0 || cache_hash_final(&h) != csr->header.checksum)
+    {
+      std::cerr << "The CSR file " << path << " is not valid!\n";
+      external_close(csr);
+      return 0;
+    }
+
+  csr->node_weight.resize(csr->header.nodes);
+  csr->offsets.resize(csr->header.nodes +1);
+  if (pread(csr->fd, csr->node_weight.data(),
+	    csr->header.nodes * sizeof(int32_t), csr->header.weight_offset) !=
+      (ssize_t) (csr->header.nodes * sizeof(int32_t)) ||
+      pread(csr->fd, csr->offsets.data(),
+	    (csr->header.nodes +1) * sizeof(int64_t),
+	    csr->header.offsets_offset) !=
+      (ssize_t) ((csr->header.nodes +1) * sizeof(int64_t)))
+    {
+      std::cerr << "It was not possible to read " << path << "\n";
+      external_close(csr);
+      return 0;
+    }
+
+  csr->capacity = std::max(budget / 2 / sizeof(int32_t), (size_t) 1);
+  csr->window.clear();
+  csr->first = 0;
+  return 1;
+}
+
+/*
+ * Function: external_targets
+ * --------------------------
+ * Reads, if needed, the targets begin, ..., end -1 of the CSR file; a new
+ * window starts at begin, so a pass from the first vertex to the last
+ * one reads the file sequentially
+ *
+ * returns: the targets, or NULL if they could not be read
+ */
+inline const int32_t *external_targets(external_csr *csr, int64_t begin,
+				       int64_t end)
+{
+  size_t amt;
+
+  if (begin < csr->first ||
+      end > csr->first + (int64_t) csr->window.size())
+    {
+      amt = std::max((size_t) (end - begin), csr->capacity);
+      amt = std::min(amt, (size_t) (csr->header.arcs - begin));
+
+      csr->window.resize(amt);
+      csr->first = begin;
+      if (pread(csr->fd, csr->window.data(), amt * sizeof(int32_t),
+		csr->header.targets_offset + begin * sizeof(int32_t)) !=
+	  (ssize_t) (amt * sizeof(int32_t)))
+	{
+	  csr->window.clear();
+	  return NULL;
+	}
+    }
+
+  return csr->window.data() + (begin - csr->first);
+}
+
+/*
+ * Function: external_find_parent_cycle
+ * ------------------------------------
+ * Looks for a cycle in the graph of predecessors which is negative with
+ * the weights scale * w - shift
+ *
+ * returns: 1 if such a cycle was found (its vertices are stored in cycle,
+ *          in the order of the arcs), otherwise, 0
+ */
+inline int external_find_parent_cycle(const external_csr &csr,
+				      lawler_value scale, lawler_value shift,
+				      external_workspace *ws,
+				      std::vector<int> &cycle)
+{
+  lawler_value sum;
+  int n, s, u;
+
+  n = (int) ws->parent.size();
+  ws->stamp.assign(n, -1);
+
+  for (s = 0; s < n; s++)
+    {
+      if (ws->stamp[s] != -1)
+	continue;
+
+      u = s;
+      while (u != -1 && ws->stamp[u] == -1)
+	{
+	  ws->stamp[u] = s;
+	  u = ws->parent[u];
+	}
+
+      if (u == -1 || ws->stamp[u] != s)
+	continue;
+
+      // u is on a cycle; the vertices are collected backwards, and each
+      // one is the target of one arc of the cycle
+      cycle.clear();
+      sum = 0;
+      do
+	{
+	  cycle.push_back(u);
+	  sum += scale * csr.node_weight[u] - shift;
+	  u = ws->parent[u];
+	}
+      while (u != cycle[0]);
+
+      if (sum < 0)
+	{
+	  std::reverse(cycle.begin(), cycle.end());
+	  return 1;
+	}
+    }
+
+  return 0;
+}
+
+/*
+ * Function: external_probe
+ * ------------------------
+ * Checks if the graph of the CSR file has a negative cycle with the
+ * weights scale * w - shift, with one pass over the file per round of
+ * Bellman-Ford
+ *
+ *   csr: the CSR file
+ *    ws: the arrays used by the search
+ * cycle: where the vertices of the negative cycle are stored
+ *
+ * returns: 1 if there is a negative cycle, 0 if there is none, and -1
+ *          if the file could not be read
+ */
+inline int external_probe(external_csr *csr, lawler_value scale,
+			  lawler_value shift, external_workspace *ws,
+			  std::vector<int> &cycle)
+{
+  const int32_t *targets;
+  lawler_value d;
+  int64_t amt_changed, a, degree;
+  int n, u, v, round;
+
+  n = (int) csr->header.nodes;
+
+  // every vertex starts at distance 0 (a virtual source linked to all
+  // the vertices)
+  ws->dist.assign(n, 0);
+  ws->parent.assign(n, -1);
+  ws->changed.assign(n, 1);
+
+  for (round = 1; ; round++)
+    {
+      amt_changed = 0;
+
+      for (u = 0; u < n; u++)
+	{
+	  if (ws->changed[u] == 0)
+	    continue;
+
+	  ws->changed[u] = 0;
+	  degree = csr->offsets[u +1] - csr->offsets[u];
+	  if (degree == 0)
+	    continue;
+
+	  targets = external_targets(csr, csr->offsets[u],
+				     csr->offsets[u +1]);
+	  if (targets == NULL)
+	    return -1;
+
+	  for (a = 0; a < degree; a++)
+	    {
+	      v = targets[a];
+	      d = ws->dist[u] + scale * csr->node_weight[v] - shift;
+
+	      if (d < ws->dist[v])
+		{
+		  ws->dist[v] = d;
+		  ws->parent[v] = u;
+		  ws->changed[v] = 1;
+		  amt_changed++;
+		}
+	    }
+	}
+
+      if (amt_changed == 0)
+	return 0;
+
+      if ((round % LAWLER_CYCLE_CHECK_ROUNDS == 0 || round >= n) &&
+	  external_find_parent_cycle(*csr, scale, shift, ws, cycle) == 1)
+	return 1;
+    }
+}
+
+/*
+ * Function: external_mmc
+ * ----------------------
+ * Finds a minimum mean cycle of the graph of a CSR file with Lawler's
+ * parametric search (the same search as lawler_mmc), reading the arcs
+ * from the disk. The arcs of the cycle are added to G, which has the
+ * vertices of the graph and no arcs, so the cycle can be printed as in
+ * the other engines
+ *
+ *      csr: the CSR file
+ *        G: the configuration graph, with its vertices
+ *   weight: where the weights of the arcs added to G are stored
+ *   result: where the minimum mean cycle is stored
+ *
+ * returns: 1 if the search finished, otherwise, 0 (the file could not be
+ *          read)
+ */
+inline int external_mmc(external_csr *csr, lemon::SmartDigraph *G,
+			lemon::SmartDigraph::ArcMap<int> *weight,
+			mmc_result *result)
+{
+  external_workspace ws;
+  std::vector<int> found, best;
+  lemon::SmartDigraph::Arc arc;
+  lawler_value D, lo, hi, mid;
+  long long best_cost;
+  int n, w_min, w_max, i, status;
+
+  result->found = 0;
+  result->cost = 0;
+  result->size = 0;
+  result->iterations = 0;
+  result->cycle.clear();
+
+  n = (int) csr->header.nodes;
+  if (n == 0 || csr->header.arcs == 0)
+    return 1;
+
+  // every arc enters some vertex, so the weights of the vertices bound
+  // the weights of the arcs
+  w_min = w_max = csr->node_weight[0];
+  for (i = 0; i < n; i++)
+    {
+      w_min = std::min(w_min, (int) csr->node_weight[i]);
+      w_max = std::max(w_max, (int) csr->node_weight[i]);
+    }
+
+  result->iterations = 1;
+  status = external_probe(csr, 1, (lawler_value) w_max +1, &ws, best);
+  if (status != 1)
+    return (status == 0) ? 1 : 0;
+
+  best_cost = 0;
+  for (i = 0; i < (int) best.size(); i++)
+    best_cost += csr->node_weight[best[i]];
+
+  // invariant: no cycle has mean smaller than lo / D and the best cycle
+  // found has mean in [hi / D, (hi +1) / D)
+  D = (lawler_value) 4 * n * n;
+  lo = D * w_min;
+  hi = lawler_floor_div(D * best_cost, (lawler_value) best.size());
+
+  while (hi - lo > 1)
+    {
+      mid = lo + (hi - lo) / 2;
+      result->iterations++;
+
+      status = external_probe(csr, D, mid, &ws, found);
+      if (status == -1)
+	return 0;
+
+      if (status == 1)
+	{
+	  best.swap(found);
+	  best_cost = 0;
+	  for (i = 0; i < (int) best.size(); i++)
+	    best_cost += csr->node_weight[best[i]];
+
+	  hi = lawler_floor_div(D * best_cost, (lawler_value) best.size());
+	}
+      else
+	lo = mid;
+    }
+
+  // the vertex best[i] is the target of the arc leaving best[i -1]
+  for (i = 0; i < (int) best.size(); i++)
+    {
+      arc = G->addArc(G->nodeFromId(best[(i + best.size() -1) % best.size()]),
+		      G->nodeFromId(best[i]));
+      (*weight)[arc] = csr->node_weight[best[i]];
+      result->cycle.addBack(arc);
+    }
+
+  result->found = 1;
+  result->cost = best_cost;
+  result->size = (int) best.size();
+  return 1;
+}
+
+#endif
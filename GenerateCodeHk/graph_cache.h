@@ -0,0 +1,494 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Persistent cache of the bar codes and of the configuration graph
+   (--cache). A run which builds the graph saves it in a cache directory,
+   and the next runs with the same number of lines, width of the bars,
+   overlap and type of code map the file in memory and only rebuild the
+   LEMON graph, instead of generating and checking all the bars and all
+   the pairs of bar codes again.
+
+   The files are kept in a subdirectory per version of the format,
+   <cache>/v<CACHE_VERSION>/H<k>_w<width>_o<overlap>_<type>.bin, with
+
+       cache_header
+       uint64_t bar[nodes]          bar code of each vertex, by id (bit
+                                    r * width + c is the vertex (r, c))
+       int32_t  node_weight[nodes]  weight of the arcs entering the vertex
+       int32_t  arc[arcs][2]        source and target of each arc, by id
+
+   in the byte order of the machine which wrote it. The header has a
+   checksum of the rest of the file and a checksum of its own fields, so
+   a truncated or corrupted file is recomputed instead of being used.
+*/
+
+#ifndef GRAPH_CACHE_H
+#define GRAPH_CACHE_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <lemon/smart_graph.h>
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// first bytes of a cache file
+#define CACHE_MAGIC "HKGRAPH"
+
+// version of the format (the name of the subdirectory of the cache)
+#define CACHE_VERSION 1
+
+// directory used by --cache without a directory
+#define CACHE_DEFAULT_DIR "../Cache"
+
+// type of code of the configuration graphs of this project
+#define CACHE_TYPE_IDCODE "idcode"
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: cache_header
+ * --------------------
+ * The beginning of a cache file
+ *
+ *           magic: CACHE_MAGIC
+ *         version: CACHE_VERSION
+ *       num_lines: the number of lines of the hexagonal grid (k)
+ *           width: the number of columns of a bar code
+ *         overlap: the number of columns shared by two consecutive bars
+ *            type: the type of code, as CACHE_TYPE_IDCODE
+ *           nodes: the number of vertices of the configuration graph
+ *            arcs: the number of arcs of the configuration graph
+ *        checksum: checksum of the bytes after the header
+ * header_checksum: checksum of the fields above
+ */
+struct cache_header
+{
+  char     magic[8];
+  int32_t  version;
+  int32_t  num_lines;
+  int32_t  width;
+  int32_t  overlap;
+  char     type[16];
+  int64_t  nodes;
+  int64_t  arcs;
+  uint64_t checksum;
+  uint64_t header_checksum;
+};
+
+typedef struct cache_header cache_header;
+
+/*
+ * Struct: graph_cache
+ * -------------------
+ * A cache file mapped in memory
+ *
+ *        data: the beginning of the mapping (NULL if there is none)
+ *        size: the size of the mapping
+ *      header: the header of the file
+ *         bar: the bar codes of the vertices
+ * node_weight: the weights of the arcs entering each vertex
+ *         arc: the sources and targets of the arcs
+ */
+struct graph_cache
+{
+  void               *data;
+  size_t              size;
+  const cache_header *header;
+  const uint64_t     *bar;
+  const int32_t      *node_weight;
+  const int32_t      *arc;
+};
+
+typedef struct graph_cache graph_cache;
+
+/*
+ * Struct: cache_hasher
+ * --------------------
+ * The state of the checksum of a sequence of blocks of memory: the FNV-1a
+ * hash taken over words of 8 bytes (the last word is completed with
+ * zeros)
+ *
+ *   hash: the hash of the complete words
+ *   word: the bytes of the incomplete word
+ * filled: the number of bytes in word
+ */
+struct cache_hasher
+{
+  uint64_t hash;
+  uint64_t word;
+  int      filled;
+};
+
+typedef struct cache_hasher cache_hasher;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: cache_hash_init
+ * -------------------------
+ * Starts a checksum
+ */
+inline void cache_hash_init(cache_hasher *h)
+{
+  h->hash = 14695981039346656037ULL;
+  h->word = 0;
+  h->filled = 0;
+}
+
+/*
+ * Function: cache_hash_update
+ * ---------------------------
+ * Adds a block of memory to a checksum
+ */
+inline void cache_hash_update(cache_hasher *h, const void *data, size_t size)
+{
+  const unsigned char *bytes;
+  uint64_t word;
+  size_t i;
+
+  bytes = (const unsigned char *) data;
+  i = 0;
+
+  // completes the word left by the previous block
+  while (h->filled != 0 && i < size)
+    {
+      h->word |= (uint64_t) bytes[i++] << (8 * h->filled);
+      if (++h->filled == 8)
+	{
+	  h->hash = (h->hash ^ h->word) * 1099511628211ULL;
+	  h->word = 0;
+	  h->filled = 0;
+	}
+    }
+
+  for (; i + 8 <= size; i += 8)
+    {
+      memcpy(&word, bytes + i, 8);
+      h->hash = (h->hash ^ word) * 1099511628211ULL;
+    }
+
+  // less than 8 bytes are left, and they start a new word
+  if (i < size)
+    {
+      word = 0;
+      memcpy(&word, bytes + i, size - i);
+      h->word = word;
+      h->filled = (int) (size - i);
+    }
+}
+
+/*
+ * Function: cache_hash_final
+ * --------------------------
+ * returns: the checksum of all the blocks added
+ */
+inline uint64_t cache_hash_final(cache_hasher *h)
+{
+  if (h->filled != 0)
+    h->hash = (h->hash ^ h->word) * 1099511628211ULL;
+
+  h->word = 0;
+  h->filled = 0;
+  return h->hash;
+}
+
+/*
+ * Function: cache_checksum
+ * ------------------------
+ * returns: the checksum of a block of memory
+ */
+inline uint64_t cache_checksum(const void *data, size_t size)
+{
+  cache_hasher h;
+
+  cache_hash_init(&h);
+  cache_hash_update(&h, data, size);
+  return cache_hash_final(&h);
+}
+
+/*
+ * Function: graph_file_name
+ * -------------------------
+ * Names the files of a configuration graph (the cache, the out-of-core
+ * graph, the checkpoints and the graphs of the benchmarks) after the
+ * grid and the bars of the graph: H<k>_w<width>_o<overlap>_<type>
+ *
+ *       dir: the directory of the file
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *      type: the type of code
+ * extension: the extension of the file, with its dot
+ *
+ * returns: the name of the file
+ */
+inline std::string graph_file_name(const std::string &dir, int num_lines,
+				   int width, int overlap, const char *type,
+				   const char *extension)
+{
+  return dir + "/H" + std::to_string(num_lines) + "_w" +
+    std::to_string(width) + "_o" + std::to_string(overlap) + "_" + type +
+    extension;
+}
+
+/*
+ * Function: cache_file_name
+ * -------------------------
+ * Creates, if needed, the directory of the current version of the cache
+ *
+ *      root: the cache directory
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *      type: the type of code
+ *
+ * returns: the name of the cache file of the configuration graph
+ */
+inline std::string cache_file_name(const char *root, int num_lines,
+				   int width, int overlap, const char *type)
+{
+  std::string directory;
+
+  directory = std::string(root) + "/v" + std::to_string(CACHE_VERSION);
+
+  // the directories may already exist
+  mkdir(root, 0755);
+  mkdir(directory.c_str(), 0755);
+
+  return graph_file_name(directory, num_lines, width, overlap, type,
+			 ".bin");
+}
+
+/*
+ * Function: cache_init_header
+ * ---------------------------
+ * Fills the fields of a header which identify the configuration graph
+ */
+inline void cache_init_header(cache_header *header, int num_lines,
+			      int width, int overlap, const char *type)
+{
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header->version = CACHE_VERSION;
+  header->num_lines = num_lines;
+  header->width = width;
+  header->overlap = overlap;
+  strncpy(header->type, type, sizeof(header->type) -1);
+}
+
+/*
+ * Function: save_graph_cache
+ * --------------------------
+ * Saves the bar codes and the configuration graph; the file is written
+ * with another name and renamed at the end, so a run interrupted while
+ * saving does not leave a partial file in the cache
+ *
+ *        path: the name of the cache file
+ *   num_lines: the number of lines of the hexagonal grid
+ *       width: the number of columns of a bar code
+ *     overlap: the number of columns shared by two consecutive bars
+ *        type: the type of code
+ *         bar: the bar codes of the vertices, by id
+ * node_weight: the weights of the arcs entering each vertex, by id
+ *           G: the configuration graph
+ *
+ * returns: 1 if the file was saved, otherwise, 0
+ */
+inline int save_graph_cache(const std::string &path, int num_lines,
+			    int width, int overlap, const char *type,
+			    const std::vector<uint64_t> &bar,
+			    const std::vector<int32_t> &node_weight,
+			    const lemon::SmartDigraph &G)
+{
+  cache_header header;
+  cache_hasher h;
+  std::vector<int32_t> arc;
+  std::string temporary;
+  std::ofstream file;
+  int a, m;
+
+  m = lemon::countArcs(G);
+  arc.resize((size_t) 2 * m);
+  for (a = 0; a < m; a++)
+    {
+      arc[2 * (size_t) a] = G.id(G.source(G.arcFromId(a)));
+      arc[2 * (size_t) a +1] = G.id(G.target(G.arcFromId(a)));
+    }
+
+  cache_init_header(&header, num_lines, width, overlap, type);
+  header.nodes = (int64_t) bar.size();
+  header.arcs = m;
+
+  // the checksum of the three arrays, one after the other, as they are
+  // read back
+  cache_hash_init(&h);
+  cache_hash_update(&h, bar.data(), bar.size() * sizeof(uint64_t));
+  cache_hash_update(&h, node_weight.data(),
+		    node_weight.size() * sizeof(int32_t));
+  cache_hash_update(&h, arc.data(), arc.size() * sizeof(int32_t));
+
+  header.checksum = cache_hash_final(&h);
+  header.header_checksum = cache_checksum(&header,
+					  offsetof(cache_header,
+						   header_checksum));
+
+  temporary = path + ".tmp";
+  file.open(temporary.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return 0;
+
+  file.write((const char *) &header, sizeof(header));
+  file.write((const char *) bar.data(), bar.size() * sizeof(uint64_t));
+  file.write((const char *) node_weight.data(),
+	     node_weight.size() * sizeof(int32_t));
+  file.write((const char *) arc.data(), arc.size() * sizeof(int32_t));
+  file.close();
+
+  if (!file.good() || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+      remove(temporary.c_str());
+      return 0;
+    }
+
+  return 1;
+}
+
+/*
+ * Function: close_graph_cache
+ * ---------------------------
+ * Unmaps a cache file
+ */
+inline void close_graph_cache(graph_cache *cache)
+{
+  if (cache->data != NULL)
+    munmap(cache->data, cache->size);
+
+  cache->data = NULL;
+  cache->size = 0;
+}
+
+/*
+ * Function: open_graph_cache
+ * --------------------------
+ * Maps a cache file in memory and checks that it is the cache of the
+ * configuration graph asked for and that it is not corrupted
+ *
+ *      path: the name of the cache file
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ *      type: the type of code
+ *     cache: where the mapping is stored
+ *
+ * returns: 1 if the cache can be used, otherwise, 0 (no file, or a file
+ *          which does not match)
+ */
+inline int open_graph_cache(const std::string &path, int num_lines,
+			    int width, int overlap, const char *type,
+			    graph_cache *cache)
+{
+  cache_header expected;
+  const cache_header *header;
+  struct stat info;
+  size_t payload;
+  int fd;
+
+  cache->data = NULL;
+  cache->size = 0;
+
+  fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return 0;
+
+  if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(cache_header))
+    {
+      close(fd);
+      return 0;
+    }
+
+  cache->size = (size_t) info.st_size;
+  cache->data = mmap(NULL, cache->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (cache->data == MAP_FAILED)
+    {
+      cache->data = NULL;
+      return 0;
+    }
+
+  header = (const cache_header *) cache->data;
+  cache_init_header(&expected, num_lines, width, overlap, type);
+
+  if (memcmp(header->magic, expected.magic, sizeof(header->magic)) != 0 ||
+      header->version != expected.version ||
+      header->num_lines != num_lines || header->width != width ||
+      header->overlap != overlap ||
+      memcmp(header->type, expected.type, sizeof(header->type)) != 0 ||
+      header->header_checksum !=
+      cache_checksum(header, offsetof(cache_header, header_checksum)) ||
+      header->nodes < 0 || header->arcs < 0)
+    {
+      close_graph_cache(cache);
+      return 0;
+    }
+
+  payload = (size_t) header->nodes * (sizeof(uint64_t) + sizeof(int32_t)) +
+    (size_t) header->arcs * 2 * sizeof(int32_t);
+
+  if (cache->size != sizeof(cache_header) + payload ||
+      cache_checksum((const char *) cache->data + sizeof(cache_header),
+		     payload) != header->checksum)
+    {
+      close_graph_cache(cache);
+      return 0;
+    }
+
+  cache->header = header;
+  cache->bar = (const uint64_t *) (header +1);
+  cache->node_weight = (const int32_t *) (cache->bar + header->nodes);
+  cache->arc = cache->node_weight + header->nodes;
+  return 1;
+}
+
+/*
+ * Function: cache_add_arcs
+ * ------------------------
+ * Adds the arcs of the cache to the configuration graph, in the order of
+ * their ids, so the graph is the same as the one which was saved
+ *
+ *  cache: the cache file mapped in memory
+ *      G: the configuration graph, with all its vertices and no arcs
+ * weight: where the weights of the arcs are stored
+ */
+inline void cache_add_arcs(const graph_cache &cache, lemon::SmartDigraph *G,
+			   lemon::SmartDigraph::ArcMap<int> *weight)
+{
+  lemon::SmartDigraph::Arc arc;
+  int64_t a;
+
+  G->reserveArc((int) cache.header->arcs);
+
+  for (a = 0; a < cache.header->arcs; a++)
+    {
+      arc = G->addArc(G->nodeFromId(cache.arc[2 * a]),
+		      G->nodeFromId(cache.arc[2 * a +1]));
+      (*weight)[arc] = cache.node_weight[cache.arc[2 * a +1]];
+    }
+}
+
+#endif
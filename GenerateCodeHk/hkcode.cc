@@ -0,0 +1,125 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   libhkcode (see hkcode.h): the solvers of Hk_lemon_eng_6bar.cc and
+   Hk_lemon_eng_8bar.cc as a library. Their kernels are in hkcode_6bar.cc
+   and hkcode_8bar.cc, each one in a namespace of its own (hk6 and hk8),
+   since they have functions with the same names. The functions of this
+   file only choose the kernels of the kind of bar and convert the
+   results to the structs of hkcode.h.
+*/
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include "hkcode.h"
+#include "hkcode_6bar.h"
+#include "hkcode_8bar.h"
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+int hk_build_barcodes(int bars, int k, int row_extension,
+		      hk_barcodes *barcodes)
+{
+  if (bars == HK_BARS_6)
+    return hk6::library_barcodes(k, row_extension, barcodes);
+
+  if (bars == HK_BARS_8)
+    return hk8::library_barcodes(k, row_extension, barcodes);
+
+  return 0;
+}
+
+int hk_build_graph(const hk_barcodes &barcodes, hk_graph *graph)
+{
+  if (barcodes.bars == HK_BARS_6)
+    return hk6::library_graph(barcodes, graph);
+
+  if (barcodes.bars == HK_BARS_8)
+    return hk8::library_graph(barcodes, graph);
+
+  return 0;
+}
+
+int hk_solve(const hk_graph &graph, mmc_engine engine,
+	     hk_solution *solution)
+{
+  lemon::SmartDigraph G;
+  lemon::SmartDigraph::Arc arc;
+  mmc_result mmc;
+  int64_t n, u, a;
+
+  // the arcs are added from the last vertex to the first one, as in
+  // csr_add_arcs, so the graph is the one the programs build
+  n = (int64_t) graph.bar.size();
+  G.reserveNode((int) n);
+  G.reserveArc((int) graph.targets.size());
+  for (u = 0; u < n; u++)
+    G.addNode();
+
+  lemon::SmartDigraph::ArcMap<int> weight(G);
+
+  for (u = n -1; u >= 0; u--)
+    for (a = graph.offsets[u]; a < graph.offsets[u +1]; a++)
+      {
+	arc = G.addArc(G.nodeFromId((int) u),
+		       G.nodeFromId(graph.targets[a]));
+	weight[arc] = graph.node_weight[graph.targets[a]];
+      }
+
+  solution->engine = run_mmc(G, weight, engine, &mmc);
+  solution->found = mmc.found;
+  solution->cost = mmc.cost;
+  solution->cycle.clear();
+
+  if (mmc.found == 1)
+    for (lemon::Path<lemon::SmartDigraph>::ArcIt p(mmc.cycle);
+	 p != lemon::INVALID; ++p)
+      solution->cycle.push_back(G.id(G.source(p)));
+
+  return mmc.found;
+}
+
+int hk_decode_pattern(const hk_graph &graph, const hk_solution &solution,
+		      hk_pattern *pattern)
+{
+  std::vector<uint64_t> bar;   // the bar codes of the cycle
+  size_t i;
+
+  if (solution.found == 0 || solution.cycle.empty())
+    return 0;
+
+  for (i = 0; i < solution.cycle.size(); i++)
+    bar.push_back(graph.bar[solution.cycle[i]]);
+
+  if (graph.bars == HK_BARS_6)
+    hk6::decode_pattern(graph.k, bar, pattern);
+  else if (graph.bars == HK_BARS_8)
+    hk8::decode_pattern(graph.k, bar, pattern);
+  else
+    return 0;
+
+  return 1;
+}
+
+int hk_find_code(int bars, int k, mmc_engine engine, hk_pattern *pattern)
+{
+  hk_barcodes barcodes;
+  hk_graph graph;
+  hk_solution solution;
+
+  if (hk_build_barcodes(bars, k, 1, &barcodes) == 0 ||
+      hk_build_graph(barcodes, &graph) == 0)
+    return 0;
+
+  // the bar codes are not needed by the MMC algorithm
+  barcodes.bar.clear();
+  barcodes.bar.shrink_to_fit();
+
+  if (hk_solve(graph, engine, &solution) == 0)
+    return 0;
+
+  return hk_decode_pattern(graph, solution, pattern);
+}
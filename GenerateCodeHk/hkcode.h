@@ -0,0 +1,240 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Interface of libhkcode, the library with the solvers of
+   Hk_lemon_eng_6bar.cc and Hk_lemon_eng_8bar.cc, for programs which find
+   many codes without starting a process (and reading ../Codes) for each
+   one. Every step returns its result in memory:
+
+       hk_barcodes  barcodes;
+       hk_graph     graph;
+       hk_solution  solution;
+       hk_pattern   pattern;
+
+       hk_build_barcodes(HK_BARS_6, 3, 1, &barcodes);
+       hk_build_graph(barcodes, &graph);
+       hk_solve(graph, MMC_HOWARD, &solution);
+       hk_decode_pattern(graph, solution, &pattern);   // 6/13
+
+   The library is hkcode.cc and the kernels of each kind of bar
+   (hkcode_6bar.cc and hkcode_8bar.cc, each one in a namespace of its
+   own), which the programs also call, so the library and the programs
+   share the same kernels (the programs also print and save their codes
+   with decode_pattern). It is built with
+
+       g++ -O2 -fopenmp -c hkcode.cc hkcode_6bar.cc hkcode_8bar.cc
+       ar rcs libhkcode.a hkcode.o hkcode_6bar.o hkcode_8bar.o
+
+   and linked with -lhkcode -lemon -fopenmp. The graph is kept in the CSR
+   form of csr_graph.h (the vertex with id u is the bar code bar[u]); the
+   codes of H_k can also be found in one call with hk_find_code.
+*/
+
+#ifndef HKCODE_H
+#define HKCODE_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "mmc_engine.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// the configuration graphs: bars of 4 columns which share 2 columns with
+// the next one (Hk_lemon_eng_6bar.cc), or which share none of them
+// (Hk_lemon_eng_8bar.cc)
+#define HK_BARS_6 6
+#define HK_BARS_8 8
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: hk_barcodes
+ * -------------------
+ * The bar codes of H_k
+ *
+ *    bars: HK_BARS_6 or HK_BARS_8
+ *       k: the number of lines of the hexagonal grid
+ *   width: the number of columns of a bar
+ * overlap: the number of columns shared by two consecutive bars
+ *     bar: the bar codes, as masks (bit r * width + c is the vertex of
+ *          the line r and column c), in the order of the enumeration
+ */
+struct hk_barcodes
+{
+  int                   bars;
+  int                   k;
+  int                   width;
+  int                   overlap;
+  std::vector<uint64_t> bar;
+};
+
+typedef struct hk_barcodes hk_barcodes;
+
+/*
+ * Struct: hk_graph
+ * ----------------
+ * A configuration graph, in CSR form
+ *
+ *        bars: HK_BARS_6 or HK_BARS_8
+ *           k: the number of lines of the hexagonal grid
+ *       width: the number of columns of a bar
+ *     overlap: the number of columns shared by two consecutive bars
+ *         bar: the bar code of each vertex, by id
+ * node_weight: the weight of the arcs entering each vertex
+ *     offsets: the arcs of the vertex u are targets[offsets[u]], ...,
+ *     targets  targets[offsets[u +1] -1]
+ */
+struct hk_graph
+{
+  int                   bars;
+  int                   k;
+  int                   width;
+  int                   overlap;
+  std::vector<uint64_t> bar;
+  std::vector<int32_t>  node_weight;
+  std::vector<int64_t>  offsets;
+  std::vector<int32_t>  targets;
+};
+
+typedef struct hk_graph hk_graph;
+
+/*
+ * Struct: hk_solution
+ * -------------------
+ * A minimum mean cycle of a configuration graph
+ *
+ *  found: 1 if the graph has a cycle, otherwise, 0
+ *   cost: the weight of the cycle
+ *  cycle: the vertices of the cycle, in the order of its arcs
+ * engine: the algorithm which found it
+ */
+struct hk_solution
+{
+  int              found;
+  long long        cost;
+  std::vector<int> cycle;
+  mmc_engine       engine;
+};
+
+typedef struct hk_solution hk_solution;
+
+/*
+ * Struct: hk_pattern
+ * ------------------
+ * The pattern of a periodic identifying code
+ *
+ *           k: the number of lines of the hexagonal grid
+ *     columns: the number of columns of the pattern
+ *    vertices: the vertices of the code, as (column, line)
+ * density_num: the density of the code is density_num / density_den, in
+ * density_den  its lowest terms
+ */
+struct hk_pattern
+{
+  int                              k;
+  int                              columns;
+  std::vector<std::pair<int, int>> vertices;
+  long long                        density_num;
+  long long                        density_den;
+};
+
+typedef struct hk_pattern hk_pattern;
+
+
+/* Function Declaration - - - - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Function: hk_build_barcodes
+ * ---------------------------
+ * Generates the bar codes of H_k
+ *
+ *          bars: HK_BARS_6 or HK_BARS_8
+ *             k: the number of lines of the hexagonal grid (2 to 16)
+ * row_extension: 1 to build the bar codes line by line, 0 to test all
+ *                the bars (the list is the same)
+ *      barcodes: where the bar codes are stored
+ *
+ * returns: 1 if the bar codes were generated, otherwise, 0
+ */
+int hk_build_barcodes(int bars, int k, int row_extension,
+		      hk_barcodes *barcodes);
+
+/*
+ * Function: hk_build_graph
+ * ------------------------
+ * Builds the configuration graph of a list of bar codes
+ *
+ * barcodes: the bar codes
+ *    graph: where the graph is stored
+ *
+ * returns: 1 if the graph was built, otherwise, 0
+ */
+int hk_build_graph(const hk_barcodes &barcodes, hk_graph *graph);
+
+/*
+ * Function: hk_solve
+ * ------------------
+ * Finds a minimum mean cycle of a configuration graph
+ *
+ *    graph: the configuration graph
+ *   engine: the algorithm used (mmc_engine.h)
+ * solution: where the cycle is stored
+ *
+ * returns: 1 if the graph has a cycle, otherwise, 0
+ */
+int hk_solve(const hk_graph &graph, mmc_engine engine,
+	     hk_solution *solution);
+
+/*
+ * Function: hk_decode_pattern
+ * ---------------------------
+ * Converts a cycle of a configuration graph into the pattern of the code
+ *
+ *    graph: the configuration graph
+ * solution: a cycle of the graph
+ *  pattern: where the pattern is stored
+ *
+ * returns: 1 if the pattern was decoded, otherwise, 0
+ */
+int hk_decode_pattern(const hk_graph &graph, const hk_solution &solution,
+		      hk_pattern *pattern);
+
+/*
+ * Function: hk_find_code
+ * ----------------------
+ * Finds the code of H_k with the smallest density, with all the steps
+ * above
+ *
+ *    bars: HK_BARS_6 or HK_BARS_8
+ *       k: the number of lines of the hexagonal grid
+ *  engine: the algorithm used to find the minimum mean cycle
+ * pattern: where the pattern of the code is stored
+ *
+ * returns: 1 if the code was found, otherwise, 0
+ */
+int hk_find_code(int bars, int k, mmc_engine engine, hk_pattern *pattern);
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: print_pattern
+ * -----------------------
+ * Outputs the vertices of a code as pairs (column,line), as in the files
+ * of ../Codes
+ */
+inline void print_pattern(std::ostream &out, const hk_pattern &pattern)
+{
+  size_t i;
+
+  for (i = 0; i < pattern.vertices.size(); i++)
+    out << "(" << pattern.vertices[i].first << ","
+	<< pattern.vertices[i].second << ") ";
+}
+
+#endif
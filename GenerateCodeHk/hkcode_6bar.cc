@@ -0,0 +1,1744 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   The kernels of libhkcode for the bars with 4 columns, overlapping 2
+   (see hkcode_6bar.h)
+*/
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include "hkcode_6bar.h"
+
+
+/* Namespaces - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+using namespace std;
+using namespace lemon;
+using namespace std::chrono;
+
+
+namespace hk6
+{
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: init_bar
+ * ------------------
+ * Initialize a bar
+ *
+ * v: points to a vertex in configuration graph (struct vertex)
+ */
+void init_bar(vertex *v)
+{
+  v->bar = nullptr;
+  v->weight = 0;
+}
+
+/*
+ * Function: create_bar
+ * --------------------
+ * Allocates a bar of given size
+ *
+ *       v: points a vertex, which represents a bar
+ *
+ *    size: the amount of vertices, of the hexgonal grid, represented in
+ *          the bar
+ *
+ * returns: 1, if the bar was allocated, otherwise, 0
+ */
+int create_bar(vertex *v, int size)
+{
+  int i;
+
+  try
+    {
+      v->bar = new int[size];
+    }
+  catch (bad_alloc& e)
+    {
+      cerr << "bad_alloc: " << e.what() << "\n";
+      v->bar = nullptr;
+      v->weight = 0;
+      return 0;
+    }
+
+  // initialize the array with zeros
+  // 0 means that a vertex (from the hexagonal grid) does not belongs
+  // to the code
+  for (i = 0; i < size; i++)
+    v->bar[i] = 0;
+
+  return 1;
+}
+
+/*
+ * Function: deallocate_bar
+ * ------------------------
+ * Deallocates a bar
+ *
+ * v: points a vertex, which represents a bar
+ */
+void deallocate_bar(vertex *v)
+{
+  if (v->bar != nullptr)
+    {
+      delete[] v->bar;
+      v->bar = nullptr;
+    }
+
+  v->weight = 0;
+}
+
+/*
+ * Function: print_bar
+ * -------------------
+ * Prints the data of a vertex associate to a bar
+ *
+ *       v: points a vertex, which represents a bar
+ *
+ *    size: the amount of vertices, of the hexgonal grid, represented in
+ *          the bar
+ */
+void print_bar(vertex *v, int size)
+{
+  int i;
+
+  cout << "weight: " << v->weight << "  [";
+
+  for (i = 0; i < size -1; i++)
+    cout << v->bar[i] << ", ";
+
+  if (size != 0)
+    cout << v->bar[size -1];
+
+  cout << "]\n";
+}
+
+
+/*
+ * Function: generate_all_bars
+ * ---------------------------
+ * Generate all the permutations of the vertices (hexagonal grid) of a bar
+ * in the code of a given size
+ *
+ *       v: points a vertex, which represents a bar
+ *
+ *    size: the amount of vertices, of the hexgonal grid, represented in
+ *          the bar
+ *
+ * returns: of the permutations
+ */
+int generate_all_bars(vertex* v, int size) {
+  int k;
+
+  k = size -1;
+
+  while (k >= 0)
+    {
+      if (v->bar[k] == 1)
+	v->bar[k--] = 0;
+
+      else
+	{
+	  v->bar[k] = 1;
+	  break;
+	}
+    }
+
+  return k;
+}
+
+/*
+ * Function: compute_bar_weight
+ * ----------------------------
+ * Computes the weight of a vertex which represents a bar
+ *
+ *       v: points a vertex, which represents a bar
+ *
+ *    size: the amount of vertices, of the hexgonal grid, represented in
+ *          the bar
+ *
+ * returns: the weight (numeber of vertices in the code) of v
+ */
+int compute_bar_weight(vertex *v, int size)
+{
+  int i, weight;
+
+  weight = 0;
+
+  for (i = 0; i < size; i++)
+    {
+      if (v->bar[i] == 1)
+	weight++;
+    }
+
+  return weight;
+}
+
+/*
+ * Function: copy_bar
+ * ------------------
+ * Copies the data from v2 (source) to v1 (target), of same size
+ *
+ * v1: points a veterx which represents a bar
+ *
+ * v2: points a veterx which represents a bar
+ *
+ * size: the number of vertices contained in the bar
+ *
+ */
+void copy_bar(vertex *v1, vertex *v2, int size)
+{
+  int i;
+
+  v1->weight = v2->weight;
+
+  for (i = 0; i < size; i++)
+    v1->bar[i] = v2->bar[i];
+}
+
+
+/*
+ * Function: init_list
+ * -------------------
+ * Initializes a linked list l
+ *
+ * l: points to a linked list
+ * k: number of lines of the hexagonal grid
+ * z: number of columns of the hexagonal grid
+ */
+void init_list(linked_list *l, int k, int z)
+{
+  l->size = 0;
+  l->vertex_size = z * k;
+  l->first = NULL;
+  l->last = NULL;
+}
+
+/*
+ * Function: deallocate_list
+ * -------------------------
+ * Deallocate a linked list
+ *
+ * l: points to a linked list
+ */
+void deallocate_list(linked_list *l)
+{
+  node *elemento;
+  node *aux;
+
+  if (l->size != 0)
+    {
+      elemento = l->first;
+
+      while (elemento != NULL)
+	{
+	  deallocate_bar(elemento->v);
+	  delete elemento->v;
+	  elemento->v = nullptr;
+	  aux = elemento;
+	  elemento = elemento->next;
+	  delete aux;
+	}
+
+      l->first = nullptr;
+      l->last = nullptr;
+      l->size = 0;
+    }
+}
+
+/*
+ * Function: append_list
+ * ---------------------
+ * Appends an element to a linked list
+ *
+ * l: points to a linked list
+ * v: an array which represents a bar code
+ *
+ * returns: 1 if the element was successfully appended, otherwise, 0
+ */
+int append_list(linked_list *l, vertex *v)
+{
+  node *node_list;
+
+  try
+    {
+      node_list = new node;
+    }
+  catch (bad_alloc& e)
+    {
+      cerr << "A node could not be allocated!\n" << e.what() << "\n";
+      return 0;
+    }
+
+  try
+    {
+      node_list->v = new vertex;
+    }
+  catch (bad_alloc& e)
+    {
+      cerr << "It was not possible to allocate a bar!\n" << e.what()
+	   << "\n";
+      delete node_list;
+      node_list = nullptr;
+      return 0;
+    }
+
+  node_list->next = nullptr;
+
+  if (create_bar(node_list->v, l->vertex_size) == 0)
+    {
+      delete node_list;
+      node_list = nullptr;
+      return 0;
+    }
+
+  copy_bar(node_list->v, v, l->vertex_size);
+
+  if (l->size == 0)
+    l->first = node_list;
+  else
+    l->last->next = node_list;
+
+  l->last = node_list;
+  l->size++;
+  return 1;
+}
+
+/*
+ * Function: print_list
+ * --------------------
+ * Ouputs to stdout the data of a linked list l
+ *
+ * l: points to a linked list
+ */
+void print_list(linked_list *l)
+{
+  node *element;
+
+  printf("Size: %d\t Size of a vertex (configuration graph): %d\n",
+	 l->size, l->vertex_size);
+  element = l->first;
+
+  while (element != NULL)
+    {
+      print_bar(element->v, l->vertex_size);
+      element = element->next;
+    }
+}
+
+
+/*
+ * Function: allocate_hexagonal_grid
+ * ---------------------------------
+ * Allocates the hexgonal grid with k lines and z columns
+ *
+ * k: the number of lines of the hexagonal grid
+ * z: the number of columns of the hexagonal grid
+ * H: points to the graph which will represent the hexagonal grid
+ */
+void allocate_hexagonal_grid(int k, int z, SmartGraph *H)
+{
+  int size;
+  int parity;
+  int i, j;
+
+  // number of vertices
+  size = k * z;
+
+  // creates the vertices
+  for (i = 0; i < size; i++)
+    H->addNode();
+
+  // add edges which represents the lines of the hexagonal grid
+  for(i = 0; i < size; i = i +z)
+    for(j = 0; j < z -1; j++)
+      H->addEdge(H->nodeFromId(i +j), H->nodeFromId(i +j +1));
+
+  // add the edges that represents the columns of the hexagonal grid
+  // we assume that we start at line 0, and also, even lines has
+  // parity -1
+  parity = -1;
+
+  // loop condition is i < size -z because, at each step we advance z
+  // vertices (number of vertices in a column)
+  // when z = 4 we got the following structure
+  for (i = 0; i < size -z; i = i +z)
+    {
+      if (parity == -1)
+	j = 0;
+      else
+	j = 1;
+
+      while (j < z)
+	{
+	  H->addEdge(H->nodeFromId(i +j), H->nodeFromId(i +z +j));
+	  j = j +2;
+	}
+
+      parity = parity * (-1);
+    }
+}
+
+
+/*
+ * Function: identifier_size
+ * -------------------------
+ * Computes the number of vertices in an identifier
+ *
+ *      id: an array of integers that represents an identifier
+ *
+ *    size: the number of vertices in the array id
+ *
+ * returns: the number of vertices in the array id which are in the
+ *          code
+ */
+int identifier_size(int *id, int size)
+{
+  int i;
+  int size_id;
+
+  size_id = 0;
+
+  for (i = 0; i < size; i++)
+    if (id[i] != -1)
+      size_id++;
+
+  return size_id;
+}
+
+
+/*
+ * Function: equal_identifier
+ * --------------------------
+ * Check if two identifiers have the same vertices, that is, if they are
+ * equal
+ *
+ *  id1: array of integers that represents the vertices of an identifier
+ *
+ *  id2: array of integers that represents the vertices of an identifier
+ *
+ * size: the number of vertices in a identifier (it applies to id1 and id2)
+ *
+ * returns: true if id1 == id2, otherwise, false
+ */
+bool equal_identifier(int *id1, int *id2, int size)
+{
+  int amt_equal;
+  int size_id1, size_id2;
+  int i, j;
+
+  amt_equal = 0;
+  i = 0;
+
+  // computes the actual size of the identifiers id1 and id2
+  // this is done because an identifier has a fixed size of size
+  // and when it is created, the identifier is initialized with -1
+  // meaning that no vertex was assigned to the identifier
+  size_id1 = 0;
+  size_id2 = 0;
+
+  for (i = 0; i < size; i++)
+    {
+      if (id1[i] != -1)
+	size_id1++;
+
+      if (id2[i] != -1)
+	size_id2++;
+    }
+
+  // if size_d1 != size_id2, as id1 and id2 are not empty, then there is an
+  // element from id1 which does not belogs to id2, or vice-versa; then
+  // id1 and id2 are distinct
+  if (size_id1 != size_id2)
+    return false;
+
+  // note that, from this part, size_id1 = size_id2
+  i = 0;
+  while (i < size_id1)
+    {
+      j = 0;
+
+      while (j < size_id2)
+	{
+	  if (id1[i] == id2[j])
+	    {
+	      amt_equal++;
+	    }
+
+	  j++;
+	}
+
+      i++;
+    }
+
+  if (amt_equal == size_id1)
+    return true;
+
+  return false;
+}
+
+
+/*
+ * Function: list_barcodes
+ * -----------------------
+ * Stores the bar codes of a list as masks (bit i is the vertex i of the
+ * bar), in the order of the list
+ *
+ * linked_list: the list which has all the bar codes
+ *
+ *         bar: where the bar codes are stored
+ */
+void list_barcodes(linked_list *l, vector<uint64_t> *bar)
+{
+  node *element;
+  size_t j;
+  int i;
+
+  bar->assign(l->size, 0);
+
+  for (element = l->first, j = 0; j < bar->size();
+       element = element->next, j++)
+    for (i = 0; i < l->vertex_size; i++)
+      if (element->v->bar[i] == 1)
+	(*bar)[j] |= 1ULL << i;
+}
+
+/*
+ * Function: generate_all_barcodes
+ * -------------------------------
+ * Generates a list wit all bar codes
+ *
+ * linked_list: the list which has all the bar codes
+ *
+ *           k: number of lines of the hexagonal grid
+ *
+ *           z: number of columns of the hexagonal grid
+ *
+ *     checker: the checkers specialized for k (NULL to check the bars
+ *              over the hexagonal grid)
+ *
+ *        ckpt: the checkpoints of the run (NULL if there are none); if a
+ *              checkpoint of the bars was loaded, its bar codes are
+ *              already in the list, and the bars after its cursor are
+ *              tested
+ *
+ *     metrics: where the number of bars tested is added (may be NULL)
+ *
+ *     returns: 1 if the list was created, otherwise, 0
+ */
+int generate_all_barcodes(linked_list *l, int k, int z,
+			  const hk_checker *checker, checkpoint *ckpt,
+			  run_metrics *metrics)
+{
+  vertex v;       // vertex which represents a bar
+  SmartGraph H;   // graph used to check if a bar is a bar code (valid)
+  bool valid_bar; // true if the bar, associated to v, is a bar code,
+		  // otherwise, false
+  uint8_t lines[CHECKER_MAX_LINES]; // the bar, one byte per line
+  uint64_t tested;  // the number of bars tested
+  uint64_t resumed; // the number of bars tested before the checkpoint
+  int i, j;
+
+
+  // initialize the vertex which will be used to generate all the
+  // possible bars
+  init_bar(&v);
+
+  if (create_bar(&v, l->vertex_size) == 0)
+    return 0;
+
+  resumed = 0;
+  if (ckpt != NULL && ckpt->phase == CHECKPOINT_BARS)
+    {
+      resumed = ckpt->cursor;
+      checkpoint_counter(v.bar, l->vertex_size, resumed);
+    }
+  tested = resumed;
+
+  // creates the hexagonal grid which will be used to check if a bar
+  // is a bar code
+  SmartGraph::NodeMap<config_vertex> map_vertex_id(H);
+  allocate_hexagonal_grid(k, z, &H);
+
+  // do the maping from a vertex from H to a vertex in the hexagonal grid
+  // (z, k) (a vertex from the hexagonal grid)
+  for(i = 0; i < l->vertex_size; i = i +z)
+    for(j = 0; j < z; j++)
+      {
+        map_vertex_id[H.nodeFromId(i +j)].column = j;
+        map_vertex_id[H.nodeFromId(i +j)].line = i/z;
+      }
+
+  // loop that generates all the bar code
+  while (generate_all_bars(&v, l->vertex_size) >= 0)
+    {
+      // the bars before v were tested
+      tested++;
+      if (ckpt != NULL && tested % CHECKPOINT_BAR_STEP == 0 &&
+	  checkpoint_due(ckpt) == 1)
+	{
+	  list_barcodes(l, &ckpt->bar);
+	  if (save_checkpoint(ckpt, CHECKPOINT_BARS, tested -1, -1,
+			      NULL) == 0)
+	    cerr << "It was not possible to save the checkpoint "
+		 << ckpt->path << "!\n";
+	}
+
+      v.weight = compute_bar_weight(&v, l->vertex_size);
+
+      if (checker != NULL)
+	{
+	  checker_lines(v.bar, k, z, lines);
+	  if (checker->bar_valid(lines) == 1)
+	    append_list(l, &v);
+
+	  continue;
+	}
+
+	  // build the identifiers for all vertices
+	  for (SmartGraph::NodeIt vertice(H); vertice != INVALID;
+	       ++vertice)
+	    {
+	      if (map_vertex_id[vertice].column != 0 &&
+		  map_vertex_id[vertice].column != z -1)
+		{
+		  i = 0;
+
+		  if (v.bar[H.id(vertice)] == 1)
+		    {
+		      map_vertex_id[vertice].identifier[i] =
+			H.id(vertice);
+		      i++;
+		    }
+
+		  for (SmartGraph::IncEdgeIt aresta(H, vertice);
+		       aresta != INVALID; ++aresta)
+		    {
+		      if (H.id(H.u(aresta)) != H.id(vertice) &&
+			  v.bar[H.id(H.u(aresta))] == 1)
+			{
+			  map_vertex_id[vertice].identifier[i] =
+			    H.id(H.u(aresta));
+			  i++;
+			}
+
+		      else if (H.id(H.v(aresta)) != H.id(vertice) &&
+			       v.bar[H.id(H.v(aresta))] == 1)
+			{
+			  map_vertex_id[vertice].identifier[i] =
+			    H.id(H.v(aresta));
+			  i++;
+			}
+		    }
+		}
+	    }
+
+	  valid_bar = true;
+
+	  // check if there is an empty identifier
+	  for (SmartGraph::NodeIt vertice(H); vertice != INVALID;
+	       ++vertice)
+	    {
+	      if (map_vertex_id[vertice].column != 0 &&
+		  map_vertex_id[vertice].column != z -1)
+		if (identifier_size(map_vertex_id[vertice].identifier, NEIGHBOORHOD_SIZE) == 0)
+		  valid_bar = false;
+	    }
+
+	  // check if there is two distinct vertices with the same identifier
+          if (valid_bar == true)
+	    {
+	      for (SmartGraph::NodeIt v1(H); v1 != INVALID; ++v1)
+		{
+		  if (map_vertex_id[v1].column != 0 &&
+		      map_vertex_id[v1].column != z -1)
+		    for (SmartGraph::NodeIt v2(H); v2 != INVALID; ++v2)
+		      {
+			if (H.id(v1) != H.id(v2) &&
+			    map_vertex_id[v2].column != 0 &&
+			    map_vertex_id[v2].column != z -1)
+			  if (equal_identifier(map_vertex_id[v1].identifier, map_vertex_id[v2].identifier, NEIGHBOORHOD_SIZE) == true)
+			    valid_bar = false;
+		      }
+		}
+	    }
+
+	  if (valid_bar == true)
+	    append_list(l, &v);
+
+	  // reinitialize the identifier for the next iteration
+          for (SmartGraph::NodeIt w(H); w != INVALID; ++w)
+	    {
+	      map_vertex_id[w].identifier[0] = -1;
+	      map_vertex_id[w].identifier[1] = -1;
+	      map_vertex_id[w].identifier[2] = -1;
+	      map_vertex_id[w].identifier[3] = -1;
+	    }
+    }
+
+  if (metrics != NULL)
+    metrics->candidates_tested += (long long) (tested - resumed);
+
+  deallocate_bar(&v);
+  return 1;
+}
+
+
+/*
+ * Function: append_barcodes
+ * -------------------------
+ * Appends bar codes given as masks (bit i is the vertex i of the bar) to
+ * the list of bar codes
+ *
+ * linked_list: the list which has all the bar codes
+ *
+ *    barcodes: the bar codes
+ *
+ *         amt: the number of bar codes
+ *
+ *     returns: 1 if the bar codes were appended, otherwise, 0
+ */
+int append_barcodes(linked_list *l, const uint64_t *barcodes, size_t amt)
+{
+  vertex v;                  // vertex which represents a bar
+  size_t j;
+  int i;
+
+  init_bar(&v);
+
+  if (create_bar(&v, l->vertex_size) == 0)
+    return 0;
+
+  for (j = 0; j < amt; j++)
+    {
+      for (i = 0; i < l->vertex_size; i++)
+	v.bar[i] = (barcodes[j] >> i) & 1;
+
+      v.weight = compute_bar_weight(&v, l->vertex_size);
+
+      if (append_list(l, &v) == 0)
+	{
+	  deallocate_bar(&v);
+	  return 0;
+	}
+    }
+
+  deallocate_bar(&v);
+  return 1;
+}
+
+
+/*
+ * Function: extend_all_barcodes
+ * -----------------------------
+ * Generates the same list of bar codes as generate_all_barcodes (in the
+ * same order), extending the bars line by line from the cached table of
+ * open bars with fewer lines
+ *
+ * linked_list: the list which has all the bar codes
+ *
+ *           k: number of lines of the hexagonal grid
+ *
+ *       cache: the table of open bars, kept between calls
+ *
+ *     returns: 1 if the list was created, otherwise, 0
+ */
+int extend_all_barcodes(linked_list *l, int k, barcode_table *cache)
+{
+  vector<uint64_t> barcodes; // the bar codes, as masks
+
+  if (l->vertex_size != BARCODE_COLUMNS * k ||
+      barcode_table_for(k, cache, &barcodes) == 0)
+    return 0;
+
+  return append_barcodes(l, barcodes.data(), barcodes.size());
+}
+
+
+/*
+ * Function: check_unon_bars
+ * -------------------------
+ * Check if the union of two bars, by overlaping two columns,
+ * forms a bar code.
+ *
+ *   v1: points to a vertex which represents a bar code
+ *   v2: points to a vertex which represents a bar code
+ * size: the number of vertices in v1 (or v2)
+ *    k: number of lines of the hexagonal grids
+ *
+ * return: 1 if bar codes v1 and v2 froms a bar code, otherwise, 0
+ *
+ *  representation of how the union of v1 and v2 are made
+ *                columns that overlap (must have the same pattern)
+ *                ____________
+ *                |           |
+ * line 3: 12-13-14-15 == 12-13-14-15
+ *         |      |       |      |
+ * line 2: 8--9--10-11 == 8--9--10-11
+ *            |     |        |     |
+ * line 1: 4--5--6--7  == 4--5--6--7
+ *         |     |        |     |
+ * line 0: 0--1--2--3  == 0--1--2--3
+ *               |           |
+ *               -------------
+ *         v1             v2
+ */
+int check_unon_bars(vertex *v1, vertex *v2,
+	       vertex *new_vertex, int size, int k)
+{
+  SmartGraph H;          // graph used to check if the union of v1 and v2,
+                         // overlaping two columns, forms a bar code
+  int amt_columns_new_v; // number of vertices in H
+  int i, j;
+
+  // check if v1 and v2 overlaps
+  for (i = 0; i < size; i = i + AMT_COLUMNS)
+    {
+      if (v1->bar[i+2] != v2->bar[i])
+	return 0;
+
+      if (v1->bar[i+3] != v2->bar[i+1])
+	return 0;
+    }
+
+  // creates a bar by the union of v1 and v2,
+  // overlaping two columns
+  amt_columns_new_v = AMT_COLUMNS + (AMT_COLUMNS - AMT_OVERLAP);
+  j = 0;
+  for (i = 0; i < size; i = i +AMT_COLUMNS)
+    {
+      new_vertex->bar[j] = v1->bar[i];
+      new_vertex->bar[j +1] = v1->bar[i +1];
+      new_vertex->bar[j +2] = v1->bar[i +2];
+      new_vertex->bar[j +3] = v1->bar[i +3];
+
+      new_vertex->bar[j +4] = v2->bar[i +2];
+      new_vertex->bar[j +5] = v2->bar[i +3];
+
+      j = j + amt_columns_new_v;
+    }
+
+  new_vertex->weight = compute_bar_weight(new_vertex, amt_columns_new_v * k);
+
+  // create the graph to check the union of v1 and v2 is a bar code
+  SmartGraph::NodeMap<config_vertex> map_vertice_id(H);
+  allocate_hexagonal_grid(k, amt_columns_new_v, &H);
+
+  // set the column and line for the vertices of H, maping the vertices
+  // of H into the struct of the hexagonal grid
+  for(i = 0; i < amt_columns_new_v * k; i = i + amt_columns_new_v)
+    for(j = 0; j < amt_columns_new_v; j++)
+      {
+        map_vertice_id[H.nodeFromId(i +j)].column = j;
+        map_vertice_id[H.nodeFromId(i +j)].line = i/amt_columns_new_v;
+      }
+
+  // create the identifiers
+  for (SmartGraph::NodeIt vertice(H); vertice != INVALID;
+       ++vertice)
+    {
+      if (map_vertice_id[vertice].column != 0 &&
+	  map_vertice_id[vertice].column != amt_columns_new_v -1)
+	{
+	  i = 0;
+
+	  if (new_vertex->bar[H.id(vertice)] == 1)
+	    {
+	      map_vertice_id[vertice].identifier[i] =
+		H.id(vertice);
+	      i++;
+	    }
+
+	  for (SmartGraph::IncEdgeIt aresta(H, vertice);
+	       aresta != INVALID; ++aresta)
+	    {
+	      if (H.id(H.u(aresta)) != H.id(vertice) &&
+		  new_vertex->bar[H.id(H.u(aresta))] == 1)
+		{
+		  map_vertice_id[vertice].identifier[i] =
+		    H.id(H.u(aresta));
+		  i++;
+		}
+
+	      else if (H.id(H.v(aresta)) != H.id(vertice) &&
+		      new_vertex->bar[H.id(H.v(aresta))] == 1)
+		{
+		  map_vertice_id[vertice].identifier[i] =
+		    H.id(H.v(aresta));
+		  i++;
+		}
+	    }
+	}
+    }
+
+  // check if there is an empty identifier
+  for (SmartGraph::NodeIt vertice(H); vertice != INVALID;
+       ++vertice)
+    {
+      if (map_vertice_id[vertice].column != 0 &&
+	  map_vertice_id[vertice].column != amt_columns_new_v -1)
+	if (identifier_size(map_vertice_id[vertice].identifier, NEIGHBOORHOD_SIZE) == 0)
+	  return 0;
+    }
+
+  // check if the identifiers are pairwise distinct
+  for (SmartGraph::NodeIt v1(H); v1 != INVALID; ++v1)
+    {
+      if (map_vertice_id[v1].column != 0 &&
+	  map_vertice_id[v1].column != amt_columns_new_v -1)
+	for (SmartGraph::NodeIt v2(H); v2 != INVALID; ++v2)
+	  {
+	    if (H.id(v1) != H.id(v2) &&
+		map_vertice_id[v2].column != 0 &&
+		map_vertice_id[v2].column != amt_columns_new_v -1)
+	      if (equal_identifier(map_vertice_id[v1].identifier,
+				   map_vertice_id[v2].identifier,
+				   NEIGHBOORHOD_SIZE) == true)
+		return 0;
+	  }
+    }
+
+  return 1;
+}
+
+
+/*
+ * Function: allocate_vertex_config_graph
+ * --------------------------------------
+ * Given a list with bar codes, creates the vertices of the configuration
+ * graph
+ *
+ *   G: points to a digraph, which represents the configuration graph
+ *
+ *   l: linke list with bar codes
+ *
+ * map: a mapping from a vertex (configuration graph) to a bar code
+ *      in the list l
+ */
+void allocate_vertex_config_graph(SmartDigraph *G, linked_list *l, node **map)
+{
+  SmartDigraph::Node v;
+  node *No;
+  int i;
+
+  No = l->first;
+
+  for (i = 0; i < l->size; i++)
+    {
+      v = G->addNode();
+      map[i] = No;
+      No = No->next;
+    }
+}
+
+
+/*
+ * Function: compute_weigth_barcode
+ * --------------------------------
+ * Computes the weight of an arc of the configuration graph, that is, the
+ * number of vertices in the code among the columns that the target bar
+ * code adds to the pattern (the columns which are not overlaped)
+ *
+ *     bar: the bar code of the target of the arc
+ *       k: number of lines of the hexagonal grid
+ *       z: number of columns of the bar
+ *
+ * returns: the number of vertices in the code in the columns 2..z-1
+ */
+int compute_weigth_barcode(int *bar, int k, int z)
+{
+  int i, j;
+  int weigth;
+
+  weigth = 0;
+
+  for (i = 0; i < k * z; i = i +z)
+      for (j = 2; j < z; j++)
+	weigth = weigth + bar[i +j];
+
+  return weigth;
+}
+
+
+/*
+ * Function: allocate_edge_config_graph
+ * ------------------------------------
+ * Given a list with bar codes, creates the edges of the configuration
+ * graph and their weights
+ *
+ *             G: points to a digraph, which represents the configuration
+ *                graph
+ *
+ *             l: linke list with bar codes
+ *
+ *           map: a mapping from a vertex (configuration graph) to a bar
+ *                code in the list l
+ *
+ *             k: the number of lines of the hexagonal grid
+ *
+ *        weight: where the weights of the new edges are stored
+ *
+ * target_weight: only the edges whose weight is target_weight are
+ *                created (all the edges, if it is -1)
+ *
+ *       checker: the checkers specialized for k (NULL to check the
+ *                unions over the hexagonal grid)
+ *
+ *      external: the out-of-core graph which receives the edges, instead
+ *                of G (NULL to add them to G)
+ *
+ *          ckpt: the checkpoints of the run, with the bar codes by id
+ *                (NULL if there are none); if a checkpoint of the edges
+ *                was loaded, its arcs are added first, and the sources
+ *                after it are processed
+ *
+ *       metrics: where the number of pairs of bar codes tested is added
+ *                (may be NULL)
+ */
+int allocate_edge_config_graph(SmartDigraph *G, linked_list *l, node **map,
+			       int k, SmartDigraph::ArcMap<int> *weight,
+			       int target_weight, const hk_checker *checker,
+			       external_graph *external, checkpoint *ckpt,
+			       run_metrics *metrics)
+{
+  node *nodeU;
+  node *nodeV;
+  vertex NovaCfg;
+  SmartDigraph::Arc arc;
+  vector<int> node_weight;
+  vector<uint8_t> lines;   // the bar codes, one byte per line
+  int valid;
+  int first;               // the first source to process
+  long long pairs;         // the number of pairs of bar codes tested
+
+  // creates a bar
+  if (create_bar(&NovaCfg, k * (2 * AMT_COLUMNS -2)) == 0)
+    return 0;
+
+  // the weight of an edge is given by its target
+  node_weight.assign(countNodes(*G), 0);
+  for (SmartDigraph::NodeIt v(*G); v != INVALID; ++v)
+    node_weight[G->id(v)] = compute_weigth_barcode(map[G->id(v)]->v->bar, k,
+						   NEIGHBOORHOD_SIZE);
+
+  if (checker != NULL)
+    {
+      lines.resize((size_t) countNodes(*G) * k);
+      for (SmartDigraph::NodeIt v(*G); v != INVALID; ++v)
+	checker_lines(map[G->id(v)]->v->bar, k, AMT_COLUMNS,
+		      &lines[(size_t) G->id(v) * k]);
+    }
+
+  // NodeIt visits the sources in decreasing order of id, from the last
+  // one or from the one after the checkpoint
+  first = countNodes(*G) -1;
+  if (ckpt != NULL && ckpt->phase == CHECKPOINT_EDGES)
+    {
+      if (checkpoint_add_arcs(ckpt, G, weight, node_weight) == 0)
+	{
+	  deallocate_bar(&NovaCfg);
+	  return 0;
+	}
+
+      first = (int) ckpt->next_source;
+    }
+
+  // add the edges
+  pairs = 0;
+  for (SmartDigraph::NodeIt u(*G); u != INVALID; ++u)
+    {
+      if (G->id(u) > first)
+	continue;
+
+      for (SmartDigraph::NodeIt v(*G); v != INVALID; ++v)
+	{
+	  if (target_weight != -1 && node_weight[G->id(v)] != target_weight)
+	    continue;
+
+	  pairs++;
+
+	  nodeU = map[G->id(u)];
+	  nodeV = map[G->id(v)];
+
+	  if (checker != NULL)
+	    valid = checker->seam_valid(&lines[(size_t) G->id(u) * k],
+					&lines[(size_t) G->id(v) * k]);
+	  else
+	    valid = check_unon_bars(nodeU->v, nodeV->v, &NovaCfg,
+				    l->vertex_size, k);
+
+	  if (valid == 1 && external != NULL)
+	    {
+	      if (external_add_arc(external, G->id(u), G->id(v)) == 0)
+		{
+		  if (metrics != NULL)
+		    metrics->pairs_tested += pairs;
+		  deallocate_bar(&NovaCfg);
+		  return 0;
+		}
+	    }
+	  else if (valid == 1)
+	    {
+	      arc = G->addArc(u, v);
+	      (*weight)[arc] = node_weight[G->id(v)];
+	    }
+	}
+
+      // the sources up to u were processed
+      if (ckpt != NULL && checkpoint_due(ckpt) == 1 &&
+	  save_checkpoint(ckpt, CHECKPOINT_EDGES, 0, G->id(u) -1, G) == 0)
+	cerr << "It was not possible to save the checkpoint " << ckpt->path
+	     << "!\n";
+    }
+
+  if (metrics != NULL)
+    metrics->pairs_tested += pairs;
+
+  deallocate_bar(&NovaCfg);
+  return 1;
+}
+
+
+/*
+ * Function: config_graph_arrays
+ * -----------------------------
+ * Stores the bar codes of the vertices of the configuration graph as
+ * masks, and the weights of the arcs entering them, by id (the arrays
+ * saved in the cache and in CSR files)
+ *
+ *           G: the configuration graph
+ *
+ *         map: a mapping from a vertex (configuration graph) to a bar code
+ *
+ *           k: the number of lines of the hexagonal grid
+ *
+ *         bar: where the bar codes are stored
+ *
+ * node_weight: where the weights are stored
+ */
+void config_graph_arrays(SmartDigraph &G, node **map, int k,
+			 vector<uint64_t> *bar, vector<int32_t> *node_weight)
+{
+  int n, i, j;
+
+  n = countNodes(G);
+  bar->assign(n, 0);
+  node_weight->assign(n, 0);
+
+  for (i = 0; i < n; i++)
+    {
+      for (j = 0; j < k * AMT_COLUMNS; j++)
+	if (map[i]->v->bar[j] == 1)
+	  (*bar)[i] |= 1ULL << j;
+
+      (*node_weight)[i] = compute_weigth_barcode(map[i]->v->bar, k,
+						 NEIGHBOORHOD_SIZE);
+    }
+}
+
+
+/*
+ * Function: greatest_common_divisor
+ * ---------------------------------
+ * Computes the greatest common divisor of two non negative integers
+ *
+ *       a: a non negative integer
+ *       b: a non negative integer
+ *
+ * returns: gcd(a, b), where gcd(0, 0) = 1 so it is always safe to divide
+ *          by it
+ */
+long long greatest_common_divisor(long long a, long long b)
+{
+  long long r;
+
+  while (b != 0)
+    {
+      r = a % b;
+      a = b;
+      b = r;
+    }
+
+  return (a == 0) ? 1 : a;
+}
+
+
+/*
+ * Function: cycle_barcodes
+ * ------------------------
+ * Stores the bar codes of the vertices of a cycle of the configuration
+ * graph, in the order of its arcs, as masks
+ *
+ *     G: the configuration graph
+ *
+ * cycle: the cycle of the configuration graph
+ *
+ *   map: a mapping from a vertex (configuration graph) to a bar code
+ *
+ *     k: the number of lines of the hexagonal grid
+ *
+ *   bar: where the bar codes are stored
+ */
+void cycle_barcodes(SmartDigraph &G, Path<SmartDigraph> &cycle, node **map,
+		    int k, vector<uint64_t> *bar)
+{
+  int *c;
+  int j;
+
+  bar->clear();
+  for (Path<SmartDigraph>::ArcIt arco(cycle); arco != INVALID; ++arco)
+    {
+      c = map[G.id(G.source(arco))]->v->bar;
+      bar->push_back(0);
+
+      for (j = 0; j < k * AMT_COLUMNS; j++)
+	if (c[j] == 1)
+	  bar->back() |= 1ULL << j;
+    }
+}
+
+
+/*
+ * Function: decode_pattern
+ * ------------------------
+ * Converts the bar codes of a cycle of the configuration graph into the
+ * pattern of the identifying code: the first bar gives the columns 0 and
+ * 1 of the pattern, and each bar the AMT_OVERLAP columns after the ones
+ * of the previous bar (its first columns overlap the previous bar)
+ *
+ *       k: the number of lines of the hexagonal grid
+ *
+ *     bar: the bar codes of the cycle, in the order of its arcs
+ *
+ * pattern: where the pattern of the code is stored (hkcode.h)
+ */
+void decode_pattern(int k, const vector<uint64_t> &bar, hk_pattern *pattern)
+{
+  long long pattern_size, density_gcd;
+  int i, j, h;
+
+  pattern->k = k;
+  pattern->columns = AMT_COLUMNS + AMT_OVERLAP * ((int) bar.size() -2);
+  pattern->vertices.clear();
+
+  for (h = 0; h < (int) bar.size(); h++)
+    for (i = 0; i < k; i++)
+      for (j = AMT_OVERLAP; j < AMT_COLUMNS; j++)
+	if ((bar[h] >> (i * AMT_COLUMNS + j) & 1) == 1)
+	  pattern->vertices.push_back(make_pair(j - AMT_OVERLAP +
+						h * AMT_OVERLAP, i +1));
+
+  // the density is the exact fraction (vertices in the code) / (vertices
+  // in the pattern), reduced to its lowest terms
+  pattern_size = (long long) pattern->columns * k;
+  density_gcd = greatest_common_divisor(pattern->vertices.size(),
+					pattern_size);
+  pattern->density_num = pattern->vertices.size() / density_gcd;
+  pattern->density_den = pattern_size / density_gcd;
+}
+
+
+/*
+ * Function: library_barcodes
+ * --------------------------
+ * Generates the bar codes of H_k for libhkcode (hk_build_barcodes)
+ *
+ *             k: the number of lines of the hexagonal grid
+ *
+ * row_extension: 1 to build the bar codes line by line, otherwise, 0
+ *
+ *      barcodes: where the bar codes are stored
+ *
+ * returns: 1 if the bar codes were generated, otherwise, 0
+ */
+int library_barcodes(int k, int row_extension, hk_barcodes *barcodes)
+{
+  linked_list l;
+  barcode_table table;
+  hk_checker specialized;
+  const hk_checker *checker;
+  int generated;
+
+  if (k < 2 || k * AMT_COLUMNS > 64)
+    return 0;
+
+  checker = NULL;
+  if (select_checker<AMT_COLUMNS, AMT_OVERLAP>(k, &specialized) == 1)
+    checker = &specialized;
+
+  init_list(&l, k, AMT_COLUMNS);
+  table.lines = 0;
+  table.tested = 0;
+
+  if (row_extension == 1)
+    generated = extend_all_barcodes(&l, k, &table);
+  else
+    generated = generate_all_barcodes(&l, k, AMT_COLUMNS, checker, NULL,
+				      NULL);
+
+  barcodes->bars = HK_BARS_6;
+  barcodes->k = k;
+  barcodes->width = AMT_COLUMNS;
+  barcodes->overlap = AMT_OVERLAP;
+  list_barcodes(&l, &barcodes->bar);
+
+  deallocate_list(&l);
+  return (generated == 0) ? 0 : 1;
+}
+
+
+/*
+ * Function: library_graph
+ * -----------------------
+ * Builds the configuration graph of a list of bar codes for libhkcode
+ * (hk_build_graph); the vertex with id i is the bar code i
+ *
+ * barcodes: the bar codes
+ *
+ *    graph: where the graph is stored, in CSR form
+ *
+ * returns: 1 if the graph was built, otherwise, 0
+ */
+int library_graph(const hk_barcodes &barcodes, hk_graph *graph)
+{
+  linked_list l;
+  SmartDigraph G;
+  node **map;
+  hk_checker specialized;
+  const hk_checker *checker;
+  int built;
+
+  checker = NULL;
+  if (select_checker<AMT_COLUMNS, AMT_OVERLAP>(barcodes.k,
+					       &specialized) == 1)
+    checker = &specialized;
+
+  init_list(&l, barcodes.k, AMT_COLUMNS);
+  if (append_barcodes(&l, barcodes.bar.data(), barcodes.bar.size()) == 0)
+    {
+      deallocate_list(&l);
+      return 0;
+    }
+
+  map = new (nothrow) node*[l.size];
+  if (map == NULL)
+    {
+      deallocate_list(&l);
+      return 0;
+    }
+
+  allocate_vertex_config_graph(&G, &l, map);
+  SmartDigraph::ArcMap<int> weight(G);
+
+  built = allocate_edge_config_graph(&G, &l, map, barcodes.k, &weight, -1,
+				     checker, NULL, NULL, NULL);
+  if (built == 1)
+    {
+      graph->bars = HK_BARS_6;
+      graph->k = barcodes.k;
+      graph->width = AMT_COLUMNS;
+      graph->overlap = AMT_OVERLAP;
+      config_graph_arrays(G, map, barcodes.k, &graph->bar,
+			  &graph->node_weight);
+      csr_arcs(G, countNodes(G), &graph->offsets, &graph->targets);
+    }
+
+  delete[] map;
+  deallocate_list(&l);
+  return built;
+}
+
+
+/*
+ * Function: run_anytime_mmc
+ * -------------------------
+ * Creates the edges of the configuration graph in increasing order of
+ * weight and, after the edges of each weight, runs the MMC algorithm on
+ * the graph built so far and prints the best code found. Stops as soon
+ * as the code reaches the target density
+ *
+ *       G: the configuration graph, with its vertices and no edges
+ *
+ *       l: linke list with bar codes
+ *
+ *     map: a mapping from a vertex (configuration graph) to a bar code
+ *
+ *       k: the number of lines of the hexagonal grid
+ *
+ *  weight: where the weights of the edges are stored
+ *
+ * options: the options given in the command line (engine and target)
+ *
+ * checker: the checkers specialized for k (may be NULL)
+ *
+ *     mmc: where the best cycle found is stored
+ *
+ * metrics: where the number of pairs of bar codes tested is added (may
+ *          be NULL)
+ *
+ * returns: the engine used by the last run of the MMC algorithm
+ */
+mmc_engine run_anytime_mmc(SmartDigraph *G, linked_list *l, node **map,
+			   int k, SmartDigraph::ArcMap<int> *weight,
+			   const hk_options *options, const hk_checker *checker,
+			   mmc_result *mmc, run_metrics *metrics)
+{
+  mmc_engine engine;
+  vector<uint64_t> cycle_bars; // the bar codes of the cycle found
+  hk_pattern pattern;          // the code given by the cycle
+  int w, amt_arcs;
+
+  engine = options->engine;
+  mmc->found = 0;
+  amt_arcs = 0;
+
+  // an edge has weight at most k * (NEIGHBOORHOD_SIZE -2), the vertices
+  // in the columns of the target which are not overlaped
+  for (w = 0; w <= k * (NEIGHBOORHOD_SIZE -2); w++)
+    {
+      if (allocate_edge_config_graph(G, l, map, k, weight, w, checker,
+				     NULL, NULL, metrics) == 0)
+	{
+	  mmc->found = 0;
+	  return engine;
+	}
+
+      // no edge of this weight, the best cycle does not change
+      if (countArcs(*G) == amt_arcs)
+	continue;
+
+      amt_arcs = countArcs(*G);
+      engine = run_mmc(*G, *weight, options->engine, mmc);
+
+      cout << "Edges of weight up to " << w << ": " << amt_arcs << " edges\t";
+      if (mmc->found == 0)
+	{
+	  cout << "no cycle\n";
+	  continue;
+	}
+
+      cycle_barcodes(*G, mmc->cycle, map, k, &cycle_bars);
+      decode_pattern(k, cycle_bars, &pattern);
+
+      cout << "columns: " << pattern.columns << "\t"
+	   << "density: " << (double) pattern.density_num /
+	pattern.density_den
+	   << " (" << pattern.density_num << "/" << pattern.density_den
+	   << ")\n";
+      print_pattern(cout, pattern);
+      cout << "\n";
+
+      if (pattern.density_num * options->target_den <=
+	  options->target_num * pattern.density_den)
+	{
+	  cout << "Target density reached!\n\n";
+	  return engine;
+	}
+    }
+
+  cout << "Target density not reached; the code found is optimal\n\n";
+  return engine;
+}
+
+
+/*
+ * Function: run_differential
+ * --------------------------
+ * Checks the fast kernels (the specialized checkers and the row
+ * extension) against the reference ones, over the hexagonal grid
+ * (differential.h)
+ *
+ * num_lines: the number of lines of the hexagonal grid
+ *   checker: the checkers specialized for num_lines (NULL if there are
+ *            none)
+ *      seed: the seed of the random pairs of bar codes
+ *
+ * returns: 1 if all the checks passed, otherwise, 0
+ */
+int run_differential(int num_lines, const hk_checker *checker, uint64_t seed)
+{
+  linked_list reference;      // the bar codes of the reference enumeration
+  linked_list fast;           // the bar codes of an enumeration checked
+  barcode_table table;        // the open bars of the row extension
+  diff_report report;
+  vector<uint64_t> reference_bars, fast_bars;
+  vector<uint8_t> lines;      // the bar codes, one byte per line
+  vector<int> targets;        // the targets of a source in the graph
+  vertex bar_union;           // the union used by check_unon_bars
+  SmartDigraph G;             // the graph built by the fast path
+  node **map;
+  mmc_result mmc;
+  ostringstream detail;
+  uint64_t state;
+  long long expected_bars, expected_arcs, mismatches, p;
+  long long code_vertices, code_columns, pattern_size;
+  int counted, n, u, v, s, amt_sources, first_u, first_v, valid;
+
+  cout << "Differential check of H" << num_lines << " (seed " << seed
+       << ")\n";
+  report.checks = 0;
+  report.failures = 0;
+  expected_bars = expected_arcs = 0;
+
+  // the reference enumeration, and the numbers of bar codes and arcs
+  // counted by the transfer matrices
+  init_list(&reference, num_lines, AMT_COLUMNS);
+  if (generate_all_barcodes(&reference, num_lines, AMT_COLUMNS, NULL, NULL,
+			    NULL) == 0 ||
+      create_bar(&bar_union, num_lines * (2 * AMT_COLUMNS - AMT_OVERLAP)) == 0)
+    {
+      cerr << "It was not possible to generate the bar codes!\n";
+      deallocate_list(&reference);
+      return 0;
+    }
+  list_barcodes(&reference, &reference_bars);
+  n = reference.size;
+
+  counted = diff_counts(AMT_COLUMNS, 2 * AMT_COLUMNS - AMT_OVERLAP,
+			num_lines, &expected_bars, &expected_arcs);
+  if (counted == 1)
+    diff_check(&report, "number of bar codes (transfer matrices)",
+	       (n == expected_bars) ? 1 : 0,
+	       to_string(n) + " of " + to_string(expected_bars));
+
+  // the same bar codes, in the same order, by the fast enumerations
+  if (checker != NULL)
+    {
+      init_list(&fast, num_lines, AMT_COLUMNS);
+      generate_all_barcodes(&fast, num_lines, AMT_COLUMNS, checker, NULL,
+			    NULL);
+      list_barcodes(&fast, &fast_bars);
+      diff_barcodes(&report, "bar codes (specialized checker)",
+		    reference_bars, fast_bars);
+      deallocate_list(&fast);
+    }
+
+  table.lines = 0;
+  table.tested = 0;
+  init_list(&fast, num_lines, AMT_COLUMNS);
+  extend_all_barcodes(&fast, num_lines, &table);
+  list_barcodes(&fast, &fast_bars);
+  diff_barcodes(&report, "bar codes (row extension)", reference_bars,
+		fast_bars);
+  deallocate_list(&fast);
+
+  // random pairs of bar codes, checked by both kernels
+  map = new (nothrow) node*[n];
+  if (map == NULL)
+    {
+      deallocate_bar(&bar_union);
+      deallocate_list(&reference);
+      return 0;
+    }
+
+  allocate_vertex_config_graph(&G, &reference, map);
+
+  state = seed;
+  if (checker != NULL)
+    {
+      lines.resize((size_t) n * num_lines);
+      for (u = 0; u < n; u++)
+	checker_lines(map[u]->v->bar, num_lines, AMT_COLUMNS,
+		      &lines[(size_t) u * num_lines]);
+
+      mismatches = 0;
+      first_u = first_v = 0;
+      for (p = 0; p < DIFFERENTIAL_PAIRS; p++)
+	{
+	  u = (int) (bench_random(&state) % (uint64_t) n);
+	  v = (int) (bench_random(&state) % (uint64_t) n);
+
+	  valid = check_unon_bars(map[u]->v, map[v]->v, &bar_union,
+				  reference.vertex_size, num_lines);
+	  if (valid != checker->seam_valid(&lines[(size_t) u * num_lines],
+					   &lines[(size_t) v * num_lines]) &&
+	      mismatches++ == 0)
+	    {
+	      first_u = u;
+	      first_v = v;
+	    }
+	}
+
+      detail << mismatches << " of " << DIFFERENTIAL_PAIRS << " pairs differ";
+      if (mismatches > 0)
+	detail << ", the first one is " << first_u << " -> " << first_v;
+      diff_check(&report, "unions of random pairs (specialized checker)",
+		 (mismatches == 0) ? 1 : 0, detail.str());
+    }
+
+  // the graph built by the fast path: its number of arcs, the arcs of
+  // some sources and the density of its minimum mean cycle
+  if (counted == 0 || expected_arcs > DIFFERENTIAL_MAX_ARCS)
+    cout << "  arcs and density: not checked (the graph is too large)\n";
+  else
+    {
+      SmartDigraph::ArcMap<int> weight(G);
+
+      if (allocate_edge_config_graph(&G, &reference, map, num_lines, &weight,
+				     -1, checker, NULL, NULL, NULL) == 0)
+	{
+	  cerr << "It was not possible to create the edges of the"
+	       << " configuration graph!\n";
+	  delete[] map;
+	  deallocate_bar(&bar_union);
+	  deallocate_list(&reference);
+	  return 0;
+	}
+
+      diff_check(&report, "number of arcs (transfer matrices)",
+		 (countArcs(G) == expected_arcs) ? 1 : 0,
+		 to_string(countArcs(G)) + " of " + to_string(expected_arcs));
+
+      // every source of a small graph, otherwise random sources
+      amt_sources = n;
+      if ((long long) n * n > DIFFERENTIAL_FULL_PAIRS)
+	amt_sources = DIFFERENTIAL_SOURCES;
+
+      mismatches = 0;
+      first_u = 0;
+      for (s = 0; s < amt_sources; s++)
+	{
+	  u = (amt_sources == n) ? s :
+	    (int) (bench_random(&state) % (uint64_t) n);
+
+	  targets.clear();
+	  for (SmartDigraph::OutArcIt a(G, G.nodeFromId(u)); a != INVALID; ++a)
+	    targets.push_back(G.id(G.target(a)));
+	  sort(targets.begin(), targets.end());
+
+	  for (v = 0, p = 0; v < n; v++)
+	    if (check_unon_bars(map[u]->v, map[v]->v, &bar_union,
+				reference.vertex_size, num_lines) == 1)
+	      {
+		if (p >= (long long) targets.size() || targets[p] != v)
+		  break;
+		p++;
+	      }
+
+	  if ((v < n || p != (long long) targets.size()) && mismatches++ == 0)
+	    first_u = u;
+	}
+
+      detail.str("");
+      detail << mismatches << " of " << amt_sources << " sources differ";
+      if (mismatches > 0)
+	detail << ", the first one is " << first_u;
+      diff_check(&report, "arcs of the graph (reference check)",
+		 (mismatches == 0) ? 1 : 0, detail.str());
+
+      // the density of the code saved by a previous run
+      run_mmc(G, weight, MMC_AUTO, &mmc);
+      pattern_size = (long long) num_lines *
+	(AMT_COLUMNS + AMT_OVERLAP * (mmc.size -2));
+
+      if (saved_code_density(DIFFERENTIAL_CODES_DIR "/CodigoH" +
+			     to_string(num_lines) + "GrafoConfig.txt",
+			     num_lines, &code_vertices, &code_columns) == 0)
+	cout << "  density: not checked (there is no saved code)\n";
+      else
+	diff_check(&report, "density (saved code)",
+		   (mmc.found == 1 && mmc.cost * num_lines * code_columns ==
+		    code_vertices * pattern_size) ? 1 : 0,
+		   to_string(mmc.cost) + "/" + to_string(pattern_size) +
+		   " and " + to_string(code_vertices) + "/" +
+		   to_string(num_lines * code_columns));
+    }
+
+  cout << report.checks << " checks, " << report.failures << " failed\n";
+
+  delete[] map;
+  deallocate_bar(&bar_union);
+  deallocate_list(&reference);
+  return (report.failures == 0) ? 1 : 0;
+}
+
+/*
+ * Function: run_mmc_step
+ * ----------------------
+ * Finds a minimum mean cycle of the configuration graph with the
+ * algorithm chosen by the options (or checks the certificate, or finds
+ * the closed walk with the smallest mean among the walks with bounded
+ * length)
+ *
+ *                G: the configuration graph
+ *
+ *                l: list of bar codes (for --target-density)
+ *
+ *              map: a mapping from a vertex to its bar code
+ *
+ *                k: the number of lines of the hexagonal grid
+ *
+ *           weight: the weights of the edges
+ *
+ *          options: the options given in the command line
+ *
+ *          checker: the checkers specialized for k (may be NULL)
+ *
+ * certificate_path: the file with the certificate (--check-certificate)
+ *
+ *       max_length: the number of arcs of the longest closed walk
+ *                   (--max-period)
+ *
+ *         external: the arcs written to disk, with the CSR file and the
+ *                   memory of the out-of-core MMC (NULL without
+ *                   --external)
+ *
+ *      period_cost: where the minimum weight of a closed walk with each
+ *                   number of arcs is stored (--max-period)
+ *
+ *          pruning: where the arcs eliminated are counted (--prune)
+ *
+ *           engine: where the algorithm actually run is stored
+ *
+ *              mmc: where the cycle found is stored
+ *
+ *          metrics: the metrics of the run (--target-density)
+ *
+ * returns: 1 if the algorithm was run, otherwise (the edges of the
+ *          out-of-core graph could not be read), 0
+ */
+int run_mmc_step(SmartDigraph *G, linked_list *l, node **map, int k,
+		 SmartDigraph::ArcMap<int> *weight, const hk_options *options,
+		 const hk_checker *checker, const string &certificate_path,
+		 int max_length, const external_graph *external,
+		 vector<long long> *period_cost, pruning_stats *pruning,
+		 mmc_engine *engine, mmc_result *mmc, run_metrics *metrics)
+{
+  external_csr external_file; // the arcs read by the out-of-core MMC
+
+  *engine = options->engine;
+
+  if (options->check == 1)
+    check_certificate(certificate_path.c_str(), *G, *weight, k, AMT_COLUMNS,
+		      AMT_OVERLAP, mmc);
+  else if (options->max_period > 0)
+    bounded_period_dp(*G, *weight, max_length, period_cost, mmc);
+  else if (options->target_den > 0)
+    *engine = run_anytime_mmc(G, l, map, k, weight, options, checker, mmc,
+			      metrics);
+  else if (options->prune == 1)
+    *engine = run_mmc_pruned(*G, *weight, options->engine, mmc, pruning);
+  else if (external != NULL)
+    {
+      *engine = MMC_LAWLER;
+
+      if (external_open(external->path, k, AMT_COLUMNS, AMT_OVERLAP,
+			external->budget, &external_file) == 0 ||
+	  external_mmc(&external_file, G, weight, mmc) == 0)
+	{
+	  cerr << "It was not possible to read the edges from "
+	       << external->path << "!\n";
+	  external_close(&external_file);
+	  return 0;
+	}
+
+      external_close(&external_file);
+    }
+  else
+    *engine = run_mmc(*G, *weight, options->engine, mmc);
+
+  return 1;
+}
+}
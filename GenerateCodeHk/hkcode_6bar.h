@@ -0,0 +1,256 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   The kernels of libhkcode (see hkcode.h) for the bars with 4 columns,
+   overlapping 2, used by Hk_lemon_eng_6bar.cc: the generation of the
+   bar codes (also line by line, for --row-extension), the construction
+   of the configuration graph, the checkers of the unions of bar codes,
+   decode_pattern and the choice of the MMC algorithm. They are in the
+   namespace hk6, since the kernels of the other bars (hkcode_8bar.h)
+   have the same names, and each one is described with its
+   implementation in hkcode_6bar.cc.
+*/
+
+#ifndef HKCODE_6BAR_H
+#define HKCODE_6BAR_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <new>
+#include <lemon/list_graph.h>
+#include <lemon/path.h>
+#include <lemon/smart_graph.h>
+#include <lemon/full_graph.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include "mmc_engine.h"
+#include "options.h"
+#include "arc_pruning.h"
+#include "bounded_period.h"
+#include "certificate.h"
+#include "barcode_extension.h"
+#include "transfer_count.h"
+#include "specialized_checker.h"
+#include "csr_graph.h"
+#include "hkcode.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// defines the maximum number of vertices in the closed neighborhood of a
+// vertex in hexagonal grid with finite number of rows
+#define NEIGHBOORHOD_SIZE 4
+
+// define the amount of columns in a 4-bar
+#define AMT_COLUMNS 4
+
+// define the amount of columns that two 4-bars overlap
+#define AMT_OVERLAP 2
+
+
+namespace hk6
+{
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: vertex
+ * --------------
+ * Represents a vertex in configuration graph
+ *
+ *    bar: bit array that indicantes which vertex, from the
+ *         hexagonal grid H_k, belongs to the code; which are represented
+ *         in the following way (for a 4-bar)
+ *         ...
+ *         line 3: 12-13-14-15
+ *                 |      |
+ *         line 2: 8--9--10-11
+ *                    |     |
+ *         line 1: 4--5--6--7
+ *                 |     |
+ *         line 0: 0--1--2--3
+ *
+ * weight: the number of vertices that belongs to the code
+ */
+struct vertex
+{
+  int    *bar;
+  double weight;
+};
+
+typedef struct vertex vertex;
+
+
+/*
+ * Struct: node
+ * ------------
+ * Represents a node of a linked list
+ *
+ *   next: points to the next node of the list
+ *
+ * vertex: points to a vertex in configuration graph (struct vertex)
+ */
+struct node
+{
+  struct node *next;
+  vertex      *v;
+};
+
+typedef struct node node;
+
+
+/*
+ * Struct: linked_list
+ * -------------------
+ * Represents a linked list, where each node points to a vertex in
+ * configuration graph
+ *
+ *        size: the number of nodes in the list
+ *
+ * vertex_size: the number of vertices that a vertex, in configuration
+ *              graph, contains (number of columns = size of l-bar x
+ *                               number of lines)
+ *
+ *       first: points to the first node of the list
+ *
+ *        last: points to the last element of the list
+ */
+struct linked_list
+{
+  int size;
+  int vertex_size;
+  node  *first;
+  node  *last;
+};
+
+typedef struct linked_list linked_list;
+
+
+/*
+ * Struct: config_vertex
+ * ---------------------
+ * Represents the line, column and identifier of a vertex in the
+ * hexagonal grid. This struct is used to map the vertices from the bar
+ * to the struct of the hexagonal grid and check if a set of vertices
+ * is an identifying code; restricted to the vertices of the bar
+ * (discarting the firts and last columns)
+ *
+ *       line: the line of the vertex in hexagonal grid
+ *
+ *     column: the column of th vertex in hexagonal grid
+ *
+ * identifier: the identifier of a vertex, such that:
+ *             identifier[] = -1 -> there is no vertex
+ *             identifier[] =  i -> id of the vertex that belongs
+ *                                  to the code
+ */
+struct config_vertex
+{
+  int line;
+  int column;
+  int identifier[NEIGHBOORHOD_SIZE] = {-1, -1, -1, -1};
+                        // o identifier tem 4 posições pois estamos
+                        // trabalhando com o conceito de 1-código de
+                        // identificação
+};
+
+typedef struct config_vertex config_vertex;
+
+
+/* Function Declaration - - - - - - - - - - - - - - - - - - - - - - - - */
+void init_bar(vertex *v);
+
+int create_bar(vertex *v, int size);
+
+void deallocate_bar(vertex *v);
+
+void print_bar(vertex *v, int size);
+
+int generate_all_bars(vertex* v, int size);
+
+int compute_bar_weight(vertex *v, int size);
+
+void copy_bar(vertex *v1, vertex *v2, int size);
+
+void init_list(linked_list *l, int k, int z);
+
+void deallocate_list(linked_list *l);
+
+int append_list(linked_list *l, vertex *v);
+
+void print_list(linked_list *l);
+
+void allocate_hexagonal_grid(int k, int z, lemon::SmartGraph *H);
+
+int identifier_size(int *id, int size);
+
+bool equal_identifier(int *id1, int *id2, int size);
+
+void list_barcodes(linked_list *l, std::vector<uint64_t> *bar);
+
+int generate_all_barcodes(linked_list *l, int k, int z,
+			  const hk_checker *checker, checkpoint *ckpt,
+			  run_metrics *metrics);
+
+int append_barcodes(linked_list *l, const uint64_t *barcodes, size_t amt);
+
+int extend_all_barcodes(linked_list *l, int k, barcode_table *cache);
+
+int check_unon_bars(vertex *v1, vertex *v2, vertex *new_vertex, int size,
+		    int k);
+
+void allocate_vertex_config_graph(lemon::SmartDigraph *G, linked_list *l,
+				  node **map);
+
+int compute_weigth_barcode(int *bar, int k, int z);
+
+int allocate_edge_config_graph(lemon::SmartDigraph *G, linked_list *l,
+			       node **map, int k,
+			       lemon::SmartDigraph::ArcMap<int> *weight,
+			       int target_weight, const hk_checker *checker,
+			       external_graph *external, checkpoint *ckpt,
+			       run_metrics *metrics);
+
+void config_graph_arrays(lemon::SmartDigraph &G, node **map, int k,
+			 std::vector<uint64_t> *bar,
+			 std::vector<int32_t> *node_weight);
+
+long long greatest_common_divisor(long long a, long long b);
+
+void cycle_barcodes(lemon::SmartDigraph &G,
+		    lemon::Path<lemon::SmartDigraph> &cycle, node **map, int k,
+		    std::vector<uint64_t> *bar);
+
+void decode_pattern(int k, const std::vector<uint64_t> &bar,
+		    hk_pattern *pattern);
+
+int library_barcodes(int k, int row_extension, hk_barcodes *barcodes);
+
+int library_graph(const hk_barcodes &barcodes, hk_graph *graph);
+
+mmc_engine run_anytime_mmc(lemon::SmartDigraph *G, linked_list *l, node **map,
+			   int k, lemon::SmartDigraph::ArcMap<int> *weight,
+			   const hk_options *options,
+			   const hk_checker *checker, mmc_result *mmc,
+			   run_metrics *metrics);
+
+int run_differential(int num_lines, const hk_checker *checker, uint64_t seed);
+
+int run_mmc_step(lemon::SmartDigraph *G, linked_list *l, node **map, int k,
+		 lemon::SmartDigraph::ArcMap<int> *weight,
+		 const hk_options *options, const hk_checker *checker,
+		 const std::string &certificate_path, int max_length,
+		 const external_graph *external,
+		 std::vector<long long> *period_cost, pruning_stats *pruning,
+		 mmc_engine *engine, mmc_result *mmc, run_metrics *metrics);
+
+}
+
+#endif
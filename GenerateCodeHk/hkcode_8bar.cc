@@ -0,0 +1,1688 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   The kernels of libhkcode for the bars with 4 columns, not overlapping
+   (see hkcode_8bar.h)
+*/
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include "hkcode_8bar.h"
+
+
+/* Namespaces - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+using namespace std;
+using namespace lemon;
+using namespace std::chrono;
+
+
+namespace hk8
+{
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: allocate_vertex
+ * -------------------------
+ * Allocates a vertex (struct vertex) of configuration graph
+ *
+ * vertex: a vertex in configuration graph
+ *
+ *   size: the number of vertices, from the hexagonal grid, in a
+ *         vertex of the configuration graph
+ *
+ *  return: 1 when the vertex was allocated, otherwise, 0
+ */
+int allocate_vertex(vertex *v, int size)
+{
+  v->weight = 0;
+  v->bar = NULL;
+  v->bar = new (nothrow) int[size];
+
+  if (v->bar == NULL)
+      return 0;
+
+  return 1;
+}
+
+/*
+ * Function: deallocate_vertex
+ * ---------------------------
+ * Deallocate a vertex (configuration graph)
+ *
+ * vertex: a vertex of the configuration graph
+ */
+void deallocate_vertex(vertex *v)
+{
+  v->weight = 0;
+
+  if (v->bar != NULL)
+    delete[] v->bar;
+
+  v->bar = NULL;
+}
+
+/*
+ * Function: copy_vertex
+ * ---------------------
+ * Copies a bar code, of size tam, to a vertex of the configuration graph
+ *
+ *    v: points to a vertex (configuration graph)
+ * size: the number of vertices in v
+ *    u: array of integer, of the same size of v, which represents a bar
+ *       code
+ */
+void copy_vertex(vertex *v, int size, int *u)
+{
+  int i;
+
+  if (v->bar != NULL)
+    {
+      for (i = 0; i < size; i++)
+	{
+	  v->bar[i] = u[i];
+
+	  // if the vertex u[i] belongs to the code, then v-> weight is
+	  // incremented in one unit
+	  if (u[i] == 1)
+	    v->weight++;
+	}
+
+      v->weight = v->weight;
+    }
+}
+
+/*
+ * Function: print_vertex
+ * ----------------------
+ * Output to stdout the data of a vertex (configuration graph)
+ *
+ *    v: points to a vertex (configuration graph)
+ * size: the number of vertex in v
+ */
+void print_vertex(vertex *v, int size)
+{
+  int i;
+
+  printf("\nDensity: %f\n", v->weight);
+  printf("[");
+
+  for (i = 0; i < size -1; i ++)
+    printf("%d, ", v->bar[i]);
+
+  if (size == 0)
+    printf("]");
+
+  else
+    printf("%d]\n", v->bar[size -1]);
+}
+
+
+/*
+ * Function: init_list
+ * -------------------
+ * Initializes a linked list l
+ *
+ * l: points to a linked list
+ * k: number of lines of the hexagonal grid
+ * z: number of columns of the hexagonal grid
+ */
+void init_list(linked_list *l, int k, int z)
+{
+  l->size = 0;
+  l->vertex_size = z * k;
+  l->first = NULL;
+  l->last = NULL;
+}
+
+/*
+ * Function: append_list
+ * ---------------------
+ * Appends an element to a linked list
+ *
+ * l: points to a linked list
+ * c: an array which represents a bar code
+ *
+ * returns: 1 if the element was successfully appended, otherwise, 0
+ */
+int append_list(linked_list *l, int *c)
+{
+  node *element;
+
+  element = NULL;
+  element = new (nothrow) node;
+
+  if (element == NULL)
+    return 0;
+
+  element->v = NULL;
+  element->v = new (nothrow) vertex;
+
+  if (element->v == NULL)
+    {
+      delete element;
+      element = NULL;
+      return 0;
+    }
+
+  if (allocate_vertex(element->v, l->vertex_size) == 0)
+    {
+      delete element;
+      element = NULL;
+      return 0;
+    }
+
+  copy_vertex(element->v, l->vertex_size, c);
+  element->next = NULL;
+
+  if (l->size == 0)
+    l->first = element;
+
+  else
+    l->last->next = element;
+
+  l->last = element;
+  l->size++;
+  return 1;
+}
+
+/*
+ * Function: deallocate_list
+ * -------------------------
+ * Deallocate a linked list l
+ *
+ * l: points to a linked lists
+ */
+void deallocate_list(linked_list *l)
+{
+  node *element;
+  node *aux;
+
+  if (l->size != 0)
+    {
+      element = l->first;
+
+      while (element != NULL)
+	{
+	  deallocate_vertex(element->v);
+	  delete element->v;
+	  element->v = NULL;
+	  aux = element;
+	  element = element->next;
+	  delete aux;
+	}
+
+      l->first = NULL;
+      l->last = NULL;
+      l->size = 0;
+    }
+}
+
+/*
+ * Function: print_list
+ * --------------------
+ * Ouputs to stdout the data of a linked list l
+ *
+ * l: points to a linked list
+ */
+void print_list(linked_list *l)
+{
+  node *element;
+
+  printf("Size: %d\t Size of a vertex (configuration graph): %d\n",
+	 l->size, l->vertex_size);
+  element = l->first;
+
+  while (element != NULL)
+    {
+      print_vertex(element->v, l->vertex_size);
+      element = element->next;
+    }
+}
+
+
+/*
+ * Function: next_config
+ * ---------------------
+ * Generates all permutations of the vertices, in the bar, in the code
+ *
+ * c: an array, of integers, which represents the vertices in a bar
+ *
+ * retuns: one of the possibile permutation of the vertices in the code
+ */
+int next_config(int* c, int size) {
+  int k;
+
+  k = size -1;
+
+  while (k >= 0)
+    {
+      if (c[k] == 1)
+	c[k--] = 0;
+
+      else
+	{
+	  c[k] = 1;
+	  break;
+	}
+    }
+
+  return k;
+}
+
+
+/*
+ * Function: identifier_size
+ * -------------------------
+ * Computes the number of vertices in an identifier
+ *
+ *   id: an array of integers that represents an identifier
+ * size: the number of vertices in the array id
+ *
+ * returns: the number of vertices in the array id which are in the
+ *          code
+ */
+int identifier_size(int *id, int size)
+{
+  int i;
+  int size_id;
+
+  size_id = 0;
+
+  for (i = 0; i < size; i++)
+    if (id[i] != -1) // -1 means that there is no vertex
+      size_id++;
+
+  return size_id;
+}
+
+
+/*
+ * Function: equal_identifier
+ * --------------------------
+ * Check if two identifiers have the same vertices, that is, if they are
+ * equal
+ *
+ *  id1: array of integers that represents the vertices of an identifier
+ *
+ *  id2: array of integers that represents the vertices of an identifier
+ *
+ * size: the number of vertices in a identifier (it applies to id1 and id2)
+ *
+ * returns: true if id1 == id2, otherwise, false
+ */
+bool equal_identifier(int *id1, int *id2, int size)
+{
+  int qtde_elementos_iguais;
+  int size_id1, size_id2;
+  int i, j;
+
+  qtde_elementos_iguais = 0;
+  i = 0;
+
+  // computes the actual size of the identifiers id1 and id2
+  // this is done because an identifier has a fixed size of size
+  // and when it is created, the identifier is initialized with -1
+  // meaning that no vertex was assigned to the identifier
+  size_id1 = 0;
+  size_id2 = 0;
+
+  for (i = 0; i < size; i++)
+    {
+      if (id1[i] != -1)
+	size_id1++;
+
+      if (id2[i] != -1)
+	size_id2++;
+    }
+
+  // if size_d1 != size_id2, as id1 and id2 are not empty, then there is an
+  // element from id1 which does not belogs to id2, or vice-versa; then
+  // id1 and id2 are distinct
+  if (size_id1 != size_id2)
+    return false;
+
+  // note that, from this part, size_id1 = size_id2
+  i = 0;
+  while (i < size_id1)
+    {
+      j = 0;
+
+      while (j < size_id2)
+	{
+	  if (id1[i] == id2[j])
+	    {
+	      qtde_elementos_iguais++;
+	    }
+
+	  j++;
+	}
+
+      i++;
+    }
+
+  if (qtde_elementos_iguais == size_id1)
+    return true;
+
+  return false;
+}
+
+
+/*
+ * Function: obtain_weigth
+ * -----------------------
+ * Computes the number of vertices, in bar of size tam, belongs to the
+ * code
+ *
+ *   c: an array which represents a bar o length tam
+ * tam: the number of vertices in the array c
+ *
+ * returns: the number of elements in c which belongs to the code
+ */
+int obtain_weigth(int *c, int size)
+{
+  int i;
+  int weight = 0;
+
+  for (i = 0; i < size; i++)
+    {
+      if (c[i] == 1)
+	weight++;
+    }
+
+  return weight;
+}
+
+
+/*
+ * Function: create_vertex_graph_cfg
+ * ---------------------------------
+ * Creates a vertex of configuration graph
+ *
+ * k: number of lines of the hexagonal grid
+ * z: number of columns of the hexagonal grid
+ * H: points to a SmathGraph
+ */
+void create_vertex_graph_cfg(int k, int z, SmartGraph *H)
+{
+  int size;
+  int parity;
+  int i, j;
+
+  // number of vertices, from the hexagonal grid, that a vertex from
+  // configuration graph has
+  size = k * z;
+
+  // creates the vertices
+  for (i = 0; i < size; i++)
+    H->addNode();
+
+  // add edges between vertices in the same line
+  for(i = 0; i < size; i = i +z)
+    for(j = 0; j < z -1; j++)
+      H->addEdge(H->nodeFromId(i +j), H->nodeFromId(i +j +1));
+
+  // add the edges that represents the columns of the hexagonal grid
+  // we assume that we start at line 0, and also, even lines has
+  // parity -1
+  parity = -1;
+
+  // loop condition is i < size -z because, at each step we advance z
+  // vertices (number of vertices in a column)
+  // when z = 4 we got the following structure
+  for (i = 0; i < size -z; i = i +z)
+    {
+      if (parity == -1)
+	j = 0;
+      else
+	j = 1;
+
+      while (j < z)
+	{
+	  H->addEdge(H->nodeFromId(i +j), H->nodeFromId(i +z +j));
+	  j = j +2;
+	}
+
+      parity = parity * (-1);
+    }
+}
+
+
+/*
+ * Function: list_barcodes
+ * -----------------------
+ * Stores the bar codes of a list as masks (bit i is the vertex i of the
+ * bar), in the order of the list
+ *
+ * linked_list: list which contains all barcodes
+ *
+ *         bar: where the bar codes are stored
+ */
+void list_barcodes(linked_list *l, vector<uint64_t> *bar)
+{
+  node *element;
+  size_t j;
+  int i;
+
+  bar->assign(l->size, 0);
+
+  for (element = l->first, j = 0; j < bar->size();
+       element = element->next, j++)
+    for (i = 0; i < l->vertex_size; i++)
+      if (element->v->bar[i] == 1)
+	(*bar)[j] |= 1ULL << i;
+}
+
+
+/*
+ * Function: create_graph_cfg
+ * --------------------------
+ * Creates all the vertices of a configuration graph
+ *
+ * linked_list: list which contains all barcodes
+ *
+ *           k: number of lines of the hexagonal grid
+ *
+ *           z: number of columns of the hexagonal grid
+ *
+ *     checker: the checkers specialized for k (NULL to check the bars
+ *              over the hexagonal grid)
+ *
+ *        ckpt: the checkpoints of the run (NULL if there are none); if a
+ *              checkpoint of the bars was loaded, its bar codes are
+ *              already in the list, and the bars after its cursor are
+ *              tested
+ *
+ *     metrics: where the number of bars tested is added (may be NULL)
+ *
+ * returns: the amount of vertices created
+ */
+int create_graph_cfg(linked_list *l, int k, int z, const hk_checker *checker,
+		     checkpoint *ckpt, run_metrics *metrics)
+{
+  int size;       // the size of the array which represents a bar
+  int *c;         // the array used to represent a bar
+  SmartGraph H;   // graph used to check if a set of vertices is a bar
+                  // code
+  bool valid_bar; // true if a set of vertices is a bar code, otherwise
+		  // is false
+  uint8_t lines[CHECKER_MAX_LINES]; // the bar, one byte per line
+  uint64_t tested;  // the number of bars tested
+  uint64_t resumed; // the number of bars tested before the checkpoint
+  int i, j;
+
+  // allocates the array all the possible barcode of a bar
+  c = nullptr;
+  size = k * z;
+  c = new (nothrow) int[size];
+
+  if (c == nullptr)
+    return 0;
+
+  // initialize the array c with zeros, because 0 means a
+  // vertex, in the bar, boes not belongs to code
+  for (i = 0; i < size; i++)
+    c[i] = 0;
+
+  resumed = 0;
+  if (ckpt != NULL && ckpt->phase == CHECKPOINT_BARS)
+    {
+      resumed = ckpt->cursor;
+      checkpoint_counter(c, size, resumed);
+    }
+  tested = resumed;
+
+  // generates the graph used to check if a set of vertices is a bar code
+  SmartGraph::NodeMap<config_vertex> map_vertice_id(H);
+  create_vertex_graph_cfg(k, z, &H);
+
+  // does a mapping of a vertex, from the bar, to an order pair
+  // (z, k) (column, line) which representes a vertex in hexagonal grid
+  for(i = 0; i < size; i = i +z)
+    for(j = 0; j < z; j++)
+      {
+        map_vertice_id[H.nodeFromId(i +j)].column = j;
+        map_vertice_id[H.nodeFromId(i +j)].line = i/z;
+      }
+
+  // check if a set of vertices is a bar code
+  while (next_config(c, size) >= 0)
+    {
+      // the bars before c were tested
+      tested++;
+      if (ckpt != NULL && tested % CHECKPOINT_BAR_STEP == 0 &&
+	  checkpoint_due(ckpt) == 1)
+	{
+	  list_barcodes(l, &ckpt->bar);
+	  if (save_checkpoint(ckpt, CHECKPOINT_BARS, tested -1, -1,
+			      NULL) == 0)
+	    cerr << "ERRO: It was not possible to save the checkpoint "
+		 << ckpt->path << "!\n";
+	}
+
+      if (checker != NULL)
+	{
+	  checker_lines(c, k, z, lines);
+	  if (checker->bar_valid(lines) == 1)
+	    append_list(l, c);
+
+	  continue;
+	}
+
+      valid_bar = true;
+
+      if (valid_bar == true)
+	{
+	  // builds the identifier for the vertices (discarting the
+	  // first and last columns) in the bar
+	  for (SmartGraph::NodeIt vertex(H); vertex != INVALID;
+	       ++vertex)
+	    {
+	      if (map_vertice_id[vertex].column != 0 &&
+		  map_vertice_id[vertex].column != z -1)
+		{
+		  i = 0;
+
+		  if (c[H.id(vertex)] == 1)
+		    {
+		      map_vertice_id[vertex].identificador[i] =
+			H.id(vertex);
+		      i++;
+		    }
+
+		  for (SmartGraph::IncEdgeIt aresta(H, vertex);
+		       aresta != INVALID; ++aresta)
+		    {
+		      if (H.id(H.u(aresta)) != H.id(vertex) &&
+			  c[H.id(H.u(aresta))] == 1)
+			{
+			  map_vertice_id[vertex].identificador[i] =
+			    H.id(H.u(aresta));
+			  i++;
+			}
+
+		      else if (H.id(H.v(aresta)) != H.id(vertex) &&
+			       c[H.id(H.v(aresta))] == 1)
+			{
+			  map_vertice_id[vertex].identificador[i] =
+			    H.id(H.v(aresta));
+			  i++;
+			}
+		    }
+		}
+	    }
+
+	  // check if the identifiers (dispate the first and last column)
+	  // are not empty
+	  for (SmartGraph::NodeIt vertex(H); vertex != INVALID;
+	       ++vertex)
+	    {
+	      if (map_vertice_id[vertex].column != 0 &&
+		  map_vertice_id[vertex].column != z -1)
+		if (identifier_size(map_vertice_id[vertex].identificador, NEIGHBOORHOD_SIZE) == 0)
+		  valid_bar = false;
+	    }
+	}
+
+      // check if the identifiers are pairwise distinct
+      if (valid_bar == true)
+	{
+	  for (SmartGraph::NodeIt v1(H); v1 != INVALID; ++v1)
+	    {
+	      if (map_vertice_id[v1].column != 0 &&
+		  map_vertice_id[v1].column != z -1)
+		for (SmartGraph::NodeIt v2(H); v2 != INVALID; ++v2)
+		  {
+		    if (H.id(v1) != H.id(v2) &&
+			map_vertice_id[v2].column != 0 &&
+			map_vertice_id[v2].column != z -1)
+		      if (equal_identifier(
+				  map_vertice_id[v1].identificador,
+				  map_vertice_id[v2].identificador,
+				  NEIGHBOORHOD_SIZE) == true)
+			valid_bar = false;
+		  }
+	    }
+	}
+
+      if (valid_bar == true)
+	append_list(l, c);
+
+      // re-initialize the identifiers for the next iteration
+      for (SmartGraph::NodeIt w(H); w != INVALID; ++w)
+	{
+	  map_vertice_id[w].identificador[0] = -1;
+	  map_vertice_id[w].identificador[1] = -1;
+	  map_vertice_id[w].identificador[2] = -1;
+	  map_vertice_id[w].identificador[3] = -1;
+	}
+    }
+
+  if (metrics != NULL)
+    metrics->candidates_tested += (long long) (tested - resumed);
+
+  delete[] c;
+  c = nullptr;
+  return 1;
+}
+
+
+/*
+ * Function: append_barcodes
+ * -------------------------
+ * Appends bar codes given as masks (bit i is the vertex i of the bar) to
+ * the list of bar codes
+ *
+ * linked_list: list which contains all barcodes
+ *
+ *    barcodes: the bar codes
+ *
+ *         amt: the number of bar codes
+ *
+ * returns: 1 if the bar codes were appended, otherwise, 0
+ */
+int append_barcodes(linked_list *l, const uint64_t *barcodes, size_t amt)
+{
+  vector<int> c;             // the array used to represent a bar
+  size_t j;
+  int i;
+
+  c.resize(l->vertex_size);
+
+  for (j = 0; j < amt; j++)
+    {
+      for (i = 0; i < l->vertex_size; i++)
+	c[i] = (barcodes[j] >> i) & 1;
+
+      if (append_list(l, c.data()) == 0)
+	return 0;
+    }
+
+  return 1;
+}
+
+
+/*
+ * Function: extend_graph_cfg
+ * --------------------------
+ * Creates the same vertices as create_graph_cfg (in the same order),
+ * extending the bars line by line from the cached table of open bars
+ * with fewer lines
+ *
+ * linked_list: list which contains all barcodes
+ *
+ *           k: number of lines of the hexagonal grid
+ *
+ *       cache: the table of open bars, kept between calls
+ *
+ * returns: 1 if the vertices were created, otherwise, 0
+ */
+int extend_graph_cfg(linked_list *l, int k, barcode_table *cache)
+{
+  vector<uint64_t> barcodes; // the bar codes, as masks
+
+  if (l->vertex_size != BARCODE_COLUMNS * k ||
+      barcode_table_for(k, cache, &barcodes) == 0)
+    return 0;
+
+  return append_barcodes(l, barcodes.data(), barcodes.size());
+}
+
+
+/*
+ * Function: load_graph_cfg
+ * ------------------------
+ * Creates the vertices saved in the cache or in a CSR file. NodeIt
+ * visits the vertices in decreasing order of id, so the bar codes are
+ * appended from the last id to the first one, and the vertex with id i
+ * gets the bar code i
+ *
+ * linked_list: list which contains all barcodes
+ *
+ *         bar: the bar codes of the vertices, by id
+ *
+ *         amt: the number of vertices
+ *
+ * returns: 1 if the vertices were created, otherwise, 0
+ */
+int load_graph_cfg(linked_list *l, const uint64_t *bar, size_t amt)
+{
+  vector<uint64_t> barcodes(bar, bar + amt);
+
+  reverse(barcodes.begin(), barcodes.end());
+
+  return append_barcodes(l, barcodes.data(), barcodes.size());
+}
+
+
+/*
+ * Function: check_bar_code
+ * ------------------------
+ * Check if a set of vertices induces a bar code
+ *
+ * bar1: represents a set of vertices in a bar
+ * bar2: represents a set of vertices in a bar
+ * size: the size of the bars 1 and 2
+ *    k: the number of lines in hexagonal grid
+ *
+ * returns: 1 if the union of bars 1 and 2 induces a bar code,
+ *          otherwise, returns 0
+ *
+ * how the vertices of the bars 1 and 2 are represented
+ * ...
+ * line 3: 12-13-14-15 == 12-13-14-15
+ *         |      |       |      |
+ * line 2: 8--9--10-11 == 8--9--10-11
+ *            |     |        |     |
+ * line 1: 4--5--6--7  == 4--5--6--7
+ *         |     |        |     |
+ * line 0: 0--1--2--3  == 0--1--2--3
+ *         bar1           bar2
+ */
+int check_bar_code(int *bar1, int *bar2, int z, int k)
+{
+  SmartGraph H;     // graph that represents that union of the bars 1 and 2
+  int num_vertices; // the number of vertices in H
+  int i, j;
+
+  // creates the graphi which represents the union of bar 1 and bar 2
+  num_vertices = 2 * z *k;
+
+  SmartGraph::NodeMap<config_vertex> map_vertice_id(H);
+  create_vertex_graph_cfg(k, 2 * z, &H);
+
+  // set the column and line for the vertices of H, maping the vertices
+  // of H into the struct of the hexagonal grid
+  for(i = 0; i < num_vertices; i = i +(2 * z))
+    for(j = 0; j < 2 * z; j++)
+      {
+        map_vertice_id[H.nodeFromId(i +j)].column = j;
+        map_vertice_id[H.nodeFromId(i +j)].line = i/(2* z);
+      }
+
+  // set which vertices belongs to the code according to the information
+  // in bar code 1 and 2
+  for (i = 0; i < num_vertices; i = i + (2 * z))
+    for (j = 0; j < z; j++)
+      {
+	map_vertice_id[H.nodeFromId(i +j)].pertence = bar1[i/2 +j];
+	map_vertice_id[H.nodeFromId(i +j +z)].pertence = bar2[i/2 +j];
+      }
+
+  // create the identifiers
+  for (SmartGraph::NodeIt v(H); v != INVALID; ++v)
+    {
+      i = 0;
+
+      if (map_vertice_id[v].pertence == 1)
+	{
+	  map_vertice_id[v].identificador[0] = H.id(v);
+	  i++;
+	}
+
+      for (SmartGraph::IncEdgeIt e(H, v); e != INVALID; ++e)
+	{
+	  if (H.id(H.u(e)) != H.id(v) &&
+	      map_vertice_id[H.u(e)].pertence == 1)
+	    {
+	      map_vertice_id[v].identificador[i] = H.id(H.u(e));
+	      i++;
+	    }
+	  else if (H.id(H.v(e)) != H.id(v) &&
+		   map_vertice_id[H.v(e)].pertence == 1)
+	    {
+	      map_vertice_id[v].identificador[i] = H.id(H.v(e));
+	      i++;
+	    }
+	}
+    }
+
+  // check if there is an empty identifier
+  for (SmartGraph::NodeIt v(H); v != INVALID; ++v)
+    {
+      if (map_vertice_id[v].column > 0 &&
+	  map_vertice_id[v].column < 2 * z -1)
+	if (identifier_size(map_vertice_id[v].identificador,
+			     NEIGHBOORHOD_SIZE) == 0)
+	    return 0;
+    }
+
+  // check if the identifiers are pairwise distinct
+  for(SmartGraph::NodeIt v(H); v != INVALID; ++v)
+    {
+      if (map_vertice_id[v].column > 0 &&
+	  map_vertice_id[v].column < 2 * z -1)
+	{
+	for (SmartGraph::NodeIt u(H); u != INVALID; ++u)
+	  if (map_vertice_id[u].column > 0 &&
+	      map_vertice_id[u].column < 2 * z -1 &&
+	      H.id(u) != H.id(v))
+	    {
+	      if (equal_identifier(map_vertice_id[v].identificador,
+				   map_vertice_id[u].identificador,
+				   NEIGHBOORHOD_SIZE) == true)
+		return 0;
+	    }
+	}
+    }
+
+  return 1;
+}
+
+
+/*
+ * Function: greatest_common_divisor
+ * ---------------------------------
+ * Computes the greatest common divisor of two non negative integers
+ *
+ *       a: a non negative integer
+ *       b: a non negative integer
+ *
+ * returns: gcd(a, b), where gcd(0, 0) = 1 so it is always safe to divide
+ *          by it
+ */
+long long greatest_common_divisor(long long a, long long b)
+{
+  long long r;
+
+  while (b != 0)
+    {
+      r = a % b;
+      a = b;
+      b = r;
+    }
+
+  return (a == 0) ? 1 : a;
+}
+
+
+/*
+ * Function: allocate_edge_config_graph
+ * ------------------------------------
+ * Creates the edges of the configuration graph and their weights. The
+ * targets of the arcs leaving each vertex are found in parallel, each
+ * thread writing only to the list of its own vertex; the arcs are added
+ * afterwards, in the order of NodeIt, since addArc is not thread safe.
+ * When the edges go to an out-of-core graph, the vertices are processed
+ * in blocks, so only the targets of one block are kept in memory, and
+ * with checkpoints, so a checkpoint can be saved after each block
+ *
+ *             G: the configuration graph, with all its vertices
+ *
+ *  map_vertices: a mapping from a vertex to its bar code
+ *
+ *   vertex_size: the number of vertices of a bar code
+ *
+ *             k: the number of lines of the hexagonal grid
+ *
+ *        weight: where the weights of the new edges are stored
+ *
+ * target_weight: only the edges whose weight is target_weight are
+ *                created (all the edges, if it is -1)
+ *
+ *       checker: the checkers specialized for k (NULL to check the
+ *                unions over the hexagonal grid)
+ *
+ *      external: the out-of-core graph which receives the edges, instead
+ *                of G (NULL to add them to G)
+ *
+ *          ckpt: the checkpoints of the run, with the bar codes by id
+ *                (NULL if there are none); if a checkpoint of the edges
+ *                was loaded, its arcs are added first, and the sources
+ *                after it are processed
+ *
+ *       metrics: where the number of pairs of bar codes tested is added
+ *                (may be NULL)
+ *
+ * returns: 1 if the edges were created, otherwise, 0
+ */
+int allocate_edge_config_graph(SmartDigraph *G,
+			       SmartDigraph::NodeMap<node *> &map_vertices,
+			       int vertex_size, int k,
+			       SmartDigraph::ArcMap<int> *weight,
+			       int target_weight, const hk_checker *checker,
+			       external_graph *external, checkpoint *ckpt,
+			       run_metrics *metrics)
+{
+  vector<vector<int>> arc_targets(countNodes(*G));
+  vector<int> node_weight(countNodes(*G));
+  vector<uint8_t> lines;  // the bar codes, one byte per line
+  SmartDigraph::Arc arc;
+  int i, j, n, valid, first, last, block, start;
+  long long pairs;        // the number of pairs of bar codes tested
+  perf_counters thread_counters; // the counters of a worker thread
+  perf_sample thread_start; // and their values at the beginning
+
+  n = countNodes(*G);
+
+  // the weight of an edge is the weight of the bar code of its target
+  for (i = 0; i < n; i++)
+    node_weight[i] = obtain_weigth(map_vertices[G->nodeFromId(i)]->v->bar,
+				   vertex_size);
+
+  if (checker != NULL)
+    {
+      lines.resize((size_t) n * k);
+      for (i = 0; i < n; i++)
+	checker_lines(map_vertices[G->nodeFromId(i)]->v->bar, k,
+		      NEIGHBOORHOD_SIZE, &lines[(size_t) i * k]);
+    }
+
+  // a block has all the vertices, unless the targets of a block (at most
+  // n per vertex) must fit in half of the budget of the out-of-core graph;
+  // the vectors of the targets double their capacity, so the targets
+  // themselves take at most a quarter of it
+  block = n;
+  if (external != NULL)
+    block = max(1, (int) min((size_t) n,
+			     external->budget / 4 / sizeof(int) /
+			     max(n, 1)));
+  else if (ckpt != NULL)
+    block = CHECKPOINT_SOURCE_BLOCK;
+
+  // the sources are processed from the last one, or from the one after
+  // the checkpoint
+  start = n -1;
+  if (ckpt != NULL && ckpt->phase == CHECKPOINT_EDGES)
+    {
+      if (checkpoint_add_arcs(ckpt, G, weight, node_weight) == 0)
+	return 0;
+
+      start = (int) ckpt->next_source;
+    }
+
+  pairs = 0;
+  for (last = start; last >= 0; last -= block)
+    {
+      first = max(0, last - block +1);
+
+      // with --perf each worker thread also measures its own counters
+      # pragma omp parallel private(i, j, valid, thread_counters, \
+	thread_start) reduction(+:pairs)
+      {
+	metrics_thread_begin(metrics, &thread_counters, &thread_start);
+
+	# pragma omp for schedule(dynamic)
+	for (i = first; i <= last; i++)
+	  {
+	    for (j = n -1; j >= 0; j--)
+	      {
+		if (target_weight != -1 && node_weight[j] != target_weight)
+		  continue;
+
+		pairs++;
+
+		if (checker != NULL)
+		  valid = checker->seam_valid(&lines[(size_t) i * k],
+					      &lines[(size_t) j * k]);
+		else
+		  valid =
+		    check_bar_code(map_vertices[G->nodeFromId(i)]->v->bar,
+				   map_vertices[G->nodeFromId(j)]->v->bar,
+				   NEIGHBOORHOD_SIZE, k);
+
+		if (valid == 1)
+		  arc_targets[i].push_back(j);
+	      }
+	  }
+
+	metrics_thread_end(metrics, &thread_counters, thread_start);
+      }
+
+      for (i = last; i >= first; i--)
+	{
+	  for (j = 0; j < (int) arc_targets[i].size(); j++)
+	    {
+	      if (external != NULL)
+		{
+		  if (external_add_arc(external, i, arc_targets[i][j]) == 0)
+		    {
+		      if (metrics != NULL)
+			metrics->pairs_tested += pairs;
+		      return 0;
+		    }
+		}
+	      else
+		{
+		  arc = G->addArc(G->nodeFromId(i),
+				  G->nodeFromId(arc_targets[i][j]));
+		  (*weight)[arc] = node_weight[arc_targets[i][j]];
+		}
+	    }
+
+	  vector<int>().swap(arc_targets[i]);
+	}
+
+      // the sources up to first were processed
+      if (ckpt != NULL && checkpoint_due(ckpt) == 1 &&
+	  save_checkpoint(ckpt, CHECKPOINT_EDGES, 0, first -1, G) == 0)
+	cerr << "ERRO: It was not possible to save the checkpoint "
+	     << ckpt->path << "!\n";
+    }
+
+  if (metrics != NULL)
+    metrics->pairs_tested += pairs;
+
+  return 1;
+}
+
+
+/*
+ * Function: config_graph_arrays
+ * -----------------------------
+ * Stores the bar codes of the vertices of the configuration graph as
+ * masks, and the weights of the arcs entering them, by id (the arrays
+ * saved in the cache and in CSR files)
+ *
+ *            G: the configuration graph
+ *
+ * map_vertices: a mapping from a vertex to its bar code
+ *
+ *  vertex_size: the number of vertices of a bar code
+ *
+ *          bar: where the bar codes are stored
+ *
+ *  node_weight: where the weights are stored
+ */
+void config_graph_arrays(SmartDigraph &G,
+			 SmartDigraph::NodeMap<node *> &map_vertices,
+			 int vertex_size, vector<uint64_t> *bar,
+			 vector<int32_t> *node_weight)
+{
+  int *c;
+  int n, i, j;
+
+  n = countNodes(G);
+  bar->assign(n, 0);
+  node_weight->assign(n, 0);
+
+  for (i = 0; i < n; i++)
+    {
+      c = map_vertices[G.nodeFromId(i)]->v->bar;
+      for (j = 0; j < vertex_size; j++)
+	if (c[j] == 1)
+	  (*bar)[i] |= 1ULL << j;
+
+      (*node_weight)[i] = obtain_weigth(c, vertex_size);
+    }
+}
+
+
+/*
+ * Function: cycle_barcodes
+ * ------------------------
+ * Stores the bar codes of the vertices of a cycle of the configuration
+ * graph, in the order of its arcs, as masks
+ *
+ *            G: the configuration graph
+ *
+ *        cycle: the cycle of the configuration graph
+ *
+ * map_vertices: a mapping from a vertex to its bar code
+ *
+ *            k: the number of lines of the hexagonal grid
+ *
+ *          bar: where the bar codes are stored
+ */
+void cycle_barcodes(SmartDigraph &G, Path<SmartDigraph> &cycle,
+		    SmartDigraph::NodeMap<node *> &map_vertices, int k,
+		    vector<uint64_t> *bar)
+{
+  int *c;
+  int j;
+
+  bar->clear();
+  for (Path<SmartDigraph>::ArcIt arco(cycle); arco != INVALID; ++arco)
+    {
+      c = map_vertices[G.source(arco)]->v->bar;
+      bar->push_back(0);
+
+      for (j = 0; j < NEIGHBOORHOD_SIZE * k; j++)
+	if (c[j] == 1)
+	  bar->back() |= 1ULL << j;
+    }
+}
+
+
+/*
+ * Function: decode_pattern
+ * ------------------------
+ * Converts the bar codes of a cycle of the configuration graph into the
+ * pattern of the identifying code: the bars are placed side by side
+ *
+ *       k: the number of lines of the hexagonal grid
+ *
+ *     bar: the bar codes of the cycle, in the order of its arcs
+ *
+ * pattern: where the pattern of the code is stored (hkcode.h)
+ */
+void decode_pattern(int k, const vector<uint64_t> &bar, hk_pattern *pattern)
+{
+  long long pattern_size, density_gcd;
+  int i, j, h;
+
+  pattern->k = k;
+  pattern->columns = (int) bar.size() * NEIGHBOORHOD_SIZE;
+  pattern->vertices.clear();
+
+  for (h = 0; h < (int) bar.size(); h++)
+    for (j = 0; j < k; j++)
+      for (i = 0; i < NEIGHBOORHOD_SIZE; i++)
+	if ((bar[h] >> (j * NEIGHBOORHOD_SIZE + i) & 1) == 1)
+	  pattern->vertices.push_back(make_pair(i + NEIGHBOORHOD_SIZE * h,
+						j +1));
+
+  // the density is the exact fraction (vertices in the code) / (vertices
+  // in the pattern), reduced to its lowest terms
+  pattern_size = (long long) pattern->columns * k;
+  density_gcd = greatest_common_divisor(pattern->vertices.size(),
+					pattern_size);
+  pattern->density_num = pattern->vertices.size() / density_gcd;
+  pattern->density_den = pattern_size / density_gcd;
+}
+
+
+/*
+ * Function: library_barcodes
+ * --------------------------
+ * Generates the bar codes of H_k for libhkcode (hk_build_barcodes)
+ *
+ *             k: the number of lines of the hexagonal grid
+ *
+ * row_extension: 1 to build the bar codes line by line, otherwise, 0
+ *
+ *      barcodes: where the bar codes are stored
+ *
+ * returns: 1 if the bar codes were generated, otherwise, 0
+ */
+int library_barcodes(int k, int row_extension, hk_barcodes *barcodes)
+{
+  linked_list l;
+  barcode_table table;
+  hk_checker specialized;
+  const hk_checker *checker;
+  int generated;
+
+  if (k < 2 || k * NEIGHBOORHOD_SIZE > 64)
+    return 0;
+
+  checker = NULL;
+  if (select_checker<NEIGHBOORHOD_SIZE, 0>(k, &specialized) == 1)
+    checker = &specialized;
+
+  init_list(&l, k, NEIGHBOORHOD_SIZE);
+  table.lines = 0;
+  table.tested = 0;
+
+  if (row_extension == 1)
+    generated = extend_graph_cfg(&l, k, &table);
+  else
+    generated = create_graph_cfg(&l, k, NEIGHBOORHOD_SIZE, checker, NULL,
+				 NULL);
+
+  barcodes->bars = HK_BARS_8;
+  barcodes->k = k;
+  barcodes->width = NEIGHBOORHOD_SIZE;
+  barcodes->overlap = 0;
+  list_barcodes(&l, &barcodes->bar);
+
+  deallocate_list(&l);
+  return (generated == 0) ? 0 : 1;
+}
+
+
+/*
+ * Function: library_graph
+ * -----------------------
+ * Builds the configuration graph of a list of bar codes for libhkcode
+ * (hk_build_graph); as in the program, NodeIt visits the vertices in
+ * decreasing order of id, so the vertex with id i is the bar code
+ * n -1 -i of the list
+ *
+ * barcodes: the bar codes
+ *
+ *    graph: where the graph is stored, in CSR form
+ *
+ * returns: 1 if the graph was built, otherwise, 0
+ */
+int library_graph(const hk_barcodes &barcodes, hk_graph *graph)
+{
+  linked_list l;
+  SmartDigraph G;
+  node *nodeAux;
+  hk_checker specialized;
+  const hk_checker *checker;
+  int built, i;
+
+  checker = NULL;
+  if (select_checker<NEIGHBOORHOD_SIZE, 0>(barcodes.k, &specialized) == 1)
+    checker = &specialized;
+
+  init_list(&l, barcodes.k, NEIGHBOORHOD_SIZE);
+  if (append_barcodes(&l, barcodes.bar.data(), barcodes.bar.size()) == 0)
+    {
+      deallocate_list(&l);
+      return 0;
+    }
+
+  for (i = 0; i < l.size; i++)
+    G.addNode();
+
+  SmartDigraph::NodeMap<node *> map_vertices(G);
+  nodeAux = l.first;
+
+  for (SmartDigraph::NodeIt v(G); v != INVALID; ++v)
+    {
+      map_vertices[v] = nodeAux;
+      nodeAux = nodeAux->next;
+    }
+
+  SmartDigraph::ArcMap<int> weight(G);
+
+  built = allocate_edge_config_graph(&G, map_vertices, l.vertex_size,
+				     barcodes.k, &weight, -1, checker, NULL,
+				     NULL, NULL);
+  if (built == 1)
+    {
+      graph->bars = HK_BARS_8;
+      graph->k = barcodes.k;
+      graph->width = NEIGHBOORHOD_SIZE;
+      graph->overlap = 0;
+      config_graph_arrays(G, map_vertices, l.vertex_size, &graph->bar,
+			  &graph->node_weight);
+      csr_arcs(G, countNodes(G), &graph->offsets, &graph->targets);
+    }
+
+  deallocate_list(&l);
+  return built;
+}
+
+
+/*
+ * Function: run_anytime_mmc
+ * -------------------------
+ * Creates the edges of the configuration graph in increasing order of
+ * weight and, after the edges of each weight, runs the MMC algorithm on
+ * the graph built so far and prints the best code found. Stops as soon
+ * as the code reaches the target density
+ *
+ *            G: the configuration graph, with its vertices and no edges
+ *
+ * map_vertices: a mapping from a vertex to its bar code
+ *
+ *  vertex_size: the number of vertices of a bar code
+ *
+ *            k: the number of lines of the hexagonal grid
+ *
+ *       weight: where the weights of the edges are stored
+ *
+ *      options: the options given in the command line (engine and target)
+ *
+ *      checker: the checkers specialized for k (may be NULL)
+ *
+ *          mmc: where the best cycle found is stored
+ *
+ *      metrics: where the number of pairs of bar codes tested is added
+ *               (may be NULL)
+ *
+ * returns: the engine used by the last run of the MMC algorithm
+ */
+mmc_engine run_anytime_mmc(SmartDigraph *G,
+			   SmartDigraph::NodeMap<node *> &map_vertices,
+			   int vertex_size, int k,
+			   SmartDigraph::ArcMap<int> *weight,
+			   const hk_options *options, const hk_checker *checker,
+			   mmc_result *mmc, run_metrics *metrics)
+{
+  mmc_engine engine;
+  vector<uint64_t> cycle_bars; // the bar codes of the cycle found
+  hk_pattern pattern;          // the code given by the cycle
+  int w, amt_arcs;
+
+  engine = options->engine;
+  mmc->found = 0;
+  amt_arcs = 0;
+
+  // the weight of an edge is the number of vertices of the target bar
+  // code which belong to the code
+  for (w = 0; w <= vertex_size; w++)
+    {
+      allocate_edge_config_graph(G, map_vertices, vertex_size, k, weight, w,
+				 checker, NULL, NULL, metrics);
+
+      // no edge of this weight, the best cycle does not change
+      if (countArcs(*G) == amt_arcs)
+	continue;
+
+      amt_arcs = countArcs(*G);
+      engine = run_mmc(*G, *weight, options->engine, mmc);
+
+      cout << "Edges of weight up to " << w << ": " << amt_arcs << " edges\t";
+      if (mmc->found == 0)
+	{
+	  cout << "no cycle\n";
+	  continue;
+	}
+
+      cycle_barcodes(*G, mmc->cycle, map_vertices, k, &cycle_bars);
+      decode_pattern(k, cycle_bars, &pattern);
+
+      cout << "columns: " << pattern.columns << "\t"
+	   << "density: " << (double) pattern.density_num /
+	pattern.density_den
+	   << " (" << pattern.density_num << "/" << pattern.density_den
+	   << ")\n";
+      print_pattern(cout, pattern);
+      cout << "\n";
+
+      if (pattern.density_num * options->target_den <=
+	  options->target_num * pattern.density_den)
+	{
+	  cout << "Target density reached!\n";
+	  return engine;
+	}
+    }
+
+  cout << "Target density not reached; the code found is optimal\n";
+  return engine;
+}
+
+
+/*
+ * Function: run_differential
+ * --------------------------
+ * Checks the fast kernels (the specialized checkers and the row
+ * extension) against the reference ones, over the hexagonal grid
+ * (differential.h)
+ *
+ *       k: the number of lines of the hexagonal grid
+ * checker: the checkers specialized for k (NULL if there are none)
+ *    seed: the seed of the random pairs of bar codes
+ *
+ * returns: 1 if all the checks passed, otherwise, 0
+ */
+int run_differential(int k, const hk_checker *checker, uint64_t seed)
+{
+  linked_list reference;      // the bar codes of the reference enumeration
+  linked_list fast;           // the bar codes of an enumeration checked
+  barcode_table table;        // the open bars of the row extension
+  diff_report report;
+  vector<uint64_t> reference_bars, fast_bars;
+  vector<uint8_t> lines;      // the bar codes by id, one byte per line
+  vector<int *> bar;          // the bar codes by id
+  vector<int> targets;        // the targets of a source in the graph
+  SmartDigraph G;             // the graph built by the fast path
+  node *nodeAux;
+  mmc_result mmc;
+  ostringstream detail;
+  uint64_t state;
+  long long expected_bars, expected_arcs, mismatches, p;
+  long long code_vertices, code_columns, pattern_size;
+  int counted, n, u, v, s, amt_sources, first_u, first_v, valid;
+
+  cout << "Differential check of H" << k << " (seed " << seed << ")\n";
+  report.checks = 0;
+  report.failures = 0;
+  expected_bars = expected_arcs = 0;
+
+  // the reference enumeration, and the numbers of bar codes and arcs
+  // counted by the transfer matrices
+  init_list(&reference, k, NEIGHBOORHOD_SIZE);
+  if (create_graph_cfg(&reference, k, NEIGHBOORHOD_SIZE, NULL, NULL,
+		       NULL) == 0)
+    {
+      cerr << "ERRO: It was not possible to generate the bar codes!\n";
+      deallocate_list(&reference);
+      return 0;
+    }
+  list_barcodes(&reference, &reference_bars);
+  n = reference.size;
+
+  counted = diff_counts(NEIGHBOORHOD_SIZE, 2 * NEIGHBOORHOD_SIZE, k,
+			&expected_bars, &expected_arcs);
+  if (counted == 1)
+    diff_check(&report, "number of bar codes (transfer matrices)",
+	       (n == expected_bars) ? 1 : 0,
+	       to_string(n) + " of " + to_string(expected_bars));
+
+  // the same bar codes, in the same order, by the fast enumerations
+  if (checker != NULL)
+    {
+      init_list(&fast, k, NEIGHBOORHOD_SIZE);
+      create_graph_cfg(&fast, k, NEIGHBOORHOD_SIZE, checker, NULL, NULL);
+      list_barcodes(&fast, &fast_bars);
+      diff_barcodes(&report, "bar codes (specialized checker)",
+		    reference_bars, fast_bars);
+      deallocate_list(&fast);
+    }
+
+  table.lines = 0;
+  table.tested = 0;
+  init_list(&fast, k, NEIGHBOORHOD_SIZE);
+  extend_graph_cfg(&fast, k, &table);
+  list_barcodes(&fast, &fast_bars);
+  diff_barcodes(&report, "bar codes (row extension)", reference_bars,
+		fast_bars);
+  deallocate_list(&fast);
+
+  // the vertices of the graph, as in the main program: NodeIt visits
+  // them in decreasing order of id
+  for (u = 0; u < n; u++)
+    G.addNode();
+
+  SmartDigraph::NodeMap<node *> map_vertices(G);
+  nodeAux = reference.first;
+
+  for (SmartDigraph::NodeIt w(G); w != INVALID; ++w)
+    {
+      map_vertices[w] = nodeAux;
+      nodeAux = nodeAux->next;
+    }
+
+  bar.resize(n);
+  for (u = 0; u < n; u++)
+    bar[u] = map_vertices[G.nodeFromId(u)]->v->bar;
+
+  // random pairs of bar codes, checked by both kernels
+  state = seed;
+  if (checker != NULL)
+    {
+      lines.resize((size_t) n * k);
+      for (u = 0; u < n; u++)
+	checker_lines(bar[u], k, NEIGHBOORHOD_SIZE, &lines[(size_t) u * k]);
+
+      mismatches = 0;
+      first_u = first_v = 0;
+      for (p = 0; p < DIFFERENTIAL_PAIRS; p++)
+	{
+	  u = (int) (bench_random(&state) % (uint64_t) n);
+	  v = (int) (bench_random(&state) % (uint64_t) n);
+
+	  valid = check_bar_code(bar[u], bar[v], NEIGHBOORHOD_SIZE, k);
+	  if (valid != checker->seam_valid(&lines[(size_t) u * k],
+					   &lines[(size_t) v * k]) &&
+	      mismatches++ == 0)
+	    {
+	      first_u = u;
+	      first_v = v;
+	    }
+	}
+
+      detail << mismatches << " of " << DIFFERENTIAL_PAIRS << " pairs differ";
+      if (mismatches > 0)
+	detail << ", the first one is " << first_u << " -> " << first_v;
+      diff_check(&report, "unions of random pairs (specialized checker)",
+		 (mismatches == 0) ? 1 : 0, detail.str());
+    }
+
+  // the graph built by the fast path: its number of arcs, the arcs of
+  // some sources and the density of its minimum mean cycle
+  if (counted == 0 || expected_arcs > DIFFERENTIAL_MAX_ARCS)
+    cout << "  arcs and density: not checked (the graph is too large)\n";
+  else
+    {
+      SmartDigraph::ArcMap<int> weight(G);
+
+      if (allocate_edge_config_graph(&G, map_vertices, reference.vertex_size,
+				     k, &weight, -1, checker, NULL, NULL,
+				     NULL) == 0)
+	{
+	  cerr << "ERRO: It was not possible to create the edges of the"
+	       << " configuration graph!\n";
+	  deallocate_list(&reference);
+	  return 0;
+	}
+
+      diff_check(&report, "number of arcs (transfer matrices)",
+		 (countArcs(G) == expected_arcs) ? 1 : 0,
+		 to_string(countArcs(G)) + " of " + to_string(expected_arcs));
+
+      // every source of a small graph, otherwise random sources
+      amt_sources = n;
+      if ((long long) n * n > DIFFERENTIAL_FULL_PAIRS)
+	amt_sources = DIFFERENTIAL_SOURCES;
+
+      mismatches = 0;
+      first_u = 0;
+      for (s = 0; s < amt_sources; s++)
+	{
+	  u = (amt_sources == n) ? s :
+	    (int) (bench_random(&state) % (uint64_t) n);
+
+	  targets.clear();
+	  for (SmartDigraph::OutArcIt a(G, G.nodeFromId(u)); a != INVALID; ++a)
+	    targets.push_back(G.id(G.target(a)));
+	  sort(targets.begin(), targets.end());
+
+	  for (v = 0, p = 0; v < n; v++)
+	    if (check_bar_code(bar[u], bar[v], NEIGHBOORHOD_SIZE, k) == 1)
+	      {
+		if (p >= (long long) targets.size() || targets[p] != v)
+		  break;
+		p++;
+	      }
+
+	  if ((v < n || p != (long long) targets.size()) && mismatches++ == 0)
+	    first_u = u;
+	}
+
+      detail.str("");
+      detail << mismatches << " of " << amt_sources << " sources differ";
+      if (mismatches > 0)
+	detail << ", the first one is " << first_u;
+      diff_check(&report, "arcs of the graph (reference check)",
+		 (mismatches == 0) ? 1 : 0, detail.str());
+
+      // the density of the code saved by a previous run
+      run_mmc(G, weight, MMC_AUTO, &mmc);
+      pattern_size = (long long) k * mmc.size * NEIGHBOORHOD_SIZE;
+
+      if (saved_code_density(DIFFERENTIAL_CODES_DIR "/CodigoH" +
+			     to_string(k) + "GrafoConfig.txt", k,
+			     &code_vertices, &code_columns) == 0)
+	cout << "  density: not checked (there is no saved code)\n";
+      else
+	diff_check(&report, "density (saved code)",
+		   (mmc.found == 1 && mmc.cost * k * code_columns ==
+		    code_vertices * pattern_size) ? 1 : 0,
+		   to_string(mmc.cost) + "/" + to_string(pattern_size) +
+		   " and " + to_string(code_vertices) + "/" +
+		   to_string(k * code_columns));
+    }
+
+  cout << report.checks << " checks, " << report.failures << " failed\n";
+
+  deallocate_list(&reference);
+  return (report.failures == 0) ? 1 : 0;
+}
+
+/*
+ * Function: run_mmc_step
+ * ----------------------
+ * Finds a minimum mean cycle of the configuration graph with the
+ * algorithm chosen by the options (or checks the certificate, or finds
+ * the closed walk with the smallest mean among the walks with bounded
+ * length)
+ *
+ *                G: the configuration graph
+ *
+ *     map_vertices: a mapping from a vertex to its bar code
+ *
+ *      vertex_size: the number of vertices of a bar code
+ *
+ *                k: the number of lines of the hexagonal grid
+ *
+ *           weight: the weights of the edges
+ *
+ *          options: the options given in the command line
+ *
+ *          checker: the checkers specialized for k (may be NULL)
+ *
+ * certificate_path: the file with the certificate (--check-certificate)
+ *
+ *       max_length: the number of arcs of the longest closed walk
+ *                   (--max-period)
+ *
+ *         external: the arcs written to disk, with the CSR file and the
+ *                   memory of the out-of-core MMC (NULL without
+ *                   --external)
+ *
+ *      period_cost: where the minimum weight of a closed walk with each
+ *                   number of arcs is stored (--max-period)
+ *
+ *          pruning: where the arcs eliminated are counted (--prune)
+ *
+ *           engine: where the algorithm actually run is stored
+ *
+ *              mmc: where the cycle found is stored
+ *
+ *          metrics: the metrics of the run (--target-density)
+ *
+ * returns: 1 if the algorithm was run, otherwise (the edges of the
+ *          out-of-core graph could not be read), 0
+ */
+int run_mmc_step(SmartDigraph *G, SmartDigraph::NodeMap<node *> &map_vertices,
+		 int vertex_size, int k, SmartDigraph::ArcMap<int> *weight,
+		 const hk_options *options, const hk_checker *checker,
+		 const string &certificate_path, int max_length,
+		 const external_graph *external,
+		 vector<long long> *period_cost, pruning_stats *pruning,
+		 mmc_engine *engine, mmc_result *mmc, run_metrics *metrics)
+{
+  external_csr external_file; // the arcs read by the out-of-core MMC
+
+  *engine = options->engine;
+
+  if (options->check == 1)
+    check_certificate(certificate_path.c_str(), *G, *weight, k,
+		      NEIGHBOORHOD_SIZE, 0, mmc);
+  else if (options->max_period > 0)
+    bounded_period_dp(*G, *weight, max_length, period_cost, mmc);
+  else if (options->target_den > 0)
+    *engine = run_anytime_mmc(G, map_vertices, vertex_size, k, weight,
+			      options, checker, mmc, metrics);
+  else if (options->prune == 1)
+    *engine = run_mmc_pruned(*G, *weight, options->engine, mmc, pruning);
+  else if (external != NULL)
+    {
+      *engine = MMC_LAWLER;
+
+      if (external_open(external->path, k, NEIGHBOORHOD_SIZE, 0,
+			external->budget, &external_file) == 0 ||
+	  external_mmc(&external_file, G, weight, mmc) == 0)
+	{
+	  cerr << "ERRO: It was not possible to read the edges from "
+	       << external->path << "!\n";
+	  external_close(&external_file);
+	  return 0;
+	}
+
+      external_close(&external_file);
+    }
+  else
+    *engine = run_mmc(*G, *weight, options->engine, mmc);
+
+  return 1;
+}
+}
@@ -0,0 +1,252 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   The kernels of libhkcode (see hkcode.h) for the bars with 4 columns,
+   not overlapping, used by Hk_lemon_eng_8bar.cc: the generation of the
+   bar codes (also line by line, for --row-extension), the construction
+   of the configuration graph, the checkers of the unions of bar codes,
+   decode_pattern and the choice of the MMC algorithm. They are in the
+   namespace hk8, since the kernels of the other bars (hkcode_6bar.h)
+   have the same names, and each one is described with its
+   implementation in hkcode_8bar.cc.
+*/
+
+#ifndef HKCODE_8BAR_H
+#define HKCODE_8BAR_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <new>
+#include <lemon/list_graph.h>
+#include <lemon/path.h>
+#include <lemon/smart_graph.h>
+#include <lemon/full_graph.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include "mmc_engine.h"
+#include "options.h"
+#include "arc_pruning.h"
+#include "bounded_period.h"
+#include "certificate.h"
+#include "barcode_extension.h"
+#include "transfer_count.h"
+#include "specialized_checker.h"
+#include "csr_graph.h"
+#include "hkcode.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// defines the maximum number of vertices in the closed neighborhood of a
+// vertex in hexagonal grid with finite number of rows
+#define NEIGHBOORHOD_SIZE 4
+
+
+namespace hk8
+{
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: vertex
+ * --------------
+ * Represents a vertex in configuration graph
+ *
+ *    bar: bit array that indicantes which vertex, from the
+ *         hexagonal grid H_k, belongs to the code; which are represented
+ *         in the following way (for a 4-bar)
+ *         ...
+ *         line 3: 12-13-14-15
+ *                 |      |
+ *         line 2: 8--9--10-11
+ *                    |     |
+ *         line 1: 4--5--6--7
+ *                 |     |
+ *         line 0: 0--1--2--3
+ *
+ * weight: the number of vertices that belongs to the code
+ */
+struct vertex
+{
+  int    *bar;
+  double weight;
+};
+
+typedef struct vertex vertex;
+
+
+/*
+ * Struct: node
+ * ------------
+ * Represents a node of a linked list
+ *
+ *   next: points to the next node of the list
+ *
+ * vertex: points to a vertex in configuration graph (struct vertex)
+ */
+struct node
+{
+  struct node *next;
+  vertex      *v;
+};
+
+typedef struct node node;
+
+
+/*
+ * Struct: linked_list
+ * -------------------
+ * Represents a linked list, where each node points to a vertex in
+ * configuration graph
+ *
+ *        size: the number of nodes in the list
+ *
+ * vertex_size: the number of vertices that a vertex, in configuration
+ *              graph, contains (number of columns = size of l-bar x
+ *                               number of lines)
+ *
+ *       first: points to the first node of the list
+ *
+ *        last: points to the last element of the list
+ */
+struct linked_list
+{
+  int  size;
+  int  vertex_size;
+  node *first;
+  node *last;
+};
+
+typedef struct linked_list linked_list;
+
+
+/*
+ * Struct: config_vertex
+ * ---------------------
+ * Represents the line, column and identifier of a vertex in the
+ * hexagonal grid. This struct is used to map the vertices from the bar
+ * to the struct of the hexagonal grid and check if a set of vertices
+ * is an identifying code; restricted to the vertices of the bar
+ * (discarting the firts and last columns)
+ *
+ *    line: the line of the vertex in hexagonal grid
+ *
+ *   column: the column of th vertex in hexagonal grid
+ *
+ * pertence: indicates if a vertex belongs to the code
+ *
+ * identificador: the identifier of a vertex, such that:
+ *                identificador[] = -1 -> there is no vertex
+ *                identificador[] =  i -> id of the vertex that belongs
+ *                                        to the code
+ */
+struct config_vertex
+{
+  int line;
+  int column;
+  int pertence;
+  int identificador[NEIGHBOORHOD_SIZE] = {-1, -1, -1, -1};
+                        // the identifier has 4 positions since we are
+                        // working with 1-identifying code
+};
+
+typedef struct config_vertex config_vertex;
+
+
+/* Function Declaration - - - - - - - - - - - - - - - - - - - - - - - - */
+int allocate_vertex(vertex *v, int size);
+
+void deallocate_vertex(vertex *v);
+
+void copy_vertex(vertex *v, int size, int *u);
+
+void print_vertex(vertex *v, int size);
+
+void init_list(linked_list *l, int k, int z);
+
+int append_list(linked_list *l, int *c);
+
+void deallocate_list(linked_list *l);
+
+void print_list(linked_list *l);
+
+int next_config(int* c, int size);
+
+int identifier_size(int *id, int size);
+
+bool equal_identifier(int *id1, int *id2, int size);
+
+int obtain_weigth(int *c, int size);
+
+void create_vertex_graph_cfg(int k, int z, lemon::SmartGraph *H);
+
+void list_barcodes(linked_list *l, std::vector<uint64_t> *bar);
+
+int create_graph_cfg(linked_list *l, int k, int z, const hk_checker *checker,
+		     checkpoint *ckpt, run_metrics *metrics);
+
+int append_barcodes(linked_list *l, const uint64_t *barcodes, size_t amt);
+
+int extend_graph_cfg(linked_list *l, int k, barcode_table *cache);
+
+int load_graph_cfg(linked_list *l, const uint64_t *bar, size_t amt);
+
+int check_bar_code(int *bar1, int *bar2, int z, int k);
+
+long long greatest_common_divisor(long long a, long long b);
+
+int allocate_edge_config_graph(lemon::SmartDigraph *G,
+			       lemon::SmartDigraph::NodeMap<node *> &map_vertices,
+			       int vertex_size, int k,
+			       lemon::SmartDigraph::ArcMap<int> *weight,
+			       int target_weight, const hk_checker *checker,
+			       external_graph *external, checkpoint *ckpt,
+			       run_metrics *metrics);
+
+void config_graph_arrays(lemon::SmartDigraph &G,
+			 lemon::SmartDigraph::NodeMap<node *> &map_vertices,
+			 int vertex_size, std::vector<uint64_t> *bar,
+			 std::vector<int32_t> *node_weight);
+
+void cycle_barcodes(lemon::SmartDigraph &G,
+		    lemon::Path<lemon::SmartDigraph> &cycle,
+		    lemon::SmartDigraph::NodeMap<node *> &map_vertices, int k,
+		    std::vector<uint64_t> *bar);
+
+void decode_pattern(int k, const std::vector<uint64_t> &bar,
+		    hk_pattern *pattern);
+
+int library_barcodes(int k, int row_extension, hk_barcodes *barcodes);
+
+int library_graph(const hk_barcodes &barcodes, hk_graph *graph);
+
+mmc_engine run_anytime_mmc(lemon::SmartDigraph *G,
+			   lemon::SmartDigraph::NodeMap<node *> &map_vertices,
+			   int vertex_size, int k,
+			   lemon::SmartDigraph::ArcMap<int> *weight,
+			   const hk_options *options,
+			   const hk_checker *checker, mmc_result *mmc,
+			   run_metrics *metrics);
+
+int run_differential(int k, const hk_checker *checker, uint64_t seed);
+
+int run_mmc_step(lemon::SmartDigraph *G,
+		 lemon::SmartDigraph::NodeMap<node *> &map_vertices,
+		 int vertex_size, int k,
+		 lemon::SmartDigraph::ArcMap<int> *weight,
+		 const hk_options *options, const hk_checker *checker,
+		 const std::string &certificate_path, int max_length,
+		 const external_graph *external,
+		 std::vector<long long> *period_cost, pruning_stats *pruning,
+		 mmc_engine *engine, mmc_result *mmc, run_metrics *metrics);
+
+}
+
+#endif
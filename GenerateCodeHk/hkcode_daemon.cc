@@ -0,0 +1,664 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Solver daemon: answers queries about the codes of H_k over a Unix
+   domain socket, keeping in memory the configuration graphs (with their
+   bar codes) and the codes already found, so a script which asks for
+   many codes (different k, bars and MMC engines) builds each graph only
+   once. The threads of OpenMP, used by the kernels, also stay alive
+   between the queries.
+
+   Each request is a line, and each answer a JSON object in a line:
+
+       solve BARS K [ENGINE]  the code of H_k with the smallest density
+                              (BARS is 6 or 8, ENGINE one of --mmc)
+       count BARS K           the number of bar codes and of arcs of the
+                              configuration graph
+       stats                  the graphs and codes kept in memory
+       drop [BARS K]          forgets one graph (or all of them)
+       shutdown               stops the daemon
+
+   A client may send any number of requests in a connection, e.g.
+
+       echo "solve 6 3 howard" | socat - UNIX-CONNECT:/tmp/hkcode.sock
+
+   The program is linked with libhkcode (see hkcode.h):
+
+       g++ -O2 -fopenmp hkcode_daemon.cc -L. -lhkcode -lemon -fopenmp \
+           -o hkcode_daemon
+*/
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "hkcode.h"
+
+
+/* Namespaces - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+using namespace std;
+using namespace std::chrono;
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// socket of the daemon, when --socket is not given
+#define DAEMON_DEFAULT_SOCKET "/tmp/hkcode.sock"
+
+// memory kept for the configuration graphs, in MB, when --cache-mb is
+// not given; the graphs used least recently are forgotten first
+#define DAEMON_DEFAULT_CACHE_MB 4096
+
+// the longest request accepted, in bytes
+#define DAEMON_MAX_REQUEST 4096
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: daemon_options
+ * ----------------------
+ * The options of the daemon
+ *
+ *   socket: the path of the socket
+ * cache_mb: the memory kept for the configuration graphs, in MB
+ *  threads: the number of threads of OpenMP (0: the default)
+ */
+struct daemon_options
+{
+  const char *socket;
+  long long   cache_mb;
+  int         threads;
+};
+
+typedef struct daemon_options daemon_options;
+
+/*
+ * Struct: cached_graph
+ * --------------------
+ * A configuration graph kept in memory
+ *
+ *    graph: the graph, with its bar codes
+ *    bytes: the memory used by the graph
+ * last_use: the number of the last request which used it
+ */
+struct cached_graph
+{
+  hk_graph  graph;
+  long long bytes;
+  long long last_use;
+};
+
+typedef struct cached_graph cached_graph;
+
+/*
+ * Struct: solver_state
+ * --------------------
+ * What the daemon keeps between the requests
+ *
+ *   graphs: the configuration graphs, by (bars, k)
+ * patterns: the codes found, by (bars, k, engine requested)
+ *    bytes: the memory used by the graphs
+ *    limit: the most memory used by the graphs
+ * requests: the number of requests answered
+ *     hits: the number of requests answered from memory
+ */
+struct solver_state
+{
+  map<pair<int, int>, cached_graph>         graphs;
+  map<tuple<int, int, int>, hk_pattern>     patterns;
+  long long                                 bytes;
+  long long                                 limit;
+  long long                                 requests;
+  long long                                 hits;
+};
+
+typedef struct solver_state solver_state;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: print_daemon_usage
+ * ----------------------------
+ * Outputs the options of the daemon
+ */
+void print_daemon_usage(const char *program)
+{
+  cerr << "Usage: " << program << " [options]\n"
+       << "  --socket=PATH  socket of the daemon (" DAEMON_DEFAULT_SOCKET
+       << " by default)\n"
+       << "  --cache-mb=MB  memory kept for the configuration graphs ("
+       << DAEMON_DEFAULT_CACHE_MB << " by default)\n"
+       << "  --threads=N    number of threads of the kernels\n";
+}
+
+/*
+ * Function: parse_daemon_options
+ * ------------------------------
+ * Reads the options of the daemon
+ *
+ * returns: 1 if the arguments are valid, otherwise, 0 (after printing the
+ *          usage)
+ */
+int parse_daemon_options(int argc, char **argv, daemon_options *options)
+{
+  int i;
+
+  options->socket = DAEMON_DEFAULT_SOCKET;
+  options->cache_mb = DAEMON_DEFAULT_CACHE_MB;
+  options->threads = 0;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (strncmp(argv[i], "--socket=", 9) == 0 && argv[i][9] != '\0')
+	{
+	  // the path is not truncated to the size of sun_path
+	  if (strlen(argv[i] +9) >= sizeof(((sockaddr_un *) 0)->sun_path))
+	    {
+	      cerr << "The path of the socket must have less than "
+		   << sizeof(((sockaddr_un *) 0)->sun_path)
+		   << " characters!\n";
+	      return 0;
+	    }
+	  options->socket = argv[i] +9;
+	}
+      else if (strncmp(argv[i], "--cache-mb=", 11) == 0 &&
+	       atoll(argv[i] +11) >= 0)
+	options->cache_mb = atoll(argv[i] +11);
+      else if (strncmp(argv[i], "--threads=", 10) == 0 &&
+	       atoi(argv[i] +10) >= 1)
+	options->threads = atoi(argv[i] +10);
+      else
+	{
+	  cerr << "Invalid argument: " << argv[i] << "\n";
+	  print_daemon_usage(argv[0]);
+	  return 0;
+	}
+    }
+
+  return 1;
+}
+
+/*
+ * Function: kernel_threads
+ * ------------------------
+ * returns: the number of threads of OpenMP used by the kernels (1 when
+ *          the daemon is built without OpenMP)
+ */
+int kernel_threads()
+{
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+/*
+ * Function: graph_bytes
+ * ---------------------
+ * returns: the memory used by a configuration graph
+ */
+long long graph_bytes(const hk_graph &graph)
+{
+  return (long long) (graph.bar.capacity() * sizeof(uint64_t) +
+		      graph.node_weight.capacity() * sizeof(int32_t) +
+		      graph.offsets.capacity() * sizeof(int64_t) +
+		      graph.targets.capacity() * sizeof(int32_t));
+}
+
+/*
+ * Function: evict_graphs
+ * ----------------------
+ * Forgets the graphs used least recently, except the one of key, until
+ * the graphs fit in the memory of the daemon
+ */
+void evict_graphs(solver_state *state, pair<int, int> key)
+{
+  map<pair<int, int>, cached_graph>::iterator it, oldest;
+
+  while (state->bytes > state->limit)
+    {
+      oldest = state->graphs.end();
+      for (it = state->graphs.begin(); it != state->graphs.end(); ++it)
+	if (it->first != key && (oldest == state->graphs.end() ||
+				 it->second.last_use < oldest->second.last_use))
+	  oldest = it;
+
+      if (oldest == state->graphs.end())
+	return;
+
+      state->bytes -= oldest->second.bytes;
+      state->graphs.erase(oldest);
+    }
+}
+
+/*
+ * Function: get_graph
+ * -------------------
+ * Finds the configuration graph of (bars, k) in memory or builds it
+ *
+ *  state: what the daemon keeps
+ *   bars: HK_BARS_6 or HK_BARS_8
+ *      k: the number of lines of the hexagonal grid
+ * cached: where 1 is stored if the graph was in memory, otherwise, 0
+ *
+ * returns: the graph, or NULL if it was not possible to build it
+ */
+const hk_graph *get_graph(solver_state *state, int bars, int k, int *cached)
+{
+  map<pair<int, int>, cached_graph>::iterator it;
+  hk_barcodes barcodes;
+  cached_graph entry;
+
+  it = state->graphs.find(make_pair(bars, k));
+  *cached = (it != state->graphs.end()) ? 1 : 0;
+
+  if (*cached == 0)
+    {
+      if (hk_build_barcodes(bars, k, 1, &barcodes) == 0 ||
+	  hk_build_graph(barcodes, &entry.graph) == 0)
+	return NULL;
+
+      entry.bytes = graph_bytes(entry.graph);
+      it = state->graphs.insert(make_pair(make_pair(bars, k), entry)).first;
+      state->bytes += entry.bytes;
+      evict_graphs(state, make_pair(bars, k));
+    }
+
+  it->second.last_use = state->requests;
+  return &it->second.graph;
+}
+
+/*
+ * Function: print_answer_head
+ * ---------------------------
+ * Outputs the beginning of the JSON object of an answer
+ */
+void print_answer_head(ostream &out, const char *request, int bars, int k)
+{
+  out << "{\"ok\":1,\"request\":\"" << request << "\",\"bars\":" << bars
+      << ",\"k\":" << k;
+}
+
+/*
+ * Function: answer_solve
+ * ----------------------
+ * Answers "solve BARS K [ENGINE]"
+ */
+void answer_solve(solver_state *state, int bars, int k, mmc_engine engine,
+		  ostream &out)
+{
+  map<tuple<int, int, int>, hk_pattern>::iterator it;
+  tuple<int, int, int> key;
+  const hk_graph *graph;
+  hk_solution solution;
+  hk_pattern pattern;
+  steady_clock::time_point start;
+  const char *cached;
+  int graph_cached;
+  size_t i;
+
+  start = steady_clock::now();
+  key = make_tuple(bars, k, (int) engine);
+  it = state->patterns.find(key);
+
+  if (it != state->patterns.end())
+    {
+      cached = "code";
+      // the graph stays as recently used as its codes
+      if (state->graphs.count(make_pair(bars, k)) > 0)
+	state->graphs[make_pair(bars, k)].last_use = state->requests;
+    }
+  else
+    {
+      graph = get_graph(state, bars, k, &graph_cached);
+      if (graph == NULL)
+	{
+	  out << "{\"ok\":0,\"error\":\"it was not possible to build the "
+	      << "configuration graph\"}\n";
+	  return;
+	}
+
+      if (hk_solve(*graph, engine, &solution) == 0 ||
+	  hk_decode_pattern(*graph, solution, &pattern) == 0)
+	{
+	  out << "{\"ok\":0,\"error\":\"the configuration graph has no "
+	      << "cycle\"}\n";
+	  return;
+	}
+
+      it = state->patterns.insert(make_pair(key, pattern)).first;
+      cached = (graph_cached == 1) ? "graph" : "none";
+    }
+
+  if (strcmp(cached, "none") != 0)
+    state->hits++;
+
+  print_answer_head(out, "solve", bars, k);
+  out << ",\"engine\":\"" << mmc_engine_name(engine) << "\",\"density\":\""
+      << it->second.density_num << "/" << it->second.density_den
+      << "\",\"columns\":" << it->second.columns << ",\"vertices\":[";
+  for (i = 0; i < it->second.vertices.size(); i++)
+    out << ((i > 0) ? "," : "") << "[" << it->second.vertices[i].first
+	<< "," << it->second.vertices[i].second << "]";
+  out << "],\"cached\":\"" << cached << "\",\"ms\":"
+      << duration_cast<milliseconds>(steady_clock::now() - start).count()
+      << "}\n";
+}
+
+/*
+ * Function: answer_count
+ * ----------------------
+ * Answers "count BARS K"
+ */
+void answer_count(solver_state *state, int bars, int k, ostream &out)
+{
+  const hk_graph *graph;
+  int cached;
+
+  graph = get_graph(state, bars, k, &cached);
+  if (graph == NULL)
+    {
+      out << "{\"ok\":0,\"error\":\"it was not possible to build the "
+	  << "configuration graph\"}\n";
+      return;
+    }
+
+  if (cached == 1)
+    state->hits++;
+
+  print_answer_head(out, "count", bars, k);
+  out << ",\"barcodes\":" << graph->bar.size() << ",\"arcs\":"
+      << graph->targets.size() << ",\"cached\":\""
+      << ((cached == 1) ? "graph" : "none") << "\"}\n";
+}
+
+/*
+ * Function: answer_stats
+ * ----------------------
+ * Answers "stats"
+ */
+void answer_stats(const solver_state &state, ostream &out)
+{
+  map<pair<int, int>, cached_graph>::const_iterator it;
+
+  out << "{\"ok\":1,\"request\":\"stats\",\"requests\":" << state.requests
+      << ",\"hits\":" << state.hits << ",\"bytes\":" << state.bytes
+      << ",\"limit\":" << state.limit << ",\"codes\":"
+      << state.patterns.size() << ",\"threads\":" << kernel_threads()
+      << ",\"graphs\":[";
+  for (it = state.graphs.begin(); it != state.graphs.end(); ++it)
+    out << ((it != state.graphs.begin()) ? "," : "") << "{\"bars\":"
+	<< it->first.first << ",\"k\":" << it->first.second << ",\"bytes\":"
+	<< it->second.bytes << "}";
+  out << "]}\n";
+}
+
+/*
+ * Function: answer_drop
+ * ---------------------
+ * Answers "drop [BARS K]": forgets the graphs (the codes found are kept)
+ */
+void answer_drop(solver_state *state, int bars, int k, ostream &out)
+{
+  map<pair<int, int>, cached_graph>::iterator it;
+  int dropped;
+
+  dropped = 0;
+  for (it = state->graphs.begin(); it != state->graphs.end(); )
+    if (bars == 0 || it->first == make_pair(bars, k))
+      {
+	state->bytes -= it->second.bytes;
+	it = state->graphs.erase(it);
+	dropped++;
+      }
+    else
+      ++it;
+
+  out << "{\"ok\":1,\"request\":\"drop\",\"graphs\":" << dropped << "}\n";
+}
+
+/*
+ * Function: answer_request
+ * ------------------------
+ * Answers a request
+ *
+ *   state: what the daemon keeps
+ * request: the line of the request
+ *     out: where the answer is written
+ *
+ * returns: 0 if the request was "shutdown", otherwise, 1
+ */
+int answer_request(solver_state *state, const string &request, ostream &out)
+{
+  istringstream in(request);
+  string command, engine_name, extra;
+  mmc_engine engine;
+  int bars, k, has_graph;
+
+  state->requests++;
+  bars = k = 0;
+  engine = MMC_HOWARD;
+  if (!(in >> command))
+    {
+      out << "{\"ok\":0,\"error\":\"empty request\"}\n";
+      return 1;
+    }
+
+  has_graph = (in >> bars >> k) ? 1 : 0;
+  if (has_graph == 1 && ((bars != HK_BARS_6 && bars != HK_BARS_8) ||
+			 k < 2 || k > 16))
+    {
+      out << "{\"ok\":0,\"error\":\"BARS must be 6 or 8 and K from 2 to "
+	  << "16\"}\n";
+      return 1;
+    }
+
+  if (in >> engine_name &&
+      parse_mmc_engine(engine_name.c_str(), &engine) == 0)
+    {
+      out << "{\"ok\":0,\"error\":\"unknown engine\"}\n";
+      return 1;
+    }
+
+  if (command == "solve" && has_graph == 1 && !(in >> extra))
+    answer_solve(state, bars, k, engine, out);
+  else if (command == "count" && has_graph == 1 && engine_name.empty())
+    answer_count(state, bars, k, out);
+  else if (command == "stats" && has_graph == 0 && bars == 0)
+    answer_stats(*state, out);
+  else if (command == "drop" && engine_name.empty() &&
+	   (has_graph == 1 || bars == 0))
+    answer_drop(state, bars, k, out);
+  else if (command == "shutdown")
+    {
+      out << "{\"ok\":1,\"request\":\"shutdown\"}\n";
+      return 0;
+    }
+  else
+    out << "{\"ok\":0,\"error\":\"invalid request\"}\n";
+
+  return 1;
+}
+
+/*
+ * Function: serve_client
+ * ----------------------
+ * Answers the requests of a connection, line by line, until the client
+ * closes it
+ *
+ *  state: what the daemon keeps
+ * client: the socket of the connection
+ *
+ * returns: 0 if the client asked to stop the daemon, otherwise, 1
+ */
+int serve_client(solver_state *state, int client)
+{
+  char buffer[DAEMON_MAX_REQUEST];
+  string pending, answer;
+  ostringstream out;
+  size_t end;
+  ssize_t amt;
+  int running;
+
+  running = 1;
+  while (running == 1 && (amt = recv(client, buffer, sizeof(buffer), 0)) > 0)
+    {
+      pending.append(buffer, (size_t) amt);
+      while (running == 1 && (end = pending.find('\n')) != string::npos)
+	{
+	  out.str("");
+	  running = answer_request(state, pending.substr(0, end), out);
+	  pending.erase(0, end +1);
+
+	  answer = out.str();
+	  if (send(client, answer.data(), answer.size(), MSG_NOSIGNAL) < 0)
+	    return running;
+	}
+
+      if (pending.size() > DAEMON_MAX_REQUEST)
+	{
+	  answer = "{\"ok\":0,\"error\":\"request too long\"}\n";
+	  send(client, answer.data(), answer.size(), MSG_NOSIGNAL);
+	  return 1;
+	}
+    }
+
+  return running;
+}
+
+/*
+ * Function: open_socket
+ * ---------------------
+ * Creates the socket of the daemon, only readable and writable by its
+ * user, replacing the file of a daemon which has stopped (a socket which
+ * refuses the connections)
+ *
+ * returns: the socket, -2 if a daemon is already listening on the path,
+ *          or -1 if it was not possible to create it
+ */
+int open_socket(const char *path)
+{
+  sockaddr_un address;
+  struct stat info;
+  int server, probe;
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path, sizeof(address.sun_path) -1);
+
+  // the file is only removed when it is the socket of a stopped daemon
+  if (lstat(path, &info) == 0)
+    {
+      if (S_ISSOCK(info.st_mode) == 0)
+	return -1;
+
+      probe = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (probe < 0)
+	return -1;
+
+      if (connect(probe, (sockaddr *) &address, sizeof(address)) == 0)
+	{
+	  close(probe);
+	  return -2;
+	}
+
+      if (errno != ECONNREFUSED)
+	{
+	  close(probe);
+	  return -1;
+	}
+
+      close(probe);
+      unlink(path);
+    }
+
+  server = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0)
+    return -1;
+
+  if (bind(server, (sockaddr *) &address, sizeof(address)) < 0)
+    {
+      close(server);
+      return -1;
+    }
+
+  // any user who can write to the socket can stop the daemon
+  if (chmod(path, 0600) < 0 || listen(server, SOMAXCONN) < 0)
+    {
+      close(server);
+      unlink(path);
+      return -1;
+    }
+
+  return server;
+}
+
+
+/* Main Program - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+int main(int argc, char **argv)
+{
+  daemon_options options;
+  solver_state state;
+  int server, client, running;
+
+  if (parse_daemon_options(argc, argv, &options) == 0)
+    return EXIT_FAILURE;
+
+#ifdef _OPENMP
+  if (options.threads > 0)
+    omp_set_num_threads(options.threads);
+#endif
+
+  server = open_socket(options.socket);
+  if (server == -2)
+    {
+      cerr << "A daemon is already listening on " << options.socket
+	   << "!\n";
+      return EXIT_FAILURE;
+    }
+  if (server < 0)
+    {
+      cerr << "It was not possible to create the socket " << options.socket
+	   << "!\n";
+      return EXIT_FAILURE;
+    }
+
+  state.bytes = 0;
+  state.limit = options.cache_mb * 1024 * 1024;
+  state.requests = 0;
+  state.hits = 0;
+
+  cout << "Waiting for requests on " << options.socket << "\n";
+  running = 1;
+  while (running == 1)
+    {
+      client = accept(server, NULL, NULL);
+      if (client < 0)
+	continue;
+
+      running = serve_client(&state, client);
+      close(client);
+    }
+
+  close(server);
+  unlink(options.socket);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,494 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Independent check of the periodic identifying codes saved in ../Codes,
+   both by the programs of the configuration graph
+   (CodigoH<k>GrafoConfig.txt) and by GenerateHkCode.py
+   (CodigoH<k>PL.txt), used by Hk_verify_code.cc. A file has the number
+   of lines k, the number of columns of the pattern (its period) and the
+   density in the first line, and the vertices of the code in the second
+   one, as (column, line), with the lines numbered from 1.
+
+   The infinite strip of H_k is represented by one bit mask per line with
+   a bit per column of the period (the columns wrap around, so the
+   boundary of the period is checked like any other column), and every
+   condition is evaluated on whole words of 64 columns:
+
+     - domination: every vertex v has some vertex of the code in its
+       closed neighbourhood N[v];
+     - separation: N[u] and N[v] have different vertices of the code for
+       every pair u, v at distance at most 2 (the farther pairs have
+       disjoint neighbourhoods, already separated by the domination).
+
+   For a pair of vertices at a given offset, the vertices of N[u] and
+   N[v] which are not in both neighbourhoods (their symmetric difference)
+   only depend on the line and on the parity of the column, so the
+   separation of all the pairs of a line is the union of a few rotations
+   of the masks of the lines around it. Everything is linear in the
+   number of vertices of the pattern.
+
+   In H_k (allocate_hexagonal_grid), the vertical edge between the lines
+   r and r +1 (numbered from 1) is in the columns c with c + r odd;
+   build_grid_hk of GenerateHkCode.py uses the columns with c + r even,
+   that is, the same grid translated by one column. A code is checked
+   with both parities, and the one in which it is an identifying code is
+   reported. A pattern with an odd number of columns is repeated twice,
+   so the parity of the columns is periodic too.
+*/
+
+#ifndef IDCODE_CHECK_H
+#define IDCODE_CHECK_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// the largest number of lines of a pattern
+#define IDCODE_MAX_LINES 64
+
+// the largest horizontal distance between a vertex and a vertex of the
+// neighbourhood of a vertex at distance at most 2 of it
+#define IDCODE_MAX_SHIFT 3
+
+// the density in a file may be rounded to this precision
+#define IDCODE_DENSITY_TOLERANCE 1e-6
+
+// parity of the columns with vertical edges: c + r odd (the programs of
+// the configuration graph), or c + r even (GenerateHkCode.py)
+#define IDCODE_PARITY_PROGRAMS 0
+#define IDCODE_PARITY_LP 1
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: periodic_code
+ * ---------------------
+ * A periodic identifying code, as saved in a file
+ *
+ *     lines: the number of lines of the hexagonal grid (k)
+ *   columns: the number of columns of the pattern
+ *   density: the density written in the file
+ *  vertices: the vertices of the code, as (column, line)
+ */
+struct periodic_code
+{
+  int                              lines;
+  int                              columns;
+  double                           density;
+  std::vector<std::pair<int, int>> vertices;
+};
+
+typedef struct periodic_code periodic_code;
+
+/*
+ * Struct: code_strip
+ * ------------------
+ * The pattern of a code over the infinite strip, one bit mask per line
+ *
+ *  lines: the number of lines
+ * period: the number of columns of a mask (the pattern, or twice it)
+ *  words: the number of words of a mask
+ *   bits: the bit c of the word c / 64 of the line r (from 0) is
+ *         bits[r * words + c / 64]
+ */
+struct code_strip
+{
+  int                   lines;
+  int                   period;
+  int                   words;
+  std::vector<uint64_t> bits;
+};
+
+typedef struct code_strip code_strip;
+
+/*
+ * Struct: code_report
+ * -------------------
+ * The result of the check of a code
+ *
+ *       valid: 1 if the pattern is an identifying code, otherwise, 0
+ *      parity: the parity of the columns with vertical edges in which it
+ *              is (IDCODE_PARITY_PROGRAMS or IDCODE_PARITY_LP)
+ *    vertices: the number of vertices of the code in the pattern
+ * density_num: the density of the code is density_num / density_den, in
+ * density_den  its lowest terms
+ *       error: what is wrong, for the parity of the programs
+ */
+struct code_report
+{
+  int         valid;
+  int         parity;
+  long long   vertices;
+  long long   density_num;
+  long long   density_den;
+  std::string error;
+};
+
+typedef struct code_report code_report;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: read_periodic_code
+ * ----------------------------
+ * Reads a file of ../Codes
+ *
+ *  path: the file
+ *  code: where the code is stored
+ * error: where what is wrong is stored
+ *
+ * returns: 1 if the file has a valid pattern, otherwise, 0
+ */
+inline int read_periodic_code(const std::string &path, periodic_code *code,
+			      std::string *error)
+{
+  std::ifstream file;
+  std::string token;
+  int column, line;
+  char open, comma, close;
+
+  file.open(path);
+  if (!file.is_open())
+    {
+      *error = "it was not possible to open the file";
+      return 0;
+    }
+
+  if (!(file >> code->lines >> code->columns >> code->density) ||
+      code->lines < 1 || code->lines > IDCODE_MAX_LINES ||
+      code->columns < 1)
+    {
+      *error = "the first line must have the lines, columns and density";
+      return 0;
+    }
+
+  code->vertices.clear();
+  while (file >> token)
+    {
+      std::istringstream pair(token);
+
+      if (!(pair >> open >> column >> comma >> line >> close) ||
+	  open != '(' || comma != ',' || close != ')' || line < 1 ||
+	  line > code->lines)
+	{
+	  *error = "invalid vertex " + token;
+	  return 0;
+	}
+
+      code->vertices.push_back(std::make_pair(column, line));
+    }
+
+  return 1;
+}
+
+/*
+ * Function: make_code_strip
+ * -------------------------
+ * Builds the bit masks of the pattern of a code (the vertices may be
+ * given more than once, or in any column congruent to their column)
+ *
+ *  code: the code
+ * strip: where the masks are stored
+ */
+inline void make_code_strip(const periodic_code &code, code_strip *strip)
+{
+  size_t i;
+  int column, copy;
+
+  strip->lines = code.lines;
+  strip->period = (code.columns % 2 == 0) ? code.columns : 2 * code.columns;
+  strip->words = (strip->period + 63) / 64;
+  strip->bits.assign((size_t) strip->lines * strip->words, 0);
+
+  for (i = 0; i < code.vertices.size(); i++)
+    for (copy = 0; copy < strip->period; copy += code.columns)
+      {
+	column = ((code.vertices[i].first % code.columns + code.columns) %
+		  code.columns) + copy;
+	strip->bits[(size_t) (code.vertices[i].second -1) * strip->words +
+		    column / 64] |= 1ULL << (column % 64);
+      }
+}
+
+/*
+ * Function: strip_rotate
+ * ----------------------
+ * Rotates the mask of a line: the bit c of dst is the bit c + shift
+ * (modulo the period) of src
+ *
+ *    src: the mask
+ * period: the number of columns of the mask
+ *  words: the number of words of the mask
+ *  shift: the rotation, from -IDCODE_MAX_SHIFT to IDCODE_MAX_SHIFT
+ *    dst: where the rotated mask is stored
+ */
+inline void strip_rotate(const uint64_t *src, int period, int words,
+			 int shift, uint64_t *dst)
+{
+  std::vector<uint64_t> repeated; // src repeated, so the words of dst
+				  // are read without wrapping around
+  int base, size, c, w, b;
+
+  // the column base of repeated is the column 0 of src, and the columns
+  // before it are the last ones of the period
+  base = period * ((IDCODE_MAX_SHIFT + period -1) / period);
+  size = base + IDCODE_MAX_SHIFT + 64 * (words +1);
+  repeated.assign(size / 64 +1, 0);
+  for (c = 0; c < size; c++)
+    if ((src[(c % period) / 64] >> ((c % period) % 64) & 1) != 0)
+      repeated[c / 64] |= 1ULL << (c % 64);
+
+  for (w = 0; w < words; w++)
+    {
+      c = base + shift + w * 64;
+      b = c % 64;
+      dst[w] = repeated[c / 64] >> b;
+      if (b != 0)
+	dst[w] |= repeated[c / 64 +1] << (64 - b);
+    }
+
+  // the bits after the period are not columns
+  if (period % 64 != 0)
+    dst[words -1] &= (1ULL << (period % 64)) -1;
+}
+
+/*
+ * Function: strip_neighbourhood
+ * -----------------------------
+ * The closed neighbourhood of a vertex, as offsets (column, line) from it
+ *
+ *  strip: the pattern
+ *   line: the line of the vertex (from 0)
+ *     up: 1 if the vertex has a vertical edge to the line above,
+ *         otherwise, 0 (to the line below)
+ * offset: where the offsets are stored
+ */
+inline void strip_neighbourhood(const code_strip &strip, int line, int up,
+				std::vector<std::pair<int, int>> *offset)
+{
+  offset->clear();
+  offset->push_back(std::make_pair(-1, 0));
+  offset->push_back(std::make_pair(0, 0));
+  offset->push_back(std::make_pair(1, 0));
+
+  if (up == 1 && line +1 < strip.lines)
+    offset->push_back(std::make_pair(0, 1));
+  else if (up == 0 && line > 0)
+    offset->push_back(std::make_pair(0, -1));
+}
+
+/*
+ * Function: strip_covered
+ * -----------------------
+ * Finds the columns of a line, among the columns of a mask, in which a
+ * set of vertices (given as offsets) has some vertex of the code
+ *
+ *   strip: the pattern
+ * rotated: rotated[(s + IDCODE_MAX_SHIFT) * lines + r] is the mask of
+ *          the line r rotated by s
+ *    line: the line (from 0)
+ *  offset: the offsets (column, line) of the vertices
+ *    mask: the columns considered
+ *
+ * returns: the first column of mask in which no vertex of the set is in
+ *          the code, or -1
+ */
+inline int strip_covered(const code_strip &strip,
+			 const std::vector<std::vector<uint64_t>> &rotated,
+			 int line,
+			 const std::vector<std::pair<int, int>> &offset,
+			 const std::vector<uint64_t> &mask)
+{
+  uint64_t covered;
+  size_t i;
+  int w;
+
+  for (w = 0; w < strip.words; w++)
+    {
+      covered = 0;
+      for (i = 0; i < offset.size(); i++)
+	covered |= rotated[(offset[i].first + IDCODE_MAX_SHIFT) *
+			   strip.lines + line + offset[i].second][w];
+
+      if ((covered & mask[w]) != mask[w])
+	return w * 64 + __builtin_ctzll(mask[w] & ~covered);
+    }
+
+  return -1;
+}
+
+/*
+ * Function: check_code_strip
+ * --------------------------
+ * Checks that the pattern is an identifying code of the strip
+ *
+ *  strip: the pattern
+ * parity: the parity of the columns with vertical edges
+ *  error: where the first vertex (or pair) which fails is described
+ *
+ * returns: 1 if it is an identifying code, otherwise, 0
+ */
+inline int check_code_strip(const code_strip &strip, int parity,
+			    std::string *error)
+{
+  // the pairs at distance at most 2, as offsets (column, line)
+  static const int pair_offset[][2] = { {1, 0}, {2, 0}, {-1, 1}, {0, 1},
+					{1, 1} };
+  std::vector<std::vector<uint64_t>> rotated;
+  std::vector<uint64_t> mask;
+  std::vector<std::pair<int, int>> near_u, near_v, difference;
+  std::ostringstream what;
+  size_t i, j, p;
+  int r, s, up, c, column;
+
+  // every line rotated by -IDCODE_MAX_SHIFT, ..., IDCODE_MAX_SHIFT
+  rotated.resize((size_t) (2 * IDCODE_MAX_SHIFT +1) * strip.lines);
+  for (s = -IDCODE_MAX_SHIFT; s <= IDCODE_MAX_SHIFT; s++)
+    for (r = 0; r < strip.lines; r++)
+      {
+	std::vector<uint64_t> &dst =
+	  rotated[(s + IDCODE_MAX_SHIFT) * strip.lines + r];
+
+	dst.resize(strip.words);
+	strip_rotate(&strip.bits[(size_t) r * strip.words], strip.period,
+		     strip.words, s, dst.data());
+      }
+
+  mask.resize(strip.words);
+  for (r = 0; r < strip.lines; r++)
+    for (up = 0; up <= 1; up++)
+      {
+	// the columns of the line with a vertical edge up (or down): the
+	// edge between the lines r and r +1 (from 0) is in the columns c
+	// with c + r even (parity 0) or odd (parity 1)
+	for (j = 0; j < mask.size(); j++)
+	  mask[j] = 0;
+	for (c = 0; c < strip.period; c++)
+	  if (((c + r + parity) % 2 == 0) == (up == 1))
+	    mask[c / 64] |= 1ULL << (c % 64);
+
+	strip_neighbourhood(strip, r, up, &near_u);
+	column = strip_covered(strip, rotated, r, near_u, mask);
+	if (column != -1)
+	  {
+	    what << "(" << column << "," << r +1 << ") is not dominated";
+	    *error = what.str();
+	    return 0;
+	  }
+
+	for (p = 0; p < sizeof(pair_offset) / sizeof(pair_offset[0]); p++)
+	  {
+	    const int dc = pair_offset[p][0];
+	    const int dr = pair_offset[p][1];
+
+	    if (r + dr >= strip.lines)
+	      continue;
+
+	    // the vertex v = u + (dc, dr) has a vertical edge up when u
+	    // has one, if dc + dr is even
+	    strip_neighbourhood(strip, r + dr,
+				((dc + dr) % 2 == 0) ? up : 1 - up, &near_v);
+	    for (j = 0; j < near_v.size(); j++)
+	      {
+		near_v[j].first += dc;
+		near_v[j].second += dr;
+	      }
+
+	    // the symmetric difference of N[u] and N[v]
+	    difference.clear();
+	    for (i = 0; i < near_u.size(); i++)
+	      if (std::find(near_v.begin(), near_v.end(), near_u[i]) ==
+		  near_v.end())
+		difference.push_back(near_u[i]);
+	    for (j = 0; j < near_v.size(); j++)
+	      if (std::find(near_u.begin(), near_u.end(), near_v[j]) ==
+		  near_u.end())
+		difference.push_back(near_v[j]);
+
+	    column = strip_covered(strip, rotated, r, difference, mask);
+	    if (column != -1)
+	      {
+		what << "(" << column << "," << r +1 << ") and ("
+		     << (column + dc + strip.period) % strip.period << ","
+		     << r + dr +1 << ") are not separated";
+		*error = what.str();
+		return 0;
+	      }
+	  }
+      }
+
+  return 1;
+}
+
+/*
+ * Function: check_periodic_code
+ * -----------------------------
+ * Checks a code with both parities of the columns with vertical edges
+ * and computes its exact density
+ *
+ *   code: the code
+ * report: where the result is stored
+ *
+ * returns: 1 if it is an identifying code, otherwise, 0
+ */
+inline int check_periodic_code(const periodic_code &code,
+			       code_report *report)
+{
+  code_strip strip;
+  std::string other;
+  long long size, a, b, t;
+  size_t i;
+
+  make_code_strip(code, &strip);
+
+  // the vertices of one copy of the pattern
+  report->vertices = 0;
+  for (i = 0; i < strip.bits.size(); i++)
+    report->vertices += __builtin_popcountll(strip.bits[i]);
+  report->vertices /= strip.period / code.columns;
+
+  size = (long long) code.columns * code.lines;
+  for (a = report->vertices, b = size; b != 0; t = a % b, a = b, b = t)
+    ;
+  report->density_num = report->vertices / a;
+  report->density_den = size / a;
+
+  report->error.clear();
+  report->parity = IDCODE_PARITY_PROGRAMS;
+  report->valid = check_code_strip(strip, IDCODE_PARITY_PROGRAMS,
+				   &report->error);
+  if (report->valid == 0 &&
+      check_code_strip(strip, IDCODE_PARITY_LP, &other) == 1)
+    {
+      report->parity = IDCODE_PARITY_LP;
+      report->valid = 1;
+    }
+
+  // the density written in the file must be the one of the pattern
+  if (report->valid == 1 &&
+      std::fabs(code.density - (double) report->density_num /
+		report->density_den) > IDCODE_DENSITY_TOLERANCE)
+    {
+      report->valid = 0;
+      report->error = "the density in the file is not the density of"
+	" the pattern";
+    }
+
+  return report->valid;
+}
+
+#endif
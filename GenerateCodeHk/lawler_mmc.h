@@ -0,0 +1,351 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Implementation of Lawler's parametric search to find a minimum mean
+   cycle: a binary search on the mean lambda, where each probe checks if
+   the configuration graph has a negative cycle with the weights
+   w - lambda. The negative cycles are detected by a frontier based
+   Bellman-Ford, in which the vertices touched by the frontier are
+   relaxed in parallel (OpenMP).
+
+   The probes are done on the grid lambda = t / D, with D = 4 n^2. Two
+   cycle means (fractions with denominator at most n) differ by at least
+   1 / n^2, so once the interval is narrower than 2 / D the best cycle
+   found is a minimum mean cycle. The search reads the arcs directly
+   from the SmartDigraph and only needs O(n) extra memory.
+*/
+
+#ifndef LAWLER_MMC_H
+#define LAWLER_MMC_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <vector>
+#include <lemon/smart_graph.h>
+#include <lemon/path.h>
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// number of rounds of Bellman-Ford between two searches for a cycle in
+// the graph of predecessors
+#define LAWLER_CYCLE_CHECK_ROUNDS 16
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+// the distances of a probe may exceed 64 bits, since the weights are
+// scaled by D = 4 n^2
+typedef __int128 lawler_value;
+
+
+/*
+ * Struct: lawler_workspace
+ * ------------------------
+ * The arrays (one entry per vertex) used by the probes
+ *
+ *    dist: the distances computed so far
+ *    next: the distances computed in the current round
+ *  parent: the arc which gave the current distance (-1 if none)
+ * changed: 1 if the distance changed in the last round
+ * touched: 1 if the vertex is the target of an arc of the frontier
+ *    list: the vertices touched in the current round
+ *   stamp: used to find a cycle in the graph of predecessors
+ */
+struct lawler_workspace
+{
+  std::vector<lawler_value> dist;
+  std::vector<lawler_value> next;
+  std::vector<int>          parent;
+  std::vector<char>         changed;
+  std::vector<char>         touched;
+  std::vector<int>          list;
+  std::vector<int>          stamp;
+};
+
+typedef struct lawler_workspace lawler_workspace;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: lawler_find_parent_cycle
+ * ----------------------------------
+ * Looks for a cycle in the graph of predecessors which is negative with
+ * the weights scale * w - shift
+ *
+ * returns: 1 if such a cycle was found (its arcs are stored in cycle),
+ *          otherwise, 0
+ */
+inline int lawler_find_parent_cycle(const lemon::SmartDigraph &G,
+				    const lemon::SmartDigraph::ArcMap<int> &weight,
+				    lawler_value scale, lawler_value shift,
+				    lawler_workspace *ws,
+				    std::vector<int> &cycle)
+{
+  lemon::SmartDigraph::Arc a;
+  lawler_value sum;
+  int n, s, u;
+
+  n = (int) ws->parent.size();
+  ws->stamp.assign(n, -1);
+
+  for (s = 0; s < n; s++)
+    {
+      if (ws->stamp[s] != -1)
+	continue;
+
+      u = s;
+      while (u != -1 && ws->stamp[u] == -1)
+	{
+	  ws->stamp[u] = s;
+	  u = (ws->parent[u] == -1) ? -1 :
+	    G.id(G.source(G.arcFromId(ws->parent[u])));
+	}
+
+      if (u == -1 || ws->stamp[u] != s)
+	continue;
+
+      // u is on a cycle; the arcs are collected backwards
+      cycle.clear();
+      sum = 0;
+      do
+	{
+	  a = G.arcFromId(ws->parent[u]);
+	  cycle.push_back(G.id(a));
+	  sum += scale * weight[a] - shift;
+	  u = G.id(G.source(a));
+	}
+      while ((int) cycle.size() < n &&
+	     G.id(G.target(G.arcFromId(cycle[0]))) != u);
+
+      if (sum < 0)
+	{
+	  for (s = 0; s < (int) cycle.size() / 2; s++)
+	    {
+	      u = cycle[s];
+	      cycle[s] = cycle[cycle.size() -1 -s];
+	      cycle[cycle.size() -1 -s] = u;
+	    }
+
+	  return 1;
+	}
+    }
+
+  return 0;
+}
+
+/*
+ * Function: lawler_probe
+ * ----------------------
+ * Checks if G has a negative cycle with the weights scale * w - shift,
+ * that is, a cycle with mean smaller than shift / scale
+ *
+ *     G: the configuration graph
+ * weight: the weights of the arcs of G
+ *    ws: the arrays used by the search
+ * cycle: where the ids of the arcs of the negative cycle are stored
+ *
+ * returns: 1 if there is a negative cycle, otherwise, 0
+ */
+inline int lawler_probe(const lemon::SmartDigraph &G,
+			const lemon::SmartDigraph::ArcMap<int> &weight,
+			lawler_value scale, lawler_value shift,
+			lawler_workspace *ws, std::vector<int> &cycle)
+{
+  int n, u, i, round, amt_touched, amt_changed;
+
+  n = lemon::countNodes(G);
+
+  // every vertex starts at distance 0 (a virtual source linked to all
+  // the vertices), so every vertex is in the first frontier
+  ws->dist.assign(n, 0);
+  ws->next.assign(n, 0);
+  ws->parent.assign(n, -1);
+  ws->changed.assign(n, 1);
+  ws->touched.assign(n, 0);
+  ws->list.resize(n);
+  amt_changed = n;
+
+  for (round = 1; amt_changed > 0; round++)
+    {
+      // marks the targets of the arcs leaving the frontier
+      # pragma omp parallel for schedule(dynamic, 1024)
+      for (u = 0; u < n; u++)
+	if (ws->changed[u])
+	  for (lemon::SmartDigraph::OutArcIt a(G, G.nodeFromId(u));
+	       a != lemon::INVALID; ++a)
+	    {
+	      # pragma omp atomic write
+	      ws->touched[G.id(G.target(a))] = 1;
+	    }
+
+      amt_touched = 0;
+      for (u = 0; u < n; u++)
+	if (ws->touched[u])
+	  {
+	    ws->list[amt_touched++] = u;
+	    ws->touched[u] = 0;
+	  }
+
+      // relaxes the touched vertices through the arcs coming from the
+      // frontier; each thread only writes the entries of its vertices
+      # pragma omp parallel for schedule(dynamic, 256)
+      for (i = 0; i < amt_touched; i++)
+	{
+	  lawler_value d;
+	  int v;
+
+	  v = ws->list[i];
+	  ws->next[v] = ws->dist[v];
+
+	  for (lemon::SmartDigraph::InArcIt a(G, G.nodeFromId(v));
+	       a != lemon::INVALID; ++a)
+	    if (ws->changed[G.id(G.source(a))])
+	      {
+		d = ws->dist[G.id(G.source(a))] + scale * weight[a] - shift;
+
+		if (d < ws->next[v])
+		  {
+		    ws->next[v] = d;
+		    ws->parent[v] = G.id(a);
+		  }
+	      }
+	}
+
+      // the new frontier is formed by the vertices whose distance
+      // decreased
+      for (u = 0; u < n; u++)
+	ws->changed[u] = 0;
+
+      amt_changed = 0;
+      for (i = 0; i < amt_touched; i++)
+	{
+	  u = ws->list[i];
+
+	  if (ws->next[u] < ws->dist[u])
+	    {
+	      ws->dist[u] = ws->next[u];
+	      ws->changed[u] = 1;
+	      amt_changed++;
+	    }
+	}
+
+      if (amt_changed > 0 &&
+	  (round % LAWLER_CYCLE_CHECK_ROUNDS == 0 || round >= n) &&
+	  lawler_find_parent_cycle(G, weight, scale, shift, ws, cycle) == 1)
+	return 1;
+    }
+
+  return 0;
+}
+
+/*
+ * Function: lawler_floor_div
+ * --------------------------
+ * returns: floor(a / b), for b > 0
+ */
+inline lawler_value lawler_floor_div(lawler_value a, lawler_value b)
+{
+  lawler_value q;
+
+  q = a / b;
+  if (a % b != 0 && a < 0)
+    q--;
+
+  return q;
+}
+
+/*
+ * Function: lawler_mmc
+ * --------------------
+ * Finds a minimum mean cycle of the configuration graph with Lawler's
+ * parametric search
+ *
+ *          G: the configuration graph
+ *     weight: the (integer) weights of the arcs of G
+ *      cycle: where the arcs of the minimum mean cycle are stored
+ *       cost: the total weight of the cycle
+ *       size: the number of arcs of the cycle
+ * iterations: the number of probes performed (may be NULL)
+ *
+ * returns: 1 if G has a cycle, otherwise, 0
+ */
+inline int lawler_mmc(const lemon::SmartDigraph &G,
+		      const lemon::SmartDigraph::ArcMap<int> &weight,
+		      lemon::Path<lemon::SmartDigraph> *cycle,
+		      long long *cost, int *size, int *iterations)
+{
+  lawler_workspace ws;
+  std::vector<int> found, best;
+  lawler_value D, lo, hi, mid;
+  long long best_cost;
+  int n, w_min, w_max, i, amt_probes;
+
+  cycle->clear();
+  *cost = 0;
+  *size = 0;
+
+  n = lemon::countNodes(G);
+  if (n == 0 || lemon::countArcs(G) == 0)
+    return 0;
+
+  w_min = w_max = weight[lemon::SmartDigraph::ArcIt(G)];
+  for (lemon::SmartDigraph::ArcIt a(G); a != lemon::INVALID; ++a)
+    {
+      if (weight[a] < w_min)
+	w_min = weight[a];
+      if (weight[a] > w_max)
+	w_max = weight[a];
+    }
+
+  // every cycle has mean smaller than w_max +1, so the first probe finds
+  // a cycle, unless G is acyclic
+  amt_probes = 1;
+  if (lawler_probe(G, weight, 1, (lawler_value) w_max +1, &ws, best) == 0)
+    {
+      if (iterations != NULL)
+	*iterations = amt_probes;
+      return 0;
+    }
+
+  best_cost = 0;
+  for (i = 0; i < (int) best.size(); i++)
+    best_cost += weight[G.arcFromId(best[i])];
+
+  // invariant: no cycle has mean smaller than lo / D and the best cycle
+  // found has mean in [hi / D, (hi +1) / D)
+  D = (lawler_value) 4 * n * n;
+  lo = D * w_min;
+  hi = lawler_floor_div(D * best_cost, (lawler_value) best.size());
+
+  while (hi - lo > 1)
+    {
+      mid = lo + (hi - lo) / 2;
+      amt_probes++;
+
+      if (lawler_probe(G, weight, D, mid, &ws, found) == 1)
+	{
+	  best.swap(found);
+	  best_cost = 0;
+	  for (i = 0; i < (int) best.size(); i++)
+	    best_cost += weight[G.arcFromId(best[i])];
+
+	  hi = lawler_floor_div(D * best_cost, (lawler_value) best.size());
+	}
+      else
+	lo = mid;
+    }
+
+  if (iterations != NULL)
+    *iterations = amt_probes;
+
+  for (i = 0; i < (int) best.size(); i++)
+    cycle->addBack(G.arcFromId(best[i]));
+
+  *cost = best_cost;
+  *size = (int) best.size();
+  return 1;
+}
+
+#endif
@@ -0,0 +1,516 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Memory planner (--mem-limit): before anything is allocated, the
+   number of bar codes and of arcs of the configuration graph is counted
+   with the transfer matrices of transfer_count.h (exactly, in a fraction
+   of a second), and the memory of each way of running the program is
+   estimated from them:
+
+     - graph in memory: the list of bar codes, the arrays with one entry
+       per vertex, the arcs of the SmartDigraph and their weights, and
+       the working memory of the MMC algorithm (the tables of Karp,
+       Hartmann-Orlin and of the tropical engine have (n +1) n entries;
+       the parallel Howard copies the arcs in CSR form);
+     - out-of-core (external_graph.h): the list of bar codes, the arrays
+       with one entry per vertex and the RAM budget of the arcs (--ram).
+
+   The first one which fits in the limit is used; with --mmc=auto the
+   engine of choose_mmc_engine is replaced by the sequential Howard when
+   only that one fits, and the out-of-core mode is chosen when the
+   options allow it. When nothing fits the program stops before building
+   the bar codes, instead of failing with bad_alloc hours later.
+
+   The vectors of LEMON double their capacity when they are full, so
+   while the last arcs are added there may be up to three times as many
+   entries allocated as arcs in the vector of the arcs; the estimates
+   take this into account. Both estimates also count the memory the
+   process already has when the plan is made (/proc/self/statm), a fixed
+   overhead of the runtime and the stack and malloc arena of each OpenMP
+   thread; the number of threads is halved until the run fits, and the
+   plan sets it with omp_set_num_threads.
+*/
+
+#ifndef MEMORY_PLAN_H
+#define MEMORY_PLAN_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include "mmc_engine.h"
+#include "transfer_count.h"
+#include "external_graph.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// --mem-limit without a value: the physical memory of the machine
+#define PLAN_PHYSICAL_MEMORY -1
+
+// bytes added by malloc to each block
+#define PLAN_MALLOC_OVERHEAD 16
+
+// bytes the runtime allocates after the plan whatever the size of the
+// graph (buffers of the streams, tables of the checkers, grids of the
+// bar codes), measured on runs of H_2
+#define PLAN_RUNTIME_BYTES (8LL * 1024 * 1024)
+
+// bytes of each OpenMP thread: its stack, its malloc arena and its
+// buffers in the parallel loops (the parallel Howard, the arcs of the
+// 8-bar program)
+#define PLAN_THREAD_BYTES (2LL * 1024 * 1024)
+
+// bytes of an arc of a SmartDigraph (target, source, next_in, next_out)
+// and of its weight in an ArcMap<int>
+#define PLAN_ARC_BYTES 16
+#define PLAN_WEIGHT_BYTES 4
+
+// bytes per vertex of the SmartDigraph (with the growth of its vector),
+// of the map to its bar code and of the weights of the arcs entering it
+#define PLAN_VERTEX_BYTES (3 * 8 + 8 + 4)
+
+// working memory of the MMC algorithms, per vertex and per arc
+#define PLAN_HOWARD_VERTEX_BYTES 64
+#define PLAN_HOWARD_ARC_BYTES 4
+#define PLAN_PARALLEL_VERTEX_BYTES 96
+#define PLAN_PARALLEL_ARC_BYTES 12
+#define PLAN_LAWLER_VERTEX_BYTES 48
+#define PLAN_KARP_ENTRY_BYTES 16
+#define PLAN_TROPICAL_ENTRY_BYTES 8
+
+// arrays with one entry per vertex in the out-of-core mode (bar codes as
+// masks, weights and the distances of Lawler's search)
+#define PLAN_EXTERNAL_VERTEX_BYTES (8 + 4 + 64)
+
+// bytes of each run of the out-of-core graph while the runs are merged
+// (the stream of the run and its buffer)
+#define PLAN_RUN_BYTES (8 * 1024 + 1024)
+
+// file descriptors kept for the rest of the program while the runs are
+// merged, all of them open at once
+#define PLAN_RESERVED_FILES 64
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Enum: plan_mode
+ * ---------------
+ * How the configuration graph is kept
+ *
+ *    PLAN_MEMORY: a SmartDigraph in memory
+ *  PLAN_EXTERNAL: the arcs on disk (--external)
+ *      PLAN_NONE: nothing fits in the limit
+ */
+enum plan_mode
+{
+  PLAN_MEMORY,
+  PLAN_EXTERNAL,
+  PLAN_NONE
+};
+
+typedef enum plan_mode plan_mode;
+
+/*
+ * Struct: memory_plan
+ * -------------------
+ * The estimates of the memory of a run, and the choices of the planner
+ *
+ *        limit: the memory available, in bytes
+ *     barcodes: the number of bar codes (vertices)
+ *         arcs: the number of arcs of the configuration graph
+ *       counts: 1 if both were counted exactly, otherwise, 0 (too many
+ *               to be represented: nothing fits)
+ * overhead_bytes: the memory which does not depend on the graph (the
+ *               process when the plan is made and its runtime)
+ *   list_bytes: the memory of the list of bar codes
+ * memory_bytes: the peak of the run with the graph in memory
+ * external_bytes: the peak of the run in the out-of-core mode
+ *         mode: the way chosen to keep the graph
+ *       engine: the MMC algorithm chosen
+ *      threads: the number of OpenMP threads of the run
+ *       ram_mb: the RAM budget of the arcs in the out-of-core mode
+ */
+struct memory_plan
+{
+  long long  limit;
+  long long  barcodes;
+  long long  arcs;
+  int        counts;
+  long long  overhead_bytes;
+  long long  list_bytes;
+  long long  memory_bytes;
+  long long  external_bytes;
+  plan_mode  mode;
+  mmc_engine engine;
+  int        threads;
+  long long  ram_mb;
+};
+
+typedef struct memory_plan memory_plan;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: plan_physical_memory
+ * ------------------------------
+ * returns: the physical memory of the machine, in bytes (0 if unknown)
+ */
+inline long long plan_physical_memory()
+{
+  long pages, page_size;
+
+  pages = sysconf(_SC_PHYS_PAGES);
+  page_size = sysconf(_SC_PAGE_SIZE);
+  if (pages <= 0 || page_size <= 0)
+    return 0;
+
+  return (long long) pages * page_size;
+}
+
+/*
+ * Function: plan_resident_bytes
+ * -----------------------------
+ * returns: the memory the process has in RAM, in bytes (0 if unknown)
+ */
+inline long long plan_resident_bytes()
+{
+  std::ifstream statm("/proc/self/statm");
+  long long size, resident;
+
+  if (!(statm >> size >> resident))
+    return 0;
+
+  return resident * sysconf(_SC_PAGE_SIZE);
+}
+
+/*
+ * Function: plan_max_threads
+ * --------------------------
+ * returns: the number of OpenMP threads of the program before any plan
+ *          changed it (the plans of the k of a sweep start from it)
+ */
+inline int plan_max_threads()
+{
+#ifdef _OPENMP
+  static int threads = omp_get_max_threads();
+
+  return threads;
+#else
+  return 1;
+#endif
+}
+
+/*
+ * Function: plan_external_runs
+ * ----------------------------
+ * returns: the number of runs written by the out-of-core graph (a run
+ *          is written when the arcs fill half of the budget)
+ */
+inline long long plan_external_runs(long long arcs, long long ram_mb)
+{
+  long long run_arcs;
+
+  run_arcs = std::max(ram_mb * 1024 * 1024, (long long) EXTERNAL_MIN_BUDGET)
+    / 2 / (long long) sizeof(external_arc);
+
+  return arcs / run_arcs +1;
+}
+
+/*
+ * Function: plan_vector_capacity
+ * ------------------------------
+ * returns: the capacity of a vector after n entries are added to it one
+ *          by one (the capacity doubles when the vector is full; while
+ *          the last buffer is filled, the previous one, with half of its
+ *          entries, was alive too)
+ */
+inline long long plan_vector_capacity(long long n)
+{
+  long long capacity;
+
+  capacity = 1;
+  while (capacity < n)
+    capacity *= 2;
+
+  return capacity;
+}
+
+/*
+ * Function: plan_mmc_bytes
+ * ------------------------
+ * Estimates the working memory of an MMC algorithm
+ *
+ *  engine: the algorithm
+ *   nodes: the number of vertices of the graph
+ *    arcs: the number of arcs of the graph
+ *
+ * returns: the number of bytes
+ */
+inline long long plan_mmc_bytes(mmc_engine engine, long long nodes,
+				long long arcs)
+{
+  long double table;
+
+  table = (long double) (nodes +1) * nodes;
+
+  switch (engine)
+    {
+    case MMC_KARP:
+    case MMC_HARTMANN_ORLIN:
+      table *= PLAN_KARP_ENTRY_BYTES;
+      break;
+    case MMC_TROPICAL:
+      // larger graphs fall back to Howard
+      if (nodes > TROPICAL_MAX_NODES)
+	return nodes * PLAN_HOWARD_VERTEX_BYTES +
+	  arcs * PLAN_HOWARD_ARC_BYTES;
+      table *= PLAN_TROPICAL_ENTRY_BYTES;
+      break;
+    case MMC_PARALLEL_HOWARD:
+      return nodes * PLAN_PARALLEL_VERTEX_BYTES +
+	arcs * PLAN_PARALLEL_ARC_BYTES;
+    case MMC_LAWLER:
+      return nodes * PLAN_LAWLER_VERTEX_BYTES;
+    default:
+      return nodes * PLAN_HOWARD_VERTEX_BYTES + arcs * PLAN_HOWARD_ARC_BYTES;
+    }
+
+  return (table > (long double) INT64_MAX / 2) ? INT64_MAX / 2 :
+    (long long) table;
+}
+
+/*
+ * Function: plan_memory_bytes
+ * ---------------------------
+ * Estimates the peak of a run with the graph in memory
+ *
+ *    plan: the counts, the overhead and the memory of the list of bar
+ *          codes
+ *  engine: the MMC algorithm
+ * k_bytes: the bytes per vertex of the checkers (one per line)
+ * threads: the number of OpenMP threads
+ *
+ * returns: the number of bytes
+ */
+inline long long plan_memory_bytes(const memory_plan &plan, mmc_engine engine,
+				   int k_bytes, int threads)
+{
+  long long vertices, capacity, building, solving;
+
+  vertices = plan.barcodes * (PLAN_VERTEX_BYTES + k_bytes);
+  capacity = plan_vector_capacity(plan.arcs);
+
+  // while the last arcs are added, and while the MMC runs on the graph
+  building = (capacity + capacity / 2) * (PLAN_ARC_BYTES + PLAN_WEIGHT_BYTES);
+  solving = capacity * (PLAN_ARC_BYTES + PLAN_WEIGHT_BYTES) +
+    plan_mmc_bytes(engine, plan.barcodes, plan.arcs);
+
+  return plan.overhead_bytes + threads * PLAN_THREAD_BYTES +
+    plan.list_bytes + vertices + std::max(building, solving);
+}
+
+/*
+ * Function: plan_memory_threads
+ * -----------------------------
+ * Halves the number of threads until the run with the graph in memory
+ * fits in the limit of the plan
+ *
+ *    plan: the counts, the overhead and the limit
+ *  engine: the MMC algorithm
+ * k_bytes: the bytes per vertex of the checkers (one per line)
+ *
+ * returns: the number of threads (1 if not even one thread fits)
+ */
+inline int plan_memory_threads(const memory_plan &plan, mmc_engine engine,
+			       int k_bytes)
+{
+  int threads;
+
+  threads = plan_max_threads();
+  while (threads > 1 &&
+	 plan_memory_bytes(plan, engine, k_bytes, threads) > plan.limit)
+    threads /= 2;
+
+  return threads;
+}
+
+/*
+ * Function: make_memory_plan
+ * --------------------------
+ * Counts the bar codes and the arcs of H_k and chooses how to run the
+ * program within a memory limit
+ *
+ *        width: the number of columns of a bar code
+ *  union_width: the number of columns of the union of the bar codes of
+ *               an arc
+ *    num_lines: the number of lines of the hexagonal grid
+ *    bar_bytes: the memory of a bar code in the list of the program
+ *     limit_mb: the limit, in megabytes, or PLAN_PHYSICAL_MEMORY
+ *       engine: the MMC algorithm asked for (MMC_AUTO: any one)
+ *  allow_external: 1 if the out-of-core mode may be used, otherwise, 0
+ * external_only: 1 if the out-of-core mode was asked for, otherwise, 0
+ *       ram_mb: the RAM budget of the arcs in the out-of-core mode
+ *         plan: where the plan is stored
+ *
+ * returns: 1 if some way of running fits in the limit, otherwise, 0
+ */
+inline int make_memory_plan(int width, int union_width, int num_lines,
+			    long long bar_bytes, long long limit_mb,
+			    mmc_engine engine, int allow_external,
+			    int external_only, long long ram_mb,
+			    memory_plan *plan)
+{
+  std::vector<unsigned __int128> bars, arcs;
+  std::vector<int> exact_bars, exact_arcs;
+  long long vertices, available, runs;
+  const long long mb = 1024 * 1024;
+
+  plan->limit = (limit_mb == PLAN_PHYSICAL_MEMORY) ?
+    plan_physical_memory() : limit_mb * 1024 * 1024;
+  plan->mode = PLAN_NONE;
+  plan->engine = engine;
+  plan->threads = plan_max_threads();
+  plan->ram_mb = ram_mb;
+  plan->memory_bytes = plan->external_bytes = INT64_MAX;
+  plan->overhead_bytes = plan_resident_bytes() + PLAN_RUNTIME_BYTES;
+
+  // the plan of the previous k of a sweep may have left fewer threads,
+  // and choose_mmc_engine looks at them
+#ifdef _OPENMP
+  omp_set_num_threads(plan->threads);
+#endif
+
+  // counts with more than 2^31 vertices or 2^62 arcs do not fit in the
+  // ids of the programs anyway
+  plan->counts = 0;
+  plan->barcodes = plan->arcs = 0;
+  if (count_valid_bars(width, num_lines, &bars, &exact_bars) == 1 &&
+      count_valid_bars(union_width, num_lines, &arcs, &exact_arcs) == 1 &&
+      exact_bars[num_lines] == 1 && exact_arcs[num_lines] == 1 &&
+      bars[num_lines] <= (unsigned __int128) INT32_MAX &&
+      arcs[num_lines] <= (unsigned __int128) (INT64_MAX / 64))
+    {
+      plan->counts = 1;
+      plan->barcodes = (long long) bars[num_lines];
+      plan->arcs = (long long) arcs[num_lines];
+    }
+
+  if (plan->counts == 0)
+    return 0;
+
+  plan->list_bytes = plan->barcodes * bar_bytes;
+  vertices = plan->barcodes * PLAN_VERTEX_BYTES;
+
+  // the graph in memory, with the engine asked for or the one --mmc=auto
+  // would choose (replaced by the sequential Howard if only it fits)
+  if (external_only == 0)
+    {
+      if (engine == MMC_AUTO)
+	plan->engine = choose_mmc_engine(plan->barcodes, plan->arcs);
+
+      plan->threads = plan_memory_threads(*plan, plan->engine, num_lines);
+      plan->memory_bytes = plan_memory_bytes(*plan, plan->engine, num_lines,
+					     plan->threads);
+      if (plan->memory_bytes > plan->limit && engine == MMC_AUTO &&
+	  plan_memory_bytes(*plan, MMC_HOWARD, num_lines, 1) <= plan->limit)
+	{
+	  plan->engine = MMC_HOWARD;
+	  plan->threads = plan_memory_threads(*plan, MMC_HOWARD, num_lines);
+	  plan->memory_bytes = plan_memory_bytes(*plan, MMC_HOWARD, num_lines,
+						 plan->threads);
+	}
+
+      if (plan->memory_bytes <= plan->limit)
+	{
+	  plan->mode = PLAN_MEMORY;
+	  return 1;
+	}
+    }
+
+  // the arcs on disk, with at most the budget left by the vertices and
+  // the threads; the threads are halved while they would take more
+  // memory than the budget of the arcs, which saves writes of runs
+  if (allow_external == 1)
+    {
+      plan->threads = plan_max_threads();
+      plan->external_bytes = plan->overhead_bytes + plan->list_bytes +
+	vertices + plan->barcodes * PLAN_EXTERNAL_VERTEX_BYTES;
+      while (plan->threads > 1 &&
+	     2 * plan->threads * PLAN_THREAD_BYTES >
+	     plan->limit - plan->external_bytes)
+	plan->threads /= 2;
+      plan->external_bytes += plan->threads * PLAN_THREAD_BYTES;
+
+      // a smaller budget writes more runs, and the merge keeps all of
+      // them open at once
+      available = plan->limit - plan->external_bytes;
+      plan->ram_mb = std::max(0LL, std::min(ram_mb, available / mb));
+      while (plan->ram_mb > 0 &&
+	     plan->ram_mb * mb + PLAN_RUN_BYTES *
+	     plan_external_runs(plan->arcs, plan->ram_mb) > available)
+	plan->ram_mb--;
+
+      runs = plan_external_runs(plan->arcs, plan->ram_mb);
+      plan->external_bytes += plan->ram_mb * mb + runs * PLAN_RUN_BYTES;
+
+      if (plan->ram_mb > 0 &&
+	  runs <= sysconf(_SC_OPEN_MAX) - PLAN_RESERVED_FILES)
+	{
+	  plan->mode = PLAN_EXTERNAL;
+	  plan->engine = MMC_LAWLER;
+	  return 1;
+	}
+    }
+
+  return 0;
+}
+
+/*
+ * Function: print_memory_plan
+ * ---------------------------
+ * Outputs the estimates and the choices of the planner
+ */
+inline void print_memory_plan(std::ostream &out, const memory_plan &plan)
+{
+  const long long mb = 1024 * 1024;
+
+  out << "Memory plan (limit of " << plan.limit / mb << " MB)\n";
+  if (plan.counts == 0)
+    {
+      out << "The bar codes or the arcs are too many to be counted\n\n";
+      return;
+    }
+
+  out << "Bar codes: " << plan.barcodes << "\tArcs: " << plan.arcs << "\n";
+  out << "Graph in memory: ";
+  if (plan.memory_bytes == INT64_MAX)
+    out << "not considered\n";
+  else
+    out << (plan.memory_bytes + mb -1) / mb << " MB\n";
+  out << "Out-of-core: ";
+  if (plan.external_bytes == INT64_MAX)
+    out << "not considered\n";
+  else
+    out << (plan.external_bytes + mb -1) / mb << " MB\n";
+
+  if (plan.mode == PLAN_MEMORY)
+    out << "Chosen: graph in memory, " << mmc_engine_name(plan.engine)
+	<< " with " << plan.threads << " thread(s)\n\n";
+  else if (plan.mode == PLAN_EXTERNAL)
+    out << "Chosen: out-of-core, with " << plan.ram_mb
+	<< " MB for the arcs and " << plan.threads << " thread(s)\n\n";
+  else
+    out << "Chosen: nothing fits\n\n";
+}
+
+#endif
@@ -0,0 +1,592 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Metrics of a run of the programs which build a configuration graph
+   (Hk_lemon_eng_6bar.cc and Hk_lemon_eng_8bar.cc): the time of each
+   phase (bar codes, vertices, edges and minimum mean cycle), the amount
+   of work done in each one (bars tested, bar codes found, pairs of bar
+   codes tested, arcs created, iterations of the MMC algorithm) and the
+   peak memory of the process. With --metrics the programs write them as
+   one JSON object per run, in a single line, so the records of many
+   runs can be appended to the same file (JSON Lines) and compared
+   across values of k and across versions of the programs:
+
+       {"format":1,"program":"Hk_lemon_eng_6bar","lines":3,"width":4,
+        "overlap":2,"mmc_engine":"Hartmann and Orlin","timestamp":...,
+        "phases":{"barcodes":0.0012,"vertices":0.0001,"edges":0.29,
+                  "mmc":0.56},
+        "total_seconds":0.85,"candidates_tested":4095,
+        "valid_barcodes":1896,"pairs_tested":3594816,
+        "arcs_accepted":57723,"mmc_iterations":0,"peak_rss_kb":21504,
+        "columns":26,"density":[6,13]}
+
+   The times are in seconds. A phase is timed from metrics_begin to
+   metrics_end (or to the beginning of the next phase). With --perf the
+   hardware counters of each phase (perf_counters.h) are also read there,
+   and the parallel loops add the counters of each worker thread with
+   metrics_thread_begin and metrics_thread_end; the record then has a
+   "perf" object with the counters of each phase. In a sweep over k
+   (--k-range) each k is a run with its own record, and a table of the
+   runs is printed at the end.
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <sys/resource.h>
+#include "perf_counters.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// version of the fields of a record
+#define METRICS_FORMAT 1
+
+// --metrics without a file writes the record to stdout
+#define METRICS_STDOUT "-"
+
+// phases of a run
+#define METRICS_NONE     -1
+#define METRICS_BARCODES  0
+#define METRICS_VERTICES  1
+#define METRICS_EDGES     2
+#define METRICS_MMC       3
+#define METRICS_PHASES    4
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: run_metrics
+ * -------------------
+ * The metrics of a run
+ *
+ *           program: the name of the program
+ *         num_lines: the number of lines of the hexagonal grid (k)
+ *             width: the number of columns of a bar code
+ *           overlap: the number of columns shared by two consecutive bars
+ *             phase: the phase being timed (METRICS_NONE if there is none)
+ *             start: when the phase being timed began
+ *          phase_ns: the nanoseconds spent in each phase
+ * candidates_tested: the number of bars tested to find the bar codes
+ *                    (the empty bar, which dominates no vertex, is never
+ *                    generated: 2^(k width) - 1 bars for k lines)
+ *    valid_barcodes: the number of bar codes
+ *      pairs_tested: the number of pairs of bar codes tested for an arc
+ *     arcs_accepted: the number of arcs of the configuration graph (with
+ *                    --target-density, the arcs created until the
+ *                    search stopped)
+ *    mmc_iterations: the iterations of the MMC algorithm, when it reports
+ *                    them
+ *       peak_rss_kb: the peak resident memory of the process, in KB
+ *        mmc_engine: the name of the algorithm which found the cycle
+ *           columns: the number of columns of the code found
+ *       density_num: the density of the code found is
+ *       density_den  density_num / density_den (0 / 0 if there is none)
+ *              perf: 1 if the hardware counters are read (--perf)
+ *          counters: the counters of the process
+ *        perf_start: the counters at the beginning of the phase being
+ *                    timed
+ *        perf_phase: the counts of each phase
+ *       perf_thread: the counts of each worker thread of the parallel
+ *                    loops, in each phase
+ */
+struct run_metrics
+{
+  const char *program;
+  int         num_lines;
+  int         width;
+  int         overlap;
+  int         phase;
+  std::chrono::steady_clock::time_point start;
+  long long   phase_ns[METRICS_PHASES];
+  long long   candidates_tested;
+  long long   valid_barcodes;
+  long long   pairs_tested;
+  long long   arcs_accepted;
+  long long   mmc_iterations;
+  long        peak_rss_kb;
+  std::string mmc_engine;
+  int         columns;
+  long long   density_num;
+  long long   density_den;
+  int         perf;
+  perf_counters counters;
+  perf_sample perf_start;
+  perf_sample perf_phase[METRICS_PHASES];
+  std::vector<perf_sample> perf_thread[METRICS_PHASES];
+};
+
+typedef struct run_metrics run_metrics;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: metrics_init
+ * ----------------------
+ * Starts the metrics of a run, with all the counters at zero
+ *
+ *   metrics: the metrics of the run
+ *   program: the name of the program
+ * num_lines: the number of lines of the hexagonal grid
+ *     width: the number of columns of a bar code
+ *   overlap: the number of columns shared by two consecutive bars
+ */
+inline void metrics_init(run_metrics *metrics, const char *program,
+			 int num_lines, int width, int overlap)
+{
+  int i;
+
+  metrics->program = program;
+  metrics->num_lines = num_lines;
+  metrics->width = width;
+  metrics->overlap = overlap;
+  metrics->phase = METRICS_NONE;
+
+  for (i = 0; i < METRICS_PHASES; i++)
+    metrics->phase_ns[i] = 0;
+
+  metrics->candidates_tested = 0;
+  metrics->valid_barcodes = 0;
+  metrics->pairs_tested = 0;
+  metrics->arcs_accepted = 0;
+  metrics->mmc_iterations = 0;
+  metrics->peak_rss_kb = 0;
+  metrics->mmc_engine = "";
+  metrics->columns = 0;
+  metrics->density_num = 0;
+  metrics->density_den = 0;
+
+  metrics->perf = 0;
+  for (i = 0; i < PERF_EVENTS; i++)
+    metrics->counters.fd[i] = -1;
+  metrics->counters.error = 0;
+
+  for (i = 0; i < METRICS_PHASES; i++)
+    perf_clear(&metrics->perf_phase[i], 0);
+}
+
+/*
+ * Function: metrics_use_perf
+ * --------------------------
+ * Reads the phases of a run from counters already open (in a sweep over
+ * k, the counters opened once for the whole process)
+ *
+ *  metrics: the metrics of the run
+ * counters: the open counters
+ */
+inline void metrics_use_perf(run_metrics *metrics,
+			     const perf_counters &counters)
+{
+  int i;
+
+  metrics->perf = 1;
+  metrics->counters = counters;
+  for (i = 0; i < METRICS_PHASES; i++)
+    perf_clear(&metrics->perf_phase[i], 1);
+}
+
+/*
+ * Function: metrics_enable_perf
+ * -----------------------------
+ * Opens the hardware counters of the process. It must be called before
+ * the first parallel region, so the worker threads are counted too
+ *
+ * metrics: the metrics of the run
+ *
+ * returns: the number of counters opened (the error of the first one
+ *          which could not be opened is in metrics->counters.error)
+ */
+inline int metrics_enable_perf(run_metrics *metrics)
+{
+  int opened;
+
+  opened = perf_open(&metrics->counters, 1);
+  if (opened == 0)
+    return 0;
+
+  metrics_use_perf(metrics, metrics->counters);
+  return opened;
+}
+
+/*
+ * Function: metrics_end
+ * ---------------------
+ * Stops timing the current phase, if there is one
+ */
+inline void metrics_end(run_metrics *metrics)
+{
+  perf_sample perf_end;  // the counters at the end of the phase
+
+  if (metrics->phase == METRICS_NONE)
+    return;
+
+  metrics->phase_ns[metrics->phase] +=
+    std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now() - metrics->start).count();
+
+  if (metrics->perf == 1)
+    {
+      perf_read(metrics->counters, &perf_end);
+      perf_add(&metrics->perf_phase[metrics->phase], metrics->perf_start,
+	       perf_end);
+    }
+
+  metrics->phase = METRICS_NONE;
+}
+
+/*
+ * Function: metrics_begin
+ * -----------------------
+ * Starts timing a phase, after stopping the current one
+ *
+ * metrics: the metrics of the run
+ *   phase: one of METRICS_BARCODES, ..., METRICS_MMC
+ */
+inline void metrics_begin(run_metrics *metrics, int phase)
+{
+  metrics_end(metrics);
+
+  metrics->phase = phase;
+  metrics->start = std::chrono::steady_clock::now();
+
+  if (metrics->perf == 1)
+    perf_read(metrics->counters, &metrics->perf_start);
+}
+
+/*
+ * Function: metrics_thread_begin
+ * ------------------------------
+ * Opens the hardware counters of a worker thread, inside a parallel
+ * region (nothing is done without --perf or out of a phase)
+ *
+ *  metrics: the metrics of the run (or NULL)
+ * counters: the counters of the thread
+ *    start: the counters at the beginning
+ */
+inline void metrics_thread_begin(const run_metrics *metrics,
+				 perf_counters *counters, perf_sample *start)
+{
+  int i;
+
+  for (i = 0; i < PERF_EVENTS; i++)
+    counters->fd[i] = -1;
+
+  if (metrics == NULL || metrics->perf == 0 ||
+      metrics->phase == METRICS_NONE)
+    return;
+
+  perf_open(counters, 0);
+  perf_read(*counters, start);
+}
+
+/*
+ * Function: metrics_thread_end
+ * ----------------------------
+ * Adds the counts of a worker thread to the ones of the current phase,
+ * and closes its counters
+ *
+ *  metrics: the metrics of the run (or NULL)
+ * counters: the counters of the thread
+ *    start: the counters at the beginning
+ */
+inline void metrics_thread_end(run_metrics *metrics, perf_counters *counters,
+			       const perf_sample &start)
+{
+  std::vector<perf_sample> *threads;
+  perf_sample end;
+  perf_sample zero;
+  int thread;
+
+  if (metrics == NULL || metrics->perf == 0 ||
+      metrics->phase == METRICS_NONE)
+    return;
+
+  perf_read(*counters, &end);
+  perf_close(counters);
+
+  thread = 0;
+#ifdef _OPENMP
+  thread = omp_get_thread_num();
+#endif
+
+  perf_clear(&zero, 1);
+
+  # pragma omp critical (metrics_threads)
+  {
+    threads = &metrics->perf_thread[metrics->phase];
+    if ((int) threads->size() <= thread)
+      threads->resize(thread +1, zero);
+    perf_add(&(*threads)[thread], start, end);
+  }
+}
+
+/*
+ * Function: metrics_phase_name
+ * ----------------------------
+ * returns: the name of a phase in the records
+ */
+inline const char *metrics_phase_name(int phase)
+{
+  switch (phase)
+    {
+    case METRICS_BARCODES: return "barcodes";
+    case METRICS_VERTICES: return "vertices";
+    case METRICS_EDGES:    return "edges";
+    case METRICS_MMC:      return "mmc";
+    }
+
+  return "none";
+}
+
+/*
+ * Function: metrics_peak_rss
+ * --------------------------
+ * returns: the peak resident memory of the process, in KB (0 if it is
+ *          not known)
+ */
+inline long metrics_peak_rss()
+{
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+
+  return usage.ru_maxrss;
+}
+
+/*
+ * Function: print_elapsed
+ * -----------------------
+ * Outputs a time as hours, minutes, seconds, milliseconds and the
+ * nanoseconds left
+ *
+ *  out: where the time is written
+ *   ns: the time, in nanoseconds
+ */
+inline void print_elapsed(std::ostream &out, long long ns)
+{
+  out << ns / 3600000000000LL << "h "
+      << ns / 60000000000LL % 60 << "m "
+      << ns / 1000000000LL % 60 << "s "
+      << ns / 1000000LL % 1000 << "ms "
+      << ns % 1000000 << "ns";
+}
+
+/*
+ * Function: print_phase_perf
+ * --------------------------
+ * Outputs the hardware counters of a phase, and of each worker thread of
+ * its parallel loops, one per line (nothing is written without --perf)
+ *
+ *     out: where the counters are written
+ * metrics: the metrics of the run
+ *   phase: the phase
+ */
+inline void print_phase_perf(std::ostream &out, const run_metrics &metrics,
+			     int phase)
+{
+  size_t i;
+
+  if (metrics.perf == 0)
+    return;
+
+  out << "  counters: ";
+  print_perf(out, metrics.perf_phase[phase]);
+  out << "\n";
+
+  for (i = 0; i < metrics.perf_thread[phase].size(); i++)
+    {
+      out << "  thread " << i << ": ";
+      print_perf(out, metrics.perf_thread[phase][i]);
+      out << "\n";
+    }
+}
+
+/*
+ * Function: print_json_string
+ * ---------------------------
+ * Outputs a string as a JSON string
+ */
+inline void print_json_string(std::ostream &out, const std::string &text)
+{
+  size_t i;
+  char c;
+
+  out << '"';
+  for (i = 0; i < text.size(); i++)
+    {
+      c = text[i];
+      if (c == '"' || c == '\\')
+	out << '\\' << c;
+      else if ((unsigned char) c < 0x20)
+	out << ' ';
+      else
+	out << c;
+    }
+  out << '"';
+}
+
+/*
+ * Function: print_metrics
+ * -----------------------
+ * Outputs the record of a run as a JSON object in a single line
+ *
+ *     out: where the record is written
+ * metrics: the metrics of the run
+ */
+inline void print_metrics(std::ostream &out, const run_metrics &metrics)
+{
+  long long total;
+  size_t j;
+  int i;
+
+  total = 0;
+  for (i = 0; i < METRICS_PHASES; i++)
+    total += metrics.phase_ns[i];
+
+  out << "{\"format\":" << METRICS_FORMAT << ",\"program\":";
+  print_json_string(out, metrics.program);
+  out << ",\"lines\":" << metrics.num_lines
+      << ",\"width\":" << metrics.width
+      << ",\"overlap\":" << metrics.overlap
+      << ",\"mmc_engine\":";
+  print_json_string(out, metrics.mmc_engine);
+  out << ",\"timestamp\":" << (long long) time(NULL)
+      << ",\"phases\":{";
+
+  for (i = 0; i < METRICS_PHASES; i++)
+    out << ((i > 0) ? "," : "") << "\"" << metrics_phase_name(i) << "\":"
+	<< metrics.phase_ns[i] / 1e9;
+
+  out << "},\"total_seconds\":" << total / 1e9
+      << ",\"candidates_tested\":" << metrics.candidates_tested
+      << ",\"valid_barcodes\":" << metrics.valid_barcodes
+      << ",\"pairs_tested\":" << metrics.pairs_tested
+      << ",\"arcs_accepted\":" << metrics.arcs_accepted
+      << ",\"mmc_iterations\":" << metrics.mmc_iterations
+      << ",\"peak_rss_kb\":" << metrics.peak_rss_kb
+      << ",\"columns\":" << metrics.columns
+      << ",\"density\":[" << metrics.density_num << ","
+      << metrics.density_den << "]";
+
+  // the counters of each phase, and of its worker threads
+  if (metrics.perf == 1)
+    {
+      out << ",\"perf\":{";
+      for (i = 0; i < METRICS_PHASES; i++)
+	{
+	  out << ((i > 0) ? "," : "") << "\"" << metrics_phase_name(i)
+	      << "\":{";
+	  print_perf_json(out, metrics.perf_phase[i]);
+	  out << ",\"threads\":[";
+	  for (j = 0; j < metrics.perf_thread[i].size(); j++)
+	    {
+	      out << ((j > 0) ? ",{" : "{");
+	      print_perf_json(out, metrics.perf_thread[i][j]);
+	      out << "}";
+	    }
+	  out << "]}";
+	}
+      out << "}";
+    }
+
+  out << "}\n";
+}
+
+/*
+ * Function: print_sweep_summary
+ * -----------------------------
+ * Outputs a table with a line for each k of a sweep (--k-range): the bar
+ * codes, the arcs, the period and the exact density of the code, and the
+ * seconds spent in each phase
+ *
+ *  out: where the table is written
+ * runs: the metrics of the runs, in increasing order of k
+ */
+inline void print_sweep_summary(std::ostream &out,
+				const std::vector<run_metrics> &runs)
+{
+  std::string density;
+  long long total;
+  size_t j;
+  int i;
+
+  out << "Summary of the sweep\n"
+      << std::left << std::setw(4) << "k" << std::right
+      << std::setw(12) << "bar codes" << std::setw(14) << "arcs"
+      << std::setw(9) << "period" << std::setw(10) << "density";
+  for (i = 0; i < METRICS_PHASES; i++)
+    out << std::setw(11) << metrics_phase_name(i);
+  out << std::setw(11) << "total" << "\n";
+
+  out << std::fixed << std::setprecision(3);
+  for (j = 0; j < runs.size(); j++)
+    {
+      density = std::to_string(runs[j].density_num) + "/" +
+	std::to_string(runs[j].density_den);
+
+      out << std::left << std::setw(4) << runs[j].num_lines << std::right
+	  << std::setw(12) << runs[j].valid_barcodes
+	  << std::setw(14) << runs[j].arcs_accepted
+	  << std::setw(9) << runs[j].columns << std::setw(10) << density;
+
+      total = 0;
+      for (i = 0; i < METRICS_PHASES; i++)
+	{
+	  out << std::setw(11) << runs[j].phase_ns[i] / 1e9;
+	  total += runs[j].phase_ns[i];
+	}
+      out << std::setw(11) << total / 1e9 << "\n";
+    }
+  out << std::defaultfloat << std::setprecision(6);
+}
+
+/*
+ * Function: save_metrics
+ * ----------------------
+ * Appends the record of a run to a file (or writes it to stdout)
+ *
+ *    path: the file, or METRICS_STDOUT
+ * metrics: the metrics of the run, whose peak memory is updated
+ *
+ * returns: 1 if the record was written, otherwise, 0
+ */
+inline int save_metrics(const char *path, run_metrics *metrics)
+{
+  std::ofstream file;
+
+  metrics_end(metrics);
+  metrics->peak_rss_kb = metrics_peak_rss();
+
+  if (std::string(path) == METRICS_STDOUT)
+    {
+      print_metrics(std::cout, *metrics);
+      return 1;
+    }
+
+  file.open(path, std::ios::app);
+  if (!file.is_open())
+    return 0;
+
+  print_metrics(file, *metrics);
+  file.close();
+
+  return file.good() ? 1 : 0;
+}
+
+#endif
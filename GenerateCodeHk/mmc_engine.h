@@ -0,0 +1,325 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Selection of the algorithm used to find a minimum mean cycle (MMC) in
+   the configuration graph. Both programs (Hk_lemon_eng_6bar and
+   Hk_lemon_eng_8bar) build the configuration graph with integer weights
+   on the arcs and then call run_mmc with the engine chosen on the
+   command line (--mmc=...)
+*/
+
+#ifndef MMC_ENGINE_H
+#define MMC_ENGINE_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <cstring>
+#include <lemon/smart_graph.h>
+#include <lemon/path.h>
+#include <lemon/hartmann_orlin_mmc.h>
+#include <lemon/howard_mmc.h>
+#include <lemon/karp_mmc.h>
+#include "parallel_howard_mmc.h"
+#include "lawler_mmc.h"
+#include "tropical_mmc.h"
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// Karp and Hartmann-Orlin keep a table with (n +1) x n entries; above
+// this number of entries the table does not fit comfortably in memory
+// and auto selects Howard, which only needs O(n + m) memory
+#define MMC_AUTO_MAX_TABLE_ENTRIES (1LL << 26)
+
+// average out-degree from which Hartmann-Orlin early termination is
+// usually faster than Howard's policy iteration
+#define MMC_AUTO_MIN_DENSE_DEGREE 32
+
+// number of arcs from which auto runs the parallel Howard (when more
+// than one thread is available)
+#define MMC_AUTO_MIN_PARALLEL_ARCS (1LL << 24)
+
+// number of vertices up to which auto runs the tropical engine (the
+// dense products cost n^3)
+#define MMC_AUTO_MAX_TROPICAL_NODES 1024
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Enum: mmc_engine
+ * ----------------
+ * Algorithms available to find a minimum mean cycle
+ */
+enum mmc_engine
+{
+  MMC_AUTO,
+  MMC_HOWARD,
+  MMC_KARP,
+  MMC_HARTMANN_ORLIN,
+  MMC_PARALLEL_HOWARD,
+  MMC_LAWLER,
+  MMC_TROPICAL
+};
+
+typedef enum mmc_engine mmc_engine;
+
+
+/*
+ * Struct: mmc_result
+ * ------------------
+ * The minimum mean cycle found by one of the engines
+ *
+ *      found: 1 if the configuration graph has a cycle, otherwise, 0
+ *
+ *       cost: total weight of the cycle (number of vertices in the code)
+ *
+ *       size: number of arcs in the cycle
+ *
+ *      cycle: the arcs of the cycle, in order
+ *
+ * iterations: number of iterations of the engine, when it reports them
+ *             (otherwise, 0)
+ */
+struct mmc_result
+{
+  int                       found;
+  long long                 cost;
+  int                       size;
+  lemon::Path<lemon::SmartDigraph> cycle;
+  int                       iterations;
+};
+
+typedef struct mmc_result mmc_result;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: parse_mmc_engine
+ * --------------------------
+ * Converts the name given in the command line to an engine
+ *
+ *    name: one of howard, karp, hartmann-orlin, parallel-howard, lawler,
+ *          tropical or auto
+ *  engine: where the engine is stored
+ *
+ * returns: 1 if name is a valid engine, otherwise, 0
+ */
+inline int parse_mmc_engine(const char *name, mmc_engine *engine)
+{
+  if (strcmp(name, "auto") == 0)
+    *engine = MMC_AUTO;
+  else if (strcmp(name, "howard") == 0)
+    *engine = MMC_HOWARD;
+  else if (strcmp(name, "karp") == 0)
+    *engine = MMC_KARP;
+  else if (strcmp(name, "hartmann-orlin") == 0)
+    *engine = MMC_HARTMANN_ORLIN;
+  else if (strcmp(name, "parallel-howard") == 0)
+    *engine = MMC_PARALLEL_HOWARD;
+  else if (strcmp(name, "lawler") == 0)
+    *engine = MMC_LAWLER;
+  else if (strcmp(name, "tropical") == 0)
+    *engine = MMC_TROPICAL;
+  else
+    return 0;
+
+  return 1;
+}
+
+/*
+ * Function: mmc_engine_name
+ * -------------------------
+ * returns: the name of an engine, as it is printed in the timings
+ */
+inline const char *mmc_engine_name(mmc_engine engine)
+{
+  switch (engine)
+    {
+    case MMC_HOWARD:
+      return "Howard";
+    case MMC_KARP:
+      return "Karp";
+    case MMC_HARTMANN_ORLIN:
+      return "Hartmann and Orlin";
+    case MMC_PARALLEL_HOWARD:
+      return "parallel Howard";
+    case MMC_LAWLER:
+      return "Lawler";
+    case MMC_TROPICAL:
+      return "tropical";
+    default:
+      return "auto";
+    }
+}
+
+/*
+ * Function: choose_mmc_engine
+ * ---------------------------
+ * Picks an engine by the size of the configuration graph (used by
+ * --mmc=auto). Karp is never picked, since Hartmann-Orlin is Karp's
+ * algorithm with an early termination test; Lawler is only run when it
+ * is asked for, to save memory on graphs that barely fit in RAM
+ *
+ *   nodes: number of vertices of the configuration graph
+ *    arcs: number of arcs of the configuration graph
+ *
+ * returns: the engine to be used
+ */
+inline mmc_engine choose_mmc_engine(long long nodes, long long arcs)
+{
+  int threads;
+
+  threads = 1;
+#ifdef _OPENMP
+  threads = omp_get_max_threads();
+#endif
+
+  if (nodes == 0)
+    return MMC_HOWARD;
+
+  if (nodes <= MMC_AUTO_MAX_TROPICAL_NODES)
+    return MMC_TROPICAL;
+
+  if (threads > 1 && arcs >= MMC_AUTO_MIN_PARALLEL_ARCS)
+    return MMC_PARALLEL_HOWARD;
+
+  if ((nodes +1) * nodes > MMC_AUTO_MAX_TABLE_ENTRIES)
+    return MMC_HOWARD;
+
+  if (arcs / nodes >= MMC_AUTO_MIN_DENSE_DEGREE)
+    return MMC_HARTMANN_ORLIN;
+
+  return MMC_HOWARD;
+}
+
+/*
+ * Function: run_lemon_mmc
+ * -----------------------
+ * Runs one of LEMON's MMC classes and copies the answer to result
+ *
+ *      G: the configuration graph
+ * weight: the weights of the arcs of G
+ * result: where the cycle is stored
+ *
+ * returns: 1 if G has a cycle, otherwise, 0
+ */
+template <typename MMC>
+int run_lemon_mmc(const lemon::SmartDigraph &G,
+		  const lemon::SmartDigraph::ArcMap<int> &weight,
+		  mmc_result *result)
+{
+  MMC mmc(G, weight);
+
+  result->cycle.clear();
+  result->iterations = 0;
+  mmc.cycle(result->cycle);
+  result->found = mmc.run() ? 1 : 0;
+
+  if (result->found == 0)
+    {
+      result->cost = 0;
+      result->size = 0;
+      return 0;
+    }
+
+  result->cost = mmc.cycleCost();
+  result->size = mmc.cycleSize();
+  return 1;
+}
+
+/*
+ * Function: run_mmc
+ * -----------------
+ * Finds a minimum mean cycle of the configuration graph
+ *
+ *      G: the configuration graph
+ * weight: the weights of the arcs of G
+ * engine: the algorithm to use (MMC_AUTO is resolved by the size of G)
+ * result: where the cycle is stored
+ *
+ * returns: the engine that was actually run (the tropical engine falls
+ *          back to Howard when G is too large for a dense matrix)
+ */
+inline mmc_engine run_mmc(const lemon::SmartDigraph &G,
+			  const lemon::SmartDigraph::ArcMap<int> &weight,
+			  mmc_engine engine, mmc_result *result)
+{
+  typedef lemon::SmartDigraph Digraph;
+  typedef lemon::SmartDigraph::ArcMap<int> WeightMap;
+
+  if (engine == MMC_AUTO)
+    engine = choose_mmc_engine(lemon::countNodes(G), lemon::countArcs(G));
+
+  switch (engine)
+    {
+    case MMC_KARP:
+      run_lemon_mmc<lemon::KarpMmc<Digraph, WeightMap>>(G, weight, result);
+      break;
+    case MMC_HARTMANN_ORLIN:
+      run_lemon_mmc<lemon::HartmannOrlinMmc<Digraph, WeightMap>>(G, weight,
+								   result);
+      break;
+    case MMC_PARALLEL_HOWARD:
+      result->found = parallel_howard_mmc(G, weight, &result->cycle,
+					  &result->cost, &result->size,
+					  &result->iterations);
+      break;
+    case MMC_LAWLER:
+      result->found = lawler_mmc(G, weight, &result->cycle, &result->cost,
+				 &result->size, &result->iterations);
+      break;
+    case MMC_TROPICAL:
+      result->found = tropical_mmc(G, weight, &result->cycle, &result->cost,
+				   &result->size, &result->iterations);
+      if (result->found != -1)
+	break;
+
+      engine = MMC_HOWARD;
+      run_lemon_mmc<lemon::HowardMmc<Digraph, WeightMap>>(G, weight, result);
+      break;
+    default:
+      engine = MMC_HOWARD;
+      run_lemon_mmc<lemon::HowardMmc<Digraph, WeightMap>>(G, weight, result);
+      break;
+    }
+
+  return engine;
+}
+
+/*
+ * Function: cross_check_mmc
+ * -------------------------
+ * Checks the cycle mean found by an engine with the tropical engine,
+ * which does not share any code with LEMON
+ *
+ *      G: the configuration graph
+ * weight: the weights of the arcs of G
+ * result: the cycle found by the engine
+ *
+ * returns: 1 if both cycle means are equal, 0 if they differ and -1 if
+ *          G is too large for the tropical engine
+ */
+inline int cross_check_mmc(const lemon::SmartDigraph &G,
+			   const lemon::SmartDigraph::ArcMap<int> &weight,
+			   const mmc_result *result)
+{
+  mmc_result check;
+
+  check.found = tropical_mmc(G, weight, &check.cycle, &check.cost,
+			     &check.size, &check.iterations);
+
+  if (check.found == -1)
+    return -1;
+
+  if (check.found != result->found)
+    return 0;
+
+  if (check.found == 0)
+    return 1;
+
+  return (check.cost * result->size == result->cost * check.size) ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,681 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Command line options shared by the programs which build a
+   configuration graph (Hk_lemon_eng_6bar.cc and Hk_lemon_eng_8bar.cc)
+*/
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include "mmc_engine.h"
+#include "graph_cache.h"
+#include "external_graph.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "differential.h"
+#include "memory_plan.h"
+#include "barcode_extension.h"
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: hk_options
+ * ------------------
+ * The options given in the command line
+ *
+ *   num_lines: the number of lines of the hexagonal grid (k); in a
+ *              sweep, the last one
+ *
+ *     k_first: the codes are found for k = k_first, ..., k_last in the
+ *      k_last  same process (--k-range); both are num_lines when only
+ *              one k is given
+ *
+ *      engine: the algorithm used to find the minimum mean cycle
+ *
+ * cross_check: 1 if the cycle mean must be checked with the tropical
+ *              engine, otherwise, 0
+ *
+ *       prune: 1 if the arcs which cannot be in a minimum mean cycle must
+ *              be eliminated before the MMC algorithm, otherwise, 0
+ *
+ *  max_period: if positive, the largest period (in columns) of the code;
+ *              the best code is then found by a dynamic program over
+ *              the closed walks, instead of the MMC algorithm
+ *
+ * certificate: 1 if the certificate of optimality of the cycle must be
+ *              saved, otherwise, 0
+ *
+ *       check: 1 if the saved certificate must be checked instead of
+ *              running the MMC algorithm, otherwise, 0
+ *
+ *  target_num: the target density is target_num / target_den; when
+ *  target_den  target_den is positive (anytime mode), the edges are
+ *              created in increasing order of weight and the program
+ *              stops as soon as a code with this density is found
+ *
+ * row_extension: 1 if the bar codes must be generated line by line
+ *              (barcode_extension.h) instead of testing all the bars,
+ *              otherwise, 0
+ *
+ *       count: 1 if only the number of bar codes and arcs must be
+ *              computed (transfer_count.h), for k = 2, ..., num_lines,
+ *              otherwise, 0
+ *
+ * differential: 1 if the fast kernels must only be checked against the
+ *              reference ones (differential.h), otherwise, 0
+ *
+ * differential_seed: the seed of the random pairs of bar codes of the
+ *              differential check
+ *
+ *     generic: 1 if the bar codes and arcs must be checked over LEMON
+ *              graphs even when there are checkers specialized for k
+ *              (specialized_checker.h), otherwise, 0
+ *
+ *   cache_dir: the directory where the bar codes and the configuration
+ *              graph are cached (graph_cache.h), or NULL (no cache)
+ *
+ *  export_csr: the file where the configuration graph is saved in CSR
+ *              form (csr_graph.h), or NULL
+ *
+ *  import_csr: the CSR file from which the configuration graph is
+ *              loaded, instead of being built, or NULL
+ *
+ * external_dir: the directory where the arcs are written in the
+ *              out-of-core mode (external_graph.h), or NULL
+ *
+ *      ram_mb: the RAM budget for the arcs in the out-of-core mode, in
+ *              megabytes
+ *
+ * mem_limit_mb: the memory the run may use, in megabytes
+ *              (memory_plan.h), PLAN_PHYSICAL_MEMORY, or 0 (no plan)
+ *
+ * checkpoint_dir: the directory where the checkpoints of the
+ *              construction of the configuration graph are saved
+ *              (checkpoint.h), or NULL (no checkpoints)
+ *
+ * checkpoint_every: the seconds between two checkpoints
+ *
+ *      resume: 1 if the run must continue from the last checkpoint,
+ *              otherwise, 0
+ *
+ * metrics_path: the file where the metrics of the run are appended
+ *              (metrics.h), METRICS_STDOUT, or NULL (no metrics)
+ *
+ *        perf: 1 if the hardware counters of each phase are measured
+ *              (perf_counters.h), otherwise, 0
+ */
+struct hk_options
+{
+  int        num_lines;
+  int        k_first;
+  int        k_last;
+  mmc_engine engine;
+  int        cross_check;
+  int        prune;
+  int        max_period;
+  int        certificate;
+  int        check;
+  long long  target_num;
+  long long  target_den;
+  int        row_extension;
+  int        count;
+  int        differential;
+  unsigned long long differential_seed;
+  int        generic;
+  const char *cache_dir;
+  const char *export_csr;
+  const char *import_csr;
+  const char *external_dir;
+  long long  ram_mb;
+  long long  mem_limit_mb;
+  const char *checkpoint_dir;
+  long long  checkpoint_every;
+  int        resume;
+  const char *metrics_path;
+  int        perf;
+};
+
+typedef struct hk_options hk_options;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: print_usage
+ * ---------------------
+ * Outputs to stderr how to call the program
+ *
+ * program: the name of the program (argv[0])
+ */
+inline void print_usage(const char *program)
+{
+  std::cerr << "Usage: " << program << " <number of lines> [options]\n"
+	    << "       " << program << " --k-range=FIRST..LAST [options]\n"
+	    << "  --k-range=FIRST..LAST\n"
+	    << "                 finds the codes for FIRST up to LAST lines in"
+	    << " the same process,\n"
+	    << "                 followed by a summary table\n"
+	    << "  --mmc=ENGINE   algorithm used to find the minimum mean"
+	    << " cycle:\n"
+	    << "                 howard, karp, hartmann-orlin (default),"
+	    << " parallel-howard,\n"
+	    << "                 lawler, tropical or auto\n"
+	    << "  --cross-check  checks the cycle mean with the tropical"
+	    << " engine\n"
+	    << "  --prune        eliminates the arcs which cannot be in a"
+	    << " minimum mean cycle\n"
+	    << "                 before running the MMC algorithm\n"
+	    << "  --max-period=P finds the best code with period of at most"
+	    << " P columns\n"
+	    << "  --certificate  saves the certificate of optimality of the"
+	    << " code\n"
+	    << "  --check-certificate\n"
+	    << "                 checks the saved certificate instead of"
+	    << " running the MMC\n"
+	    << "                 algorithm\n"
+	    << "  --target-density=D\n"
+	    << "                 creates the edges in increasing order of"
+	    << " weight and stops\n"
+	    << "                 as soon as a code with density D (as 6/13"
+	    << " or 0.4615) is found\n"
+	    << "  --row-extension\n"
+	    << "                 generates the bar codes line by line, instead"
+	    << " of testing all\n"
+	    << "                 the bars\n"
+	    << "  --count        only counts the bar codes and the arcs of the"
+	    << " configuration\n"
+	    << "                 graph, for 2 up to <number of lines> lines\n"
+	    << "  --differential[=SEED]\n"
+	    << "                 only checks the fast kernels against the"
+	    << " reference ones\n"
+	    << "                 (bar codes, random pairs, arcs and density)\n"
+	    << "  --generic-checker\n"
+	    << "                 does not use the checkers specialized for the"
+	    << " number of lines\n"
+	    << "  --cache[=DIR]  loads the bar codes and the configuration"
+	    << " graph from the\n"
+	    << "                 cache directory (" << CACHE_DEFAULT_DIR
+	    << " by default), or saves them there\n"
+	    << "  --export-csr=FILE\n"
+	    << "                 saves the configuration graph in CSR form"
+	    << " (csr_graph.h)\n"
+	    << "  --import-csr=FILE\n"
+	    << "                 loads the configuration graph from a CSR"
+	    << " file\n"
+	    << "  --external[=DIR]\n"
+	    << "                 keeps the arcs on disk (" << EXTERNAL_DEFAULT_DIR
+	    << " by default) and finds\n"
+	    << "                 the minimum mean cycle reading them"
+	    << " sequentially\n"
+	    << "  --ram=MB       RAM budget for the arcs with --external ("
+	    << EXTERNAL_DEFAULT_RAM_MB << " by default)\n"
+	    << "  --mem-limit[=MB]\n"
+	    << "                 estimates the memory of the run before"
+	    << " building the graph,\n"
+	    << "                 chooses how to keep it within MB (the"
+	    << " physical memory by\n"
+	    << "                 default) and stops if nothing fits\n"
+	    << "  --checkpoint[=DIR]\n"
+	    << "                 saves the state of the construction of the"
+	    << " configuration graph\n"
+	    << "                 periodically (in " << CHECKPOINT_DEFAULT_DIR
+	    << " by default)\n"
+	    << "  --checkpoint-every=SECONDS\n"
+	    << "                 seconds between two checkpoints ("
+	    << CHECKPOINT_DEFAULT_INTERVAL << " by default)\n"
+	    << "  --resume       continues from the last checkpoint, if there"
+	    << " is one\n"
+	    << "  --metrics[=FILE]\n"
+	    << "                 writes the times and counters of each phase as"
+	    << " a JSON record\n"
+	    << "                 (appended to FILE, or to stdout)\n"
+	    << "  --perf         measures the hardware counters of each phase"
+	    << " (cache misses,\n"
+	    << "                 branch mispredictions, IPC)\n";
+}
+
+/*
+ * Function: parse_fraction
+ * ------------------------
+ * Reads a non negative rational number written as a fraction (6/13) or
+ * as a decimal number (0.4615), without rounding
+ *
+ * text: the number
+ *  num: where the numerator is stored
+ *  den: where the denominator is stored
+ *
+ * returns: 1 if text is a valid number, otherwise, 0
+ */
+inline int parse_fraction(const char *text, long long *num, long long *den)
+{
+  const char *c;
+  int amt_digits, decimal;
+
+  *num = 0;
+  *den = 1;
+  amt_digits = 0;
+  decimal = 0;
+
+  for (c = text; *c != '\0' && *c != '/'; c++)
+    {
+      if (*c == '.' && decimal == 0)
+	{
+	  decimal = 1;
+	  continue;
+	}
+
+      if (*c < '0' || *c > '9' || amt_digits == 18)
+	return 0;
+
+      *num = *num * 10 + (*c - '0');
+      if (decimal == 1)
+	*den = *den * 10;
+      amt_digits++;
+    }
+
+  if (amt_digits == 0)
+    return 0;
+
+  if (*c == '/')
+    {
+      if (decimal == 1 || c[1] == '\0' || strlen(c +1) > 18)
+	return 0;
+
+      *den = 0;
+      for (c++; *c != '\0'; c++)
+	{
+	  if (*c < '0' || *c > '9')
+	    return 0;
+	  *den = *den * 10 + (*c - '0');
+	}
+    }
+
+  return (*den > 0) ? 1 : 0;
+}
+
+/*
+ * Function: parse_k_range
+ * -----------------------
+ * Reads a range of numbers of lines, written as FIRST..LAST
+ *
+ *  text: the range
+ * first: where the first number of lines is stored
+ *  last: where the last number of lines is stored
+ *
+ * returns: 1 if text is a valid range, with 2 <= FIRST <= LAST,
+ *          otherwise, 0
+ */
+inline int parse_k_range(const char *text, int *first, int *last)
+{
+  char *end;
+
+  *first = (int) strtol(text, &end, 10);
+  if (end == text || strncmp(end, "..", 2) != 0)
+    return 0;
+
+  text = end +2;
+  *last = (int) strtol(text, &end, 10);
+  if (end == text || *end != '\0')
+    return 0;
+
+  return (*first >= 2 && *last >= *first) ? 1 : 0;
+}
+
+/*
+ * Function: external_conflict
+ * ---------------------------
+ * The out-of-core mode only keeps the arcs of the minimum mean cycle in
+ * memory, so it cannot be used with the options which need the whole
+ * graph
+ *
+ * returns: the first option which does not allow --external, or NULL if
+ *          there is none
+ */
+inline const char *external_conflict(const hk_options *options)
+{
+  if (options->cross_check == 1)
+    return "--cross-check";
+  if (options->prune == 1)
+    return "--prune";
+  if (options->max_period > 0)
+    return "--max-period";
+  if (options->certificate == 1)
+    return "--certificate";
+  if (options->check == 1)
+    return "--check-certificate";
+  if (options->target_den > 0)
+    return "--target-density";
+  if (options->cache_dir != NULL)
+    return "--cache";
+  if (options->export_csr != NULL)
+    return "--export-csr";
+  if (options->import_csr != NULL)
+    return "--import-csr";
+
+  return NULL;
+}
+
+/*
+ * Function: external_allowed
+ * --------------------------
+ * returns: 1 if the other options allow --external, otherwise, 0
+ */
+inline int external_allowed(const hk_options *options)
+{
+  return (external_conflict(options) == NULL) ? 1 : 0;
+}
+
+/*
+ * Function: parse_options
+ * -----------------------
+ * Reads the options from the command line
+ *
+ *    argc: the number of arguments
+ *    argv: the arguments
+ * options: where the options are stored
+ *
+ * returns: 1 if all the arguments are valid, otherwise, 0 (after
+ *          printing what is wrong)
+ */
+inline int parse_options(int argc, char **argv, hk_options *options)
+{
+  int first;   // the first option (after the number of lines)
+  int i;
+
+  options->num_lines = 0;
+  options->k_first = 0;
+  options->k_last = 0;
+  options->engine = MMC_HARTMANN_ORLIN;
+  options->cross_check = 0;
+  options->prune = 0;
+  options->max_period = 0;
+  options->certificate = 0;
+  options->check = 0;
+  options->target_num = 0;
+  options->target_den = 0;
+  options->row_extension = 0;
+  options->count = 0;
+  options->differential = 0;
+  options->differential_seed = DIFFERENTIAL_DEFAULT_SEED;
+  options->generic = 0;
+  options->cache_dir = NULL;
+  options->export_csr = NULL;
+  options->import_csr = NULL;
+  options->external_dir = NULL;
+  options->ram_mb = EXTERNAL_DEFAULT_RAM_MB;
+  options->mem_limit_mb = 0;
+  options->checkpoint_dir = NULL;
+  options->checkpoint_every = CHECKPOINT_DEFAULT_INTERVAL;
+  options->resume = 0;
+  options->metrics_path = NULL;
+  options->perf = 0;
+
+  if (argc < 2)
+    {
+      std::cerr << "Invalid number of arguments!\n";
+      print_usage(argv[0]);
+      return 0;
+    }
+
+  // the number of lines is left out in a sweep
+  first = 1;
+  if (argv[1][0] != '-')
+    {
+      options->num_lines = atoi(argv[1]);
+      first = 2;
+
+      if (options->num_lines < 2)
+	{
+	  std::cerr << "The number of lines must be at least 2!\n";
+	  print_usage(argv[0]);
+	  return 0;
+	}
+    }
+
+  for (i = first; i < argc; i++)
+    {
+      if (strncmp(argv[i], "--k-range=", 10) == 0 &&
+	  parse_k_range(argv[i] +10, &options->k_first,
+			&options->k_last) == 1)
+	continue;
+
+      if (strncmp(argv[i], "--mmc=", 6) == 0 &&
+	  parse_mmc_engine(argv[i] +6, &options->engine) == 1)
+	continue;
+
+      if (strcmp(argv[i], "--cross-check") == 0)
+	{
+	  options->cross_check = 1;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--prune") == 0)
+	{
+	  options->prune = 1;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--certificate") == 0)
+	{
+	  options->certificate = 1;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--check-certificate") == 0)
+	{
+	  options->check = 1;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--target-density=", 17) == 0 &&
+	  parse_fraction(argv[i] +17, &options->target_num,
+			 &options->target_den) == 1)
+	continue;
+
+      if (strcmp(argv[i], "--count") == 0)
+	{
+	  options->count = 1;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--differential") == 0)
+	{
+	  options->differential = 1;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--differential=", 15) == 0 &&
+	  argv[i][15] >= '0' && argv[i][15] <= '9')
+	{
+	  options->differential = 1;
+	  options->differential_seed = strtoull(argv[i] +15, NULL, 0);
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--cache") == 0)
+	{
+	  options->cache_dir = CACHE_DEFAULT_DIR;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--cache=", 8) == 0 && argv[i][8] != '\0')
+	{
+	  options->cache_dir = argv[i] +8;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--export-csr=", 13) == 0 && argv[i][13] != '\0')
+	{
+	  options->export_csr = argv[i] +13;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--import-csr=", 13) == 0 && argv[i][13] != '\0')
+	{
+	  options->import_csr = argv[i] +13;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--external") == 0)
+	{
+	  options->external_dir = EXTERNAL_DEFAULT_DIR;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--external=", 11) == 0 && argv[i][11] != '\0')
+	{
+	  options->external_dir = argv[i] +11;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--ram=", 6) == 0 && atoll(argv[i] +6) > 0)
+	{
+	  options->ram_mb = atoll(argv[i] +6);
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--mem-limit") == 0)
+	{
+	  options->mem_limit_mb = PLAN_PHYSICAL_MEMORY;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--mem-limit=", 12) == 0 &&
+	  atoll(argv[i] +12) > 0)
+	{
+	  options->mem_limit_mb = atoll(argv[i] +12);
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--checkpoint") == 0)
+	{
+	  options->checkpoint_dir = CHECKPOINT_DEFAULT_DIR;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--checkpoint=", 13) == 0 && argv[i][13] != '\0')
+	{
+	  options->checkpoint_dir = argv[i] +13;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--checkpoint-every=", 19) == 0 &&
+	  atoll(argv[i] +19) > 0)
+	{
+	  options->checkpoint_every = atoll(argv[i] +19);
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--resume") == 0)
+	{
+	  options->resume = 1;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--metrics") == 0)
+	{
+	  options->metrics_path = METRICS_STDOUT;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--metrics=", 10) == 0 && argv[i][10] != '\0')
+	{
+	  options->metrics_path = argv[i] +10;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--perf") == 0)
+	{
+	  options->perf = 1;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--generic-checker") == 0)
+	{
+	  options->generic = 1;
+	  continue;
+	}
+
+      if (strcmp(argv[i], "--row-extension") == 0)
+	{
+	  options->row_extension = 1;
+	  continue;
+	}
+
+      if (strncmp(argv[i], "--max-period=", 13) == 0 &&
+	  atoi(argv[i] +13) > 0)
+	{
+	  options->max_period = atoi(argv[i] +13);
+	  continue;
+	}
+
+      std::cerr << "Invalid argument: " << argv[i] << "\n";
+      print_usage(argv[0]);
+      return 0;
+    }
+
+  // either a number of lines or a sweep; --count counts up to the last
+  // number of lines of the sweep
+  if ((options->num_lines == 0) == (options->k_first == 0))
+    {
+      std::cerr << "Give either the number of lines or --k-range!\n";
+      print_usage(argv[0]);
+      return 0;
+    }
+
+  if (options->k_first == 0)
+    options->k_first = options->k_last = options->num_lines;
+  else
+    options->num_lines = options->k_last;
+
+  // the bars of the extension are kept in 64 bits
+  if (options->row_extension == 1 && options->k_last > BARCODE_MAX_LINES)
+    {
+      std::cerr << "--row-extension supports at most " << BARCODE_MAX_LINES
+		<< " lines!\n";
+      return 0;
+    }
+
+  // a CSR file has the graph of a single k
+  if (options->k_first < options->k_last &&
+      (options->import_csr != NULL || options->export_csr != NULL))
+    {
+      std::cerr << "--import-csr and --export-csr cannot be used with"
+		<< " --k-range!\n";
+      return 0;
+    }
+
+  if (options->external_dir != NULL && external_allowed(options) == 0)
+    {
+      std::cerr << "--external cannot be used with "
+		<< external_conflict(options) << "!\n";
+      return 0;
+    }
+
+  // the checkpoints are saved where --resume looks for them
+  if (options->resume == 1 && options->checkpoint_dir == NULL)
+    options->checkpoint_dir = CHECKPOINT_DEFAULT_DIR;
+
+  // the checkpoints only follow the construction of the whole graph in
+  // memory
+  if (options->checkpoint_dir != NULL &&
+      (options->external_dir != NULL || options->target_den > 0 ||
+       options->import_csr != NULL))
+    {
+      std::cerr << "--checkpoint and --resume cannot be used with"
+		<< " --external, --target-density or --import-csr!\n";
+      return 0;
+    }
+
+  return 1;
+}
+
+#endif
@@ -0,0 +1,529 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Implementation of Howard's policy iteration algorithm to find a
+   minimum mean cycle, in which the evaluation of a policy and the
+   improvement of a policy are done in parallel (OpenMP) over ranges of
+   vertices of the configuration graph. Each iteration is synchronized
+   at the end of the evaluation and of the improvement.
+
+   All the arithmetic is done with integers: the mean of a cycle is kept
+   as a reduced fraction p/q and the distance of a vertex to its cycle is
+   scaled by q, so the algorithm finds exactly the same cycle mean as
+   the algorithms of LEMON.
+*/
+
+#ifndef PARALLEL_HOWARD_MMC_H
+#define PARALLEL_HOWARD_MMC_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <vector>
+#include <lemon/smart_graph.h>
+#include <lemon/path.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: howard_csr
+ * ------------------
+ * The out-arcs of the configuration graph in compressed sparse rows,
+ * so the arcs of a vertex can be scanned in parallel
+ *
+ * offset: the out-arcs of vertex u are offset[u] .. offset[u +1] -1
+ * target: the target of each arc
+ * weight: the weight of each arc
+ * arc_id: the id of each arc in the SmartDigraph
+ */
+struct howard_csr
+{
+  std::vector<int> offset;
+  std::vector<int> target;
+  std::vector<int> weight;
+  std::vector<int> arc_id;
+};
+
+typedef struct howard_csr howard_csr;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: howard_gcd
+ * --------------------
+ * returns: the greatest common divisor of a and b (1 if both are 0)
+ */
+inline long long howard_gcd(long long a, long long b)
+{
+  long long r;
+
+  if (a < 0)
+    a = -a;
+
+  while (b != 0)
+    {
+      r = a % b;
+      a = b;
+      b = r;
+    }
+
+  return (a == 0) ? 1 : a;
+}
+
+/*
+ * Function: howard_build_csr
+ * --------------------------
+ * Copies the arcs of G, grouped by source, to csr
+ */
+inline void howard_build_csr(const lemon::SmartDigraph &G,
+			     const lemon::SmartDigraph::ArcMap<int> &weight,
+			     howard_csr *csr)
+{
+  std::vector<int> position;
+  int n, m, u, i;
+
+  n = lemon::countNodes(G);
+  m = lemon::countArcs(G);
+
+  csr->offset.assign(n +1, 0);
+  csr->target.resize(m);
+  csr->weight.resize(m);
+  csr->arc_id.resize(m);
+
+  for (lemon::SmartDigraph::ArcIt a(G); a != lemon::INVALID; ++a)
+    csr->offset[G.id(G.source(a)) +1]++;
+
+  for (u = 0; u < n; u++)
+    csr->offset[u +1] += csr->offset[u];
+
+  position.assign(csr->offset.begin(), csr->offset.end() -1);
+
+  for (lemon::SmartDigraph::ArcIt a(G); a != lemon::INVALID; ++a)
+    {
+      i = position[G.id(G.source(a))]++;
+      csr->target[i] = G.id(G.target(a));
+      csr->weight[i] = weight[a];
+      csr->arc_id[i] = G.id(a);
+    }
+}
+
+/*
+ * Function: howard_prune_acyclic
+ * ------------------------------
+ * Marks the vertices which cannot reach a cycle (repeatedly removes the
+ * vertices without out-arcs), since they have no policy
+ *
+ *     G: the configuration graph
+ *   csr: the out-arcs of G
+ * alive: alive[u] = 1 if u reaches a cycle, otherwise, 0
+ *
+ * returns: the number of vertices which reach a cycle
+ */
+inline int howard_prune_acyclic(const lemon::SmartDigraph &G,
+				const howard_csr &csr,
+				std::vector<char> &alive)
+{
+  std::vector<int> degree;
+  std::vector<int> queue;
+  int n, u, h, amt_alive;
+
+  n = (int) csr.offset.size() -1;
+  alive.assign(n, 1);
+  degree.resize(n);
+  amt_alive = n;
+
+  for (u = 0; u < n; u++)
+    {
+      degree[u] = csr.offset[u +1] - csr.offset[u];
+
+      if (degree[u] == 0)
+	queue.push_back(u);
+    }
+
+  for (h = 0; h < (int) queue.size(); h++)
+    {
+      u = queue[h];
+      alive[u] = 0;
+      amt_alive--;
+
+      for (lemon::SmartDigraph::InArcIt a(G, G.nodeFromId(u));
+	   a != lemon::INVALID; ++a)
+	if (--degree[G.id(G.source(a))] == 0)
+	  queue.push_back(G.id(G.source(a)));
+    }
+
+  return amt_alive;
+}
+
+/*
+ * Function: howard_evaluate_policy
+ * --------------------------------
+ * Computes, for every vertex u, the mean p/q of the cycle reached by u
+ * following the policy and the distance of u to that cycle scaled by q
+ * (dist[u] = q * w(u, policy(u)) - p + dist[policy(u)]).
+ *
+ * The cycles of the policy are found by a sequential walk, which is
+ * linear on the number of vertices; the distances are then propagated
+ * from the cycles by levels, each level processed in parallel.
+ */
+inline void howard_evaluate_policy(const howard_csr &csr,
+				   const std::vector<char> &alive,
+				   const std::vector<int> &policy,
+				   std::vector<long long> &mean_num,
+				   std::vector<long long> &mean_den,
+				   std::vector<long long> &dist)
+{
+  std::vector<int> visit;       // the walk in which a vertex was visited
+  std::vector<char> evaluated;  // 1 if the vertex lies on a cycle
+  std::vector<int> child_count; // number of vertices whose policy
+                                // points to the vertex
+  std::vector<int> child_offset;
+  std::vector<int> children;
+  std::vector<int> frontier, next;
+  std::vector<int> cycle;
+  long long sum, len, g;
+  int n, s, u, v, i, j;
+
+  n = (int) alive.size();
+  visit.assign(n, -1);
+  evaluated.assign(n, 0);
+
+  // finds the cycles of the policy and the distances along them, taking
+  // the first vertex found on the cycle as its root (distance 0)
+  for (s = 0; s < n; s++)
+    {
+      if (!alive[s] || visit[s] != -1)
+	continue;
+
+      u = s;
+      while (visit[u] == -1)
+	{
+	  visit[u] = s;
+	  u = csr.target[policy[u]];
+	}
+
+      // the walk stopped at a vertex of a previous walk
+      if (visit[u] != s)
+	continue;
+
+      cycle.clear();
+      sum = 0;
+      v = u;
+      do
+	{
+	  cycle.push_back(v);
+	  sum += csr.weight[policy[v]];
+	  v = csr.target[policy[v]];
+	}
+      while (v != u);
+
+      len = (long long) cycle.size();
+      g = howard_gcd(sum, len);
+
+      for (i = (int) cycle.size() -1; i >= 0; i--)
+	{
+	  v = cycle[i];
+	  mean_num[v] = sum / g;
+	  mean_den[v] = len / g;
+	  evaluated[v] = 1;
+
+	  if (i == 0)
+	    dist[v] = 0;
+	  else
+	    dist[v] = mean_den[v] * csr.weight[policy[v]] - mean_num[v] +
+	      ((i +1 < (int) cycle.size()) ? dist[cycle[i +1]] : 0);
+	}
+
+      frontier.insert(frontier.end(), cycle.begin(), cycle.end());
+    }
+
+  // builds the tree of the policy (the children of each vertex)
+  child_count.assign(n, 0);
+
+  # pragma omp parallel for schedule(static)
+  for (u = 0; u < n; u++)
+    if (alive[u] && !evaluated[u])
+      {
+	# pragma omp atomic
+	child_count[csr.target[policy[u]]]++;
+      }
+
+  child_offset.assign(n +1, 0);
+  for (u = 0; u < n; u++)
+    child_offset[u +1] = child_offset[u] + child_count[u];
+
+  children.resize(child_offset[n]);
+
+  # pragma omp parallel for schedule(static)
+  for (u = 0; u < n; u++)
+    if (alive[u] && !evaluated[u])
+      {
+	int parent, slot;
+
+	parent = csr.target[policy[u]];
+
+	# pragma omp atomic capture
+	slot = --child_count[parent];
+
+	children[child_offset[parent] + slot] = u;
+      }
+
+  // propagates mean and distance from the cycles to the trees, by levels
+  while (!frontier.empty())
+    {
+      std::vector<int> level_offset(frontier.size() +1, 0);
+
+      for (i = 0; i < (int) frontier.size(); i++)
+	{
+	  u = frontier[i];
+	  level_offset[i +1] = level_offset[i] +
+	    (child_offset[u +1] - child_offset[u]);
+	}
+
+      next.resize(level_offset[frontier.size()]);
+
+      # pragma omp parallel for schedule(dynamic, 256) private(j)
+      for (i = 0; i < (int) frontier.size(); i++)
+	{
+	  int parent, c, k;
+
+	  parent = frontier[i];
+	  k = level_offset[i];
+
+	  for (j = child_offset[parent]; j < child_offset[parent +1]; j++)
+	    {
+	      c = children[j];
+	      mean_num[c] = mean_num[parent];
+	      mean_den[c] = mean_den[parent];
+	      dist[c] = mean_den[c] * csr.weight[policy[c]] - mean_num[c] +
+		dist[parent];
+	      next[k++] = c;
+	    }
+	}
+
+      frontier.swap(next);
+    }
+}
+
+/*
+ * Function: howard_improve_policy
+ * -------------------------------
+ * Improves the policy of every vertex in parallel. A vertex first moves
+ * to an arc whose target reaches a cycle with smaller mean; if there is
+ * none, it moves to an arc (towards the same mean) which decreases its
+ * distance. A vertex only changes its policy on a strict improvement,
+ * which guarantees termination.
+ *
+ * returns: the number of vertices whose policy changed
+ */
+inline int howard_improve_policy(const howard_csr &csr,
+				 const std::vector<char> &alive,
+				 std::vector<int> &policy,
+				 const std::vector<long long> &mean_num,
+				 const std::vector<long long> &mean_den,
+				 const std::vector<long long> &dist)
+{
+  int n, u, changed;
+
+  n = (int) alive.size();
+  changed = 0;
+
+  # pragma omp parallel for schedule(dynamic, 1024) reduction(+:changed)
+  for (u = 0; u < n; u++)
+    {
+      long long p, q, value, best_value;
+      int e, v, best;
+
+      if (!alive[u])
+	continue;
+
+      // smallest mean reachable through an out-arc of u
+      p = mean_num[u];
+      q = mean_den[u];
+
+      for (e = csr.offset[u]; e < csr.offset[u +1]; e++)
+	{
+	  v = csr.target[e];
+
+	  if (alive[v] && mean_num[v] * q < p * mean_den[v])
+	    {
+	      p = mean_num[v];
+	      q = mean_den[v];
+	    }
+	}
+
+      // among the arcs which reach that mean, the one with the smallest
+      // distance; the current policy is kept when it ties
+      best = -1;
+      best_value = 0;
+
+      for (e = csr.offset[u]; e < csr.offset[u +1]; e++)
+	{
+	  v = csr.target[e];
+
+	  if (!alive[v] || mean_num[v] != p || mean_den[v] != q)
+	    continue;
+
+	  value = q * csr.weight[e] - p + dist[v];
+
+	  if (best == -1 || value < best_value ||
+	      (value == best_value && e == policy[u]))
+	    {
+	      best = e;
+	      best_value = value;
+	    }
+	}
+
+      if (p != mean_num[u] || q != mean_den[u] ||
+	  (best_value < dist[u] && best != policy[u]))
+	{
+	  policy[u] = best;
+	  changed++;
+	}
+    }
+
+  return changed;
+}
+
+/*
+ * Function: howard_policy_iteration
+ * ---------------------------------
+ * Runs Howard's policy iteration, evaluating and improving the policy in
+ * parallel, and gives the cycle with the smallest mean in the last
+ * policy evaluated
+ *
+ *              G: the configuration graph
+ *         weight: the (integer) weights of the arcs of G
+ * max_iterations: the maximum number of policies evaluated (0 for no
+ *                 limit); when the limit stops the iteration, the cycle
+ *                 is not always a minimum mean cycle, but its mean is an
+ *                 upper bound for the minimum mean
+ *          cycle: where the arcs of the cycle are stored
+ *           cost: the total weight of the cycle
+ *           size: the number of arcs of the cycle
+ *     iterations: the number of policy iterations performed (may be NULL)
+ *
+ * returns: 1 if G has a cycle, otherwise, 0
+ */
+inline int howard_policy_iteration(const lemon::SmartDigraph &G,
+				   const lemon::SmartDigraph::ArcMap<int> &weight,
+				   int max_iterations,
+				   lemon::Path<lemon::SmartDigraph> *cycle,
+				   long long *cost, int *size, int *iterations)
+{
+  howard_csr csr;
+  std::vector<char> alive;
+  std::vector<int> policy;
+  std::vector<long long> mean_num, mean_den, dist;
+  std::vector<int> visit;
+  int n, u, best_u, amt_iterations;
+
+  cycle->clear();
+  *cost = 0;
+  *size = 0;
+
+  howard_build_csr(G, weight, &csr);
+  n = (int) csr.offset.size() -1;
+
+  if (howard_prune_acyclic(G, csr, alive) == 0)
+    return 0;
+
+  // initial policy: the lightest arc towards a vertex which reaches a
+  // cycle
+  policy.assign(n, -1);
+
+  # pragma omp parallel for schedule(dynamic, 1024)
+  for (u = 0; u < n; u++)
+    {
+      int e;
+
+      if (!alive[u])
+	continue;
+
+      for (e = csr.offset[u]; e < csr.offset[u +1]; e++)
+	if (alive[csr.target[e]] &&
+	    (policy[u] == -1 || csr.weight[e] < csr.weight[policy[u]]))
+	  policy[u] = e;
+    }
+
+  mean_num.assign(n, 0);
+  mean_den.assign(n, 1);
+  dist.assign(n, 0);
+  amt_iterations = 0;
+
+  for (;;)
+    {
+      howard_evaluate_policy(csr, alive, policy, mean_num, mean_den, dist);
+      amt_iterations++;
+
+      if (max_iterations > 0 && amt_iterations >= max_iterations)
+	break;
+
+      if (howard_improve_policy(csr, alive, policy, mean_num, mean_den,
+				dist) == 0)
+	break;
+    }
+
+  if (iterations != NULL)
+    *iterations = amt_iterations;
+
+  // the vertex with the smallest mean reaches a minimum mean cycle
+  best_u = -1;
+  for (u = 0; u < n; u++)
+    if (alive[u] && (best_u == -1 ||
+		     mean_num[u] * mean_den[best_u] <
+		     mean_num[best_u] * mean_den[u]))
+      best_u = u;
+
+  visit.assign(n, 0);
+  u = best_u;
+  while (!visit[u])
+    {
+      visit[u] = 1;
+      u = csr.target[policy[u]];
+    }
+
+  best_u = u;
+  do
+    {
+      cycle->addBack(G.arcFromId(csr.arc_id[policy[u]]));
+      *cost += csr.weight[policy[u]];
+      (*size)++;
+      u = csr.target[policy[u]];
+    }
+  while (u != best_u);
+
+  return 1;
+}
+
+/*
+ * Function: parallel_howard_mmc
+ * -----------------------------
+ * Finds a minimum mean cycle of the configuration graph with Howard's
+ * policy iteration, evaluating and improving the policy in parallel
+ *
+ *          G: the configuration graph
+ *     weight: the (integer) weights of the arcs of G
+ *      cycle: where the arcs of the minimum mean cycle are stored
+ *       cost: the total weight of the cycle
+ *       size: the number of arcs of the cycle
+ * iterations: the number of policy iterations performed (may be NULL)
+ *
+ * returns: 1 if G has a cycle, otherwise, 0
+ */
+inline int parallel_howard_mmc(const lemon::SmartDigraph &G,
+			       const lemon::SmartDigraph::ArcMap<int> &weight,
+			       lemon::Path<lemon::SmartDigraph> *cycle,
+			       long long *cost, int *size, int *iterations)
+{
+  return howard_policy_iteration(G, weight, 0, cycle, cost, size,
+				 iterations);
+}
+
+#endif
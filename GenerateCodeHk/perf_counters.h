@@ -0,0 +1,323 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Hardware performance counters of Linux (perf_event_open), used by
+   --perf to measure each phase of the programs which build a
+   configuration graph: cycles, instructions (and so the IPC), cache
+   references and misses, branches and branch mispredictions, and the
+   CPU time (task clock) of the threads.
+
+   The counters of the process are opened once, before any parallel
+   region, with inherit set: the threads created afterwards (the OpenMP
+   workers) are counted with the thread which opened them, and a read
+   returns the sum over all of them. The counters of a phase are the
+   difference of two reads. The parallel loops may also open counters of
+   their own in each worker thread, to show how the work is spread.
+
+   The counters are opened one by one (not as a group, which cannot be
+   inherited in older kernels), so the ones the machine does not have are
+   left out: in virtual machines and containers usually only the task
+   clock is available, and with /proc/sys/kernel/perf_event_paranoid
+   above 2 none is. When the kernel multiplexes the counters their
+   values are scaled by the fraction of the time they were running.
+*/
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// the counters measured
+#define PERF_CYCLES           0
+#define PERF_INSTRUCTIONS     1
+#define PERF_CACHE_REFERENCES 2
+#define PERF_CACHE_MISSES     3
+#define PERF_BRANCHES         4
+#define PERF_BRANCH_MISSES    5
+#define PERF_TASK_CLOCK       6
+#define PERF_EVENTS           7
+
+// value of a counter which is not available
+#define PERF_UNAVAILABLE -1
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: perf_counters
+ * ---------------------
+ * The open counters of a thread (or of the process)
+ *
+ *     fd: the file descriptor of each counter (-1 if it is not open)
+ *  error: the errno of the first counter which could not be opened
+ */
+struct perf_counters
+{
+  int fd[PERF_EVENTS];
+  int error;
+};
+
+typedef struct perf_counters perf_counters;
+
+/*
+ * Struct: perf_sample
+ * -------------------
+ * The values of the counters (PERF_UNAVAILABLE if a counter is not
+ * open). The task clock is in nanoseconds
+ */
+struct perf_sample
+{
+  long long value[PERF_EVENTS];
+};
+
+typedef struct perf_sample perf_sample;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: perf_event_name
+ * -------------------------
+ * returns: the name of a counter in the records
+ */
+inline const char *perf_event_name(int event)
+{
+  switch (event)
+    {
+    case PERF_CYCLES:           return "cycles";
+    case PERF_INSTRUCTIONS:     return "instructions";
+    case PERF_CACHE_REFERENCES: return "cache_references";
+    case PERF_CACHE_MISSES:     return "cache_misses";
+    case PERF_BRANCHES:         return "branches";
+    case PERF_BRANCH_MISSES:    return "branch_misses";
+    case PERF_TASK_CLOCK:       return "task_clock_ns";
+    }
+
+  return "none";
+}
+
+/*
+ * Function: perf_clear
+ * --------------------
+ * Sets all the counters of a sample to zero (or PERF_UNAVAILABLE)
+ *
+ *    sample: the sample
+ * available: 1 if the counters start at zero, 0 if they are unavailable
+ */
+inline void perf_clear(perf_sample *sample, int available)
+{
+  int i;
+
+  for (i = 0; i < PERF_EVENTS; i++)
+    sample->value[i] = (available == 1) ? 0 : PERF_UNAVAILABLE;
+}
+
+/*
+ * Function: perf_open
+ * -------------------
+ * Opens the counters of the calling thread, counting only user space
+ *
+ * counters: the counters opened
+ *  inherit: 1 if the threads created afterwards are also counted
+ *
+ * returns: the number of counters opened
+ */
+inline int perf_open(perf_counters *counters, int inherit)
+{
+  static const uint32_t type[PERF_EVENTS] =
+    {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+     PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+     PERF_TYPE_SOFTWARE};
+  static const uint64_t config[PERF_EVENTS] =
+    {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+     PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES,
+     PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+     PERF_COUNT_SW_TASK_CLOCK};
+  struct perf_event_attr attr;
+  int opened;
+  int i;
+
+  counters->error = 0;
+  opened = 0;
+
+  for (i = 0; i < PERF_EVENTS; i++)
+    {
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type[i];
+      attr.config = config[i];
+      attr.inherit = inherit;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+	PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      // pid 0 and cpu -1: the calling thread, on any cpu
+      counters->fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+      if (counters->fd[i] >= 0)
+	opened++;
+      else if (counters->error == 0)
+	counters->error = errno;
+    }
+
+  return opened;
+}
+
+/*
+ * Function: perf_read
+ * -------------------
+ * Reads the counters, scaled when the kernel multiplexed them
+ *
+ * counters: the open counters
+ *   sample: the values read
+ */
+inline void perf_read(const perf_counters &counters, perf_sample *sample)
+{
+  uint64_t data[3];    // the value, the time enabled and the time running
+  int i;
+
+  for (i = 0; i < PERF_EVENTS; i++)
+    {
+      sample->value[i] = PERF_UNAVAILABLE;
+
+      if (counters.fd[i] < 0 ||
+	  read(counters.fd[i], data, sizeof(data)) != sizeof(data))
+	continue;
+
+      if (data[2] == 0)
+	sample->value[i] = 0;
+      else if (data[2] < data[1])
+	sample->value[i] = (long long) ((double) data[0] * data[1] / data[2]);
+      else
+	sample->value[i] = (long long) data[0];
+    }
+}
+
+/*
+ * Function: perf_close
+ * --------------------
+ * Closes the counters
+ */
+inline void perf_close(perf_counters *counters)
+{
+  int i;
+
+  for (i = 0; i < PERF_EVENTS; i++)
+    {
+      if (counters->fd[i] >= 0)
+	close(counters->fd[i]);
+      counters->fd[i] = -1;
+    }
+}
+
+/*
+ * Function: perf_add
+ * ------------------
+ * Adds to a sample the counts between two reads
+ *
+ *   sum: the sample
+ * begin: the values at the beginning
+ *   end: the values at the end
+ */
+inline void perf_add(perf_sample *sum, const perf_sample &begin,
+		     const perf_sample &end)
+{
+  int i;
+
+  for (i = 0; i < PERF_EVENTS; i++)
+    {
+      if (begin.value[i] == PERF_UNAVAILABLE ||
+	  end.value[i] == PERF_UNAVAILABLE)
+	sum->value[i] = PERF_UNAVAILABLE;
+      else if (sum->value[i] != PERF_UNAVAILABLE)
+	sum->value[i] += end.value[i] - begin.value[i];
+    }
+}
+
+/*
+ * Function: print_ratio
+ * ---------------------
+ * Outputs a ratio between two counters, or "n/a" if one of them is not
+ * available
+ *
+ *       out: where the ratio is written
+ *       num: the numerator
+ *       den: the denominator
+ *     scale: the ratio is multiplied by scale (100 for a percentage)
+ *    suffix: written after the ratio
+ */
+inline void print_ratio(std::ostream &out, long long num, long long den,
+			double scale, const char *suffix)
+{
+  if (num == PERF_UNAVAILABLE || den == PERF_UNAVAILABLE || den == 0)
+    out << "n/a";
+  else
+    out << scale * num / den << suffix;
+}
+
+/*
+ * Function: print_perf
+ * --------------------
+ * Outputs the counters of a sample in a single line: the CPU time, the
+ * IPC, and the rates of cache misses and of branch mispredictions
+ *
+ *    out: where the counters are written
+ * sample: the counters
+ */
+inline void print_perf(std::ostream &out, const perf_sample &sample)
+{
+  out << "cpu time: ";
+  print_ratio(out, sample.value[PERF_TASK_CLOCK], 1000000, 1, "ms");
+  out << "  cycles: ";
+  if (sample.value[PERF_CYCLES] == PERF_UNAVAILABLE)
+    out << "n/a";
+  else
+    out << sample.value[PERF_CYCLES];
+  out << "  IPC: ";
+  print_ratio(out, sample.value[PERF_INSTRUCTIONS],
+	      sample.value[PERF_CYCLES], 1, "");
+  out << "  cache misses: ";
+  print_ratio(out, sample.value[PERF_CACHE_MISSES],
+	      sample.value[PERF_CACHE_REFERENCES], 100, "%");
+  out << "  branch mispredictions: ";
+  print_ratio(out, sample.value[PERF_BRANCH_MISSES],
+	      sample.value[PERF_BRANCHES], 100, "%");
+}
+
+/*
+ * Function: print_perf_json
+ * -------------------------
+ * Outputs the counters of a sample as the fields of a JSON object (null
+ * for the ones which are not available)
+ *
+ *    out: where the counters are written
+ * sample: the counters
+ */
+inline void print_perf_json(std::ostream &out, const perf_sample &sample)
+{
+  int i;
+
+  for (i = 0; i < PERF_EVENTS; i++)
+    {
+      out << ((i > 0) ? "," : "") << "\"" << perf_event_name(i) << "\":";
+      if (sample.value[i] == PERF_UNAVAILABLE)
+	out << "null";
+      else
+	out << sample.value[i];
+    }
+}
+
+#endif
@@ -0,0 +1,269 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Checkers of bar codes and of unions of bar codes (the arcs of the
+   configuration graph) specialized at compile time on the number of
+   lines k, the number of columns of a bar and the number of overlapping
+   columns. A bar is stored with one byte per line (bit c is the vertex
+   of column c), and the neighborhoods of the vertices and the pairs of
+   vertices to compare come from constexpr tables, so the compiler
+   unrolls all the loops and keeps the lines in registers.
+
+   The identifier of the vertex (r, c) is stored as three bytes: the
+   vertices of the lines r -1, r and r +1. Two identifiers of the same
+   line are compared directly. An identifier of the line r -1 can only
+   be equal to one of the line r when it has no vertex in the line r -2,
+   and then it is compared shifted by one byte; identifiers of lines
+   farther apart are never equal (the vertical edges below and above a
+   line are in different columns).
+
+   The checkers are instantiated for k = CHECKER_MIN_LINES, ...,
+   CHECKER_MAX_LINES and selected at startup from the number of lines
+   given in the command line; for other values of k the programs use the
+   checkers over LEMON graphs.
+*/
+
+#ifndef SPECIALIZED_CHECKER_H
+#define SPECIALIZED_CHECKER_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <cstdint>
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// range of the number of lines with specialized checkers
+#define CHECKER_MIN_LINES 2
+#define CHECKER_MAX_LINES 10
+
+// the widest union of two bars (a line is stored in one byte)
+#define CHECKER_MAX_WIDTH 8
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: checker_table
+ * ---------------------
+ * The neighborhoods of the vertices of a bar with W columns and the
+ * pairs of vertices of a line which are compared
+ *
+ * neighborhood: neighborhood[p][c] has the vertices of the lines r -1, r
+ *               and r +1 adjacent (or equal) to the vertex (r, c), for a
+ *               line r with r % 2 == p
+ *    amt_pairs: the number of pairs of columns (c, d), with c < d, which
+ *               are not the first or last column
+ *         pair: the pairs of columns
+ */
+template <int W>
+struct checker_table
+{
+  uint8_t neighborhood[2][W][3];
+  int     amt_pairs;
+  uint8_t pair[W * W][2];
+};
+
+/*
+ * Struct: hk_checker
+ * ------------------
+ * The checkers selected for the number of lines given
+ *
+ *  bar_valid: checks if a bar (one byte per line) is a bar code
+ * seam_valid: checks if the union of two bar codes is a bar code, that
+ *             is, if there is an arc between them
+ */
+struct hk_checker
+{
+  int (*bar_valid)(const uint8_t *lines);
+  int (*seam_valid)(const uint8_t *a, const uint8_t *b);
+};
+
+typedef struct hk_checker hk_checker;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: make_checker_table
+ * ----------------------------
+ * returns: the table of a bar with W columns (the vertical edges between
+ *          the lines r and r +1 are in the columns with c % 2 == r % 2)
+ */
+template <int W>
+constexpr checker_table<W> make_checker_table()
+{
+  checker_table<W> table = {};
+  int p = 0, c = 0, d = 0;
+
+  for (p = 0; p < 2; p++)
+    for (c = 0; c < W; c++)
+      {
+	table.neighborhood[p][c][0] = (c % 2 != p) ? (uint8_t) (1u << c) : 0;
+	table.neighborhood[p][c][1] =
+	  (uint8_t) ((1u << c) | ((c > 0) ? 1u << (c -1) : 0) |
+		     ((c < W -1) ? 1u << (c +1) : 0));
+	table.neighborhood[p][c][2] = (c % 2 == p) ? (uint8_t) (1u << c) : 0;
+      }
+
+  table.amt_pairs = 0;
+  for (c = 1; c < W -1; c++)
+    for (d = c +1; d < W -1; d++)
+      {
+	table.pair[table.amt_pairs][0] = (uint8_t) c;
+	table.pair[table.amt_pairs][1] = (uint8_t) d;
+	table.amt_pairs++;
+      }
+
+  return table;
+}
+
+/*
+ * Function: checker_bar_valid
+ * ---------------------------
+ * Checks if a bar with K lines and W columns is valid: the vertices which
+ * are not in the first or last column have non empty and pairwise
+ * distinct identifiers
+ *
+ * lines: the lines of the bar
+ *
+ * returns: 1 if the bar is valid, otherwise, 0
+ */
+template <int K, int W>
+int checker_bar_valid(const uint8_t *lines)
+{
+  static constexpr checker_table<W> table = make_checker_table<W>();
+  uint32_t id[2][W];
+  uint32_t below, above;
+  int r, c, d, i, cur;
+
+  for (r = 0; r < K; r++)
+    {
+      cur = r % 2;
+      below = (r > 0) ? lines[r -1] : 0;
+      above = (r < K -1) ? lines[r +1] : 0;
+
+      for (c = 1; c < W -1; c++)
+	{
+	  id[cur][c] = (below & table.neighborhood[cur][c][0]) |
+	    (uint32_t) (lines[r] & table.neighborhood[cur][c][1]) << 8 |
+	    (above & table.neighborhood[cur][c][2]) << 16;
+
+	  if (id[cur][c] == 0)
+	    return 0;
+	}
+
+      for (i = 0; i < table.amt_pairs; i++)
+	if (id[cur][table.pair[i][0]] == id[cur][table.pair[i][1]])
+	  return 0;
+
+      // an identifier of the line r -1 without vertices in the line r -2
+      // is compared with the ones of the line r in the same bytes
+      if (r > 0)
+	for (d = 1; d < W -1; d++)
+	  if ((id[1 - cur][d] & 0xff) == 0)
+	    for (c = 1; c < W -1; c++)
+	      if (id[1 - cur][d] >> 8 == id[cur][c])
+		return 0;
+    }
+
+  return 1;
+}
+
+/*
+ * Function: checker_seam_valid
+ * ----------------------------
+ * Checks if the union of two bar codes with K lines and W columns,
+ * overlapping OVERLAP columns, is valid
+ *
+ * a: the lines of the first bar code
+ * b: the lines of the second bar code
+ *
+ * returns: 1 if the bar codes agree on the overlapping columns and their
+ *          union is valid, otherwise, 0
+ */
+template <int K, int W, int OVERLAP>
+int checker_seam_valid(const uint8_t *a, const uint8_t *b)
+{
+  static_assert(2 * W - OVERLAP <= CHECKER_MAX_WIDTH,
+		"a line of the union must fit in one byte");
+  uint8_t lines[K];
+  int r;
+
+  for (r = 0; r < K; r++)
+    {
+      if ((a[r] >> (W - OVERLAP)) != (b[r] & ((1u << OVERLAP) -1)))
+	return 0;
+
+      lines[r] = (uint8_t) (a[r] | (b[r] >> OVERLAP) << W);
+    }
+
+  return checker_bar_valid<K, 2 * W - OVERLAP>(lines);
+}
+
+/*
+ * Function: checker_set
+ * ---------------------
+ * Sets the checkers of bars with K lines
+ */
+template <int K, int W, int OVERLAP>
+void checker_set(hk_checker *checker)
+{
+  checker->bar_valid = checker_bar_valid<K, W>;
+  checker->seam_valid = checker_seam_valid<K, W, OVERLAP>;
+}
+
+/*
+ * Function: select_checker
+ * ------------------------
+ * Selects the checkers specialized for the number of lines given
+ *
+ *       k: the number of lines of the hexagonal grid
+ * checker: where the checkers are stored
+ *
+ * returns: 1 if there are specialized checkers for k, otherwise, 0
+ */
+template <int W, int OVERLAP>
+int select_checker(int k, hk_checker *checker)
+{
+  switch (k)
+    {
+    case 2:  checker_set<2, W, OVERLAP>(checker);  return 1;
+    case 3:  checker_set<3, W, OVERLAP>(checker);  return 1;
+    case 4:  checker_set<4, W, OVERLAP>(checker);  return 1;
+    case 5:  checker_set<5, W, OVERLAP>(checker);  return 1;
+    case 6:  checker_set<6, W, OVERLAP>(checker);  return 1;
+    case 7:  checker_set<7, W, OVERLAP>(checker);  return 1;
+    case 8:  checker_set<8, W, OVERLAP>(checker);  return 1;
+    case 9:  checker_set<9, W, OVERLAP>(checker);  return 1;
+    case 10: checker_set<10, W, OVERLAP>(checker); return 1;
+    }
+
+  return 0;
+}
+
+/*
+ * Function: checker_lines
+ * -----------------------
+ * Stores a bar given as an array of 0s and 1s (line by line) with one
+ * byte per line
+ *
+ *   bar: the bar
+ *     k: the number of lines of the bar
+ * width: the number of columns of the bar
+ * lines: where the lines are stored
+ */
+inline void checker_lines(const int *bar, int k, int width, uint8_t *lines)
+{
+  int r, c;
+
+  for (r = 0; r < k; r++)
+    {
+      lines[r] = 0;
+      for (c = 0; c < width; c++)
+	if (bar[r * width + c] == 1)
+	  lines[r] |= (uint8_t) (1u << c);
+    }
+}
+
+#endif
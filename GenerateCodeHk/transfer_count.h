@@ -0,0 +1,445 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Counting of the bar codes of H_k and of the arcs of the configuration
+   graph without building them (--count). A bar with w columns is valid
+   when the vertices which are not in the first or last column have non
+   empty and pairwise distinct identifiers. The bar codes are the valid
+   bars with 4 columns, and an arc of the configuration graph is a valid
+   union of two bar codes: a valid bar with 6 columns (two overlapping
+   columns, 6bar program) or with 8 columns (8bar program).
+
+   The valid bars are counted line by line by a transfer matrix. The
+   identifiers of two vertices whose lines differ by 2 never coincide
+   (the vertical edges between the lines r -1 and r and between r and
+   r +1 are in different columns), so when the line m +1 is added only
+   the identifiers of the line m have to be checked, against each other
+   and against the ones of the line m -1. Hence the state of the
+   transfer matrix after the line m is the pair of lines m -1 and m plus
+   the vertices of the line m -2 linked to the line m -1 by a vertical
+   edge in a column which is checked. A missing line has the same effect
+   as an empty line on the identifiers, so the bars with k lines are
+   closed by adding an empty line k.
+*/
+
+#ifndef TRANSFER_COUNT_H
+#define TRANSFER_COUNT_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// the widest bar counted (a state has 2 w + (w -1) / 2 bits)
+#define COUNT_MAX_WIDTH 8
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: count_layout
+ * --------------------
+ * The columns of a bar used by the transfer matrix
+ *
+ *       width: the number of columns of the bar
+ *    vertical: vertical[p] has the columns c, not in the first or last
+ *              column, with c % 2 == p (the vertical edges between the
+ *              lines r and r +1 are in the columns with c % 2 == r % 2)
+ *    low_bits: the number of bits used to store the vertices of the line
+ *              m -2 of a state
+ */
+struct count_layout
+{
+  int                width;
+  std::vector<int>   vertical[2];
+  int                low_bits;
+};
+
+typedef struct count_layout count_layout;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: count_init_layout
+ * ---------------------------
+ * Computes the columns used by the transfer matrix of a bar
+ *
+ *  width: the number of columns of the bar
+ * layout: where the columns are stored
+ */
+inline void count_init_layout(int width, count_layout *layout)
+{
+  int c, p;
+
+  layout->width = width;
+  layout->low_bits = 0;
+
+  for (p = 0; p < 2; p++)
+    {
+      layout->vertical[p].clear();
+      for (c = 1; c < width -1; c++)
+	if (c % 2 == p)
+	  layout->vertical[p].push_back(c);
+
+      if ((int) layout->vertical[p].size() > layout->low_bits)
+	layout->low_bits = (int) layout->vertical[p].size();
+    }
+}
+
+/*
+ * Function: count_identifier
+ * --------------------------
+ * returns: the identifier of the vertex (r, c) of a window of four lines
+ *          (the line j of the window is in the bits j w .. j w + w -1),
+ *          where the vertical edges between the lines j and j +1 are in
+ *          the columns with c % 2 == (j + parity) % 2
+ */
+inline uint32_t count_identifier(uint32_t window, int r, int c, int width,
+				 int parity)
+{
+  uint32_t mask;
+
+  mask = 7u << (width * r + c -1);
+
+  if (r < 3 && c % 2 == (r + parity) % 2)
+    mask |= 1u << (width * (r +1) + c);
+  if (r > 0 && c % 2 == (r -1 + parity) % 2)
+    mask |= 1u << (width * (r -1) + c);
+
+  return window & mask;
+}
+
+/*
+ * Function: count_line_ids
+ * ------------------------
+ * Computes the identifiers of the line 2 of a window (the line m) and
+ * checks that they are not empty and pairwise distinct; they only
+ * depend on the line m, on the line m +1 and on the vertices of the line
+ * m -1 linked to the line m
+ *
+ * window: the lines m -2 .. m +1 of a bar
+ *  width: the number of columns of the bar
+ * parity: m % 2
+ *     id: where the identifiers are stored
+ *
+ * returns: 1 if the identifiers are valid, otherwise, 0
+ */
+inline int count_line_ids(uint32_t window, int width, int parity,
+			  uint32_t *id)
+{
+  int c, d;
+
+  for (c = 1; c < width -1; c++)
+    {
+      id[c] = count_identifier(window, 2, c, width, parity);
+      if (id[c] == 0)
+	return 0;
+
+      for (d = 1; d < c; d++)
+	if (id[d] == id[c])
+	  return 0;
+    }
+
+  return 1;
+}
+
+/*
+ * Function: count_below_distinct
+ * ------------------------------
+ * returns: 1 if the identifiers of the line 1 of the window (the line
+ *          m -1) are distinct from the identifiers id of the line m,
+ *          otherwise, 0
+ */
+inline int count_below_distinct(uint32_t window, int width, int parity,
+				const uint32_t *id)
+{
+  uint32_t low;
+  int c, d;
+
+  for (d = 1; d < width -1; d++)
+    {
+      low = count_identifier(window, 1, d, width, parity);
+      for (c = 1; c < width -1; c++)
+	if (id[c] == low)
+	  return 0;
+    }
+
+  return 1;
+}
+
+/*
+ * Function: count_line_valid
+ * --------------------------
+ * Checks the identifiers of the line 2 of a window (the line m): not
+ * empty, pairwise distinct and distinct from the ones of the line 1
+ *
+ * window: the lines m -2 .. m +1 of a bar
+ *  width: the number of columns of the bar
+ * parity: m % 2
+ *  first: 1 if m == 0 (there is no line m -1), otherwise, 0
+ *
+ * returns: 1 if the line m is valid, otherwise, 0
+ */
+inline int count_line_valid(uint32_t window, int width, int parity,
+			    int first)
+{
+  uint32_t id[COUNT_MAX_WIDTH];
+
+  if (count_line_ids(window, width, parity, id) == 0)
+    return 0;
+
+  if (first == 1)
+    return 1;
+
+  return count_below_distinct(window, width, parity, id);
+}
+
+/*
+ * Function: count_expand
+ * ----------------------
+ * returns: the line with the vertices stored in the first bits of bits
+ *          placed in the given columns
+ */
+inline uint32_t count_expand(uint32_t bits, const std::vector<int> &columns)
+{
+  uint32_t line;
+  int i;
+
+  line = 0;
+  for (i = 0; i < (int) columns.size(); i++)
+    if (bits & (1u << i))
+      line |= 1u << columns[i];
+
+  return line;
+}
+
+/*
+ * Function: count_add
+ * -------------------
+ * Adds x to *sum, setting *overflow when the type of the counter cannot
+ * represent the result
+ */
+template <typename T>
+inline void count_add(T *sum, T x, int *overflow)
+{
+  *sum += x;
+  if (*sum < x)
+    *overflow = 1;
+}
+
+/*
+ * Function: count_valid_bars
+ * --------------------------
+ * Counts the valid bars with width columns and 1, 2, ..., max_lines
+ * lines
+ *
+ *     width: the number of columns of a bar (at most COUNT_MAX_WIDTH)
+ * max_lines: the largest number of lines
+ *     total: total[k] = the number of valid bars with k lines
+ *     exact: exact[k] = 1 if total[k] did not overflow T, otherwise, 0
+ *
+ * returns: 1 if the bars were counted, otherwise, 0 (invalid width)
+ */
+template <typename T>
+int count_valid_bars(int width, int max_lines, std::vector<T> *total,
+		     std::vector<int> *exact)
+{
+  count_layout layout;
+  std::vector<T> cur, next;
+  size_t amt_states;
+  uint32_t line_mask;
+  int m, overflow, step_overflow, parity;
+
+  if (width < 3 || width > COUNT_MAX_WIDTH || max_lines < 1)
+    return 0;
+
+  count_init_layout(width, &layout);
+  line_mask = (1u << width) -1;
+  amt_states = (size_t) 1 << (layout.low_bits + 2 * width);
+
+  total->assign(max_lines +1, 0);
+  exact->assign(max_lines +1, 1);
+
+  // a state is low | line m -1 << low_bits | line m << (low_bits + w);
+  // before the line 0, the lines -2 and -1 are empty
+  cur.assign(amt_states, 0);
+  next.assign(amt_states, 0);
+  for (uint32_t c = 0; c <= line_mask; c++)
+    cur[(size_t) c << (layout.low_bits + width)] = 1;
+
+  overflow = 0;
+  for (m = 0; m < max_lines; m++)
+    {
+      const std::vector<int> &low_columns = layout.vertical[m % 2];
+      const std::vector<int> &next_columns = layout.vertical[(m +1) % 2];
+      parity = m % 2;
+
+      // closes the bars with m +1 lines with an empty line m +1
+      T closed;
+      closed = 0;
+      for (size_t s = 0; s < amt_states; s++)
+	{
+	  uint32_t low, below, line, window;
+
+	  if (cur[s] == 0)
+	    continue;
+
+	  low = count_expand(s & ((1u << layout.low_bits) -1), low_columns);
+	  below = (s >> layout.low_bits) & line_mask;
+	  line = (s >> (layout.low_bits + width)) & line_mask;
+	  window = low | below << width | line << (2 * width);
+
+	  if (count_line_valid(window, width, parity, m == 0) == 1)
+	    count_add(&closed, cur[s], &overflow);
+	}
+
+      (*total)[m +1] = closed;
+      (*exact)[m +1] = (overflow == 0) ? 1 : 0;
+
+      if (m +1 == max_lines)
+	break;
+
+      // adds the line m +1: the state (low', line m, line m +1) comes
+      // from the states (low, below, line m) whose line below has the
+      // vertices low' in the columns linked to the line m
+      step_overflow = 0;
+
+      # pragma omp parallel for schedule(dynamic, 1024) reduction(|:step_overflow)
+      for (size_t t = 0; t < amt_states; t++)
+	{
+	  uint32_t low_next, line, above, fixed, free_mask, below, low, window;
+	  uint32_t id[COUNT_MAX_WIDTH];
+	  T sum;
+	  size_t s;
+
+	  next[t] = 0;
+	  low_next = t & ((1u << layout.low_bits) -1);
+	  if (low_next >> next_columns.size() != 0)
+	    continue;
+
+	  line = (t >> layout.low_bits) & line_mask;
+	  above = (t >> (layout.low_bits + width)) & line_mask;
+	  fixed = count_expand(low_next, next_columns);
+	  free_mask = line_mask & ~count_expand((1u << next_columns.size()) -1,
+						next_columns);
+	  sum = 0;
+
+	  // the identifiers of the line m do not depend on the state
+	  if (count_line_ids(fixed << width | line << (2 * width) |
+			     above << (3 * width), width, parity, id) == 0)
+	    continue;
+
+	  // the line below runs over the lines with the vertices fixed
+	  below = 0;
+	  do
+	    {
+	      for (low = 0; low < (1u << low_columns.size()); low++)
+		{
+		  s = (size_t) low | (size_t) (below | fixed) << layout.low_bits |
+		    (size_t) line << (layout.low_bits + width);
+
+		  if (cur[s] == 0)
+		    continue;
+
+		  window = count_expand(low, low_columns) |
+		    (below | fixed) << width | line << (2 * width) |
+		    above << (3 * width);
+
+		  if (m == 0 ||
+		      count_below_distinct(window, width, parity, id) == 1)
+		    count_add(&sum, cur[s], &step_overflow);
+		}
+
+	      below = (below - free_mask) & free_mask;
+	    }
+	  while (below != 0);
+
+	  next[t] = sum;
+	}
+
+      overflow |= step_overflow;
+      cur.swap(next);
+    }
+
+  return 1;
+}
+
+/*
+ * Function: count_to_string
+ * -------------------------
+ * returns: the decimal representation of a 128 bits counter
+ */
+inline std::string count_to_string(unsigned __int128 x)
+{
+  std::string digits;
+
+  do
+    {
+      digits.insert(digits.begin(), (char) ('0' + (int) (x % 10)));
+      x /= 10;
+    }
+  while (x != 0);
+
+  return digits;
+}
+
+/*
+ * Function: print_counts
+ * ----------------------
+ * Outputs, for k = 2, ..., max_lines, the number of bar codes of H_k and
+ * the number of arcs of its configuration graph; the numbers which do
+ * not fit in 128 bits are approximated
+ *
+ *     max_lines: the largest number of lines
+ *     bar_width: the number of columns of a bar code
+ *   union_width: the number of columns of the union of the two bar codes
+ *                of an arc
+ *
+ * returns: 1 if the numbers were computed, otherwise, 0
+ */
+inline int print_counts(int max_lines, int bar_width, int union_width)
+{
+  std::vector<unsigned __int128> bars, arcs;
+  std::vector<long double> approx_bars, approx_arcs;
+  std::vector<int> exact_bars, exact_arcs, unused;
+  int k;
+
+  if (count_valid_bars(bar_width, max_lines, &bars, &exact_bars) == 0 ||
+      count_valid_bars(union_width, max_lines, &arcs, &exact_arcs) == 0)
+    return 0;
+
+  if (exact_bars[max_lines] == 0)
+    count_valid_bars(bar_width, max_lines, &approx_bars, &unused);
+  if (exact_arcs[max_lines] == 0)
+    count_valid_bars(union_width, max_lines, &approx_arcs, &unused);
+
+  std::cout << "lines\tbar codes\tarcs\n";
+  for (k = 2; k <= max_lines; k++)
+    {
+      std::cout << k << "\t";
+
+      if (exact_bars[k] == 1)
+	std::cout << count_to_string(bars[k]);
+      else
+	std::cout << "~" << (double) approx_bars[k];
+
+      std::cout << "\t";
+
+      if (exact_arcs[k] == 1)
+	std::cout << count_to_string(arcs[k]);
+      else
+	std::cout << "~" << (double) approx_arcs[k];
+
+      std::cout << "\n";
+    }
+
+  return 1;
+}
+
+#endif
@@ -0,0 +1,282 @@
+/* Description - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+   Authors:
+   Gabriel Sobral      - IME USP
+   Yoshiko Wakabayashi - IME USP
+   Rudini Sampaio      - UFC
+
+   Implementation of a minimum mean cycle algorithm in the tropical
+   (min-plus) algebra, for configuration graphs with few vertices (small
+   k). The configuration graph is stored as a dense matrix and Karp's
+   table D_l[v] (the minimum weight of a walk with l arcs ending at v)
+   is computed by n min-plus products D_{l+1} = D_l (x) A. The products
+   are blocked over four columns of A, whose inner loop is a min
+   reduction over contiguous memory that the compiler vectorizes.
+
+   Since it does not share any code with LEMON, it is also used to
+   cross-check the cycle mean found by the other engines.
+*/
+
+#ifndef TROPICAL_MMC_H
+#define TROPICAL_MMC_H
+
+
+/* Libraries - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+#include <vector>
+#include <climits>
+#include <lemon/smart_graph.h>
+#include <lemon/path.h>
+
+
+/* Macros - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+// the largest configuration graph accepted: the matrix and Karp's table
+// have n^2 entries each
+#define TROPICAL_MAX_NODES 4096
+
+// the "infinity" of the min-plus algebra; INF + INF does not overflow
+#define TROPICAL_INF (INT_MAX / 4)
+
+
+/* Data Structure Declaration - - - - - - - - - - - - - - - - - - - - - */
+/*
+ * Struct: tropical_matrix
+ * -----------------------
+ * A dense matrix of the min-plus algebra, stored by columns:
+ * entry[j * n + i] is the smallest weight of an arc (i, j), or
+ * TROPICAL_INF if there is no such arc
+ */
+struct tropical_matrix
+{
+  int              n;
+  std::vector<int> entry;
+};
+
+typedef struct tropical_matrix tropical_matrix;
+
+
+/* Function Implementation - - - - - - - - - - - - - - - - - - - - - - -*/
+/*
+ * Function: tropical_build_matrix
+ * -------------------------------
+ * Builds the dense adjacency matrix of the configuration graph
+ */
+inline void tropical_build_matrix(const lemon::SmartDigraph &G,
+				  const lemon::SmartDigraph::ArcMap<int> &weight,
+				  tropical_matrix *A)
+{
+  long long position;
+
+  A->n = lemon::countNodes(G);
+  A->entry.assign((size_t) A->n * A->n, TROPICAL_INF);
+
+  for (lemon::SmartDigraph::ArcIt a(G); a != lemon::INVALID; ++a)
+    {
+      position = (long long) G.id(G.target(a)) * A->n + G.id(G.source(a));
+
+      if (weight[a] < A->entry[position])
+	A->entry[position] = weight[a];
+    }
+}
+
+/*
+ * Function: tropical_vector_product
+ * ---------------------------------
+ * Computes y = x (x) A, that is, y[j] = min_i x[i] + A[i][j]. The
+ * columns of A are processed four at a time, so each x[i] loaded is
+ * used four times, and the columns are split among the threads
+ */
+inline void tropical_vector_product(const tropical_matrix &A, const int *x,
+				    int *y)
+{
+  int n, j;
+
+  n = A.n;
+
+  # pragma omp parallel for schedule(static)
+  for (j = 0; j < n; j += 4)
+    {
+      const int *c0, *c1, *c2, *c3;
+      int m0, m1, m2, m3;
+      int i, amt;
+
+      amt = (n - j < 4) ? n - j : 4;
+      c0 = &A.entry[(size_t) j * n];
+      c1 = (amt > 1) ? c0 + n : c0;
+      c2 = (amt > 2) ? c0 + 2 * n : c0;
+      c3 = (amt > 3) ? c0 + 3 * n : c0;
+      m0 = m1 = m2 = m3 = TROPICAL_INF;
+
+      # pragma omp simd reduction(min:m0, m1, m2, m3)
+      for (i = 0; i < n; i++)
+	{
+	  m0 = (x[i] + c0[i] < m0) ? x[i] + c0[i] : m0;
+	  m1 = (x[i] + c1[i] < m1) ? x[i] + c1[i] : m1;
+	  m2 = (x[i] + c2[i] < m2) ? x[i] + c2[i] : m2;
+	  m3 = (x[i] + c3[i] < m3) ? x[i] + c3[i] : m3;
+	}
+
+      y[j] = m0;
+      if (amt > 1)
+	y[j +1] = m1;
+      if (amt > 2)
+	y[j +2] = m2;
+      if (amt > 3)
+	y[j +3] = m3;
+    }
+}
+
+/*
+ * Function: tropical_mmc
+ * ----------------------
+ * Finds a minimum mean cycle of the configuration graph with Karp's
+ * algorithm over the dense min-plus matrix of the graph
+ *
+ *          G: the configuration graph
+ *     weight: the non negative (integer) weights of the arcs of G
+ *      cycle: where the arcs of the minimum mean cycle are stored
+ *       cost: the total weight of the cycle
+ *       size: the number of arcs of the cycle
+ * iterations: the number of min-plus products performed (may be NULL)
+ *
+ * returns: 1 if G has a cycle, 0 if it is acyclic, and -1 if G is too
+ *          large for the dense representation (or has negative weights)
+ */
+inline int tropical_mmc(const lemon::SmartDigraph &G,
+			const lemon::SmartDigraph::ArcMap<int> &weight,
+			lemon::Path<lemon::SmartDigraph> *cycle,
+			long long *cost, int *size, int *iterations)
+{
+  tropical_matrix A;
+  std::vector<int> D;          // Karp's table, (n +1) rows of n entries
+  std::vector<int> walk;       // the vertices of the critical walk
+  std::vector<int> position;   // position of a vertex in the stack
+  std::vector<int> stack;
+  long long best_num, best_den, num, den, c;
+  int n, w_min, w_max, v, best_v, l, i, j, s, t;
+  lemon::SmartDigraph::Arc arc;
+
+  cycle->clear();
+  *cost = 0;
+  *size = 0;
+
+  n = lemon::countNodes(G);
+  if (n == 0)
+    return 0;
+
+  // a negative weight added to TROPICAL_INF would look like an arc
+  w_min = 0;
+  w_max = 0;
+  for (lemon::SmartDigraph::ArcIt a(G); a != lemon::INVALID; ++a)
+    {
+      if (weight[a] < w_min)
+	w_min = weight[a];
+      if (weight[a] > w_max)
+	w_max = weight[a];
+    }
+
+  if (n > TROPICAL_MAX_NODES || w_min < 0 ||
+      (long long) n * w_max >= TROPICAL_INF)
+    return -1;
+
+  tropical_build_matrix(G, weight, &A);
+
+  // D_0 = 0 (walks from a virtual source) and D_{l+1} = D_l (x) A
+  D.assign((size_t) (n +1) * n, 0);
+  for (l = 0; l < n; l++)
+    tropical_vector_product(A, &D[(size_t) l * n], &D[(size_t) (l +1) * n]);
+
+  if (iterations != NULL)
+    *iterations = n;
+
+  // Karp's theorem: the minimum mean is
+  // min_v max_l (D_n[v] - D_l[v]) / (n - l), compared as fractions
+  best_v = -1;
+  best_num = 0;
+  best_den = 1;
+
+  for (v = 0; v < n; v++)
+    {
+      if (D[(size_t) n * n + v] >= TROPICAL_INF)
+	continue;
+
+      num = 0;
+      den = 0;
+      for (l = 0; l < n; l++)
+	{
+	  if (D[(size_t) l * n + v] >= TROPICAL_INF)
+	    continue;
+
+	  c = D[(size_t) n * n + v] - D[(size_t) l * n + v];
+	  if (den == 0 || c * den > num * (n - l))
+	    {
+	      num = c;
+	      den = n - l;
+	    }
+	}
+
+      if (den != 0 && (best_v == -1 || num * best_den < best_num * den))
+	{
+	  best_v = v;
+	  best_num = num;
+	  best_den = den;
+	}
+    }
+
+  if (best_v == -1)
+    return 0;
+
+  // rebuilds the walk with n arcs which ends at best_v, going backwards
+  // through the table
+  walk.resize(n +1);
+  walk[n] = best_v;
+  for (l = n; l > 0; l--)
+    {
+      v = walk[l];
+      for (i = 0; i < n; i++)
+	if (D[(size_t) (l -1) * n + i] < TROPICAL_INF &&
+	    A.entry[(size_t) v * n + i] < TROPICAL_INF &&
+	    D[(size_t) (l -1) * n + i] + A.entry[(size_t) v * n + i] ==
+	    D[(size_t) l * n + v])
+	  break;
+
+      walk[l -1] = i;
+    }
+
+  // every cycle of this walk is a minimum mean cycle; the first one
+  // closed while the walk is pushed on a stack is taken
+  position.assign(n, -1);
+  s = 0;
+  t = 0;
+  for (j = 0; j <= n; j++)
+    {
+      v = walk[j];
+      if (position[v] != -1)
+	{
+	  s = position[v];
+	  t = (int) stack.size();
+	  break;
+	}
+
+      position[v] = (int) stack.size();
+      stack.push_back(v);
+    }
+
+  stack.push_back(walk[j]);
+  for (i = s; i < t; i++)
+    {
+      // the lightest arc between two consecutive vertices of the cycle
+      arc = lemon::INVALID;
+      for (lemon::SmartDigraph::OutArcIt a(G, G.nodeFromId(stack[i]));
+	   a != lemon::INVALID; ++a)
+	if (G.id(G.target(a)) == stack[i +1] &&
+	    (arc == lemon::INVALID || weight[a] < weight[arc]))
+	  arc = a;
+
+      cycle->addBack(arc);
+      *cost += weight[arc];
+      (*size)++;
+    }
+
+  return 1;
+}
+
+#endif